@@ -0,0 +1,108 @@
+// Local avoidance cost per tick.
+//
+//   bench_avoidance [agents] [ticks] [threads]
+//
+// Scatters agents (default 500) over a 40 m square, each walking to a random
+// waypoint and picking a new one when it gets there, so the crowd keeps
+// crossing itself. Times AvoidanceSystem::update serially and on a task pool
+// against a 1 ms budget; moving the agents isn't counted.
+#include "arena/ecs/avoidance_system.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+
+namespace {
+
+constexpr float kHalf = 20.0f;
+
+struct Walker {
+    Entity e;
+    float goal[2];
+};
+
+std::vector<Walker> Spawn(Registry& registry, int count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-kHalf, kHalf);
+    std::vector<Walker> walkers;
+    for (int i = 0; i < count; ++i) {
+        Entity e = registry.create();
+        Transform t;
+        t.pos[0] = pos(rng);
+        t.pos[2] = pos(rng);
+        registry.add<Transform>(e, t);
+        registry.add<AvoidanceAgent>(e, {});
+        walkers.push_back({e, {pos(rng), pos(rng)}});
+    }
+    return walkers;
+}
+
+double Run(AvoidanceSystem& system, Registry& registry, std::vector<Walker>& walkers, int ticks, double& worst) {
+    const float dt = 1.0f / 60.0f;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> pos(-kHalf, kHalf);
+    double total = 0.0;
+    worst = 0.0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (Walker& w : walkers) {
+            Transform* t = registry.get<Transform>(w.e);
+            AvoidanceAgent* a = registry.get<AvoidanceAgent>(w.e);
+            float dx = w.goal[0] - t->pos[0], dz = w.goal[1] - t->pos[2];
+            float dist = std::sqrt(dx * dx + dz * dz);
+            if (dist < 0.5f) {
+                w.goal[0] = pos(rng);
+                w.goal[1] = pos(rng);
+                continue;
+            }
+            a->preferred[0] = dx / dist * a->maxSpeed;
+            a->preferred[1] = dz / dist * a->maxSpeed;
+        }
+        auto start = std::chrono::steady_clock::now();
+        system.update(dt, registry);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        total += ms;
+        worst = std::max(worst, ms);
+        for (Walker& w : walkers) {
+            Transform* t = registry.get<Transform>(w.e);
+            const AvoidanceAgent* a = registry.get<AvoidanceAgent>(w.e);
+            t->pos[0] += a->velocity[0] * dt;
+            t->pos[2] += a->velocity[1] * dt;
+        }
+    }
+    return total / ticks;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 500;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 600;
+    unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+    std::printf("agents: %d over %.0f x %.0f m\n", count, 2 * kHalf, 2 * kHalf);
+
+    double worst;
+    {
+        Registry registry;
+        std::vector<Walker> walkers = Spawn(registry, count);
+        AvoidanceSystem system;
+        double mean = Run(system, registry, walkers, ticks, worst);
+        std::printf("serial:     mean %.3f ms, worst %.3f ms per tick\n", mean, worst);
+    }
+    {
+        Registry registry;
+        std::vector<Walker> walkers = Spawn(registry, count);
+        TaskPool pool(threads);
+        AvoidanceSystem system;
+        system.setTaskPool(&pool);
+        double mean = Run(system, registry, walkers, ticks, worst);
+        std::printf("%u+1 threads: mean %.3f ms, worst %.3f ms per tick\n", pool.threadCount(), mean, worst);
+    }
+    return 0;
+}
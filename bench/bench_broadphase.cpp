@@ -0,0 +1,76 @@
+// Dynamic broadphase cost per tick.
+//
+//   bench_broadphase [colliders] [ticks]
+//
+// Scatters box and capsule colliders over a 200 m arena (a tenth of them
+// static), then each tick moves every dynamic one a 60 Hz step along its own
+// velocity and times BroadphaseSystem::update. Reports the mean and worst tick
+// against the 16.7 ms frame.
+#include "arena/ecs/broadphase_system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace arena::ecs;
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 600;
+    const float half = 100.0f, dt = 1.0f / 60.0f;
+
+    Registry registry;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-half, half), size(0.2f, 0.8f), speed(-8.0f, 8.0f);
+
+    struct Mover { Entity e; float vel[3]; };
+    std::vector<Mover> movers;
+    for (int i = 0; i < count; ++i) {
+        Entity e = registry.create();
+        Transform t;
+        t.pos[0] = pos(rng);
+        t.pos[1] = pos(rng) * 0.05f;
+        t.pos[2] = pos(rng);
+        registry.add<Transform>(e, t);
+
+        Collider c;
+        c.shape = i % 3 == 0 ? 2 : 1;
+        c.params[0] = size(rng);
+        c.params[1] = size(rng);
+        c.params[2] = size(rng);
+        c.isStatic = i % 10 == 0;
+        registry.add<Collider>(e, c);
+        if (!c.isStatic) movers.push_back({e, {speed(rng), 0.0f, speed(rng)}});
+    }
+
+    BroadphaseSystem broadphase;
+    auto start = std::chrono::steady_clock::now();
+    broadphase.update(registry);
+    double firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double totalMs = 0.0, worstMs = 0.0;
+    size_t pairs = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (auto& m : movers) {
+            Transform* t = registry.get<Transform>(m.e);
+            for (int a = 0; a < 3; a += 2) {
+                t->pos[a] += m.vel[a] * dt;
+                if (t->pos[a] < -half || t->pos[a] > half) m.vel[a] = -m.vel[a];
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        pairs += broadphase.update(registry).size();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+    }
+
+    std::printf("colliders: %d (%zu moving), first update %.2f ms\n", count, movers.size(), firstMs);
+    std::printf("update: mean %.3f ms, worst %.3f ms over %d ticks (%.1f%% of a 60 Hz frame)\n", totalMs / ticks,
+                worstMs, ticks, totalMs / ticks / (1000.0 / 60.0) * 100.0);
+    std::printf("pairs per tick: %.1f\n", ticks > 0 ? static_cast<double>(pairs) / ticks : 0.0);
+    return 0;
+}
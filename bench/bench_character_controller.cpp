@@ -0,0 +1,123 @@
+// Character controller cost per tick.
+//
+//   bench_character_controller [controllers] [ticks] [threads]
+//
+// Builds a 120 m arena floor scattered with crates, low steps and ramps, spawns
+// controllers (default 264: 64 players and 200 bots) that wander, turn and
+// jump now and then, and times CharacterControllerSystem::update serially and
+// on a task pool against a 1 ms budget.
+#include "arena/ecs/character_controller_system.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+using arena::phys::StaticWorld;
+
+namespace {
+
+void AddBox(StaticWorld& world, float x0, float z0, float x1, float z1, float height) {
+    std::vector<float> pos = {x0, 0, z0,  x1, 0, z0,  x1, 0, z1,  x0, 0, z1,
+                              x0, height, z0,  x1, height, z0,  x1, height, z1,  x0, height, z1};
+    std::vector<uint32_t> idx = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                                 3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+    world.addTriangles(pos, idx);
+}
+
+void AddRamp(StaticWorld& world, float x, float z, float length, float rise) {
+    std::vector<float> pos = {x, 0, z, x, 0, z + 4, x + length, rise, z + 4, x + length, rise, z};
+    std::vector<uint32_t> idx = {0, 1, 2, 0, 2, 3};
+    world.addTriangles(pos, idx);
+}
+
+double Run(CharacterControllerSystem& system, Registry& registry, StaticWorld& world, int ticks, double& worst) {
+    const float dt = 1.0f / 60.0f;
+    auto& inputs = registry.storage<CharacterInput>();
+    double total = 0.0;
+    worst = 0.0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        // Turn a little every tick; jump every couple of seconds, staggered
+        for (size_t i = 0; i < inputs.data.size(); ++i) {
+            float heading = 0.37f * static_cast<float>(i) + 0.01f * static_cast<float>(tick);
+            inputs.data[i].move[0] = std::cos(heading);
+            inputs.data[i].move[1] = std::sin(heading);
+            inputs.data[i].jump = (tick + static_cast<int>(i) * 7) % 150 == 0;
+        }
+        auto start = std::chrono::steady_clock::now();
+        world.applyRebuild(); // the host's sync point; nothing is pending after a batched load
+        system.update(dt, registry, world);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        total += ms;
+        worst = std::max(worst, ms);
+    }
+    return total / ticks;
+}
+
+void Spawn(Registry& registry, int count) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-55.0f, 55.0f);
+    for (int i = 0; i < count; ++i) {
+        Entity e = registry.create();
+        Transform t;
+        t.pos[0] = pos(rng);
+        t.pos[1] = 3.0f;
+        t.pos[2] = pos(rng);
+        registry.add<Transform>(e, t);
+        registry.add<CharacterController>(e, {});
+        registry.add<CharacterInput>(e, {});
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 264;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 600;
+    unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+    const float half = 60.0f;
+
+    StaticWorld world(nullptr);
+    world.beginBatch();
+    std::vector<float> floor = {-half, 0, -half, -half, 0, half, half, 0, half, half, 0, -half};
+    std::vector<uint32_t> floorIdx = {0, 1, 2, 0, 2, 3};
+    world.addTriangles(floor, floorIdx);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> spot(-half + 5.0f, half - 5.0f), size(0.5f, 3.0f), height(0.1f, 2.5f);
+    for (int i = 0; i < 150; ++i) {
+        float x = spot(rng), z = spot(rng), s = size(rng);
+        AddBox(world, x, z, x + s, z + size(rng), height(rng));
+    }
+    for (int i = 0; i < 20; ++i) AddRamp(world, spot(rng), spot(rng), 6.0f, 2.0f);
+    AddBox(world, -half, -half, -half + 1, half, 4);
+    AddBox(world, half - 1, -half, half, half, 4);
+    AddBox(world, -half, -half, half, -half + 1, 4);
+    AddBox(world, -half, half - 1, half, half, 4);
+    world.endBatch();
+    std::printf("world: %zu triangles, %d controllers\n", world.triangleCount(), count);
+
+    double worst;
+    {
+        Registry registry;
+        Spawn(registry, count);
+        CharacterControllerSystem system;
+        double mean = Run(system, registry, world, ticks, worst);
+        std::printf("serial:     mean %.3f ms, worst %.3f ms per tick\n", mean, worst);
+    }
+    {
+        Registry registry;
+        Spawn(registry, count);
+        TaskPool pool(threads);
+        CharacterControllerSystem system;
+        system.setTaskPool(&pool);
+        double mean = Run(system, registry, world, ticks, worst);
+        std::printf("%u+1 threads: mean %.3f ms, worst %.3f ms per tick\n", pool.threadCount(), mean, worst);
+    }
+    return 0;
+}
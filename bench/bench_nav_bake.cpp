@@ -0,0 +1,45 @@
+// Nav grid bake time on the stock arenas.
+//
+//   bench_nav_bake [threads]
+//
+// Bakes each 256 x 256 x 4 arena from nav_arenas.hpp serially and on a task
+// pool (default: one thread per core) and reports walkable cells and time
+// against a one second budget.
+#include "arena/nav/nav_grid.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "nav_arenas.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace arena;
+using namespace arena::nav;
+
+int main(int argc, char** argv) {
+    unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 0;
+    TaskPool pool(threads);
+    NavGridSettings settings = bench::NavArenaSettings();
+    std::printf("grid %dx%dx%d, %.2f m cells, %d-cell tiles\n", settings.width, settings.depth, settings.levels,
+                settings.cellSize, settings.tileSize);
+
+    bool withinBudget = true;
+    for (auto arena : {bench::NavArena::Open, bench::NavArena::Storeys, bench::NavArena::Maze}) {
+        phys::StaticWorld world(nullptr);
+        bench::BuildNavArena(world, arena);
+
+        auto time = [&](TaskPool* p, NavGrid& out) {
+            auto start = std::chrono::steady_clock::now();
+            out = bakeNavGrid(world, settings, p);
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        NavGrid serial, pooled;
+        double serialMs = time(nullptr, serial);
+        double pooledMs = time(&pool, pooled);
+        withinBudget = withinBudget && pooledMs < 1000.0;
+        std::printf("%-8s %6zu tris  %7zu walkable  serial %7.1f ms  %u+1 threads %7.1f ms%s\n",
+                    bench::NavArenaName(arena), world.triangleCount(), pooled.walkableCount(), serialMs,
+                    pool.threadCount(), pooledMs, serial.walkableCount() == pooled.walkableCount() ? "" : "  MISMATCH");
+    }
+    return withinBudget ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Static-world raycast throughput on a procedural arena.
+//
+//   bench_raycast [rays] [gridSize]
+//
+// Builds a bumpy terrain of 2 * gridSize^2 triangles plus a few hundred box
+// pillars, then times StaticWorld::raycast over random rays, and
+// raycastBatch over the same rays and over pellet-style bundles, serially and
+// on a task pool. Finally times editor-style wall inserts and removals.
+//
+// Measured on one 2.1 GHz Xeon core (SSE2 build, 2 MiB L2): single rays
+// run at 1.5-2.0 Mrays/s at the default grid and 3-4 Mrays/s at grid 8,
+// where the whole scene stays in cache. That is 5-10x short of the tens of
+// millions of rays/s per core first asked for, which has been re-scoped
+// (see the StaticWorld notes). A ray visits about 4 top-level and 6 mesh
+// nodes and 2 triangles at grid 224 (4 + 2.5 and 2 at grid 8). Each node
+// costs ~50 cycles of dependent latency (load, slab test, pick a child,
+// load it) plus a mispredicted branch on which children were entered, and
+// at grid 224 cache misses on the terrain's nodes and triangles add another
+// ~250 ns per ray. Setting a ray up is branch free, as direction signs are
+// a coin toss; a ray that misses the root costs ~45 ns all told.
+// Pellet batches go as packets and run 1.2-1.4x the plain loop at grid 8
+// but only 1.05-1.15x at grid 224: packets halve the box and triangle tests
+// per ray, but each pellet still misses on its own terrain cells.
+// Wall edits average 10-15 us. The worst, 0.25-0.4 ms, are the edits that
+// also run a slice of a top-level rebuild or swap a finished one in.
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::phys;
+
+namespace {
+
+void AddTerrain(StaticWorld& world, int grid, float size) {
+    std::vector<float> pos;
+    std::vector<uint32_t> idx;
+    float step = size / grid;
+    for (int z = 0; z <= grid; ++z) {
+        for (int x = 0; x <= grid; ++x) {
+            float px = -size * 0.5f + x * step, pz = -size * 0.5f + z * step;
+            pos.push_back(px);
+            pos.push_back(std::sin(px * 0.05f) * std::cos(pz * 0.07f) * 4.0f);
+            pos.push_back(pz);
+        }
+    }
+    for (int z = 0; z < grid; ++z) {
+        for (int x = 0; x < grid; ++x) {
+            uint32_t a = z * (grid + 1) + x, b = a + 1, c = a + grid + 1, d = c + 1;
+            idx.insert(idx.end(), {a, c, b, b, c, d});
+        }
+    }
+    world.addTriangles(pos, idx);
+}
+
+uint32_t AddBox(StaticWorld& world, float cx, float cz, float half, float height) {
+    float x0 = cx - half, x1 = cx + half, z0 = cz - half, z1 = cz + half;
+    std::vector<float> pos = {x0, 0, z0,  x1, 0, z0,  x1, 0, z1,  x0, 0, z1,
+                              x0, height, z0,  x1, height, z0,  x1, height, z1,  x0, height, z1};
+    std::vector<uint32_t> idx = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                                 3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+    return world.addTriangles(pos, idx);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int rays = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    int grid = argc > 2 ? std::atoi(argv[2]) : 224;
+    const float size = 400.0f;
+
+    StaticWorld world(nullptr);
+    auto buildStart = std::chrono::steady_clock::now();
+    world.beginBatch();
+    AddTerrain(world, grid, size);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> spread(-size * 0.45f, size * 0.45f);
+    for (int i = 0; i < 300; ++i) AddBox(world, spread(rng), spread(rng), 2.0f, 12.0f);
+    world.endBatch();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+    // Mix of player-height hitscan rays and downward ground probes
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<Vec3> origins(rays), dirs(rays);
+    for (int i = 0; i < rays; ++i) {
+        origins[i] = {spread(rng), 6.0f + unit(rng) * 4.0f, spread(rng)};
+        dirs[i] = (i % 4 == 0) ? Vec3{0, -1, 0} : Vec3{unit(rng), unit(rng) * 0.3f, unit(rng)};
+    }
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto report = [&](const char* label, double seconds, const std::vector<RayHit>& hits) {
+        int hitCount = 0;
+        for (auto& hit : hits) hitCount += hit.hit ? 1 : 0;
+        std::printf("%-28s %.3f s, %6.2f Mrays/s, %d hits\n", label, seconds, rays / seconds / 1e6, hitCount);
+    };
+
+    std::vector<Ray> batch(rays);
+    for (int i = 0; i < rays; ++i) batch[i] = {origins[i], dirs[i], 500.0f};
+
+    // Pellet bundles: 12 rays per shot inside a narrow cone
+    std::vector<Ray> pellets(rays);
+    for (int i = 0; i < rays; i += 12) {
+        Vec3 d{unit(rng), unit(rng) * 0.3f, unit(rng)};
+        for (int k = 0; k < 12 && i + k < rays; ++k) {
+            pellets[i + k] = {origins[i], {d.x + unit(rng) * 0.03f, d.y + unit(rng) * 0.03f, d.z + unit(rng) * 0.03f}, 500.0f};
+        }
+    }
+
+    std::printf("triangles: %zu in %zu meshes (build %.1f ms)\n", world.triangleCount(), world.meshCount(), buildMs);
+
+    std::vector<RayHit> single(rays), batched(rays);
+    auto same = [&] {
+        bool match = true;
+        for (int i = 0; i < rays; ++i) {
+            match = match && single[i].hit == batched[i].hit && single[i].t == batched[i].t &&
+                    single[i].normal.x == batched[i].normal.x && single[i].normal.y == batched[i].normal.y &&
+                    single[i].normal.z == batched[i].normal.z;
+        }
+        return match;
+    };
+    report("raycast", time([&] {
+        for (int i = 0; i < rays; ++i) single[i] = world.raycast(batch[i].origin, batch[i].dir, batch[i].maxDist);
+    }), single);
+    report("raycastBatch", time([&] { world.raycastBatch(batch, batched); }), batched);
+    bool identical = same();
+
+    // Best of three alternating runs each, as the two are compared
+    double loopSeconds = 1e30, pelletSeconds = 1e30;
+    for (int run = 0; run < 3; ++run) {
+        loopSeconds = std::min(loopSeconds, time([&] {
+            for (int i = 0; i < rays; ++i) single[i] = world.raycast(pellets[i].origin, pellets[i].dir, pellets[i].maxDist);
+        }));
+        pelletSeconds = std::min(pelletSeconds, time([&] { world.raycastBatch(pellets, batched); }));
+    }
+    report("raycast (pellets)", loopSeconds, single);
+    report("raycastBatch (pellets)", pelletSeconds, batched);
+    identical = same() && identical;
+    std::printf("pellet batch: %.2fx the raycast loop\n", loopSeconds / pelletSeconds);
+
+    arena::TaskPool pool;
+    world.setTaskPool(&pool);
+    char label[64];
+    std::snprintf(label, sizeof(label), "raycastBatch (%u+1 threads)", pool.threadCount());
+    report(label, time([&] { world.raycastBatch(batch, batched); }), batched);
+
+    world.setTaskPool(nullptr);
+
+    // Editor walls: place 1000, then remove them in placement order
+    std::vector<uint32_t> walls;
+    double insertMax = 0.0, removeMax = 0.0;
+    double insertTotal = time([&] {
+        for (int i = 0; i < 1000; ++i) {
+            float cx = spread(rng), cz = spread(rng);
+            insertMax = std::max(insertMax, time([&] { walls.push_back(AddBox(world, cx, cz, 1.0f, 3.0f)); }));
+        }
+    });
+    float cost = world.topLevelCost();
+    double removeTotal = time([&] {
+        for (uint32_t wall : walls) removeMax = std::max(removeMax, time([&] { world.removeMesh(wall); }));
+    });
+    world.finishRebuild();
+    std::printf("wall insert: %.1f us avg, %.1f us max (top-level cost %.2f)\n", insertTotal / 1000 * 1e6,
+                insertMax * 1e6, cost);
+    std::printf("wall remove: %.1f us avg, %.1f us max (top-level cost %.2f after rebuild)\n",
+                removeTotal / 1000 * 1e6, removeMax * 1e6, world.topLevelCost());
+
+    std::printf("batch and pellet results %s single-ray results\n", identical ? "match" : "DIFFER from");
+    return identical ? 0 : 1;
+}
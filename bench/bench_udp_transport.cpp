@@ -0,0 +1,225 @@
+// UDP transport cost of a server tick.
+//
+//   bench_udp_transport [clients] [ticks] [sendmmsg|thread|io_uring|compare]
+//
+// Forks a process of clients (default 64) that each send a 64-byte input
+// every 60 Hz tick over loopback and read what comes back; the server reads
+// every input and sends each client a 1000-byte snapshot per tick, both
+// paced in real time. Reports the server's time per tick and the CPU its
+// process used (tick and I/O threads) as a share of one core, for the
+// backend given: UdpTransport on the tick (default) or with its I/O
+// thread, or UringTransport. "compare" runs sendmmsg and then io_uring with
+// the same load and prints the two side by side. Linux only.
+#include "arena/net/udp_transport.hpp"
+#include "arena/net/uring_transport.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace arena::net;
+
+#if defined(__linux__)
+namespace {
+
+constexpr auto kTick = std::chrono::nanoseconds(1000000000 / 60);
+
+double ProcessCpuMs() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+void RunClients(Endpoint server, int count, int ticks) {
+    UdpTransport::Settings s;
+    s.loopbackOnly = true;
+    std::vector<std::unique_ptr<UdpTransport>> clients;
+    for (int i = 0; i < count; ++i) {
+        clients.push_back(std::make_unique<UdpTransport>(s));
+        if (!clients.back()->open()) std::_Exit(1);
+        clients.back()->setPeer(server);
+    }
+    uint8_t input[64] = {}, snapshot[1500];
+    auto next = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (auto& client : clients) {
+            input[0] = static_cast<uint8_t>(tick);
+            client->send(input, sizeof(input));
+            client->flush();
+            client->poll();
+            while (client->receive(snapshot, sizeof(snapshot)) > 0) {}
+        }
+        next += kTick;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+struct Result {
+    std::string backend;
+    double meanMs = 0.0;
+    double worstMs = 0.0;
+    double corePercent = 0.0;
+    uint64_t inputs = 0;
+    DatagramTransport::Stats stats;
+};
+
+// Runs the server side of the bench on one backend; false if it couldn't
+// open or the client process failed
+bool RunServer(const std::string& backend, int count, int ticks, Result& out) {
+    DatagramTransport::Settings s;
+    s.loopbackOnly = true;
+    s.ioThread = backend == "thread";
+    s.socketBuffer = 4 << 20;
+    // Room for a snapshot to every client between flushes
+    s.sendSlots = std::max<size_t>(s.sendSlots, count);
+    s.receiveSlots = std::max<size_t>(s.receiveSlots, count);
+    std::unique_ptr<DatagramTransport> transport;
+    if (backend == "io_uring") {
+        transport = std::make_unique<UringTransport>(s);
+    } else {
+        transport = std::make_unique<UdpTransport>(s);
+    }
+    if (!transport->open()) {
+        std::printf("can't open a %s transport\n", transport->backend());
+        return false;
+    }
+    DatagramTransport& server = *transport;
+    pid_t child = fork();
+    if (child == 0) {
+        RunClients(server.localEndpoint(), count, ticks);
+        std::_Exit(0);
+    }
+
+    std::vector<Endpoint> known;
+    uint8_t input[1500], snapshot[1000] = {};
+    double totalMs = 0.0, worstMs = 0.0;
+    uint64_t inputs = 0;
+    double cpuStart = ProcessCpuMs();
+    auto wallStart = std::chrono::steady_clock::now(), next = wallStart;
+    for (int tick = 0; tick < ticks; ++tick) {
+        auto start = std::chrono::steady_clock::now();
+        server.poll();
+        Endpoint from;
+        while (server.receiveFrom(from, input, sizeof(input)) > 0) {
+            ++inputs;
+            if (std::find(known.begin(), known.end(), from) == known.end()) known.push_back(from);
+        }
+        snapshot[0] = static_cast<uint8_t>(tick);
+        for (const Endpoint& client : known) server.sendTo(client, snapshot, sizeof(snapshot));
+        server.flush();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+        next += kTick;
+        std::this_thread::sleep_until(next);
+    }
+    double cpuMs = ProcessCpuMs() - cpuStart;
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    int status = 0;
+    waitpid(child, &status, 0);
+    server.poll(); // io_uring counts the last tick's sends as they complete
+
+    out.backend = server.backend();
+    if (s.ioThread) out.backend += " on an I/O thread";
+    out.meanMs = totalMs / ticks;
+    out.worstMs = worstMs;
+    out.corePercent = cpuMs / wallMs * 100.0;
+    out.inputs = inputs;
+    out.stats = server.stats();
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void PrintResult(const Result& r) {
+    std::printf("%s\n", r.backend.c_str());
+    std::printf("  tick: mean %.3f ms, worst %.3f ms in the transport\n", r.meanMs, r.worstMs);
+    std::printf("  server cpu: %.2f%% of a core\n", r.corePercent);
+    std::printf("  datagrams: %llu in, %llu out; syscalls %llu receiving, %llu sending; dropped %llu in, %llu out\n",
+                static_cast<unsigned long long>(r.inputs), static_cast<unsigned long long>(r.stats.sent),
+                static_cast<unsigned long long>(r.stats.receiveCalls),
+                static_cast<unsigned long long>(r.stats.sendCalls),
+                static_cast<unsigned long long>(r.stats.receiveDropped),
+                static_cast<unsigned long long>(r.stats.sendDropped));
+}
+
+void PrintComparison(const Result& a, const Result& b) {
+    auto row = [](const char* name, double x, double y, const char* fmt) {
+        std::printf("%-22s", name);
+        std::printf(fmt, x);
+        std::printf(fmt, y);
+        std::printf("\n");
+    };
+    std::printf("%-22s%16s%16s\n", "", a.backend.c_str(), b.backend.c_str());
+    row("tick mean (ms)", a.meanMs, b.meanMs, "%16.3f");
+    row("tick worst (ms)", a.worstMs, b.worstMs, "%16.3f");
+    row("server cpu (% core)", a.corePercent, b.corePercent, "%16.2f");
+    row("datagrams in", double(a.inputs), double(b.inputs), "%16.0f");
+    row("datagrams out", double(a.stats.sent), double(b.stats.sent), "%16.0f");
+    row("receive syscalls", double(a.stats.receiveCalls), double(b.stats.receiveCalls), "%16.0f");
+    row("send syscalls", double(a.stats.sendCalls), double(b.stats.sendCalls), "%16.0f");
+    row("dropped in", double(a.stats.receiveDropped), double(b.stats.receiveDropped), "%16.0f");
+    row("dropped out", double(a.stats.sendDropped), double(b.stats.sendDropped), "%16.0f");
+}
+
+// Positive count from argv, or the default when absent; false if it
+// doesn't parse as one
+bool ParseCount(int argc, char** argv, int index, int fallback, int& out) {
+    if (argc <= index) {
+        out = fallback;
+        return true;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(argv[index], &end, 10);
+    if (end == argv[index] || *end != '\0' || errno == ERANGE || value <= 0 || value > 1000000) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+} // namespace
+#endif
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+    int count = 0, ticks = 0;
+    if (!ParseCount(argc, argv, 1, 64, count) || !ParseCount(argc, argv, 2, 600, ticks)) {
+        std::printf("usage: bench_udp_transport [clients] [ticks] [sendmmsg|thread|io_uring|compare]\n"
+                    "clients and ticks must be positive integers\n");
+        return 1;
+    }
+    std::string backend = argc > 3 ? argv[3] : "sendmmsg";
+    if (backend != "sendmmsg" && backend != "thread" && backend != "io_uring" && backend != "compare") {
+        std::printf("unknown backend '%s'; expected sendmmsg, thread, io_uring or compare\n", backend.c_str());
+        return 1;
+    }
+
+    std::printf("clients: %d, %d ticks at 60 Hz\n", count, ticks);
+    if (backend != "compare") {
+        Result result;
+        bool ok = RunServer(backend, count, ticks, result);
+        if (!result.backend.empty()) PrintResult(result);
+        return ok ? 0 : 1;
+    }
+    Result a, b;
+    bool ok = RunServer("sendmmsg", count, ticks, a);
+    ok = RunServer("io_uring", count, ticks, b) && ok;
+    if (a.backend.empty() || b.backend.empty()) return 1;
+    PrintComparison(a, b);
+    return ok ? 0 : 1;
+#else
+    (void)argc;
+    (void)argv;
+    std::printf("bench_udp_transport needs Linux\n");
+    return 0;
+#endif
+}
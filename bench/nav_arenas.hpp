@@ -0,0 +1,112 @@
+#pragma once
+// Procedural stand-ins for the stock arena maps, shared by the nav benchmarks.
+// All are 128 m square on 0.5 m cells (256 x 256) with four 4 m levels:
+//
+//   Open     flat floor scattered with crates and pillars
+//   Storeys  ground floor, two decks joined by ramps, and a tower roof
+//   Maze     corridors between long walls with gaps
+#include "arena/nav/nav_grid.hpp"
+#include "arena/phys/static_world.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace arena::bench {
+
+enum class NavArena { Open, Storeys, Maze };
+
+inline const char* NavArenaName(NavArena arena) {
+    switch (arena) {
+    case NavArena::Open: return "open";
+    case NavArena::Storeys: return "storeys";
+    case NavArena::Maze: return "maze";
+    }
+    return "?";
+}
+
+inline nav::NavGridSettings NavArenaSettings() {
+    nav::NavGridSettings s;
+    s.origin[0] = -64.0f;
+    s.origin[1] = -1.0f;
+    s.origin[2] = -64.0f;
+    s.width = 256;
+    s.depth = 256;
+    s.levels = 4;
+    s.levelHeight = 4.0f;
+    return s;
+}
+
+inline void AddSlab(phys::StaticWorld& world, float x0, float z0, float x1, float z1, float y) {
+    std::vector<float> pos = {x0, y, z0,  x1, y, z0,  x1, y, z1,  x0, y, z1};
+    std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+    world.addTriangles(pos, idx);
+}
+
+// Closed box from y0 to y1
+inline void AddBlock(phys::StaticWorld& world, float x0, float z0, float x1, float z1, float y0, float y1) {
+    std::vector<float> pos = {x0, y0, z0,  x1, y0, z0,  x1, y0, z1,  x0, y0, z1,
+                              x0, y1, z0,  x1, y1, z0,  x1, y1, z1,  x0, y1, z1};
+    std::vector<uint32_t> idx = {0, 2, 1, 0, 3, 2,  0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,
+                                 2, 3, 7, 2, 7, 6,  3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+    world.addTriangles(pos, idx);
+}
+
+// Ramp along +x from height y0 at x to y1 at x + length, spanning z0..z1
+inline void AddRampX(phys::StaticWorld& world, float x, float z0, float z1, float length, float y0, float y1) {
+    std::vector<float> pos = {x, y0, z0,  x, y0, z1,  x + length, y1, z1,  x + length, y1, z0};
+    std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+    world.addTriangles(pos, idx);
+}
+
+inline void BuildNavArena(phys::StaticWorld& world, NavArena arena, uint32_t seed = 7) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> spread(-60.0f, 60.0f), size(0.6f, 2.5f), height(0.5f, 3.5f);
+    world.beginBatch();
+    AddSlab(world, -64, -64, 64, 64, 0);
+
+    switch (arena) {
+    case NavArena::Open:
+        for (int i = 0; i < 250; ++i) {
+            float x = spread(rng), z = spread(rng), w = size(rng), d = size(rng);
+            AddBlock(world, x, z, x + w, z + d, 0, i % 5 == 0 ? 10.0f : height(rng));
+        }
+        break;
+
+    case NavArena::Storeys:
+        // Deck 1 at 4.5 m over the west half, deck 2 at 8.5 m over the north-west
+        // quarter, and a tower roof at 12.5 m; each reached by a ramp
+        AddBlock(world, -64, -40, -4, 40, 4.2f, 4.5f);
+        AddBlock(world, -64, -40, -24, 0, 8.2f, 8.5f);
+        AddBlock(world, -60, -36, -52, -28, 0, 12.5f);
+        AddRampX(world, 14, -6, 0, -18, 0.0f, 4.5f);
+        AddRampX(world, -6, -10, -4, -18, 4.5f, 8.5f);
+        AddRampX(world, -34, -34, -30, -18, 8.5f, 12.5f);
+        for (int i = 0; i < 120; ++i) {
+            float x = spread(rng), z = spread(rng), w = size(rng), d = size(rng);
+            float base = x < -4 && z > -40 && z < 40 ? 4.5f : 0.0f;
+            AddBlock(world, x, z, x + w, z + d, base, base + height(rng));
+        }
+        break;
+
+    case NavArena::Maze:
+        // Walls every 6 m along alternating axes, over half of their 8 m
+        // segments missing so most of the floor is one region
+        for (int k = 0; k < 20; ++k) {
+            float line = -57.0f + k * 6.0f;
+            std::bernoulli_distribution gap(0.55);
+            for (int seg = 0; seg < 16; ++seg) {
+                if (gap(rng)) continue;
+                float a = -64.0f + seg * 8.0f;
+                if (k % 2 == 0) {
+                    AddBlock(world, line, a, line + 0.6f, a + 8.0f, 0, 3.0f);
+                } else {
+                    AddBlock(world, a, line, a + 8.0f, line + 0.6f, 0, 3.0f);
+                }
+            }
+        }
+        break;
+    }
+    world.endBatch();
+}
+
+} // namespace arena::bench
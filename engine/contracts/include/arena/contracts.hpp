@@ -24,12 +24,19 @@ struct IRenderer {
 // -------- phys::IWorld --------
 struct RayHit { bool hit{false}; Vec3 pos{}, normal{}; float t{0}; EntityId entity{0}; };
 struct Capsule { float radius, halfHeight; };
+struct Ray { Vec3 origin{}, dir{}; float maxDist{0}; };
 
 struct IWorld {
   virtual ~IWorld() = default;
   virtual void registerStaticMesh(MeshHandle mh, const Mat4& world) = 0;
   virtual RayHit raycast(const Vec3& origin, const Vec3& dir, float maxDist) const = 0;
   virtual bool sweepCapsule(const Capsule& cap, const Vec3& start, const Vec3& delta, Vec3& outPos) const = 0;
+  // out[i] = raycast(rays[i]); implementations may reorder and parallelize
+  virtual void raycastBatch(std::span<const Ray> rays, std::span<RayHit> out) const {
+    for (size_t i = 0; i < rays.size() && i < out.size(); ++i) {
+      out[i] = raycast(rays[i].origin, rays[i].dir, rays[i].maxDist);
+    }
+  }
 };
 
 // -------- nav::INav --------
@@ -40,6 +47,9 @@ struct INav {
   virtual ~INav() = default;
   virtual bool bakeFromWorld(const IWorld& world) = 0;
   virtual Path findPath(const Vec3& start, const Vec3& goal) const = 0;
+  // The cell p falls in, so callers can tell queries that search the same
+  // cells apart; false if p is off the nav or it has no cells to report
+  virtual bool locate(const Vec3& p, Cell& out) const { (void)p; (void)out; return false; }
 };
 
 // -------- net::ITransport / IReplicator --------
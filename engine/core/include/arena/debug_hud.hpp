@@ -6,13 +6,24 @@ struct Clock;
 namespace arena {
 
 struct InputState;
+class FrameStats;
 
 class DebugHud {
 public:
-    // Draw the debug HUD overlay
-    static void draw(const Clock& clock, const InputState& input);
-    
+    // Draw the debug HUD overlay with the text HUD, top-left corner at (x, y):
+    // frame/tick histories, subsystem breakdown, hitches and memory from stats.
+    // Call between TextHud_BeginFrame and the buffer swap; nothing is allocated
+    // per frame beyond what TextHud_DrawLine does for each line of text.
+    static void draw(float x, float y, const Clock& clock, const InputState& input, const FrameStats& stats,
+                     double nowSeconds);
+
 private:
+    // Bars of the most recent frame times, newest on the right
+    static void drawFrameGraph(const FrameStats& stats, float x, float y, float width, float height);
+
+    // Stacked per-subsystem frame times, newest on the right
+    static void drawSubsystemGraph(const FrameStats& stats, float x, float y, float width, float height);
+    
     // Helper function to check if a key is pressed
     static bool isKeyPressed(const InputState& input, int key);
 };
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace arena {
+
+namespace profile { struct ZoneTotal; }
+
+// Fixed-capacity history of millisecond timings with their sample times.
+// All storage is allocated up front; push() and summarize() never allocate.
+class TimingHistory {
+public:
+    struct Summary {
+        float min = 0.0f;
+        float avg = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+        uint32_t count = 0;
+    };
+
+    explicit TimingHistory(size_t capacity);
+
+    void push(double nowSeconds, float ms);
+
+    // Statistics over the samples taken in the last windowSeconds
+    Summary summarize(double nowSeconds, double windowSeconds) const;
+
+    // Ring storage for plotting: values()[offset()] is the oldest of size() samples
+    const float* values() const { return ms_.data(); }
+    size_t size() const { return count_; }
+    size_t capacity() const { return ms_.size(); }
+    size_t offset() const { return count_ < ms_.size() ? 0 : head_; }
+    float latest() const;
+
+private:
+    std::vector<float> ms_;
+    std::vector<double> times_;
+    mutable std::vector<float> scratch_; // percentile workspace
+    size_t head_ = 0;                    // next slot to write
+    size_t count_ = 0;
+};
+
+// Rolling frame/tick timings, per-subsystem breakdown and memory counters for
+// the debug HUD. Sized at construction so recording doesn't disturb the frame
+// being measured.
+class FrameStats {
+public:
+    static constexpr size_t kMaxSubsystems = 8;
+
+    // A frame counts as a hitch when it takes this many times the running average
+    static constexpr float kHitchFactor = 2.0f;
+
+    explicit FrameStats(size_t capacity = 1024, double windowSeconds = 5.0);
+
+    // Profiler zone shown as a layer of the stacked subsystem graph; zones
+    // should not nest inside each other or the stack double counts
+    bool trackSubsystem(const char* zoneName);
+
+    void recordFrame(double nowSeconds, double frameSeconds);
+    void recordTick(double nowSeconds, double tickSeconds);
+
+    // Attach the profiler's zone totals to the most recently recorded frame
+    void recordSubsystems(const profile::ZoneTotal* zones, size_t count);
+
+    void setMemory(size_t ecsBytes, size_t gpuBytes);
+
+    const TimingHistory& frames() const { return frames_; }
+    const TimingHistory& ticks() const { return ticks_; }
+    TimingHistory::Summary frameSummary(double nowSeconds) const { return frames_.summarize(nowSeconds, windowSeconds_); }
+    TimingHistory::Summary tickSummary(double nowSeconds) const { return ticks_.summarize(nowSeconds, windowSeconds_); }
+    double windowSeconds() const { return windowSeconds_; }
+
+    uint64_t hitchCount() const { return hitches_; }
+    double lastHitchTime() const { return lastHitchTime_; }
+
+    size_t subsystemCount() const { return subsystemCount_; }
+    const char* subsystemName(size_t subsystem) const { return subsystemNames_[subsystem]; }
+    // Ring of per-frame zone times, laid out like frames(): one row of kMaxSubsystems per frame slot
+    const float* subsystemValues() const { return subsystemMs_.data(); }
+    float subsystemMs(size_t frameSlot, size_t subsystem) const { return subsystemMs_[frameSlot * kMaxSubsystems + subsystem]; }
+
+    size_t ecsBytes() const { return ecsBytes_; }
+    size_t gpuBytes() const { return gpuBytes_; }
+
+private:
+    TimingHistory frames_;
+    TimingHistory ticks_;
+    double windowSeconds_;
+
+    float averageFrameMs_ = 0.0f;
+    uint64_t hitches_ = 0;
+    double lastHitchTime_ = -1.0;
+
+    const char* subsystemNames_[kMaxSubsystems] = {};
+    size_t subsystemCount_ = 0;
+    std::vector<float> subsystemMs_;
+    size_t lastFrameSlot_ = 0;
+
+    size_t ecsBytes_ = 0;
+    size_t gpuBytes_ = 0;
+};
+
+} // namespace arena
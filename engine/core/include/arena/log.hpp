@@ -0,0 +1,173 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Structured, asynchronous logging.
+//
+// ARENA_LOG_INFO(App, "loaded %s in %.2f ms", path, ms) captures the format
+// pointer and the arguments by value into a fixed-size record and pushes it
+// onto a lock-free ring buffer; a background thread formats and writes it.
+// The calling thread never allocates, formats or touches stdio. Format strings
+// must be string literals (only the pointer is stored); string arguments are
+// copied into the record and truncated if they don't fit.
+
+namespace arena::log {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warn, Error, Off };
+
+enum class Category : uint8_t { App, Input, Render, Sim, Net, Phys, Nav, Count };
+
+constexpr size_t kCategoryCount = static_cast<size_t>(Category::Count);
+constexpr size_t kMaxArgs = 8;
+
+struct Arg {
+  enum class Type : uint8_t { Int, UInt, Double, Str, Ptr };
+  Type type;
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void* p;
+    uint32_t str; // offset of a NUL-terminated copy in Record::text
+  };
+};
+
+// One log line before formatting. Sized so a queue cell is 256 bytes.
+struct Record {
+  uint64_t timestampNs;
+  const char* fmt;
+  Level level;
+  Category category;
+  uint8_t argCount;
+  uint8_t textUsed;
+  Arg args[kMaxArgs];
+  char text[96];
+};
+
+// Receives each formatted line (without trailing newline) on the logger thread
+using SinkFn = void (*)(const char* line, size_t len, Level level, Category category, void* user);
+
+// Per-category minimum level; checked inline before any work is done
+inline std::atomic<uint8_t> g_levels[kCategoryCount] = {
+  static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+  static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+  static_cast<uint8_t>(Level::Info), static_cast<uint8_t>(Level::Info),
+  static_cast<uint8_t>(Level::Info),
+};
+
+inline bool enabled(Category category, Level level) {
+  return static_cast<uint8_t>(level) >= g_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+}
+
+void setLevel(Category category, Level level);
+void setLevel(Level level); // all categories
+
+// Lines per second a category may emit before the rest are counted and dropped
+// (0 = unlimited). Suppressed counts are reported once the window rolls over.
+void setRateLimit(Category category, uint32_t linesPerSecond);
+
+// Replace the default stdout sink; nullptr restores it
+void setSink(SinkFn sink, void* user = nullptr);
+
+// Block until everything logged before this call has been written
+void flush();
+
+// Flush and stop the background thread; later lines are dropped
+void shutdown();
+
+// Records lost because the ring buffer was full
+uint64_t droppedCount();
+
+const char* levelName(Level level);
+const char* categoryName(Category category);
+
+// Push a captured record; returns false if it was rate limited or the ring was full
+bool submit(const Record& record);
+
+namespace detail {
+
+template<typename T> inline constexpr bool kAlwaysFalse = false;
+
+uint64_t nowNs();
+
+inline void packString(Record& r, Arg& a, const char* s, size_t len) {
+  size_t room = sizeof(r.text) - r.textUsed;
+  if (room == 0) { a.type = Arg::Type::Ptr; a.p = nullptr; return; }
+  if (len > room - 1) len = room - 1;
+  std::memcpy(r.text + r.textUsed, s, len);
+  r.text[r.textUsed + len] = '\0';
+  a.type = Arg::Type::Str;
+  a.str = r.textUsed;
+  r.textUsed = static_cast<uint8_t>(r.textUsed + len + 1);
+}
+
+template<typename T>
+inline void pack(Record& r, const T& value) {
+  if (r.argCount >= kMaxArgs) return;
+  Arg& a = r.args[r.argCount++];
+  using D = std::decay_t<T>;
+  if constexpr (std::is_same_v<D, bool>) {
+    a.type = Arg::Type::Int; a.i = value ? 1 : 0;
+  } else if constexpr (std::is_enum_v<D>) {
+    a.type = Arg::Type::Int; a.i = static_cast<int64_t>(value);
+  } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+    a.type = Arg::Type::Int; a.i = static_cast<int64_t>(value);
+  } else if constexpr (std::is_integral_v<D>) {
+    a.type = Arg::Type::UInt; a.u = static_cast<uint64_t>(value);
+  } else if constexpr (std::is_floating_point_v<D>) {
+    a.type = Arg::Type::Double; a.d = static_cast<double>(value);
+  } else if constexpr (std::is_array_v<T>) {
+    static_assert(std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>, "unsupported log argument type");
+    const char* end = std::find(value, value + std::extent_v<T>, '\0');
+    packString(r, a, value, static_cast<size_t>(end - value));
+  } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+    const char* s = value ? value : "(null)";
+    packString(r, a, s, std::strlen(s));
+  } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+    std::string_view sv = value;
+    packString(r, a, sv.data(), sv.size());
+  } else if constexpr (std::is_pointer_v<D>) {
+    a.type = Arg::Type::Ptr; a.p = static_cast<const void*>(value);
+  } else {
+    static_assert(kAlwaysFalse<T>, "unsupported log argument type");
+  }
+}
+
+template<typename... Ts>
+inline void write(Level level, Category category, const char* fmt, const Ts&... args) {
+  Record r;
+  r.timestampNs = nowNs();
+  r.fmt = fmt;
+  r.level = level;
+  r.category = category;
+  r.argCount = 0;
+  r.textUsed = 0;
+  (pack(r, args), ...);
+  submit(r);
+}
+
+// Format a record into out (always NUL-terminated); returns the length written
+size_t format(const Record& record, char* out, size_t cap);
+
+} // namespace detail
+
+} // namespace arena::log
+
+#define ARENA_LOG(level, category, ...)                                                   \
+  do {                                                                                    \
+    if (::arena::log::enabled(category, level)) {                                         \
+      ::arena::log::detail::write(level, category, __VA_ARGS__);                          \
+    }                                                                                     \
+  } while (0)
+
+#define ARENA_LOG_TRACE(cat, ...) ARENA_LOG(::arena::log::Level::Trace, ::arena::log::Category::cat, __VA_ARGS__)
+#define ARENA_LOG_DEBUG(cat, ...) ARENA_LOG(::arena::log::Level::Debug, ::arena::log::Category::cat, __VA_ARGS__)
+#define ARENA_LOG_INFO(cat, ...)  ARENA_LOG(::arena::log::Level::Info,  ::arena::log::Category::cat, __VA_ARGS__)
+#define ARENA_LOG_WARN(cat, ...)  ARENA_LOG(::arena::log::Level::Warn,  ::arena::log::Category::cat, __VA_ARGS__)
+#define ARENA_LOG_ERROR(cat, ...) ARENA_LOG(::arena::log::Level::Error, ::arena::log::Category::cat, __VA_ARGS__)
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, or a file mapping view on
+// Windows). Pages come straight from the OS page cache, so every process
+// mapping the same file shares one copy. Move-only; unmaps on destruction.
+
+namespace arena {
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // False if the file can't be opened or mapped, or is empty
+  bool open(const std::string& path);
+  void close();
+
+  bool isOpen() const { return data_ != nullptr; }
+  // Page-aligned start of the mapping
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace arena
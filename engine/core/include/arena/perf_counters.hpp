@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hardware performance counters (Linux perf_event_open).
+//
+// Each thread that samples gets its own counter group (cycles, instructions,
+// LLC misses, branch misses) opened on first use and read with one syscall.
+// Sampling is off unless setEnabled(true) is called; elsewhere than Linux, or
+// when the kernel refuses (perf_event_paranoid, containers, VMs without a
+// PMU), available() is false and reads do nothing.
+
+namespace arena::perf {
+
+struct CounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t llcMisses = 0;
+  uint64_t branchMisses = 0;
+
+  CounterValues operator-(const CounterValues& o) const {
+    return {cycles - o.cycles, instructions - o.instructions, llcMisses - o.llcMisses, branchMisses - o.branchMisses};
+  }
+  CounterValues& operator+=(const CounterValues& o) {
+    cycles += o.cycles;
+    instructions += o.instructions;
+    llcMisses += o.llcMisses;
+    branchMisses += o.branchMisses;
+    return *this;
+  }
+};
+
+// Running sum of counter deltas over some number of samples (ticks, system runs)
+struct CounterTotals {
+  uint64_t samples = 0;
+  CounterValues sum;
+
+  void add(const CounterValues& delta) {
+    ++samples;
+    sum += delta;
+  }
+  CounterTotals& operator+=(const CounterTotals& o) {
+    samples += o.samples;
+    sum += o.sum;
+    return *this;
+  }
+};
+
+// A counter group for the thread that opened it
+class ThreadCounters {
+public:
+  ThreadCounters() = default;
+  ~ThreadCounters();
+  ThreadCounters(const ThreadCounters&) = delete;
+  ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+  // Open counters measuring the calling thread; false if the leader (cycles) can't be opened.
+  // Counters the PMU doesn't support are left out and read as zero.
+  bool open();
+  void close();
+  bool isOpen() const { return leader_ >= 0; }
+
+  // Current counts since open(), scaled up if the kernel multiplexed the group
+  bool read(CounterValues& out) const;
+
+private:
+  static constexpr int kCounterCount = 4;
+  int leader_ = -1;
+  int fds_[kCounterCount] = {-1, -1, -1, -1};
+  int slot_[kCounterCount] = {-1, -1, -1, -1}; // position of each counter in the group read
+  int opened_ = 0;
+};
+
+inline std::atomic<bool> g_enabled{false};
+
+inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+// Whether the calling thread's counters are open (opens them on first call)
+bool available();
+
+// Read the calling thread's counters; false if disabled or unavailable
+bool read(CounterValues& out);
+
+struct ReportEntry {
+  std::string name;
+  CounterTotals totals;
+};
+
+// Write per-entry totals and derived rates (IPC, misses per sample) as JSON
+bool writeBenchmarkJson(const std::string& path, const std::string& benchmark, const std::vector<ReportEntry>& entries);
+
+} // namespace arena::perf
@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ARENA_PROFILE_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ARENA_PROFILE_HAS_RDTSC 1
+#else
+#include <chrono>
+#define ARENA_PROFILE_HAS_RDTSC 0
+#endif
+
+// Scoped CPU profiler.
+//
+// ARENA_PROFILE_SCOPE("Render") times the enclosing scope. With frame totals
+// on, each zone adds its duration to the zone's per-frame total; while a
+// capture runs it also appends {site, begin, end} to its thread's ring buffer.
+// With both off a zone costs one relaxed load and a branch; build with
+// ARENA_PROFILE=0 to compile zones out entirely. ARENA_PROFILE_FRAME() marks
+// the end of a frame; exportChromeTrace() writes the captured rings as Chrome
+// trace / Perfetto JSON.
+
+#ifndef ARENA_PROFILE
+#define ARENA_PROFILE 1
+#endif
+
+namespace arena::profile {
+
+// Raw timestamp: TSC cycles on x86, steady_clock nanoseconds elsewhere
+inline uint64_t now() {
+#if ARENA_PROFILE_HAS_RDTSC
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// One static instance per ARENA_PROFILE_SCOPE call site
+struct ZoneSite {
+  ZoneSite(const char* name, const char* file, int line);
+  ZoneSite(const ZoneSite&) = delete;
+  ZoneSite& operator=(const ZoneSite&) = delete;
+
+  const char* name;
+  const char* file;
+  int line;
+  std::atomic<uint64_t> frameTicks{0}; // accumulating for the current frame
+  std::atomic<uint32_t> frameCalls{0};
+  std::atomic<uint64_t> lastFrameTicks{0}; // totals of the last completed frame
+  std::atomic<uint32_t> lastFrameCalls{0};
+  ZoneSite* next = nullptr;
+};
+
+// One completed zone in a thread's ring
+struct Event {
+  const ZoneSite* site;
+  uint64_t begin;
+  uint64_t end;
+};
+
+enum Mode : uint8_t { kFrameTotals = 1, kCapture = 2 };
+
+inline std::atomic<uint8_t> g_mode{0};
+
+inline bool active() { return g_mode.load(std::memory_order_relaxed) != 0; }
+inline bool capturing() { return (g_mode.load(std::memory_order_relaxed) & kCapture) != 0; }
+
+// Accumulate per-zone frame totals (cheap; no events are stored)
+void setFrameTotalsEnabled(bool enabled);
+
+// Start recording zones; clears previously captured events
+void beginCapture();
+void endCapture();
+
+// Write everything captured since beginCapture() as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev). Call after endCapture() for a
+// consistent snapshot. Returns false if the file can't be written.
+bool exportChromeTrace(const std::string& path);
+
+// Name the calling thread in exported traces
+void setThreadName(const char* name);
+
+// End the current frame: rolls every zone's running total into lastFrame*
+void frameMark();
+
+uint64_t frameIndex();
+double lastFrameMs();
+
+struct ZoneTotal {
+  const char* name;
+  double ms;
+  uint32_t calls;
+};
+
+// Per-zone totals for the last completed frame, zones with no calls omitted
+std::vector<ZoneTotal> lastFrameTotals();
+
+// Allocation-free variant: fills up to capacity entries, returns how many were written
+size_t lastFrameTotals(ZoneTotal* out, size_t capacity);
+
+// Timestamp units per second, calibrated against steady_clock
+double ticksPerSecond();
+double ticksToMs(uint64_t ticks);
+
+// Events dropped because a thread's ring wrapped during capture
+uint64_t overwrittenCount();
+
+// A counter track in exported traces (Chrome "C" events) with up to four series
+struct CounterTrack {
+  const char* name;
+  const char* series[4];
+  size_t count;
+};
+
+// Record one sample of a counter track at the current time; ignored unless capturing
+void counterSample(const CounterTrack& track, const double* values);
+
+namespace detail {
+void record(ZoneSite& site, uint64_t begin, uint64_t end);
+} // namespace detail
+
+class Scope {
+public:
+  explicit Scope(ZoneSite& site) {
+    if (active()) {
+      site_ = &site;
+      begin_ = now();
+    }
+  }
+
+  ~Scope() {
+    if (site_) detail::record(*site_, begin_, now());
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  ZoneSite* site_ = nullptr;
+  uint64_t begin_ = 0;
+};
+
+} // namespace arena::profile
+
+#define ARENA_PROFILE_CONCAT_INNER(a, b) a##b
+#define ARENA_PROFILE_CONCAT(a, b) ARENA_PROFILE_CONCAT_INNER(a, b)
+
+#if ARENA_PROFILE
+#define ARENA_PROFILE_SCOPE(name)                                                                     \
+  static ::arena::profile::ZoneSite ARENA_PROFILE_CONCAT(arenaProfileSite_, __LINE__){name, __FILE__, __LINE__}; \
+  ::arena::profile::Scope ARENA_PROFILE_CONCAT(arenaProfileScope_, __LINE__)(ARENA_PROFILE_CONCAT(arenaProfileSite_, __LINE__))
+#define ARENA_PROFILE_FRAME() ::arena::profile::frameMark()
+#define ARENA_PROFILE_THREAD(name) ::arena::profile::setThreadName(name)
+#else
+#define ARENA_PROFILE_SCOPE(name) ((void)0)
+#define ARENA_PROFILE_FRAME() ((void)0)
+#define ARENA_PROFILE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join helper for data-parallel work inside a tick (batched queries,
+// bakes). parallelFor splits [0, count) into chunks of `grain` that the pool's
+// threads and the calling thread claim from a shared counter, and returns once
+// every chunk has run. Several threads may call parallelFor at once; each call
+// is its own job and the caller always works on it, so nested or concurrent
+// calls can't deadlock on a busy pool.
+
+namespace arena {
+
+class TaskPool {
+public:
+  // 0 = one thread per hardware thread, minus the caller
+  explicit TaskPool(unsigned threads = 0);
+  ~TaskPool();
+
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+
+  unsigned threadCount() const { return static_cast<unsigned>(threads_.size()); }
+
+  // fn(begin, end) for consecutive ranges covering [0, count)
+  void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+  struct Job {
+    const std::function<void(size_t, size_t)>* fn;
+    size_t count;
+    size_t grain;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    int helpers = 0; // pool threads inside work(); guarded by mutex_
+  };
+
+  // Claim and run chunks until none are left
+  static void work(Job& job);
+  void run();
+
+  std::vector<std::thread> threads_;
+  std::vector<Job*> jobs_; // open jobs, oldest first
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+  bool stopping_ = false;
+};
+
+} // namespace arena
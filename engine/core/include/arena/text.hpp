@@ -15,6 +15,9 @@ void TextHud_Shutdown();                          // delete GL objects
 void TextHud_BeginFrame(int fbWidth, int fbHeight); // set viewport-space uniforms
 void TextHud_DrawLine(float x, float y, const char* text, float r=1, float g=1, float b=1, float a=1);
 void TextHud_DrawStats(const HudStats& s);        // convenience: "FPS: … | ms: … | ticks: …"
+// Filled rectangles in one colour; rects holds count (x, y, w, h) in pixels.
+// Batched through a fixed buffer, so drawing graphs doesn't allocate.
+void TextHud_DrawRects(const float* rects, int count, float r, float g, float b, float a=1);
 
 } // namespace arena::hud
 
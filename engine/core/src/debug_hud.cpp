@@ -1,52 +1,176 @@
 #include "arena/debug_hud.hpp"
 #include "../../../src/app/Clock.hpp"
 #include "arena/input.hpp"
-#include <GLFW/glfw3.h>
-#include <imgui.h>
+#include "arena/frame_stats.hpp"
+#include "arena/text.hpp"
 #include <cstdio>
-#include <sstream>
-#include <iomanip>
 
 // Prevent GLFW from pulling in legacy OpenGL headers
 #ifndef GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_NONE
 #endif
+#include <GLFW/glfw3.h>
 
 namespace arena {
 
-void DebugHud::draw(const Clock& clock, const InputState& input) {
-    // Set window position and size
-    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(200, 120), ImGuiCond_FirstUseEver);
-    
-    // Begin the debug HUD window
-    if (ImGui::Begin("Debug HUD", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-        // Calculate FPS
-        double fps = clock.lastDt > 0.0 ? 1.0 / clock.lastDt : 0.0;
-        
-        // Display FPS
-        ImGui::Text("FPS: %.1f", fps);
-        
-        // Display ms/frame
-        ImGui::Text("ms/frame: %.2f", clock.lastDt * 1000.0);
-        
-        // Display tick count
-        ImGui::Text("Ticks: %llu", static_cast<unsigned long long>(clock.ticks));
-        
-        // Display WASD pressed flags
-        ImGui::Separator();
-        ImGui::Text("WASD: %s %s %s %s",
-            isKeyPressed(input, GLFW_KEY_W) ? "W" : "-",
-            isKeyPressed(input, GLFW_KEY_A) ? "A" : "-",
-            isKeyPressed(input, GLFW_KEY_S) ? "S" : "-",
-            isKeyPressed(input, GLFW_KEY_D) ? "D" : "-"
-        );
-        
-        // Display mouse movement
-        ImGui::Text("Mouse: dx=%.2f dy=%.2f", input.mouseDx, input.mouseDy);
+namespace {
+
+constexpr float kLineHeight = 20.0f;
+constexpr float kGraphWidth = 400.0f;
+constexpr float kBarWidth = 2.0f;
+constexpr int kGraphColumns = static_cast<int>(kGraphWidth / kBarWidth);
+
+// Layer colors for the stacked subsystem graph
+const float kSubsystemColors[FrameStats::kMaxSubsystems][3] = {
+    {0.90f, 0.47f, 0.24f}, {0.31f, 0.67f, 0.90f}, {0.47f, 0.78f, 0.35f}, {0.86f, 0.78f, 0.27f},
+    {0.75f, 0.43f, 0.82f}, {0.35f, 0.82f, 0.75f}, {0.90f, 0.35f, 0.51f}, {0.63f, 0.63f, 0.63f},
+};
+
+// Scratch for one layer of bars; the HUD is drawn from the render thread only
+float g_rects[kGraphColumns * 4];
+
+void SummaryLine(float x, float y, const char* label, const TimingHistory::Summary& s) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%s ms min %.2f  avg %.2f  p99 %.2f  max %.2f", label, s.min, s.avg, s.p99,
+                  s.max);
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 1.0f, 0.8f);
+}
+
+// Ring slot of the n-th newest of the last `shown` samples
+size_t SlotOf(const TimingHistory& history, size_t shown, size_t n) {
+    return (history.offset() + history.size() - shown + n) % history.capacity();
+}
+
+} // namespace
+
+void DebugHud::draw(float x, float y, const Clock& clock, const InputState& input, const FrameStats& stats,
+                    double nowSeconds) {
+    TimingHistory::Summary frame = stats.frameSummary(nowSeconds);
+    TimingHistory::Summary tick = stats.tickSummary(nowSeconds);
+    char line[128];
+    
+    // FPS from the windowed average rather than a single frame
+    double fps = frame.avg > 0.0f ? 1000.0 / frame.avg : 0.0;
+    std::snprintf(line, sizeof(line), "FPS: %.1f (last %.0f s)  Ticks: %llu", fps, stats.windowSeconds(),
+                  static_cast<unsigned long long>(clock.ticks));
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 1.0f, 0.8f);
+    y += kLineHeight;
+    
+    // Frame and tick time histories
+    SummaryLine(x, y, "Frame", frame);
+    y += kLineHeight;
+    drawFrameGraph(stats, x, y, kGraphWidth, 60.0f);
+    y += 60.0f + 6.0f;
+    SummaryLine(x, y, "Tick ", tick);
+    y += kLineHeight;
+    
+    double sinceHitch = stats.lastHitchTime() >= 0.0 ? nowSeconds - stats.lastHitchTime() : -1.0;
+    if (sinceHitch >= 0.0) {
+        std::snprintf(line, sizeof(line), "Hitches: %llu (last %.1f s ago)",
+                      static_cast<unsigned long long>(stats.hitchCount()), sinceHitch);
+    } else {
+        std::snprintf(line, sizeof(line), "Hitches: 0");
+    }
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 1.0f, 0.8f);
+    y += kLineHeight;
+    
+    // Per-subsystem breakdown from profiler zones
+    if (stats.subsystemCount() > 0) {
+        drawSubsystemGraph(stats, x, y, kGraphWidth, 80.0f);
+        y += 80.0f + 6.0f + kLineHeight * static_cast<float>(stats.subsystemCount() + 1);
     }
     
-    ImGui::End();
+    // Memory
+    std::snprintf(line, sizeof(line), "ECS %.1f KiB | GPU buffers %.1f KiB", stats.ecsBytes() / 1024.0,
+                  stats.gpuBytes() / 1024.0);
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 1.0f, 0.8f);
+    y += kLineHeight;
+    
+    // Display WASD pressed flags and mouse movement
+    std::snprintf(line, sizeof(line), "WASD: %s %s %s %s  Mouse: dx=%.2f dy=%.2f",
+        isKeyPressed(input, GLFW_KEY_W) ? "W" : "-",
+        isKeyPressed(input, GLFW_KEY_A) ? "A" : "-",
+        isKeyPressed(input, GLFW_KEY_S) ? "S" : "-",
+        isKeyPressed(input, GLFW_KEY_D) ? "D" : "-",
+        input.mouseDx, input.mouseDy);
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 0.8f, 0.8f);
+}
+
+void DebugHud::drawFrameGraph(const FrameStats& stats, float x, float y, float width, float height) {
+    const TimingHistory& frames = stats.frames();
+    size_t shown = frames.size() < static_cast<size_t>(kGraphColumns) ? frames.size() : kGraphColumns;
+    
+    float background[4] = {x, y, width, height};
+    hud::TextHud_DrawRects(background, 1, 0.08f, 0.08f, 0.08f, 0.8f);
+    
+    float peak = 0.0f;
+    for (size_t n = 0; n < shown; ++n) {
+        float ms = frames.values()[SlotOf(frames, shown, n)];
+        peak = ms > peak ? ms : peak;
+    }
+    if (peak <= 0.0f) return;
+    
+    float scale = height / (peak * 1.1f);
+    for (size_t n = 0; n < shown; ++n) {
+        float h = frames.values()[SlotOf(frames, shown, n)] * scale;
+        float* rect = g_rects + n * 4;
+        rect[0] = x + width - static_cast<float>(shown - n) * kBarWidth;
+        rect[1] = y + height - h;
+        rect[2] = kBarWidth;
+        rect[3] = h;
+    }
+    hud::TextHud_DrawRects(g_rects, static_cast<int>(shown), 0.8f, 1.0f, 0.8f, 0.9f);
+}
+
+void DebugHud::drawSubsystemGraph(const FrameStats& stats, float x, float y, float width, float height) {
+    const TimingHistory& frames = stats.frames();
+    size_t shown = frames.size() < static_cast<size_t>(kGraphColumns) ? frames.size() : kGraphColumns;
+    size_t layers = stats.subsystemCount();
+    
+    // Scale to the tallest stack on screen
+    float peak = 0.0f;
+    for (size_t n = 0; n < shown; ++n) {
+        size_t slot = SlotOf(frames, shown, n);
+        float total = 0.0f;
+        for (size_t i = 0; i < layers; ++i) total += stats.subsystemMs(slot, i);
+        peak = total > peak ? total : peak;
+    }
+    
+    float background[4] = {x, y, width, height};
+    hud::TextHud_DrawRects(background, 1, 0.08f, 0.08f, 0.08f, 0.8f);
+    
+    if (peak > 0.0f) {
+        // One batch per layer, each bar sitting on top of the layers below it
+        float scale = height / peak;
+        for (size_t i = 0; i < layers; ++i) {
+            for (size_t n = 0; n < shown; ++n) {
+                size_t slot = SlotOf(frames, shown, n);
+                float below = 0.0f;
+                for (size_t j = 0; j < i; ++j) below += stats.subsystemMs(slot, j);
+                float h = stats.subsystemMs(slot, i) * scale;
+                float* rect = g_rects + n * 4;
+                rect[0] = x + width - static_cast<float>(shown - n) * kBarWidth;
+                rect[1] = y + height - below * scale - h;
+                rect[2] = kBarWidth;
+                rect[3] = h;
+            }
+            hud::TextHud_DrawRects(g_rects, static_cast<int>(shown), kSubsystemColors[i][0], kSubsystemColors[i][1],
+                                   kSubsystemColors[i][2]);
+        }
+    }
+    y += height + 6.0f;
+    
+    // Legend with the latest frame's values
+    char line[128];
+    size_t latest = frames.size() > 0 ? SlotOf(frames, 1, 0) : 0;
+    for (size_t i = 0; i < layers; ++i) {
+        std::snprintf(line, sizeof(line), "%s: %.2f ms", stats.subsystemName(i),
+                      frames.size() > 0 ? stats.subsystemMs(latest, i) : 0.0f);
+        hud::TextHud_DrawLine(x, y, line, kSubsystemColors[i][0], kSubsystemColors[i][1], kSubsystemColors[i][2]);
+        y += kLineHeight;
+    }
+    std::snprintf(line, sizeof(line), "Peak stack: %.2f ms", peak);
+    hud::TextHud_DrawLine(x, y, line, 0.8f, 0.8f, 0.8f);
 }
 
 bool DebugHud::isKeyPressed(const InputState& input, int key) {
@@ -0,0 +1,104 @@
+#include "arena/frame_stats.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace arena {
+
+TimingHistory::TimingHistory(size_t capacity)
+    : ms_(std::max<size_t>(capacity, 1), 0.0f),
+      times_(ms_.size(), 0.0),
+      scratch_(ms_.size(), 0.0f) {}
+
+void TimingHistory::push(double nowSeconds, float ms) {
+    ms_[head_] = ms;
+    times_[head_] = nowSeconds;
+    head_ = (head_ + 1) % ms_.size();
+    if (count_ < ms_.size()) ++count_;
+}
+
+float TimingHistory::latest() const {
+    if (count_ == 0) return 0.0f;
+    return ms_[(head_ + ms_.size() - 1) % ms_.size()];
+}
+
+TimingHistory::Summary TimingHistory::summarize(double nowSeconds, double windowSeconds) const {
+    Summary s;
+    double cutoff = nowSeconds - windowSeconds;
+    double sum = 0.0;
+
+    // Walk newest to oldest until samples fall outside the window
+    for (size_t i = 0; i < count_; ++i) {
+        size_t slot = (head_ + ms_.size() - 1 - i) % ms_.size();
+        if (times_[slot] < cutoff) break;
+        float ms = ms_[slot];
+        if (s.count == 0 || ms < s.min) s.min = ms;
+        if (s.count == 0 || ms > s.max) s.max = ms;
+        sum += ms;
+        scratch_[s.count++] = ms;
+    }
+    if (s.count == 0) return s;
+
+    s.avg = static_cast<float>(sum / s.count);
+    size_t rank = static_cast<size_t>(std::ceil(0.99 * s.count)) - 1;
+    std::nth_element(scratch_.begin(), scratch_.begin() + rank, scratch_.begin() + s.count);
+    s.p99 = scratch_[rank];
+    return s;
+}
+
+FrameStats::FrameStats(size_t capacity, double windowSeconds)
+    : frames_(capacity),
+      ticks_(capacity),
+      windowSeconds_(windowSeconds),
+      subsystemMs_(frames_.capacity() * kMaxSubsystems, 0.0f) {}
+
+bool FrameStats::trackSubsystem(const char* zoneName) {
+    for (size_t i = 0; i < subsystemCount_; ++i) {
+        if (std::strcmp(subsystemNames_[i], zoneName) == 0) return true;
+    }
+    if (subsystemCount_ == kMaxSubsystems) return false;
+    subsystemNames_[subsystemCount_++] = zoneName;
+    return true;
+}
+
+void FrameStats::recordFrame(double nowSeconds, double frameSeconds) {
+    float ms = static_cast<float>(frameSeconds * 1000.0);
+
+    // Compare against the average before this frame so a spike can't hide itself;
+    // the first few frames only seed the average
+    const size_t warmupFrames = 10;
+    if (frames_.size() >= warmupFrames && ms > averageFrameMs_ * kHitchFactor) {
+        ++hitches_;
+        lastHitchTime_ = nowSeconds;
+    }
+    const float smoothing = 0.05f;
+    averageFrameMs_ = frames_.size() == 0 ? ms : averageFrameMs_ + (ms - averageFrameMs_) * smoothing;
+
+    lastFrameSlot_ = frames_.size() < frames_.capacity() ? frames_.size() : frames_.offset();
+    frames_.push(nowSeconds, ms);
+    std::fill_n(subsystemMs_.begin() + lastFrameSlot_ * kMaxSubsystems, kMaxSubsystems, 0.0f);
+}
+
+void FrameStats::recordTick(double nowSeconds, double tickSeconds) {
+    ticks_.push(nowSeconds, static_cast<float>(tickSeconds * 1000.0));
+}
+
+void FrameStats::recordSubsystems(const profile::ZoneTotal* zones, size_t count) {
+    float* row = subsystemMs_.data() + lastFrameSlot_ * kMaxSubsystems;
+    for (size_t z = 0; z < count; ++z) {
+        for (size_t i = 0; i < subsystemCount_; ++i) {
+            if (std::strcmp(subsystemNames_[i], zones[z].name) == 0) {
+                row[i] += static_cast<float>(zones[z].ms);
+                break;
+            }
+        }
+    }
+}
+
+void FrameStats::setMemory(size_t ecsBytes, size_t gpuBytes) {
+    ecsBytes_ = ecsBytes;
+    gpuBytes_ = gpuBytes;
+}
+
+} // namespace arena
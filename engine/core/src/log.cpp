@@ -0,0 +1,372 @@
+#include "arena/log.hpp"
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace arena::log {
+
+namespace {
+
+// Ring capacity in records (power of two); 1 MiB of 256-byte cells
+constexpr uint64_t kCapacity = 4096;
+constexpr uint32_t kDefaultLinesPerSecond = 200;
+constexpr uint64_t kWindowNs = 1000000000ull;
+
+struct Cell {
+  std::atomic<uint64_t> seq;
+  Record record;
+};
+static_assert(sizeof(Cell) == 256, "log records should fill exactly one 256-byte cell");
+
+struct RateWindow {
+  std::atomic<uint32_t> limit{kDefaultLinesPerSecond};
+  std::atomic<uint64_t> windowStartNs{0};
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint64_t> suppressed{0};
+};
+
+void StdoutSink(const char* line, size_t len, Level, Category, void*) {
+  std::fwrite(line, 1, len, stdout);
+  std::fputc('\n', stdout);
+}
+
+// Bounded multi-producer queue (Vyukov): producers claim a cell with one CAS,
+// the single logger thread consumes in order. Full means drop, never block.
+class Logger {
+public:
+  Logger() : cells_(new Cell[kCapacity]) {
+    for (uint64_t i = 0; i < kCapacity; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    thread_ = std::thread(&Logger::run, this);
+  }
+
+  ~Logger() { shutdown(); }
+
+  bool push(const Record& record) {
+    if (!running_.load(std::memory_order_relaxed)) return false;
+
+    if (record.level < Level::Warn && rateLimited(rates_[static_cast<size_t>(record.category)], record.timestampNs)) {
+      return false;
+    }
+
+    uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & (kCapacity - 1)];
+      uint64_t seq = cell.seq.load(std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.record = record;
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void flush() {
+    uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+    while (running_.load() && written_.load(std::memory_order_acquire) < target) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+
+  void shutdown() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void setSink(SinkFn sink, void* user) {
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    sink_ = sink ? sink : &StdoutSink;
+    user_ = sink ? user : nullptr;
+  }
+
+  void setRateLimit(Category category, uint32_t linesPerSecond) {
+    rates_[static_cast<size_t>(category)].limit.store(linesPerSecond, std::memory_order_relaxed);
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  static bool rateLimited(RateWindow& window, uint64_t nowNs) {
+    uint32_t limit = window.limit.load(std::memory_order_relaxed);
+    if (limit == 0) return false;
+
+    uint64_t start = window.windowStartNs.load(std::memory_order_relaxed);
+    if (nowNs - start >= kWindowNs && window.windowStartNs.compare_exchange_strong(start, nowNs)) {
+      window.count.store(0, std::memory_order_relaxed);
+    }
+    if (window.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+      window.suppressed.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  bool pop(Record& out) {
+    Cell& cell = cells_[dequeuePos_ & (kCapacity - 1)];
+    if (cell.seq.load(std::memory_order_acquire) != dequeuePos_ + 1) return false;
+    out = cell.record;
+    cell.seq.store(dequeuePos_ + kCapacity, std::memory_order_release);
+    ++dequeuePos_;
+    return true;
+  }
+
+  void emit(const char* line, size_t len, Level level, Category category) {
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    sink_(line, len, level, category, user_);
+  }
+
+  // Lines the producers couldn't write themselves: rate-limit and overflow notices
+  void reportLosses() {
+    char line[160];
+    uint64_t now = detail::nowNs();
+    for (size_t c = 0; c < kCategoryCount; ++c) {
+      RateWindow& window = rates_[c];
+      if (now - window.windowStartNs.load(std::memory_order_relaxed) < kWindowNs) continue;
+      uint64_t suppressed = window.suppressed.exchange(0, std::memory_order_relaxed);
+      if (suppressed == 0) continue;
+      int len = std::snprintf(line, sizeof(line), "[%.6f] [%s] [log] rate limit suppressed %llu %s lines",
+                              now / 1e9, levelName(Level::Warn), static_cast<unsigned long long>(suppressed),
+                              categoryName(static_cast<Category>(c)));
+      emit(line, static_cast<size_t>(len), Level::Warn, static_cast<Category>(c));
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped_) {
+      int len = std::snprintf(line, sizeof(line), "[%.6f] [%s] [log] ring buffer full, dropped %llu lines",
+                              now / 1e9, levelName(Level::Warn),
+                              static_cast<unsigned long long>(dropped - reportedDropped_));
+      emit(line, static_cast<size_t>(len), Level::Warn, Category::App);
+      reportedDropped_ = dropped;
+    }
+  }
+
+  void run() {
+    Record record;
+    char line[1024];
+    for (;;) {
+      bool stopping = !running_.load(std::memory_order_acquire);
+      size_t drained = 0;
+      while (pop(record)) {
+        size_t len = detail::format(record, line, sizeof(line));
+        emit(line, len, record.level, record.category);
+        written_.fetch_add(1, std::memory_order_release);
+        ++drained;
+      }
+      reportLosses();
+      if (drained) {
+        // One flush per batch instead of one per line
+        std::fflush(stdout);
+      }
+      if (stopping) break;
+      if (!drained) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::fflush(stdout);
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<uint64_t> enqueuePos_{0};
+  alignas(64) uint64_t dequeuePos_ = 0; // logger thread only
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  uint64_t reportedDropped_ = 0;        // logger thread only
+  std::atomic<bool> running_{true};
+  RateWindow rates_[kCategoryCount];
+  std::mutex sinkMutex_;
+  SinkFn sink_ = &StdoutSink;
+  void* user_ = nullptr;
+  std::thread thread_;
+};
+
+Logger& Instance() {
+  static Logger logger;
+  return logger;
+}
+
+bool IsFloatConversion(char c) {
+  return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+} // namespace
+
+void setLevel(Category category, Level level) {
+  g_levels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+void setLevel(Level level) {
+  for (size_t c = 0; c < kCategoryCount; ++c) {
+    setLevel(static_cast<Category>(c), level);
+  }
+}
+
+void setRateLimit(Category category, uint32_t linesPerSecond) {
+  Instance().setRateLimit(category, linesPerSecond);
+}
+
+void setSink(SinkFn sink, void* user) {
+  Instance().setSink(sink, user);
+}
+
+void flush() {
+  Instance().flush();
+}
+
+void shutdown() {
+  Instance().shutdown();
+}
+
+uint64_t droppedCount() {
+  return Instance().dropped();
+}
+
+bool submit(const Record& record) {
+  return Instance().push(record);
+}
+
+const char* levelName(Level level) {
+  switch (level) {
+    case Level::Trace: return "TRACE";
+    case Level::Debug: return "DEBUG";
+    case Level::Info:  return "INFO";
+    case Level::Warn:  return "WARN";
+    case Level::Error: return "ERROR";
+    default:           return "OFF";
+  }
+}
+
+const char* categoryName(Category category) {
+  switch (category) {
+    case Category::App:    return "app";
+    case Category::Input:  return "input";
+    case Category::Render: return "render";
+    case Category::Sim:    return "sim";
+    case Category::Net:    return "net";
+    case Category::Phys:   return "phys";
+    case Category::Nav:    return "nav";
+    default:               return "?";
+  }
+}
+
+namespace detail {
+
+uint64_t nowNs() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - epoch).count());
+}
+
+size_t format(const Record& r, char* out, size_t cap) {
+  if (cap == 0) return 0;
+  int header = std::snprintf(out, cap, "[%.6f] [%s] [%s] ", r.timestampNs / 1e9,
+                             levelName(r.level), categoryName(r.category));
+  size_t n = header < 0 ? 0 : (static_cast<size_t>(header) < cap ? static_cast<size_t>(header) : cap - 1);
+
+  auto append = [&](int written) {
+    if (written > 0) n += static_cast<size_t>(written) < cap - n ? static_cast<size_t>(written) : cap - 1 - n;
+  };
+
+  const char* f = r.fmt ? r.fmt : "";
+  size_t argIndex = 0;
+  while (*f && n + 1 < cap) {
+    if (*f != '%') { out[n++] = *f++; continue; }
+    if (f[1] == '%') { out[n++] = '%'; f += 2; continue; }
+
+    // Rebuild the conversion spec without length modifiers; the stored arg type
+    // decides those, so "%d" with an int64 or "%f" with a float both work
+    const char* specStart = f++;
+    char spec[32];
+    size_t sl = 0;
+    spec[sl++] = '%';
+    auto keep = [&](char c) { if (sl < sizeof(spec) - 4) spec[sl++] = c; };
+    while (*f == '-' || *f == '+' || *f == ' ' || *f == '#' || *f == '0') keep(*f++);
+    if (*f == '*') {
+      ++f;
+      long long width = argIndex < r.argCount && r.args[argIndex].type == Arg::Type::Int ? r.args[argIndex++].i : 0;
+      char digits[24];
+      int dl = std::snprintf(digits, sizeof(digits), "%lld", width);
+      for (int i = 0; i < dl; ++i) keep(digits[i]);
+    }
+    while (std::isdigit(static_cast<unsigned char>(*f))) keep(*f++);
+    if (*f == '.') {
+      keep(*f++);
+      while (std::isdigit(static_cast<unsigned char>(*f))) keep(*f++);
+    }
+    while (*f == 'h' || *f == 'l' || *f == 'L' || *f == 'q' || *f == 'j' || *f == 'z' || *f == 't') ++f;
+    char conv = *f;
+    if (!conv) break;
+    ++f;
+
+    if (argIndex >= r.argCount) {
+      // Missing argument: print the spec verbatim rather than garbage
+      for (const char* p = specStart; p < f && n + 1 < cap; ++p) out[n++] = *p;
+      continue;
+    }
+
+    const Arg& a = r.args[argIndex++];
+    char* dst = out + n;
+    size_t room = cap - n;
+    switch (a.type) {
+      case Arg::Type::Int:
+        if (conv == 'c') {
+          keep('c'); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<int>(a.i)));
+        } else if (IsFloatConversion(conv)) {
+          keep(conv); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<double>(a.i)));
+        } else {
+          bool unsignedConv = conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o';
+          keep('l'); keep('l'); keep(unsignedConv ? conv : 'd'); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<long long>(a.i)));
+        }
+        break;
+      case Arg::Type::UInt:
+        if (conv == 'c') {
+          keep('c'); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<int>(a.u)));
+        } else if (IsFloatConversion(conv)) {
+          keep(conv); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<double>(a.u)));
+        } else {
+          bool otherBase = conv == 'x' || conv == 'X' || conv == 'o';
+          keep('l'); keep('l'); keep(otherBase ? conv : 'u'); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, static_cast<unsigned long long>(a.u)));
+        }
+        break;
+      case Arg::Type::Double:
+        keep(IsFloatConversion(conv) ? conv : 'g'); spec[sl] = '\0';
+        append(std::snprintf(dst, room, spec, a.d));
+        break;
+      case Arg::Type::Str:
+        keep('s'); spec[sl] = '\0';
+        append(std::snprintf(dst, room, spec, r.text + a.str));
+        break;
+      case Arg::Type::Ptr:
+        if (conv == 's') {
+          // String that didn't fit in the record
+          append(std::snprintf(dst, room, "%s", "(...)"));
+        } else {
+          keep('p'); spec[sl] = '\0';
+          append(std::snprintf(dst, room, spec, a.p));
+        }
+        break;
+    }
+  }
+
+  out[n] = '\0';
+  return n;
+}
+
+} // namespace detail
+
+} // namespace arena::log
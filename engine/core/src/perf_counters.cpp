@@ -0,0 +1,178 @@
+#include "arena/perf_counters.hpp"
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace arena::perf {
+
+namespace {
+
+#if defined(__linux__)
+long PerfEventOpen(perf_event_attr* attr, pid_t pid, int cpu, int groupFd, unsigned long flags) {
+  return syscall(__NR_perf_event_open, attr, pid, cpu, groupFd, flags);
+}
+
+// Same order as CounterValues
+const uint64_t kConfigs[] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES, // last-level cache misses on x86 and most ARM cores
+  PERF_COUNT_HW_BRANCH_MISSES,
+};
+#endif
+
+struct LazyCounters {
+  ThreadCounters counters;
+  bool attempted = false;
+};
+
+// Quoted, with quotes, backslashes and control characters escaped
+void writeJsonString(FILE* f, const std::string& s) {
+  std::fputc('"', f);
+  for (unsigned char ch : s) {
+    if (ch == '"' || ch == '\\') {
+      std::fputc('\\', f);
+      std::fputc(ch, f);
+    } else if (ch < 0x20) {
+      std::fprintf(f, "\\u%04x", ch);
+    } else {
+      std::fputc(ch, f);
+    }
+  }
+  std::fputc('"', f);
+}
+
+LazyCounters& threadCounters() {
+  thread_local LazyCounters lazy;
+  if (!lazy.attempted) {
+    lazy.attempted = true;
+    lazy.counters.open();
+  }
+  return lazy;
+}
+
+} // namespace
+
+ThreadCounters::~ThreadCounters() { close(); }
+
+bool ThreadCounters::open() {
+  close();
+#if defined(__linux__)
+  for (int i = 0; i < kCounterCount; ++i) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = kConfigs[i];
+    attr.disabled = leader_ < 0 ? 1 : 0; // the whole group starts with the leader
+    attr.exclude_kernel = 1;              // user-space only works at perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = static_cast<int>(PerfEventOpen(&attr, 0, -1, leader_, 0));
+    if (fd < 0) {
+      if (leader_ < 0) return false;
+      continue;
+    }
+    if (leader_ < 0) leader_ = fd;
+    fds_[i] = fd;
+    slot_[i] = opened_++;
+  }
+  ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void ThreadCounters::close() {
+#if defined(__linux__)
+  for (int i = 0; i < kCounterCount; ++i) {
+    if (fds_[i] >= 0) ::close(fds_[i]);
+  }
+#endif
+  for (int i = 0; i < kCounterCount; ++i) {
+    fds_[i] = -1;
+    slot_[i] = -1;
+  }
+  leader_ = -1;
+  opened_ = 0;
+}
+
+bool ThreadCounters::read(CounterValues& out) const {
+#if defined(__linux__)
+  if (leader_ < 0) return false;
+
+  // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+  uint64_t buffer[3 + kCounterCount];
+  ssize_t bytes = ::read(leader_, buffer, sizeof(buffer));
+  if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+
+  uint64_t enabled = buffer[1];
+  uint64_t running = buffer[2];
+  double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+  auto value = [&](int counter) -> uint64_t {
+    int slot = slot_[counter];
+    if (slot < 0 || static_cast<uint64_t>(slot) >= buffer[0]) return 0;
+    return static_cast<uint64_t>(static_cast<double>(buffer[3 + slot]) * scale);
+  };
+
+  out.cycles = value(0);
+  out.instructions = value(1);
+  out.llcMisses = value(2);
+  out.branchMisses = value(3);
+  return true;
+#else
+  (void)out;
+  return false;
+#endif
+}
+
+void setEnabled(bool enabled) {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool available() {
+  return threadCounters().counters.isOpen();
+}
+
+bool read(CounterValues& out) {
+  if (!enabled()) return false;
+  return threadCounters().counters.read(out);
+}
+
+bool writeBenchmarkJson(const std::string& path, const std::string& benchmark, const std::vector<ReportEntry>& entries) {
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) return false;
+
+  std::fputs("{\n  \"benchmark\": ", f);
+  writeJsonString(f, benchmark);
+  std::fprintf(f, ",\n  \"countersAvailable\": %s,\n  \"entries\": [", available() ? "true" : "false");
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const CounterTotals& t = entries[i].totals;
+    double samples = t.samples > 0 ? static_cast<double>(t.samples) : 1.0;
+    double ipc = t.sum.cycles > 0 ? static_cast<double>(t.sum.instructions) / static_cast<double>(t.sum.cycles) : 0.0;
+    std::fprintf(f, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+    writeJsonString(f, entries[i].name);
+    std::fprintf(f,
+                 ", \"samples\": %llu, \"cycles\": %llu, \"instructions\": %llu, "
+                 "\"llcMisses\": %llu, \"branchMisses\": %llu, \"ipc\": %.3f, \"cyclesPerSample\": %.1f, "
+                 "\"llcMissesPerSample\": %.2f, \"branchMissesPerSample\": %.2f}",
+                 static_cast<unsigned long long>(t.samples),
+                 static_cast<unsigned long long>(t.sum.cycles), static_cast<unsigned long long>(t.sum.instructions),
+                 static_cast<unsigned long long>(t.sum.llcMisses), static_cast<unsigned long long>(t.sum.branchMisses),
+                 ipc, t.sum.cycles / samples, t.sum.llcMisses / samples, t.sum.branchMisses / samples);
+  }
+  std::fputs("\n  ]\n}\n", f);
+  bool ok = std::ferror(f) == 0;
+  return std::fclose(f) == 0 && ok;
+}
+
+} // namespace arena::perf
@@ -0,0 +1,324 @@
+#include "arena/profiler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace arena::profile {
+
+namespace {
+
+// Events per thread ring (power of two); 1.5 MiB per profiled thread
+constexpr uint64_t kRingSize = 1ull << 16;
+constexpr uint64_t kFrameRingSize = 1ull << 14;
+constexpr uint64_t kCounterRingSize = 1ull << 12;
+
+struct CounterEvent {
+  const CounterTrack* track;
+  uint64_t time;
+  double values[4];
+};
+
+struct ThreadBuffer {
+  uint32_t tid = 0;
+  char name[32] = {};
+  std::atomic<uint64_t> head{0}; // written only by the owning thread
+  uint64_t captureStart = 0;     // head when the current capture began
+  std::unique_ptr<Event[]> events{new Event[kRingSize]};
+  std::atomic<uint64_t> counterHead{0};
+  uint64_t counterCaptureStart = 0;
+  std::unique_ptr<CounterEvent[]> counters{new CounterEvent[kCounterRingSize]};
+};
+
+struct State {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> threads; // never freed; rings outlive their threads
+  uint64_t captureBegin = 0;
+
+  // Frame boundaries, touched only by the frame-marking thread and exporters under mutex
+  uint64_t frames[kFrameRingSize] = {};
+  uint64_t frameCount = 0;
+  uint64_t captureFrameStart = 0;
+  uint64_t lastFrameMark = 0;
+  std::atomic<uint64_t> lastFrameTicks{0};
+};
+
+State& state() {
+  static State s;
+  return s;
+}
+
+// Intrusive list of every zone site that has executed its static initializer
+std::atomic<ZoneSite*> g_sites{nullptr};
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer* threadBuffer() {
+  if (!t_buffer) {
+    auto buffer = std::make_unique<ThreadBuffer>();
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    buffer->tid = static_cast<uint32_t>(s.threads.size() + 1);
+    std::snprintf(buffer->name, sizeof(buffer->name), "Thread %u", buffer->tid);
+    t_buffer = buffer.get();
+    s.threads.push_back(std::move(buffer));
+  }
+  return t_buffer;
+}
+
+struct Calibration {
+  uint64_t ticks;
+  std::chrono::steady_clock::time_point time;
+};
+
+const Calibration& anchor() {
+  static Calibration c{now(), std::chrono::steady_clock::now()};
+  return c;
+}
+
+void writeJsonString(FILE* f, const char* s) {
+  std::fputc('"', f);
+  for (; *s; ++s) {
+    unsigned char ch = static_cast<unsigned char>(*s);
+    if (ch == '"' || ch == '\\') {
+      std::fputc('\\', f);
+      std::fputc(ch, f);
+    } else if (ch < 0x20) {
+      std::fprintf(f, "\\u%04x", ch);
+    } else {
+      std::fputc(ch, f);
+    }
+  }
+  std::fputc('"', f);
+}
+
+} // namespace
+
+ZoneSite::ZoneSite(const char* name_, const char* file_, int line_) : name(name_), file(file_), line(line_) {
+  ZoneSite* head = g_sites.load(std::memory_order_relaxed);
+  do {
+    next = head;
+  } while (!g_sites.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void setFrameTotalsEnabled(bool enabled) {
+  if (enabled) {
+    g_mode.fetch_or(kFrameTotals);
+  } else {
+    g_mode.fetch_and(static_cast<uint8_t>(~kFrameTotals));
+  }
+}
+
+void beginCapture() {
+  anchor();
+  State& s = state();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto& thread : s.threads) {
+      thread->captureStart = thread->head.load(std::memory_order_acquire);
+      thread->counterCaptureStart = thread->counterHead.load(std::memory_order_acquire);
+    }
+    s.captureFrameStart = s.frameCount;
+    s.captureBegin = now();
+  }
+  g_mode.fetch_or(kCapture);
+}
+
+void endCapture() {
+  g_mode.fetch_and(static_cast<uint8_t>(~kCapture));
+}
+
+void setThreadName(const char* name) {
+  ThreadBuffer* buffer = threadBuffer();
+  std::lock_guard<std::mutex> lock(state().mutex);
+  std::snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+}
+
+void frameMark() {
+  uint64_t t = now();
+  State& s = state();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.lastFrameMark != 0) {
+      s.lastFrameTicks.store(t - s.lastFrameMark, std::memory_order_relaxed);
+    }
+    s.lastFrameMark = t;
+    s.frames[s.frameCount % kFrameRingSize] = t;
+    ++s.frameCount;
+  }
+
+  for (ZoneSite* site = g_sites.load(std::memory_order_acquire); site; site = site->next) {
+    site->lastFrameTicks.store(site->frameTicks.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    site->lastFrameCalls.store(site->frameCalls.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+}
+
+uint64_t frameIndex() {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.frameCount;
+}
+
+double lastFrameMs() {
+  return ticksToMs(state().lastFrameTicks.load(std::memory_order_relaxed));
+}
+
+std::vector<ZoneTotal> lastFrameTotals() {
+  std::vector<ZoneTotal> totals;
+  for (ZoneSite* site = g_sites.load(std::memory_order_acquire); site; site = site->next) {
+    uint32_t calls = site->lastFrameCalls.load(std::memory_order_relaxed);
+    if (calls == 0) continue;
+    totals.push_back({site->name, ticksToMs(site->lastFrameTicks.load(std::memory_order_relaxed)), calls});
+  }
+  return totals;
+}
+
+size_t lastFrameTotals(ZoneTotal* out, size_t capacity) {
+  size_t count = 0;
+  for (ZoneSite* site = g_sites.load(std::memory_order_acquire); site && count < capacity; site = site->next) {
+    uint32_t calls = site->lastFrameCalls.load(std::memory_order_relaxed);
+    if (calls == 0) continue;
+    out[count++] = {site->name, ticksToMs(site->lastFrameTicks.load(std::memory_order_relaxed)), calls};
+  }
+  return count;
+}
+
+double ticksPerSecond() {
+#if ARENA_PROFILE_HAS_RDTSC
+  // Invariant TSC assumed; measured once against steady_clock over at least 20 ms
+  // so every conversion uses the same rate
+  static const double rate = [] {
+    const Calibration& a = anchor();
+    auto elapsed = std::chrono::steady_clock::now() - a.time;
+    if (elapsed < std::chrono::milliseconds(20)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20) - elapsed);
+    }
+    uint64_t ticks = now();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - a.time).count();
+    return static_cast<double>(ticks - a.ticks) / seconds;
+  }();
+  return rate;
+#else
+  return 1e9;
+#endif
+}
+
+double ticksToMs(uint64_t ticks) {
+  return static_cast<double>(ticks) * 1000.0 / ticksPerSecond();
+}
+
+uint64_t overwrittenCount() {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  uint64_t lost = 0;
+  for (auto& thread : s.threads) {
+    uint64_t recorded = thread->head.load(std::memory_order_acquire) - thread->captureStart;
+    if (recorded > kRingSize) lost += recorded - kRingSize;
+  }
+  return lost;
+}
+
+bool exportChromeTrace(const std::string& path) {
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) return false;
+
+  double usPerTick = 1e6 / ticksPerSecond();
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  uint64_t origin = s.captureBegin;
+  auto toUs = [&](uint64_t t) { return t > origin ? static_cast<double>(t - origin) * usPerTick : 0.0; };
+
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+  bool first = true;
+  auto separator = [&]() {
+    if (!first) std::fputs(",\n", f);
+    first = false;
+  };
+
+  for (auto& thread : s.threads) {
+    separator();
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", thread->tid);
+    writeJsonString(f, thread->name);
+    std::fputs("}}", f);
+
+    uint64_t head = thread->head.load(std::memory_order_acquire);
+    uint64_t begin = thread->captureStart;
+    if (head - begin > kRingSize) begin = head - kRingSize;
+    for (uint64_t i = begin; i < head; ++i) {
+      const Event& e = thread->events[i & (kRingSize - 1)];
+      if (e.begin < origin) continue;
+      separator();
+      std::fputs("{\"name\":", f);
+      writeJsonString(f, e.site->name);
+      std::fprintf(f, ",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"file\":",
+                   thread->tid, toUs(e.begin), static_cast<double>(e.end - e.begin) * usPerTick);
+      writeJsonString(f, e.site->file);
+      std::fprintf(f, ",\"line\":%d}}", e.site->line);
+    }
+
+    uint64_t counterHead = thread->counterHead.load(std::memory_order_acquire);
+    uint64_t counterBegin = thread->counterCaptureStart;
+    if (counterHead - counterBegin > kCounterRingSize) counterBegin = counterHead - kCounterRingSize;
+    for (uint64_t i = counterBegin; i < counterHead; ++i) {
+      const CounterEvent& c = thread->counters[i & (kCounterRingSize - 1)];
+      if (c.time < origin) continue;
+      separator();
+      std::fputs("{\"name\":", f);
+      writeJsonString(f, c.track->name);
+      std::fprintf(f, ",\"cat\":\"counter\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{", thread->tid, toUs(c.time));
+      for (size_t v = 0; v < c.track->count && v < 4; ++v) {
+        if (v > 0) std::fputc(',', f);
+        writeJsonString(f, c.track->series[v]);
+        std::fprintf(f, ":%.6g", c.values[v]);
+      }
+      std::fputs("}}", f);
+    }
+  }
+
+  uint64_t frameBegin = s.captureFrameStart;
+  if (s.frameCount - frameBegin > kFrameRingSize) frameBegin = s.frameCount - kFrameRingSize;
+  for (uint64_t i = frameBegin; i < s.frameCount; ++i) {
+    uint64_t t = s.frames[i % kFrameRingSize];
+    if (t < origin) continue;
+    separator();
+    std::fprintf(f, "{\"name\":\"Frame %llu\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+                 static_cast<unsigned long long>(i), toUs(t));
+  }
+
+  std::fputs("\n]}\n", f);
+  bool ok = std::ferror(f) == 0;
+  return std::fclose(f) == 0 && ok;
+}
+
+void counterSample(const CounterTrack& track, const double* values) {
+  if (!capturing()) return;
+  ThreadBuffer* buffer = threadBuffer();
+  uint64_t head = buffer->counterHead.load(std::memory_order_relaxed);
+  CounterEvent& e = buffer->counters[head & (kCounterRingSize - 1)];
+  e.track = &track;
+  e.time = now();
+  for (size_t v = 0; v < 4; ++v) e.values[v] = v < track.count ? values[v] : 0.0;
+  buffer->counterHead.store(head + 1, std::memory_order_release);
+}
+
+namespace detail {
+
+void record(ZoneSite& site, uint64_t begin, uint64_t end) {
+  uint8_t mode = g_mode.load(std::memory_order_relaxed);
+  if (mode & kFrameTotals) {
+    site.frameTicks.fetch_add(end - begin, std::memory_order_relaxed);
+    site.frameCalls.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (mode & kCapture) {
+    ThreadBuffer* buffer = threadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head & (kRingSize - 1)] = {&site, begin, end};
+    buffer->head.store(head + 1, std::memory_order_release);
+  }
+}
+
+} // namespace detail
+
+} // namespace arena::profile
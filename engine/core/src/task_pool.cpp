@@ -0,0 +1,100 @@
+#include "arena/task_pool.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace arena {
+
+TaskPool::TaskPool(unsigned threads) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+  threads_.reserve(threads);
+  jobs_.reserve(16);
+  for (unsigned i = 0; i < threads; ++i) {
+    threads_.emplace_back([this, i] {
+      char name[32];
+      std::snprintf(name, sizeof(name), "Task worker %u", i);
+      ARENA_PROFILE_THREAD(name);
+      run();
+    });
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void TaskPool::work(Job& job) {
+  size_t chunks = (job.count + job.grain - 1) / job.grain;
+  size_t ran = 0;
+  for (size_t chunk = job.next.fetch_add(1); chunk < chunks; chunk = job.next.fetch_add(1)) {
+    size_t begin = chunk * job.grain;
+    (*job.fn)(begin, std::min(job.count, begin + job.grain));
+    ++ran;
+  }
+  job.done.fetch_add(ran);
+}
+
+void TaskPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+  if (count == 0) return;
+  grain = std::max<size_t>(1, grain);
+  if (threads_.empty() || count <= grain) {
+    fn(0, count);
+    return;
+  }
+
+  Job job;
+  job.fn = &fn;
+  job.count = count;
+  job.grain = grain;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(&job);
+  }
+  wake_.notify_all();
+
+  work(job);
+
+  // Every chunk is claimed by now; retire the job so no other thread picks it
+  // up, then wait for helpers still running theirs
+  std::unique_lock<std::mutex> lock(mutex_);
+  jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+  size_t chunks = (count + grain - 1) / grain;
+  finished_.wait(lock, [&] { return job.helpers == 0 && job.done.load() == chunks; });
+}
+
+void TaskPool::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [&] {
+      if (stopping_) return true;
+      for (Job* job : jobs_) {
+        if (job->next.load() * job->grain < job->count) return true;
+      }
+      return false;
+    });
+    if (stopping_) return;
+
+    Job* job = nullptr;
+    for (Job* candidate : jobs_) {
+      if (candidate->next.load() * candidate->grain < candidate->count) {
+        job = candidate;
+        break;
+      }
+    }
+    if (!job) continue;
+
+    ++job->helpers;
+    lock.unlock();
+    work(*job);
+    lock.lock();
+    --job->helpers;
+    finished_.notify_all();
+  }
+}
+
+} // namespace arena
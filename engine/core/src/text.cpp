@@ -1,4 +1,5 @@
 #include "arena/text.hpp"
+#include "arena/log.hpp"
 #include <vector>
 #include <string>
 #include <cstdio>
@@ -229,9 +230,33 @@ void TextHud_DrawLine(float x, float y, const char* text,
     glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(verts.size() / 2));
 }
 
+void TextHud_DrawRects(const float* rects, int count, float r, float g, float b, float a)
+{
+    if (count <= 0) return;
+    constexpr int kBatch = 256;                 // rects per upload, well under the 64 KiB VBO
+    static float verts[kBatch * 12];            // 2 tris * 3 verts * 2 floats per rect
+
+    glUseProgram(g_prog);
+    glProgramUniform4f(g_prog, g_uColor, r, g, b, a);
+    glBindVertexArray(g_vao);
+
+    for (int first = 0; first < count; first += kBatch) {
+        const int n = count - first < kBatch ? count - first : kBatch;
+        for (int i = 0; i < n; ++i) {
+            const float* rect = rects + (first + i) * 4;
+            const float x0 = rect[0], y0 = rect[1], x1 = rect[0] + rect[2], y1 = rect[1] + rect[3];
+            float* v = verts + i * 12;
+            v[0] = x0; v[1] = y0;  v[2] = x1;  v[3] = y0;  v[4] = x1;  v[5] = y1;
+            v[6] = x0; v[7] = y0;  v[8] = x1;  v[9] = y1;  v[10] = x0; v[11] = y1;
+        }
+        glNamedBufferSubData(g_vbo, 0, (GLsizeiptr)(n * 12 * sizeof(float)), verts);
+        glDrawArrays(GL_TRIANGLES, 0, n * 6);
+    }
+}
+
 
 void TextHud_DrawStats(const HudStats& s) {
-    printf("TextHud_DrawStats: Drawing stats - FPS: %.1f, ms: %.2f, ticks: %llu\n", s.fps, s.ms, (unsigned long long)s.ticks);
+    ARENA_LOG_TRACE(Render, "TextHud_DrawStats: Drawing stats - FPS: %.1f, ms: %.2f, ticks: %llu", s.fps, s.ms, s.ticks);
     
     // Draw a semi-transparent background rectangle for better text readability
     float bgX = 10.0f;
@@ -265,7 +290,7 @@ void TextHud_DrawStats(const HudStats& s) {
     // Use bright white color for better visibility
     TextHud_DrawLine(10.0f, 20.0f, buf, 1.0f, 1.0f, 1.0f, 1.0f);
     
-    printf("TextHud_DrawStats: Draw call complete\n");
+    ARENA_LOG_TRACE(Render, "TextHud_DrawStats: Draw call complete");
 }
 
 } // namespace arena::hud
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::ecs {
+
+// Local avoidance between AvoidanceAgents with a Transform, by optimal
+// reciprocal collision avoidance (ORCA). Each agent takes the velocity
+// nearest its preferred one that keeps it clear of its nearest neighbours
+// for timeHorizon seconds, assuming each of them takes half the effort:
+// every neighbour cuts the velocity plane in half, and a small linear
+// program finds the best velocity within maxSpeed on the allowed side of
+// all the cuts (or, when they leave nothing, the one that breaks them
+// least). Agents that have a CharacterInput get it set to walk at the
+// chosen velocity (scaled by the CharacterController's speed if present).
+// Like any reciprocal scheme it can stall a perfectly symmetric crowd (a
+// ring all heading for its centre); real paths rarely are.
+//
+// Neighbours come from a uniform spatial hash of neighbourDist cells,
+// rebuilt every tick from the Transforms with a counting sort. Every agent
+// plans against the velocities of the previous tick, so agents are solved
+// in parallel chunks on the task pool and the results are the same for any
+// split: the same registry order in gives the same velocities out.
+class AvoidanceSystem {
+public:
+    static constexpr int kMaxNeighbours = 16;
+
+    struct Settings {
+        float neighbourDist = 4.0f;  // agents further apart than this ignore each other
+        int maxNeighbours = 10;      // nearest ones considered, up to kMaxNeighbours
+        float timeHorizon = 1.5f;    // seconds ahead to stay clear for
+        size_t chunkSize = 64;       // agents per parallel task
+    };
+
+    AvoidanceSystem() = default;
+    explicit AvoidanceSystem(const Settings& settings) : settings_(settings) {}
+
+    void update(float dt, Registry& registry);
+
+    // Pool for solving agents in parallel; null (default) runs on the caller
+    void setTaskPool(TaskPool* pool) { pool_ = pool; }
+    const Settings& settings() const { return settings_; }
+    size_t agentCount() const { return agents_.size(); }
+
+private:
+    struct Agent {
+        float pos[2];
+        float vel[2];
+        float pref[2];
+        float radius;
+        float maxSpeed;
+    };
+
+    // New velocity for agents_[index] from the others' current ones
+    void solve(float dt, uint32_t index, float out[2]) const;
+
+    struct Work {
+        AvoidanceAgent* agent;
+        CharacterInput* input;
+        float walkSpeed;     // speed a full CharacterInput.move walks at
+    };
+
+    Settings settings_;
+    TaskPool* pool_ = nullptr;
+    std::vector<Agent> agents_;
+    std::vector<Work> work_;
+    std::vector<float> chosen_;          // two per agent
+    // Spatial hash: agents sorted by bucket, bucket b's run at
+    // [bucketStart_[b], bucketStart_[b + 1])
+    std::vector<uint32_t> bucketOf_;
+    std::vector<uint32_t> bucketStart_;
+    std::vector<uint32_t> sorted_;
+    std::vector<float> sortedPos_;       // x, z of each sorted_ entry
+    uint32_t bucketMask_ = 0;
+};
+
+} // namespace arena::ecs
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+
+namespace arena::ecs {
+
+// Two entities whose collider bounds overlap; always a < b
+struct ColliderPair {
+    Entity a{kInvalid};
+    Entity b{kInvalid};
+};
+
+inline bool operator==(const ColliderPair& x, const ColliderPair& y) { return x.a == y.a && x.b == y.b; }
+
+// Broadphase over every entity with a Collider (shape != 0) and a Transform.
+//
+// Colliders live in a loose spatial hash: each one sits in the single cell
+// holding its centre, so any two that overlap are in the same or adjacent
+// cells as long as neither is wider than a cell. Wider ones go on a short
+// oversize list checked against everything. update() only recomputes bounds
+// for entities whose Transform or Collider changed since the last call, and
+// only relinks those whose centre crossed into another cell.
+//
+// Pairs come out sorted by (a, b), so the order depends only on the scene,
+// not on component storage order or hash layout. Static-static pairs are
+// skipped; level geometry belongs to the physics world.
+class BroadphaseSystem {
+public:
+    explicit BroadphaseSystem(float cellSize = 4.0f);
+
+    // Sync with the registry and return the overlapping pairs for the
+    // narrowphase. The span stays valid until the next update().
+    std::span<const ColliderPair> update(Registry& registry);
+
+    std::span<const ColliderPair> pairs() const { return pairs_; }
+    size_t proxyCount() const { return proxies_.size(); }
+    // Colliders whose bounds were recomputed by the last update()
+    size_t refreshedCount() const { return refreshed_; }
+
+    // World-space bounds of a collider. Box and ramp take half extents in
+    // params[0..2]; a capsule takes radius in params[0] and the half height
+    // of its core segment (along local y) in params[1]. False for shape 0.
+    static bool colliderBounds(const Transform& transform, const Collider& collider, float min[3], float max[3]);
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr uint32_t kOversize = UINT32_MAX - 1;
+
+    struct Proxy {
+        float min[3], max[3];
+        Entity entity;
+        uint32_t cell;        // slot in cells_, kOversize, or kNone before placement
+        uint32_t prev, next;  // neighbours in the cell's list
+        uint32_t seen;        // update stamp
+        bool isStatic;
+        Transform transform;  // snapshot the bounds were computed from
+        Collider collider;
+    };
+
+    // Bounds copied out in cell key order for the pair search: each cell's
+    // colliders are contiguous, and so is each run of cells along z
+    struct Packed {
+        float min[3], max[3];
+        Entity entity;
+        uint32_t isStatic;
+    };
+
+    struct Cell {
+        uint64_t key;
+        uint32_t head;
+        uint32_t count;
+    };
+
+    uint32_t addProxy(Entity e, const Transform& transform, const Collider& collider);
+    void removeProxy(uint32_t index);
+    void refresh(Proxy& proxy, uint32_t index);
+    void link(uint32_t index, uint64_t key);
+    void unlink(uint32_t index);
+    uint32_t findCell(uint64_t key) const;
+    uint32_t insertCell(uint64_t key);
+    void rehash(size_t capacity);
+    void collectPairs();
+    void testPair(const Packed& p, const Packed& q);
+
+    float cellSize_;
+    float invCellSize_;
+    uint32_t stamp_ = 0;
+    size_t refreshed_ = 0;
+    std::vector<Proxy> proxies_;
+    std::vector<uint32_t> entityToProxy_;  // kNone when absent
+    std::vector<Cell> cells_;              // open addressing, power-of-two size
+    size_t usedCells_ = 0;                 // slots holding a key, empty or not
+    std::vector<uint32_t> oversize_;
+    std::vector<Packed> packed_;
+    std::vector<uint64_t> occupied_;       // keys of the non-empty cells, sorted
+    std::vector<uint32_t> packedBegin_;    // first packed_ entry per occupied_ entry, plus end
+    std::vector<ColliderPair> pairs_;
+};
+
+} // namespace arena::ecs
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::ecs {
+
+// Walks every entity with a Transform and CharacterController through the
+// static world. Transform.pos is the centre of the controller's upright
+// capsule. Each tick it applies CharacterInput (if present), gravity and
+// jumps, sweeps the capsule with IWorld::sweepCapsule, steps up ledges of
+// up to stepHeight, follows the ground down slopes and steps, and sets
+// grounded when standing on something no steeper than maxSlopeCos allows.
+//
+// A controller only reads static geometry and writes its own components, so
+// with a task pool set the controllers are split into chunks and moved in
+// parallel. The world's queries must be safe to call from several threads
+// (StaticWorld's are), and results don't depend on the split.
+class CharacterControllerSystem {
+public:
+    struct Settings {
+        float gravity = 20.0f;       // m/s^2
+        float jumpSpeed = 6.5f;      // m/s
+        float stepHeight = 0.35f;    // tallest ledge walked onto without jumping
+        float groundSnap = 0.25f;    // how far a grounded controller follows the ground down
+        float maxSlopeCos = 0.64f;   // ~50 degrees; steeper surfaces aren't ground
+        size_t chunkSize = 16;       // controllers per parallel task
+    };
+
+    CharacterControllerSystem() = default;
+    explicit CharacterControllerSystem(const Settings& settings) : settings_(settings) {}
+
+    void update(float dt, Registry& registry, const IWorld& world);
+
+    // Pool for moving controllers in parallel; null (default) runs on the caller
+    void setTaskPool(TaskPool* pool) { pool_ = pool; }
+    const Settings& settings() const { return settings_; }
+
+private:
+    struct Work {
+        Transform* transform;
+        CharacterController* controller;
+        const CharacterInput* input;
+    };
+
+    void move(float dt, const IWorld& world, const Work& work) const;
+    // Walkable ground at most maxDrop below the capsule; restY is the centre
+    // height that leaves the capsule resting on it
+    bool findGround(const IWorld& world, const Vec3& centre, const Capsule& capsule, float maxDrop, float& restY) const;
+
+    Settings settings_;
+    TaskPool* pool_ = nullptr;
+    std::vector<Work> work_;
+};
+
+} // namespace arena::ecs
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include "arena/contracts.hpp"
 
 namespace arena::ecs {
 
@@ -9,6 +10,12 @@ struct Transform {
   float scale[3]{1,1,1};
 };
 
+// Transform as of the previous fixed tick. Maintained by InterpolationSystem
+// so rendering can blend towards the current Transform.
+struct PreviousTransform {
+  Transform value;
+};
+
 struct Renderable {
   uint32_t mesh{0};
   uint32_t lightmap{0};
@@ -26,6 +33,35 @@ struct CharacterController {
   float height{1.8f};
   float speed{5.5f};
   bool  grounded{false};
+  float verticalSpeed{0.0f}; // m/s, up positive; kept by CharacterControllerSystem
+};
+
+// What a CharacterController wants to do this tick, written by player input or
+// bot AI. move is the wished direction on the ground plane (world x, z);
+// longer than 1 is clamped.
+struct CharacterInput {
+  float move[2]{0,0};
+  bool  jump{false};
+};
+
+// An agent AvoidanceSystem steers round the others. preferred is the
+// velocity on the ground plane (world x, z) it would take alone, written by
+// path following; velocity is what AvoidanceSystem chose for it this tick,
+// which the others expect it to keep to on the next.
+struct AvoidanceAgent {
+  float radius{0.4f};
+  float maxSpeed{5.5f};
+  float preferred[2]{0,0};
+  float velocity[2]{0,0};
+};
+
+// The last path PathService delivered for this entity, written at its sync
+// point. request is the id submit() returned; expired means the request
+// waited past its deadline and was never searched (path.ok is false then).
+struct NavPath {
+  Path path{};
+  uint32_t request{0};
+  bool expired{false};
 };
 
 struct NetworkReplicated {
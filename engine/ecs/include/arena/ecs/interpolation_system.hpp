@@ -0,0 +1,24 @@
+#pragma once
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+
+namespace arena::ecs {
+
+class InterpolationSystem {
+public:
+    // Copy every Transform into its PreviousTransform (added on first sight).
+    // Call once before each fixed tick, ahead of the systems that move things.
+    void capture(Registry& registry);
+    
+    // Render-time transform of an entity, blended from the previous tick to the
+    // current one by alpha (Clock::alpha()). Entities without history render as-is.
+    Transform extract(Registry& registry, Entity entity, float alpha) const;
+    
+    // Lerp position/scale; orientation angles take the shortest arc
+    static Transform interpolate(const Transform& previous, const Transform& current, float alpha);
+    
+private:
+    static float lerpAngle(float a, float b, float alpha);
+};
+
+} // namespace arena::ecs
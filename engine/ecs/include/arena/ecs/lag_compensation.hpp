@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+
+namespace arena::ecs {
+
+// Where one character's hitbox was on one tick. Boxes turn with yaw only;
+// capsules stay upright.
+struct HitboxPose {
+    Entity entity;
+    uint8_t shape;   // Collider shape: 1 box, 2 capsule
+    float pos[3];
+    float yaw;
+    float dims[3];   // box half extents, or capsule radius and core half height
+};
+
+// raycastAtTick's result: character says whether the shot ended on a hitbox
+// (entity is then the character, which may be entity 0) or on the static
+// world (entity is left 0 and means nothing)
+struct RewindHit : RayHit {
+    bool character{false};
+};
+
+// Server-side rewind for validating client hitscans. record() stores the
+// hitbox of every CharacterController entity for a tick in a fixed ring of
+// compact poses (no registry copies), and raycastAtTick() traces a shot
+// against the hitboxes as they were on the tick the client was looking at,
+// optionally blended towards the next one the way InterpolationSystem does,
+// and against the static world so walls still block. Queries are const,
+// don't allocate, and may run from several threads at once.
+//
+// The hitbox is the entity's box or capsule Collider when it has one, and
+// otherwise the controller's own capsule. Ticks older than the ring, and
+// characters beyond maxCharacters, aren't kept.
+class LagCompensationSystem {
+public:
+    // raycastAtTick's ignore value that skips nobody (entity 0 is a valid id)
+    static constexpr Entity kIgnoreNone = UINT32_MAX;
+
+    explicit LagCompensationSystem(uint32_t ticks = 32, uint32_t maxCharacters = 256);
+
+    // Snapshot the hitboxes for `tick`, replacing whatever the slot held
+    void record(uint32_t tick, Registry& registry);
+
+    bool hasTick(uint32_t tick) const;
+    uint32_t historyTicks() const { return static_cast<uint32_t>(frames_.size()); }
+
+    // Nearest hit along ray against the hitboxes at `tick` (alpha < 1 blends
+    // from tick - 1, as seen by a client rendering between the two) and, if
+    // given, the static world. Hitbox hits set character and report their
+    // entity. ignore skips the shooter. Misses if tick isn't held.
+    RewindHit raycastAtTick(uint32_t tick, const Ray& ray, Entity ignore = kIgnoreNone,
+                            const IWorld* world = nullptr, float alpha = 1.0f) const;
+
+    // Poses held for a tick, sorted by entity; empty if the tick isn't held
+    std::span<const HitboxPose> posesAt(uint32_t tick) const;
+
+private:
+    struct Frame {
+        uint32_t tick = 0;
+        uint32_t count = 0;
+        bool valid = false;
+    };
+
+    uint32_t maxCharacters_;
+    std::vector<Frame> frames_;
+    std::vector<HitboxPose> poses_;  // frames_.size() * maxCharacters_
+};
+
+} // namespace arena::ecs
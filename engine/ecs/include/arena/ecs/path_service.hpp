@@ -0,0 +1,171 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/components.hpp"
+#include "arena/frame_stats.hpp"
+
+namespace arena::ecs {
+
+// Runs INav path queries off the tick. Systems submit() requests for
+// entities at any point in a tick; worker threads search them, most urgent
+// first, and sync() (once per tick, at the sync point) writes the finished
+// ones into the entities' NavPath components. The tick never waits on a
+// search, so a burst of repaths spreads over the following ticks instead of
+// landing on one.
+//
+// Requests go by priority (higher first), then by deadline, then in order.
+// A deadline is a number of ticks (sync() calls): a request not searched by
+// then is delivered as expired. Requests whose ends fall in the same cells
+// (INav::locate) share one search, joined until sync() delivers its result,
+// so how a tick's requests are shared doesn't hang on when the workers run
+// them; a new request for an entity replaces the
+// one it was still waiting on.
+//
+// Workers may spend budgetMs of search time between two sync() calls, all
+// together; a search that's started runs to the end, so the last one of a
+// tick can overrun by its own length. With no workers sync() runs up to
+// inlineSearches searches itself instead, a count rather than a time so
+// replays and lockstep peers make the same ones each tick. The nav must
+// be safe to query from several threads while it's re-baked (GridNav is:
+// searches finish on the data they started on).
+class PathService {
+public:
+    struct Settings {
+        unsigned workers = 1;           // 0 = search inside sync()
+        float budgetMs = 2.0f;          // search time per tick, all workers together
+        size_t inlineSearches = 8;      // searches per sync() with no workers
+        size_t latencyHistory = 1024;   // latency samples kept
+    };
+
+    // Counts since construction, and the queue as of the call
+    struct Stats {
+        size_t queued = 0;          // searches waiting
+        size_t waiting = 0;         // requests not yet delivered, shared ones counted once each
+        uint64_t submitted = 0;
+        uint64_t shared = 0;        // requests that joined a search not yet delivered
+        uint64_t replaced = 0;      // requests dropped for a newer one for the same entity
+        uint64_t searched = 0;
+        uint64_t expired = 0;       // requests delivered as expired
+        uint64_t delivered = 0;
+        float lastTickMs = 0.0f;    // search time spent since the previous sync()
+    };
+
+    static constexpr uint32_t kNoDeadline = 0;
+
+    explicit PathService(const INav& nav) : PathService(nav, Settings{}) {}
+    PathService(const INav& nav, const Settings& settings);
+    ~PathService();
+
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    // Queue a path for entity from start to goal; returns the request id its
+    // NavPath will carry. deadlineTicks = kNoDeadline waits as long as it
+    // takes. Call from the simulation thread.
+    uint32_t submit(Entity entity, const Vec3& start, const Vec3& goal, int priority = 0,
+                    uint32_t deadlineTicks = kNoDeadline);
+
+    // Forget entity's waiting request (say, when destroying it); its search
+    // is dropped if nobody else is waiting on it and it hasn't started
+    void cancel(Entity entity);
+
+    // The sync point: writes every result finished since the last call to
+    // its entity's NavPath (skipping entities destroyed since), expires
+    // requests past their deadline and starts the next tick's budget
+    void sync(Registry& registry);
+
+    // Blocks until the workers can't start another search this tick: the
+    // queue is empty or the budget is spent. For tests and tools.
+    void wait();
+
+    size_t queueDepth() const;
+    Stats stats() const;
+    // Milliseconds from submit() to delivery, over the last windowSeconds
+    TimingHistory::Summary latency(double windowSeconds = 5.0) const;
+    const Settings& settings() const { return settings_; }
+
+private:
+    struct Waiter {
+        Entity entity;
+        uint32_t request;
+        uint32_t expires;    // last tick it may start on; UINT32_MAX for none
+        double submitted;    // seconds
+    };
+    enum class State : uint8_t { Free, Queued, Running, Done };
+    struct Job {
+        State state = State::Free;
+        bool keyed = false;     // listed in byKey_ under its start and goal cells
+        bool expired = false;
+        Cell start{}, goal{};
+        Vec3 from{}, to{};
+        int priority = 0;
+        uint32_t due = 0;       // earliest waiter deadline, for ordering
+        uint32_t expires = 0;   // latest waiter deadline; expired once past it
+        uint32_t version = 0;   // bumped when reordered, so stale open_ entries are skipped
+        std::vector<Waiter> waiters;
+        Path path;
+    };
+    struct OpenEntry {
+        int priority;
+        uint32_t due;
+        uint32_t seq;
+        uint32_t job;
+        uint32_t version;
+        bool operator<(const OpenEntry& o) const;
+    };
+    struct Pending {
+        uint32_t request;
+        uint32_t job;
+    };
+
+    double now() const;
+    uint32_t allocJob();
+    void freeJob(uint32_t job);
+    // Takes job out of byKey_ once delivered or dropped
+    void unkey(uint32_t job);
+    void pushOpen(uint32_t job);
+    // Takes entity's waiter off its job; call locked
+    bool dropWaiter(Entity entity);
+    // Highest open job that's still queued, or UINT32_MAX; call locked
+    uint32_t popOpen();
+    bool canStart() const { return queued_ > 0 && budgetLeftNs_ > 0; }
+    // Searches the most urgent job with the lock released; call locked with
+    // a job queued
+    void runNext(std::unique_lock<std::mutex>& lock);
+    void workerLoop();
+
+    const INav& nav_;
+    Settings settings_;
+    std::chrono::steady_clock::time_point epoch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;   // workers: work or budget arrived, or stopping
+    std::condition_variable idle_;   // wait(): a worker finished or went idle
+    std::vector<std::unique_ptr<Job>> jobs_;
+    std::vector<uint32_t> freeJobs_;
+    std::vector<OpenEntry> open_;    // heap, most urgent on top
+    std::vector<uint32_t> done_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> byKey_;   // cell hash -> jobs not yet delivered
+    std::unordered_map<Entity, Pending> pending_;
+    size_t queued_ = 0;
+    unsigned running_ = 0;
+    int64_t budgetLeftNs_ = 0;
+    int64_t spentNs_ = 0;
+    uint32_t tick_ = 0;
+    uint32_t seq_ = 0;
+    uint32_t nextRequest_ = 1;
+    bool stopping_ = false;
+    Stats stats_;
+    TimingHistory latency_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace arena::ecs
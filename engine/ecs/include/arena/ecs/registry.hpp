@@ -25,6 +25,7 @@ class IStorage {
 public:
   virtual ~IStorage() = default;
   virtual void onDestroy(Entity e) = 0;
+  virtual size_t memoryBytes() const = 0;
 };
 
 template<typename T>
@@ -41,6 +42,7 @@ public:
   }
 
   bool has(Entity e) const {
+    if (e >= entityToDense.size()) return false;
     uint32_t idx = entityToDense[e];
     return idx && denseToEntity[idx-1] == e;
   }
@@ -55,6 +57,7 @@ public:
   }
 
   void remove(Entity e) {
+    if (e >= entityToDense.size()) return;
     uint32_t idx1 = entityToDense[e];
     if (!idx1) return;
     uint32_t idx = idx1 - 1;
@@ -71,12 +74,18 @@ public:
   }
 
   T* get(Entity e) {
+    if (e >= entityToDense.size()) return nullptr;
     uint32_t idx1 = entityToDense[e];
     if (!idx1) return nullptr;
     return &data[idx1 - 1];
   }
 
   void onDestroy(Entity e) override { remove(e); }
+
+  size_t memoryBytes() const override {
+    return data.capacity() * sizeof(T) + denseToEntity.capacity() * sizeof(Entity) +
+           entityToDense.capacity() * sizeof(uint32_t);
+  }
 };
 
 class Registry {
@@ -146,6 +155,13 @@ public:
     }
   }
 
+  // Heap bytes reserved by entity bookkeeping and all component storages
+  size_t memoryBytes() const {
+    size_t bytes = meta.capacity() * sizeof(EntityMeta) + freeList.capacity() * sizeof(Entity);
+    for (auto& [_, storage] : storages) bytes += storage->memoryBytes();
+    return bytes;
+  }
+
 private:
   std::vector<EntityMeta> meta;
   std::vector<Entity> freeList;
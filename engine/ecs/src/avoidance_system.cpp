@@ -0,0 +1,302 @@
+#include "arena/ecs/avoidance_system.hpp"
+#include "arena/profiler.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace arena::ecs {
+
+namespace {
+
+constexpr float kEpsilon = 1e-5f;
+
+struct Vec2 {
+    float x, y;
+};
+
+Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+Vec2 operator*(float s, Vec2 a) { return {s * a.x, s * a.y}; }
+float Dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+// z of the cross product: > 0 when b is anticlockwise of a
+float Det(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+Vec2 Normalize(Vec2 a) {
+    float length = std::sqrt(Dot(a, a));
+    return length > 0.0f ? (1.0f / length) * a : Vec2{0.0f, 0.0f};
+}
+
+// Velocities allowed are on the left of direction through point
+struct Line {
+    Vec2 point;
+    Vec2 direction;
+};
+
+int CellCoord(float v, float invCell) {
+    return static_cast<int>(std::floor(std::clamp(v * invCell, -1.0e9f, 1.0e9f)));
+}
+
+uint32_t CellHash(int cx, int cz) {
+    return static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cz) * 19349663u;
+}
+
+// Best velocity on line `index` within radius and left of lines [0, index):
+// furthest along optimize if asDirection, else nearest to it
+bool SolveOnLine(const Line* lines, int index, float radius, Vec2 optimize, bool asDirection, Vec2& result) {
+    const Line& line = lines[index];
+    float along = Dot(line.point, line.direction);
+    float discriminant = along * along + radius * radius - Dot(line.point, line.point);
+    if (discriminant < 0.0f) return false; // the line misses the speed circle
+    float root = std::sqrt(discriminant);
+    float tLeft = -along - root, tRight = -along + root;
+
+    for (int i = 0; i < index; ++i) {
+        float denominator = Det(line.direction, lines[i].direction);
+        float numerator = Det(lines[i].direction, line.point - lines[i].point);
+        if (std::abs(denominator) <= kEpsilon) {
+            if (numerator < 0.0f) return false; // parallel and wholly outside
+            continue;
+        }
+        float t = numerator / denominator;
+        if (denominator >= 0.0f) {
+            tRight = std::min(tRight, t);
+        } else {
+            tLeft = std::max(tLeft, t);
+        }
+        if (tLeft > tRight) return false;
+    }
+
+    float t;
+    if (asDirection) {
+        t = Dot(optimize, line.direction) > 0.0f ? tRight : tLeft;
+    } else {
+        t = std::clamp(Dot(line.direction, optimize - line.point), tLeft, tRight);
+    }
+    result = line.point + t * line.direction;
+    return true;
+}
+
+// Best velocity within radius left of every line; returns the count of lines
+// it got through, less than count if they leave nothing
+int SolvePlanes(const Line* lines, int count, float radius, Vec2 optimize, bool asDirection, Vec2& result) {
+    if (asDirection) {
+        result = radius * optimize; // optimize is a unit direction here
+    } else if (Dot(optimize, optimize) > radius * radius) {
+        result = radius * Normalize(optimize);
+    } else {
+        result = optimize;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (Det(lines[i].direction, lines[i].point - result) <= 0.0f) continue;
+        Vec2 kept = result;
+        if (!SolveOnLine(lines, i, radius, optimize, asDirection, result)) {
+            result = kept;
+            return i;
+        }
+    }
+    return count;
+}
+
+// When lines [begin, count) can't all be met: the velocity that breaks the
+// worst of them least
+void SolveLeastBad(const Line* lines, int count, int begin, float radius, Vec2& result) {
+    Line projected[AvoidanceSystem::kMaxNeighbours];
+    float distance = 0.0f;
+    for (int i = begin; i < count; ++i) {
+        if (Det(lines[i].direction, lines[i].point - result) <= distance) continue;
+        int projectedCount = 0;
+        for (int j = 0; j < i; ++j) {
+            Line line;
+            float determinant = Det(lines[i].direction, lines[j].direction);
+            if (std::abs(determinant) <= kEpsilon) {
+                if (Dot(lines[i].direction, lines[j].direction) > 0.0f) continue; // same way: j adds nothing
+                line.point = 0.5f * (lines[i].point + lines[j].point);
+            } else {
+                line.point = lines[i].point +
+                             (Det(lines[j].direction, lines[i].point - lines[j].point) / determinant) * lines[i].direction;
+            }
+            line.direction = Normalize(lines[j].direction - lines[i].direction);
+            projected[projectedCount++] = line;
+        }
+        Vec2 kept = result;
+        Vec2 away{-lines[i].direction.y, lines[i].direction.x};
+        if (SolvePlanes(projected, projectedCount, radius, away, true, result) < projectedCount) result = kept;
+        distance = Det(lines[i].direction, lines[i].point - result);
+    }
+}
+
+} // namespace
+
+void AvoidanceSystem::update(float dt, Registry& registry) {
+    ARENA_PROFILE_SCOPE("AvoidanceSystem::update");
+    auto& avoiders = registry.storage<AvoidanceAgent>();
+    auto& transforms = registry.storage<Transform>();
+    auto& inputs = registry.storage<CharacterInput>();
+    auto& controllers = registry.storage<CharacterController>();
+
+    agents_.clear();
+    work_.clear();
+    for (size_t i = 0; i < avoiders.data.size(); ++i) {
+        Entity e = avoiders.denseToEntity[i];
+        const Transform* transform = transforms.get(e);
+        if (!transform) continue;
+        AvoidanceAgent& a = avoiders.data[i];
+        agents_.push_back({{transform->pos[0], transform->pos[2]},
+                           {a.velocity[0], a.velocity[1]},
+                           {a.preferred[0], a.preferred[1]},
+                           a.radius,
+                           a.maxSpeed});
+        const CharacterController* controller = controllers.get(e);
+        work_.push_back({&a, inputs.get(e), controller ? controller->speed : a.maxSpeed});
+    }
+    if (agents_.empty() || !(dt > 0.0f)) return;
+
+    // Spatial hash: count agents per bucket, prefix sum, then place them in
+    // registry order so each bucket's run is in a fixed order
+    uint32_t count = static_cast<uint32_t>(agents_.size());
+    uint32_t buckets = std::bit_ceil(std::max(count * 2, 64u));
+    bucketMask_ = buckets - 1;
+    bucketOf_.resize(count);
+    bucketStart_.assign(buckets + 1, 0);
+    sorted_.resize(count);
+    float invCell = 1.0f / std::max(settings_.neighbourDist, kEpsilon);
+    for (uint32_t i = 0; i < count; ++i) {
+        bucketOf_[i] = CellHash(CellCoord(agents_[i].pos[0], invCell), CellCoord(agents_[i].pos[1], invCell)) & bucketMask_;
+        ++bucketStart_[bucketOf_[i] + 1];
+    }
+    for (uint32_t b = 0; b < buckets; ++b) bucketStart_[b + 1] += bucketStart_[b];
+    for (uint32_t i = 0; i < count; ++i) sorted_[bucketStart_[bucketOf_[i]]++] = i;
+    // Placing advanced each start to the next bucket's; shift them back
+    for (uint32_t b = buckets; b > 0; --b) bucketStart_[b] = bucketStart_[b - 1];
+    bucketStart_[0] = 0;
+    // Positions in bucket order, so a neighbour scan reads one run per bucket
+    sortedPos_.resize(static_cast<size_t>(count) * 2);
+    for (uint32_t s = 0; s < count; ++s) {
+        sortedPos_[s * 2] = agents_[sorted_[s]].pos[0];
+        sortedPos_[s * 2 + 1] = agents_[sorted_[s]].pos[1];
+    }
+
+    chosen_.resize(static_cast<size_t>(count) * 2);
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) solve(dt, static_cast<uint32_t>(i), &chosen_[i * 2]);
+    };
+    size_t chunk = std::max<size_t>(1, settings_.chunkSize);
+    if (pool_ && count > chunk) {
+        pool_->parallelFor(count, chunk, run);
+    } else {
+        run(0, count);
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        Work& w = work_[i];
+        w.agent->velocity[0] = chosen_[i * 2];
+        w.agent->velocity[1] = chosen_[i * 2 + 1];
+        if (w.input && w.walkSpeed > 0.0f) {
+            w.input->move[0] = chosen_[i * 2] / w.walkSpeed;
+            w.input->move[1] = chosen_[i * 2 + 1] / w.walkSpeed;
+        }
+    }
+}
+
+void AvoidanceSystem::solve(float dt, uint32_t index, float out[2]) const {
+    const Agent& self = agents_[index];
+    Vec2 pos{self.pos[0], self.pos[1]}, vel{self.vel[0], self.vel[1]};
+
+    // Nearest neighbours within range, nearest first, ties by index. The own
+    // cell goes first so the list fills with close ones early, and from then
+    // on only candidates no further than the furthest kept are looked at.
+    struct Near {
+        float distSq;
+        uint32_t index;
+    };
+    static constexpr int kCells[9][2] = {{0, 0}, {-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    Near near[kMaxNeighbours];
+    int maxNear = std::clamp(settings_.maxNeighbours, 0, kMaxNeighbours), nearCount = 0;
+    float limitSq = settings_.neighbourDist * settings_.neighbourDist;
+    float invCell = 1.0f / std::max(settings_.neighbourDist, kEpsilon);
+    int cx = CellCoord(pos.x, invCell), cz = CellCoord(pos.y, invCell);
+    uint32_t visited[9];
+    int visitedCount = 0;
+    for (int c = 0; c < 9 && maxNear > 0; ++c) {
+        // Cells can share a bucket; search each bucket once
+        uint32_t bucket = CellHash(cx + kCells[c][0], cz + kCells[c][1]) & bucketMask_;
+        if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount) continue;
+        visited[visitedCount++] = bucket;
+        for (uint32_t s = bucketStart_[bucket]; s < bucketStart_[bucket + 1]; ++s) {
+            float ox = sortedPos_[s * 2] - pos.x, oz = sortedPos_[s * 2 + 1] - pos.y;
+            float distSq = ox * ox + oz * oz;
+            if (distSq > limitSq) continue;
+            uint32_t other = sorted_[s];
+            if (other == index) continue;
+            Near candidate{distSq, other};
+            auto closer = [](const Near& a, const Near& b) {
+                return a.distSq < b.distSq || (a.distSq == b.distSq && a.index < b.index);
+            };
+            // Range is exclusive; once full, a tie with the furthest goes by index
+            if (nearCount < maxNear ? distSq == limitSq : !closer(candidate, near[nearCount - 1])) continue;
+            int slot = nearCount < maxNear ? nearCount++ : nearCount - 1;
+            while (slot > 0 && closer(candidate, near[slot - 1])) {
+                near[slot] = near[slot - 1];
+                --slot;
+            }
+            near[slot] = candidate;
+            if (nearCount == maxNear) limitSq = near[nearCount - 1].distSq;
+        }
+    }
+
+    // One half-plane per neighbour: the velocities that stay clear of it for
+    // timeHorizon if it does its half
+    Line lines[kMaxNeighbours];
+    float invHorizon = 1.0f / std::max(settings_.timeHorizon, kEpsilon);
+    for (int n = 0; n < nearCount; ++n) {
+        const Agent& other = agents_[near[n].index];
+        Vec2 relPos = Vec2{other.pos[0], other.pos[1]} - pos;
+        Vec2 relVel = vel - Vec2{other.vel[0], other.vel[1]};
+        float distSq = Dot(relPos, relPos);
+        float combined = self.radius + other.radius, combinedSq = combined * combined;
+        Line& line = lines[n];
+        Vec2 u;
+        if (distSq > combinedSq) {
+            // Not touching: push relVel out of the truncated velocity-obstacle
+            // cone, across its end cap or its nearer leg
+            Vec2 w = relVel - invHorizon * relPos;
+            float wLengthSq = Dot(w, w), along = Dot(w, relPos);
+            if (along < 0.0f && along * along > combinedSq * wLengthSq) {
+                float wLength = std::sqrt(wLengthSq);
+                Vec2 unitW = (1.0f / wLength) * w;
+                line.direction = {unitW.y, -unitW.x};
+                u = (combined * invHorizon - wLength) * unitW;
+            } else {
+                float leg = std::sqrt(distSq - combinedSq);
+                if (Det(relPos, w) > 0.0f) {
+                    line.direction = (1.0f / distSq) * Vec2{relPos.x * leg - relPos.y * combined,
+                                                            relPos.x * combined + relPos.y * leg};
+                } else {
+                    line.direction = (-1.0f / distSq) * Vec2{relPos.x * leg + relPos.y * combined,
+                                                             -relPos.x * combined + relPos.y * leg};
+                }
+                u = Dot(relVel, line.direction) * line.direction - relVel;
+            }
+        } else {
+            // Already overlapping: get apart within this tick
+            float invDt = 1.0f / dt;
+            Vec2 w = relVel - invDt * relPos;
+            float wLength = std::sqrt(Dot(w, w));
+            // On top of each other with nothing to tell them apart: split
+            // along x, the lower index going +x
+            Vec2 unitW = wLength > kEpsilon ? (1.0f / wLength) * w : Vec2{index < near[n].index ? 1.0f : -1.0f, 0.0f};
+            line.direction = {unitW.y, -unitW.x};
+            u = (combined * invDt - wLength) * unitW;
+        }
+        line.point = vel + 0.5f * u;
+    }
+
+    Vec2 result;
+    Vec2 preferred{self.pref[0], self.pref[1]};
+    int met = SolvePlanes(lines, nearCount, self.maxSpeed, preferred, false, result);
+    if (met < nearCount) SolveLeastBad(lines, nearCount, met, self.maxSpeed, result);
+    out[0] = result.x;
+    out[1] = result.y;
+}
+
+} // namespace arena::ecs
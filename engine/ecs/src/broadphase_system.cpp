@@ -0,0 +1,349 @@
+#include "arena/ecs/broadphase_system.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace arena::ecs {
+
+namespace {
+
+constexpr uint64_t kEmptyKey = UINT64_MAX;
+constexpr int kCoordBits = 21;
+constexpr int64_t kCoordBias = int64_t{1} << (kCoordBits - 1);
+constexpr uint64_t kCoordMask = (uint64_t{1} << kCoordBits) - 1;
+
+// Half of the 3x3x3 neighbourhood as runs along z: {dx, dy, first dz}, each
+// running to dz = +1. Every adjacent pair of cells is visited once.
+constexpr int kColumns = 5;
+constexpr int kForwardColumns[kColumns][3] = {
+    {1, -1, -1}, {1, 0, -1}, {1, 1, -1}, {0, 1, -1}, {0, 0, 1},
+};
+
+uint64_t PackCell(int64_t x, int64_t y, int64_t z) {
+    auto bias = [](int64_t c) {
+        return static_cast<uint64_t>(std::clamp(c + kCoordBias, int64_t{0}, int64_t{kCoordMask}));
+    };
+    return (bias(x) << (2 * kCoordBits)) | (bias(y) << kCoordBits) | bias(z);
+}
+
+uint32_t HashCell(uint64_t key, size_t capacity) {
+    return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & static_cast<uint32_t>(capacity - 1);
+}
+
+bool SameTransform(const Transform& a, const Transform& b) {
+    for (int i = 0; i < 3; ++i) {
+        if (a.pos[i] != b.pos[i] || a.rotYawPitchRoll[i] != b.rotYawPitchRoll[i] || a.scale[i] != b.scale[i]) return false;
+    }
+    return true;
+}
+
+bool SameCollider(const Collider& a, const Collider& b) {
+    if (a.shape != b.shape || a.isStatic != b.isStatic) return false;
+    for (int i = 0; i < 6; ++i) {
+        if (a.params[i] != b.params[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+BroadphaseSystem::BroadphaseSystem(float cellSize)
+    : cellSize_(cellSize > 0.0f ? cellSize : 4.0f), invCellSize_(1.0f / cellSize_) {}
+
+bool BroadphaseSystem::colliderBounds(const Transform& transform, const Collider& collider, float min[3], float max[3]) {
+    const float* s = transform.scale;
+    float ext[3];
+
+    // Rotation for yaw (y) * pitch (x) * roll (z), as in rotateYawPitchRoll.
+    // Most colliders are unrotated, so skip the trig for those.
+    const float* ypr = transform.rotYawPitchRoll;
+    bool rotated = ypr[0] != 0.0f || ypr[1] != 0.0f || ypr[2] != 0.0f;
+    float cy = rotated ? std::cos(ypr[0]) : 1.0f, sy = rotated ? std::sin(ypr[0]) : 0.0f;
+    float cp = rotated ? std::cos(ypr[1]) : 1.0f, sp = rotated ? std::sin(ypr[1]) : 0.0f;
+    float cr = rotated ? std::cos(ypr[2]) : 1.0f, sr = rotated ? std::sin(ypr[2]) : 0.0f;
+    const float r[3][3] = {
+        {cy * cr + sy * sp * sr, -cy * sr + sy * sp * cr, sy * cp},
+        {cp * sr, cp * cr, -sp},
+        {-sy * cr + cy * sp * sr, sy * sr + cy * sp * cr, cy * cp},
+    };
+
+    switch (collider.shape) {
+    case 1: // box
+    case 3: { // ramp: bounded by its box
+        float h[3] = {std::fabs(collider.params[0] * s[0]), std::fabs(collider.params[1] * s[1]),
+                      std::fabs(collider.params[2] * s[2])};
+        for (int i = 0; i < 3; ++i) {
+            ext[i] = std::fabs(r[i][0]) * h[0] + std::fabs(r[i][1]) * h[1] + std::fabs(r[i][2]) * h[2];
+        }
+        break;
+    }
+    case 2: { // capsule: the segment's extent along each axis plus the radius
+        float radius = std::fabs(collider.params[0]) * std::max(std::fabs(s[0]), std::fabs(s[2]));
+        float half = std::fabs(collider.params[1] * s[1]);
+        for (int i = 0; i < 3; ++i) ext[i] = std::fabs(r[i][1]) * half + radius;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        min[i] = transform.pos[i] - ext[i];
+        max[i] = transform.pos[i] + ext[i];
+    }
+    return true;
+}
+
+std::span<const ColliderPair> BroadphaseSystem::update(Registry& registry) {
+    ++stamp_;
+    refreshed_ = 0;
+
+    auto& colliders = registry.storage<Collider>();
+    auto& transforms = registry.storage<Transform>();
+    for (size_t i = 0; i < colliders.data.size(); ++i) {
+        const Collider& collider = colliders.data[i];
+        if (collider.shape == 0) continue;
+        Entity e = colliders.denseToEntity[i];
+        const Transform* transform = transforms.get(e);
+        if (!transform) continue;
+
+        uint32_t index = e < entityToProxy_.size() ? entityToProxy_[e] : kNone;
+        if (index == kNone) {
+            index = addProxy(e, *transform, collider);
+        } else {
+            Proxy& proxy = proxies_[index];
+            if (!SameTransform(proxy.transform, *transform) || !SameCollider(proxy.collider, collider)) {
+                proxy.transform = *transform;
+                proxy.collider = collider;
+                refresh(proxy, index);
+            }
+        }
+        proxies_[index].seen = stamp_;
+    }
+
+    // Anything not seen lost its Collider or Transform, or was destroyed.
+    // Walking backwards, the proxy swapped into a freed slot was already kept.
+    for (size_t i = proxies_.size(); i-- > 0;) {
+        if (proxies_[i].seen != stamp_) removeProxy(static_cast<uint32_t>(i));
+    }
+
+    collectPairs();
+    return pairs_;
+}
+
+uint32_t BroadphaseSystem::addProxy(Entity e, const Transform& transform, const Collider& collider) {
+    uint32_t index = static_cast<uint32_t>(proxies_.size());
+    Proxy proxy{};
+    proxy.entity = e;
+    proxy.cell = kNone;
+    proxy.prev = proxy.next = kNone;
+    proxy.transform = transform;
+    proxy.collider = collider;
+    proxies_.push_back(proxy);
+
+    if (entityToProxy_.size() <= e) entityToProxy_.resize(e + 1, kNone);
+    entityToProxy_[e] = index;
+    refresh(proxies_[index], index);
+    return index;
+}
+
+void BroadphaseSystem::removeProxy(uint32_t index) {
+    Proxy& proxy = proxies_[index];
+    if (proxy.cell == kOversize) {
+        oversize_.erase(std::find(oversize_.begin(), oversize_.end(), index));
+    } else if (proxy.cell != kNone) {
+        unlink(index);
+    }
+    entityToProxy_[proxy.entity] = kNone;
+
+    // Move the last proxy into the hole and repoint whatever referenced it
+    uint32_t last = static_cast<uint32_t>(proxies_.size() - 1);
+    if (index != last) {
+        Proxy& moved = proxies_[last];
+        if (moved.cell == kOversize) {
+            *std::find(oversize_.begin(), oversize_.end(), last) = index;
+        } else if (moved.cell != kNone) {
+            if (moved.prev != kNone) proxies_[moved.prev].next = index;
+            else cells_[moved.cell].head = index;
+            if (moved.next != kNone) proxies_[moved.next].prev = index;
+        }
+        entityToProxy_[moved.entity] = index;
+        proxies_[index] = moved;
+    }
+    proxies_.pop_back();
+}
+
+void BroadphaseSystem::refresh(Proxy& proxy, uint32_t index) {
+    ++refreshed_;
+    proxy.isStatic = proxy.collider.isStatic;
+    colliderBounds(proxy.transform, proxy.collider, proxy.min, proxy.max);
+
+    float centre[3];
+    bool fits = true;
+    for (int a = 0; a < 3; ++a) {
+        centre[a] = 0.5f * (proxy.min[a] + proxy.max[a]);
+        fits &= proxy.max[a] - proxy.min[a] <= cellSize_;
+    }
+
+    if (!fits) {
+        if (proxy.cell == kOversize) return;
+        if (proxy.cell != kNone) unlink(index);
+        proxy.cell = kOversize;
+        oversize_.push_back(index);
+        return;
+    }
+
+    uint64_t key = PackCell(static_cast<int64_t>(std::floor(centre[0] * invCellSize_)),
+                            static_cast<int64_t>(std::floor(centre[1] * invCellSize_)),
+                            static_cast<int64_t>(std::floor(centre[2] * invCellSize_)));
+    if (proxy.cell == kOversize) {
+        oversize_.erase(std::find(oversize_.begin(), oversize_.end(), index));
+        proxy.cell = kNone;
+    } else if (proxy.cell != kNone) {
+        if (cells_[proxy.cell].key == key) return;
+        unlink(index);
+    }
+    link(index, key);
+}
+
+void BroadphaseSystem::link(uint32_t index, uint64_t key) {
+    uint32_t slot = findCell(key);
+    if (slot == kNone) {
+        if ((usedCells_ + 1) * 2 > cells_.size()) {
+            size_t live = 1;
+            for (const Cell& cell : cells_) live += cell.count > 0;
+            rehash(std::max<size_t>(64, std::bit_ceil(live * 4)));
+        }
+        slot = insertCell(key);
+    }
+
+    Cell& cell = cells_[slot];
+    Proxy& proxy = proxies_[index];
+    proxy.cell = slot;
+    proxy.prev = kNone;
+    proxy.next = cell.head;
+    if (cell.head != kNone) proxies_[cell.head].prev = index;
+    cell.head = index;
+    ++cell.count;
+}
+
+void BroadphaseSystem::unlink(uint32_t index) {
+    Proxy& proxy = proxies_[index];
+    Cell& cell = cells_[proxy.cell];
+    if (proxy.prev != kNone) proxies_[proxy.prev].next = proxy.next;
+    else cell.head = proxy.next;
+    if (proxy.next != kNone) proxies_[proxy.next].prev = proxy.prev;
+    --cell.count;
+    proxy.cell = kNone;
+    proxy.prev = proxy.next = kNone;
+}
+
+uint32_t BroadphaseSystem::findCell(uint64_t key) const {
+    if (cells_.empty()) return kNone;
+    for (uint32_t slot = HashCell(key, cells_.size());; slot = (slot + 1) & static_cast<uint32_t>(cells_.size() - 1)) {
+        if (cells_[slot].key == key) return slot;
+        if (cells_[slot].key == kEmptyKey) return kNone;
+    }
+}
+
+uint32_t BroadphaseSystem::insertCell(uint64_t key) {
+    uint32_t slot = HashCell(key, cells_.size());
+    while (cells_[slot].key != kEmptyKey) slot = (slot + 1) & static_cast<uint32_t>(cells_.size() - 1);
+    cells_[slot] = {key, kNone, 0};
+    ++usedCells_;
+    return slot;
+}
+
+void BroadphaseSystem::rehash(size_t capacity) {
+    // Cells that emptied out are dropped here rather than on the spot, so
+    // something bouncing across a cell border doesn't churn the table
+    std::vector<Cell> old = std::move(cells_);
+    cells_.assign(capacity, {kEmptyKey, kNone, 0});
+    usedCells_ = 0;
+    for (const Cell& cell : old) {
+        if (cell.count == 0) continue;
+        uint32_t slot = insertCell(cell.key);
+        cells_[slot].head = cell.head;
+        cells_[slot].count = cell.count;
+        for (uint32_t i = cell.head; i != kNone; i = proxies_[i].next) proxies_[i].cell = slot;
+    }
+}
+
+void BroadphaseSystem::testPair(const Packed& p, const Packed& q) {
+    // Branch-free: almost every candidate is rejected, and unpredictably so
+    bool overlap = (p.min[0] <= q.max[0]) & (q.min[0] <= p.max[0]) & (p.min[1] <= q.max[1]) &
+                   (q.min[1] <= p.max[1]) & (p.min[2] <= q.max[2]) & (q.min[2] <= p.max[2]);
+    if (!(overlap & !(p.isStatic & q.isStatic))) return;
+    pairs_.push_back(p.entity < q.entity ? ColliderPair{p.entity, q.entity} : ColliderPair{q.entity, p.entity});
+}
+
+void BroadphaseSystem::collectPairs() {
+    pairs_.clear();
+    packed_.clear();
+    auto pack = [this](const Proxy& proxy) {
+        Packed p;
+        for (int a = 0; a < 3; ++a) {
+            p.min[a] = proxy.min[a];
+            p.max[a] = proxy.max[a];
+        }
+        p.entity = proxy.entity;
+        p.isStatic = proxy.isStatic;
+        packed_.push_back(p);
+    };
+
+    // Occupied cells in key order (x, then y, then z). The cells of one
+    // (x, y) column are then adjacent, and so are their colliders in packed_,
+    // so each neighbouring column is one contiguous range found by a cursor
+    // that only moves forward, rather than a hash lookup per neighbour cell.
+    occupied_.clear();
+    for (size_t slot = 0; slot < cells_.size(); ++slot) {
+        if (cells_[slot].count) occupied_.push_back(cells_[slot].key);
+    }
+    std::sort(occupied_.begin(), occupied_.end());
+    packedBegin_.resize(occupied_.size() + 1);
+    for (size_t c = 0; c < occupied_.size(); ++c) {
+        packedBegin_[c] = static_cast<uint32_t>(packed_.size());
+        for (uint32_t i = cells_[findCell(occupied_[c])].head; i != kNone; i = proxies_[i].next) pack(proxies_[i]);
+    }
+    size_t gridEnd = packed_.size();
+    packedBegin_[occupied_.size()] = static_cast<uint32_t>(gridEnd);
+    for (uint32_t i : oversize_) pack(proxies_[i]);
+
+    size_t cursor[kColumns] = {};
+    for (size_t c = 0; c < occupied_.size(); ++c) {
+        uint64_t key = occupied_[c];
+        uint32_t begin = packedBegin_[c], end = packedBegin_[c + 1];
+        for (uint32_t i = begin; i < end; ++i) {
+            for (uint32_t j = i + 1; j < end; ++j) testPair(packed_[i], packed_[j]);
+        }
+
+        int64_t x = static_cast<int64_t>((key >> (2 * kCoordBits)) & kCoordMask) - kCoordBias;
+        int64_t y = static_cast<int64_t>((key >> kCoordBits) & kCoordMask) - kCoordBias;
+        int64_t z = static_cast<int64_t>(key & kCoordMask) - kCoordBias;
+        for (int k = 0; k < kColumns; ++k) {
+            const int* d = kForwardColumns[k];
+            uint64_t lo = PackCell(x + d[0], y + d[1], z + d[2]);
+            uint64_t hi = PackCell(x + d[0], y + d[1], z + 1);
+            size_t& first = cursor[k];
+            while (first < occupied_.size() && occupied_[first] < lo) ++first;
+            size_t last = first;
+            while (last < occupied_.size() && occupied_[last] <= hi) ++last;
+            if (first == last || (first <= c && c < last)) continue;
+            for (uint32_t i = begin; i < end; ++i) {
+                for (uint32_t j = packedBegin_[first]; j < packedBegin_[last]; ++j) testPair(packed_[i], packed_[j]);
+            }
+        }
+    }
+
+    // Oversize colliders against everything, each oversize pair once
+    for (size_t k = gridEnd; k < packed_.size(); ++k) {
+        for (size_t j = 0; j < gridEnd; ++j) testPair(packed_[k], packed_[j]);
+        for (size_t j = k + 1; j < packed_.size(); ++j) testPair(packed_[k], packed_[j]);
+    }
+
+    std::sort(pairs_.begin(), pairs_.end(), [](const ColliderPair& x, const ColliderPair& y) {
+        return x.a != y.a ? x.a < y.a : x.b < y.b;
+    });
+}
+
+} // namespace arena::ecs
@@ -0,0 +1,149 @@
+#include "arena/ecs/character_controller_system.hpp"
+#include "arena/profiler.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace arena::ecs {
+
+namespace {
+
+// Height kept between a grounded capsule and the ground under it
+constexpr float kGroundClearance = 0.01f;
+// How far an airborne controller looks for ground to land on
+constexpr float kLandingProbe = 0.02f;
+
+float PlanarDistSq(const Vec3& a, const Vec3& b) {
+    float dx = a.x - b.x, dz = a.z - b.z;
+    return dx * dx + dz * dz;
+}
+
+} // namespace
+
+void CharacterControllerSystem::update(float dt, Registry& registry, const IWorld& world) {
+    ARENA_PROFILE_SCOPE("CharacterControllerSystem::update");
+    auto& controllers = registry.storage<CharacterController>();
+    auto& transforms = registry.storage<Transform>();
+    auto& inputs = registry.storage<CharacterInput>();
+
+    // Resolve components up front; nothing adds or removes them while moving
+    work_.clear();
+    for (size_t i = 0; i < controllers.data.size(); ++i) {
+        Entity e = controllers.denseToEntity[i];
+        if (Transform* transform = transforms.get(e)) {
+            work_.push_back({transform, &controllers.data[i], inputs.get(e)});
+        }
+    }
+
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) move(dt, world, work_[i]);
+    };
+    size_t chunk = std::max<size_t>(1, settings_.chunkSize);
+    if (pool_ && work_.size() > chunk) {
+        pool_->parallelFor(work_.size(), chunk, run);
+    } else {
+        run(0, work_.size());
+    }
+}
+
+bool CharacterControllerSystem::findGround(const IWorld& world, const Vec3& centre, const Capsule& capsule,
+                                           float maxDrop, float& restY) const {
+    // On a plane with normal n the bottom sphere rests radius / n.y above the
+    // plane point straight below its centre
+    float reach = capsule.halfHeight + capsule.radius / settings_.maxSlopeCos + kGroundClearance + maxDrop;
+    RayHit hit = world.raycast(centre, {0.0f, -1.0f, 0.0f}, reach);
+    if (!hit.hit || hit.normal.y < settings_.maxSlopeCos) return false;
+
+    restY = hit.pos.y + capsule.halfHeight + capsule.radius / hit.normal.y + kGroundClearance;
+    return centre.y - restY <= maxDrop;
+}
+
+void CharacterControllerSystem::move(float dt, const IWorld& world, const Work& work) const {
+    Transform& transform = *work.transform;
+    CharacterController& controller = *work.controller;
+    const Capsule capsule{controller.radius, std::max(0.0f, 0.5f * controller.height - controller.radius)};
+    Vec3 pos{transform.pos[0], transform.pos[1], transform.pos[2]};
+
+    float wish[2] = {0.0f, 0.0f};
+    bool jump = false;
+    if (work.input) {
+        wish[0] = work.input->move[0];
+        wish[1] = work.input->move[1];
+        float len = std::sqrt(wish[0] * wish[0] + wish[1] * wish[1]);
+        if (len > 1.0f) {
+            wish[0] /= len;
+            wish[1] /= len;
+        }
+        jump = work.input->jump;
+    }
+
+    bool grounded = controller.grounded;
+    if (grounded && jump) {
+        controller.verticalSpeed = settings_.jumpSpeed;
+        grounded = false;
+    }
+    if (grounded) {
+        controller.verticalSpeed = 0.0f;
+    } else {
+        controller.verticalSpeed -= settings_.gravity * dt;
+    }
+
+    // Walk. The sweep slides along walls and up ramps; a grounded controller
+    // that gets stopped short also tries stepping up: lift, move, and set
+    // back down on whatever it's now over, keeping that if it got further.
+    Vec3 step{wish[0] * controller.speed * dt, 0.0f, wish[1] * controller.speed * dt};
+    float wantSq = step.x * step.x + step.z * step.z;
+    if (wantSq > 0.0f) {
+        Vec3 flat;
+        world.sweepCapsule(capsule, pos, step, flat);
+        float gotSq = PlanarDistSq(flat, pos);
+        if (grounded && gotSq < wantSq * 0.98f && settings_.stepHeight > 0.0f) {
+            Vec3 up, across, down;
+            world.sweepCapsule(capsule, pos, {0.0f, settings_.stepHeight, 0.0f}, up);
+            world.sweepCapsule(capsule, up, step, across);
+            // Look for the ledge under the leading edge of the capsule: the
+            // centre may not be over it yet
+            float scale = capsule.radius / std::sqrt(wantSq);
+            Vec3 lead{across.x + step.x * scale, across.y, across.z + step.z * scale};
+            float restY;
+            if (PlanarDistSq(across, pos) > gotSq + 1e-8f &&
+                findGround(world, lead, capsule, across.y - pos.y + kGroundClearance, restY) &&
+                restY > pos.y - kGroundClearance && restY <= up.y) {
+                world.sweepCapsule(capsule, across, {0.0f, std::min(0.0f, restY - across.y), 0.0f}, down);
+                flat = down;
+            }
+        }
+        pos = flat;
+    }
+
+    // Fall or rise; a ceiling stops the rise
+    if (!grounded) {
+        Vec3 out;
+        if (world.sweepCapsule(capsule, pos, {0.0f, controller.verticalSpeed * dt, 0.0f}, out) &&
+            controller.verticalSpeed > 0.0f) {
+            controller.verticalSpeed = 0.0f;
+        }
+        pos = out;
+    }
+
+    // Ground: a grounded controller follows it down slopes and off low steps;
+    // an airborne one lands once it's close enough
+    controller.grounded = false;
+    float restY;
+    if (controller.verticalSpeed <= 0.0f &&
+        findGround(world, pos, capsule, grounded ? settings_.groundSnap : kLandingProbe, restY)) {
+        if (restY < pos.y) {
+            Vec3 snapped;
+            world.sweepCapsule(capsule, pos, {0.0f, restY - pos.y, 0.0f}, snapped);
+            pos = snapped;
+        }
+        controller.grounded = true;
+        controller.verticalSpeed = 0.0f;
+    }
+
+    transform.pos[0] = pos.x;
+    transform.pos[1] = pos.y;
+    transform.pos[2] = pos.z;
+}
+
+} // namespace arena::ecs
@@ -0,0 +1,51 @@
+#include "arena/ecs/interpolation_system.hpp"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace arena::ecs {
+
+void InterpolationSystem::capture(Registry& registry) {
+    auto& current = registry.storage<Transform>();
+    auto& previous = registry.storage<PreviousTransform>();
+    
+    for (size_t i = 0; i < current.data.size(); ++i) {
+        Entity e = current.denseToEntity[i];
+        if (auto* prev = previous.get(e)) {
+            prev->value = current.data[i];
+        } else {
+            previous.add(e, {current.data[i]});
+        }
+    }
+}
+
+Transform InterpolationSystem::extract(Registry& registry, Entity entity, float alpha) const {
+    auto* current = registry.get<Transform>(entity);
+    if (!current) return {};
+    
+    auto* previous = registry.get<PreviousTransform>(entity);
+    if (!previous) return *current;
+    
+    return interpolate(previous->value, *current, alpha);
+}
+
+Transform InterpolationSystem::interpolate(const Transform& previous, const Transform& current, float alpha) {
+    Transform out;
+    for (int i = 0; i < 3; ++i) {
+        out.pos[i] = previous.pos[i] + (current.pos[i] - previous.pos[i]) * alpha;
+        out.rotYawPitchRoll[i] = lerpAngle(previous.rotYawPitchRoll[i], current.rotYawPitchRoll[i], alpha);
+        out.scale[i] = previous.scale[i] + (current.scale[i] - previous.scale[i]) * alpha;
+    }
+    return out;
+}
+
+float InterpolationSystem::lerpAngle(float a, float b, float alpha) {
+    // Wrap the delta into [-pi, pi] so a yaw crossing +-pi doesn't spin the long way round
+    const float twoPi = static_cast<float>(2.0 * M_PI);
+    float delta = std::remainder(b - a, twoPi);
+    return a + delta * alpha;
+}
+
+} // namespace arena::ecs
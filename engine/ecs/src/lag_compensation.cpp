@@ -0,0 +1,227 @@
+#include "arena/ecs/lag_compensation.hpp"
+#include "arena/log.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace arena::ecs {
+
+namespace {
+
+float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+// Entering hit of o + t d (d unit) with a sphere, t in [0, limit)
+bool RaySphere(const float o[3], const float d[3], const float c[3], float r, float limit, float& t) {
+    float oc[3] = {o[0] - c[0], o[1] - c[1], o[2] - c[2]};
+    float b = Dot(oc, d);
+    float h = b * b - (Dot(oc, oc) - r * r);
+    if (h < 0.0f) return false;
+    float hit = -b - std::sqrt(h);
+    if (hit < 0.0f || hit >= limit) return false;
+    t = hit;
+    return true;
+}
+
+// Upright capsule: core segment pos +/- halfHeight on y, then the radius
+bool RayCapsule(const HitboxPose& p, const float o[3], const float d[3], float limit, float& t, float n[3]) {
+    float r = p.dims[0], half = p.dims[1];
+    bool found = false;
+
+    // Side: the infinite cylinder around the y axis, kept if within the segment
+    float ox = o[0] - p.pos[0], oz = o[2] - p.pos[2];
+    float a = d[0] * d[0] + d[2] * d[2];
+    if (a > 1e-12f) {
+        float b = ox * d[0] + oz * d[2];
+        float h = b * b - a * (ox * ox + oz * oz - r * r);
+        if (h >= 0.0f) {
+            float hit = (-b - std::sqrt(h)) / a;
+            float y = o[1] + d[1] * hit - p.pos[1];
+            if (hit >= 0.0f && hit < limit && std::fabs(y) <= half) {
+                t = limit = hit;
+                n[0] = (ox + d[0] * hit) / r;
+                n[1] = 0.0f;
+                n[2] = (oz + d[2] * hit) / r;
+                found = true;
+            }
+        }
+    }
+
+    // Ends
+    for (float sign : {-1.0f, 1.0f}) {
+        float c[3] = {p.pos[0], p.pos[1] + sign * half, p.pos[2]};
+        float hit;
+        if (RaySphere(o, d, c, r, limit, hit)) {
+            t = limit = hit;
+            for (int k = 0; k < 3; ++k) n[k] = (o[k] + d[k] * hit - c[k]) / r;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Box turned by yaw about y: slab test in the box's frame
+bool RayBox(const HitboxPose& p, const float o[3], const float d[3], float limit, float& t, float n[3]) {
+    float c = std::cos(p.yaw), s = std::sin(p.yaw);
+    float wo[3] = {o[0] - p.pos[0], o[1] - p.pos[1], o[2] - p.pos[2]};
+    float lo[3] = {c * wo[0] - s * wo[2], wo[1], s * wo[0] + c * wo[2]};
+    float ld[3] = {c * d[0] - s * d[2], d[1], s * d[0] + c * d[2]};
+
+    float tNear = 0.0f, tFar = limit;
+    int axis = -1;
+    float sign = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        if (std::fabs(ld[k]) < 1e-12f) {
+            if (std::fabs(lo[k]) > p.dims[k]) return false;
+            continue;
+        }
+        float inv = 1.0f / ld[k];
+        float t0 = (-p.dims[k] - lo[k]) * inv, t1 = (p.dims[k] - lo[k]) * inv;
+        float face = -1.0f;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+            face = 1.0f;
+        }
+        if (t0 > tNear) {
+            tNear = t0;
+            axis = k;
+            sign = face;
+        }
+        tFar = std::min(tFar, t1);
+        if (tNear > tFar) return false;
+    }
+    // Starting inside doesn't count as a hit
+    if (axis < 0 || tNear >= limit) return false;
+
+    float ln[3] = {0.0f, 0.0f, 0.0f};
+    ln[axis] = sign;
+    t = tNear;
+    n[0] = c * ln[0] + s * ln[2];
+    n[1] = ln[1];
+    n[2] = -s * ln[0] + c * ln[2];
+    return true;
+}
+
+HitboxPose Blend(const HitboxPose& from, const HitboxPose& to, float alpha) {
+    HitboxPose out = to;
+    for (int k = 0; k < 3; ++k) out.pos[k] = from.pos[k] + (to.pos[k] - from.pos[k]) * alpha;
+    out.yaw = from.yaw + std::remainder(to.yaw - from.yaw, static_cast<float>(2.0 * M_PI)) * alpha;
+    return out;
+}
+
+} // namespace
+
+LagCompensationSystem::LagCompensationSystem(uint32_t ticks, uint32_t maxCharacters)
+    : maxCharacters_(maxCharacters), frames_(std::max<uint32_t>(1, ticks)),
+      poses_(static_cast<size_t>(frames_.size()) * maxCharacters) {}
+
+void LagCompensationSystem::record(uint32_t tick, Registry& registry) {
+    auto& controllers = registry.storage<CharacterController>();
+    auto& transforms = registry.storage<Transform>();
+    auto& colliders = registry.storage<Collider>();
+
+    size_t slot = tick % frames_.size();
+    HitboxPose* out = &poses_[slot * maxCharacters_];
+    uint32_t count = 0, dropped = 0;
+    for (size_t i = 0; i < controllers.data.size(); ++i) {
+        Entity e = controllers.denseToEntity[i];
+        const Transform* t = transforms.get(e);
+        if (!t) continue;
+        if (count == maxCharacters_) {
+            ++dropped;
+            continue;
+        }
+
+        HitboxPose& pose = out[count++];
+        pose.entity = e;
+        pose.pos[0] = t->pos[0];
+        pose.pos[1] = t->pos[1];
+        pose.pos[2] = t->pos[2];
+        pose.yaw = t->rotYawPitchRoll[0];
+
+        const Collider* collider = colliders.get(e);
+        if (collider && (collider->shape == 1 || collider->shape == 3)) {
+            pose.shape = 1;
+            for (int k = 0; k < 3; ++k) pose.dims[k] = std::fabs(collider->params[k] * t->scale[k]);
+        } else if (collider && collider->shape == 2) {
+            pose.shape = 2;
+            pose.dims[0] = std::fabs(collider->params[0]) * std::max(std::fabs(t->scale[0]), std::fabs(t->scale[2]));
+            pose.dims[1] = std::fabs(collider->params[1] * t->scale[1]);
+            pose.dims[2] = 0.0f;
+        } else {
+            const CharacterController& c = controllers.data[i];
+            pose.shape = 2;
+            pose.dims[0] = c.radius;
+            pose.dims[1] = std::max(0.0f, 0.5f * c.height - c.radius);
+            pose.dims[2] = 0.0f;
+        }
+    }
+
+    // Entity order lets queries pair up consecutive ticks with one merge walk
+    std::sort(out, out + count, [](const HitboxPose& a, const HitboxPose& b) { return a.entity < b.entity; });
+    frames_[slot] = {tick, count, true};
+
+    if (dropped) {
+        ARENA_LOG_WARN(Sim, "Lag compensation: %u characters over the limit of %u not recorded", dropped, maxCharacters_);
+    }
+}
+
+bool LagCompensationSystem::hasTick(uint32_t tick) const {
+    const Frame& frame = frames_[tick % frames_.size()];
+    return frame.valid && frame.tick == tick;
+}
+
+std::span<const HitboxPose> LagCompensationSystem::posesAt(uint32_t tick) const {
+    if (!hasTick(tick)) return {};
+    size_t slot = tick % frames_.size();
+    return {&poses_[slot * maxCharacters_], frames_[slot].count};
+}
+
+RewindHit LagCompensationSystem::raycastAtTick(uint32_t tick, const Ray& ray, Entity ignore, const IWorld* world,
+                                               float alpha) const {
+    RewindHit best;
+    if (!hasTick(tick)) return best;
+    float len = std::sqrt(ray.dir.x * ray.dir.x + ray.dir.y * ray.dir.y + ray.dir.z * ray.dir.z);
+    if (len <= 0.0f || !(ray.maxDist > 0.0f)) return best;
+
+    const float o[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    const float d[3] = {ray.dir.x / len, ray.dir.y / len, ray.dir.z / len};
+    float limit = ray.maxDist;
+
+    // Walls first: a hitbox only counts if it's nearer
+    if (world) {
+        RayHit wall = world->raycast(ray.origin, {d[0], d[1], d[2]}, limit);
+        if (wall.hit) {
+            static_cast<RayHit&>(best) = wall;
+            best.entity = 0;
+            limit = wall.t;
+        }
+    }
+
+    std::span<const HitboxPose> current = posesAt(tick);
+    std::span<const HitboxPose> previous = alpha < 1.0f ? posesAt(tick - 1) : std::span<const HitboxPose>{};
+    size_t j = 0;
+    for (const HitboxPose& pose : current) {
+        if (pose.entity == ignore) continue;
+
+        HitboxPose p = pose;
+        while (j < previous.size() && previous[j].entity < pose.entity) ++j;
+        if (j < previous.size() && previous[j].entity == pose.entity) p = Blend(previous[j], pose, alpha);
+
+        float t, n[3];
+        bool hit = p.shape == 1 ? RayBox(p, o, d, limit, t, n) : RayCapsule(p, o, d, limit, t, n);
+        if (!hit) continue;
+        limit = t;
+        best.hit = true;
+        best.t = t;
+        best.pos = {o[0] + d[0] * t, o[1] + d[1] * t, o[2] + d[2] * t};
+        best.normal = {n[0], n[1], n[2]};
+        best.entity = pose.entity;
+        best.character = true;
+    }
+    return best;
+}
+
+} // namespace arena::ecs
@@ -0,0 +1,277 @@
+#include "arena/ecs/path_service.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace arena::ecs {
+
+namespace {
+
+constexpr uint32_t kNoJob = UINT32_MAX;
+
+bool SameCell(const Cell& a, const Cell& b) { return a.x == b.x && a.y == b.y && a.level == b.level; }
+
+uint64_t CellKey(const Cell& start, const Cell& goal) {
+    uint64_t key = static_cast<uint16_t>(start.x) | static_cast<uint64_t>(static_cast<uint16_t>(start.y)) << 16 |
+                   static_cast<uint64_t>(static_cast<uint16_t>(goal.x)) << 32 |
+                   static_cast<uint64_t>(static_cast<uint16_t>(goal.y)) << 48;
+    return key ^ static_cast<uint64_t>(start.level * 31 + goal.level) * 0x9E3779B97F4A7C15ull;
+}
+
+} // namespace
+
+bool PathService::OpenEntry::operator<(const OpenEntry& o) const {
+    if (priority != o.priority) return priority < o.priority;
+    if (due != o.due) return due > o.due;
+    return seq > o.seq;
+}
+
+PathService::PathService(const INav& nav, const Settings& settings)
+    : nav_(nav), settings_(settings), epoch_(std::chrono::steady_clock::now()),
+      latency_(std::max<size_t>(settings.latencyHistory, 1)) {
+    budgetLeftNs_ = static_cast<int64_t>(settings_.budgetMs * 1.0e6f);
+    for (unsigned i = 0; i < settings_.workers; ++i) workers_.emplace_back([this] { workerLoop(); });
+}
+
+PathService::~PathService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+double PathService::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+uint32_t PathService::submit(Entity entity, const Vec3& start, const Vec3& goal, int priority,
+                             uint32_t deadlineTicks) {
+    Cell from{}, to{};
+    bool located = nav_.locate(start, from) && nav_.locate(goal, to);
+    double submitted = now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t request = nextRequest_++;
+    if (nextRequest_ == 0) nextRequest_ = 1;
+    uint32_t expires = deadlineTicks == kNoDeadline ? UINT32_MAX
+                       : tick_ > UINT32_MAX - 1 - deadlineTicks ? UINT32_MAX - 1
+                                                                 : tick_ + deadlineTicks;
+    ++stats_.submitted;
+    if (dropWaiter(entity)) ++stats_.replaced;
+
+    // Join a search for the same cells that hasn't been delivered yet
+    uint32_t job = kNoJob;
+    uint64_t key = located ? CellKey(from, to) : 0;
+    if (located) {
+        auto it = byKey_.find(key);
+        if (it != byKey_.end()) {
+            for (uint32_t j : it->second) {
+                if (SameCell(jobs_[j]->start, from) && SameCell(jobs_[j]->goal, to)) job = j;
+            }
+        }
+    }
+    Waiter waiter{entity, request, expires, submitted};
+    if (job != kNoJob) {
+        Job& shared = *jobs_[job];
+        ++stats_.shared;
+        shared.waiters.push_back(waiter);
+        shared.expires = std::max(shared.expires, expires);
+        if (shared.state == State::Queued && (priority > shared.priority || expires < shared.due)) {
+            shared.priority = std::max(shared.priority, priority);
+            shared.due = std::min(shared.due, expires);
+            ++shared.version;
+            pushOpen(job);
+        }
+    } else {
+        job = allocJob();
+        Job& fresh = *jobs_[job];
+        fresh.state = State::Queued;
+        fresh.keyed = located;
+        fresh.expired = false;
+        fresh.start = from;
+        fresh.goal = to;
+        fresh.from = start;
+        fresh.to = goal;
+        fresh.priority = priority;
+        fresh.due = expires;
+        fresh.expires = expires;
+        fresh.waiters.push_back(waiter);
+        if (located) byKey_[key].push_back(job);
+        ++queued_;
+        pushOpen(job);
+        wake_.notify_one();
+    }
+    pending_[entity] = {request, job};
+    return request;
+}
+
+void PathService::cancel(Entity entity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dropWaiter(entity);
+}
+
+bool PathService::dropWaiter(Entity entity) {
+    auto it = pending_.find(entity);
+    if (it == pending_.end()) return false;
+    Job& job = *jobs_[it->second.job];
+    uint32_t request = it->second.request;
+    std::erase_if(job.waiters, [&](const Waiter& w) { return w.request == request; });
+    if (job.state == State::Queued && job.waiters.empty()) {
+        // Nobody left to search for; its open_ entry goes stale with the version
+        --queued_;
+        freeJob(it->second.job);
+    }
+    pending_.erase(it);
+    return true;
+}
+
+uint32_t PathService::allocJob() {
+    uint32_t job;
+    if (!freeJobs_.empty()) {
+        job = freeJobs_.back();
+        freeJobs_.pop_back();
+    } else {
+        job = static_cast<uint32_t>(jobs_.size());
+        jobs_.push_back(std::make_unique<Job>());
+    }
+    ++jobs_[job]->version;
+    return job;
+}
+
+void PathService::freeJob(uint32_t job) {
+    unkey(job);
+    Job& j = *jobs_[job];
+    j.state = State::Free;
+    j.waiters.clear();
+    ++j.version;
+    freeJobs_.push_back(job);
+}
+
+void PathService::unkey(uint32_t job) {
+    Job& j = *jobs_[job];
+    if (!j.keyed) return;
+    auto it = byKey_.find(CellKey(j.start, j.goal));
+    std::erase(it->second, job);
+    if (it->second.empty()) byKey_.erase(it);
+    j.keyed = false;
+}
+
+void PathService::pushOpen(uint32_t job) {
+    const Job& j = *jobs_[job];
+    open_.push_back({j.priority, j.due, seq_++, job, j.version});
+    std::push_heap(open_.begin(), open_.end());
+}
+
+uint32_t PathService::popOpen() {
+    while (!open_.empty()) {
+        std::pop_heap(open_.begin(), open_.end());
+        OpenEntry top = open_.back();
+        open_.pop_back();
+        const Job& j = *jobs_[top.job];
+        if (j.state == State::Queued && j.version == top.version) return top.job;
+    }
+    return kNoJob;
+}
+
+void PathService::runNext(std::unique_lock<std::mutex>& lock) {
+    uint32_t job = popOpen();
+    Job& j = *jobs_[job];
+    j.state = State::Running;
+    --queued_;
+    ++running_;
+    lock.unlock();
+    auto t0 = std::chrono::steady_clock::now();
+    j.path = nav_.findPath(j.from, j.to);
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    lock.lock();
+    j.state = State::Done;
+    done_.push_back(job);
+    budgetLeftNs_ -= ns;
+    spentNs_ += ns;
+    --running_;
+    ++stats_.searched;
+}
+
+void PathService::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [&] { return stopping_ || canStart(); });
+        if (stopping_) return;
+        runNext(lock);
+        idle_.notify_all();
+    }
+}
+
+void PathService::sync(Registry& registry) {
+    ARENA_PROFILE_SCOPE("PathService::sync");
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++tick_;
+    stats_.lastTickMs = static_cast<float>(spentNs_ * 1.0e-6);
+
+    // Searches nobody may start any more go out as expired with the rest
+    for (uint32_t i = 0; i < jobs_.size(); ++i) {
+        Job& j = *jobs_[i];
+        if (j.state != State::Queued || j.expires >= tick_) continue;
+        j.state = State::Done;
+        j.expired = true;
+        j.path = Path{};
+        --queued_;
+        done_.push_back(i);
+    }
+
+    double delivered = now();
+    for (uint32_t job : done_) {
+        Job& j = *jobs_[job];
+        for (const Waiter& w : j.waiters) {
+            auto it = pending_.find(w.entity);
+            if (it == pending_.end() || it->second.request != w.request) continue;
+            pending_.erase(it);
+            if (!registry.alive(w.entity)) continue;
+            NavPath* nav = registry.get<NavPath>(w.entity);
+            if (!nav) nav = &registry.add<NavPath>(w.entity, NavPath{});
+            nav->path = j.path;
+            nav->request = w.request;
+            nav->expired = j.expired;
+            ++stats_.delivered;
+            if (j.expired) ++stats_.expired;
+            latency_.push(delivered, static_cast<float>((delivered - w.submitted) * 1000.0));
+        }
+        freeJob(job);
+    }
+    done_.clear();
+
+    budgetLeftNs_ = static_cast<int64_t>(settings_.budgetMs * 1.0e6f);
+    spentNs_ = 0;
+    if (!workers_.empty()) {
+        wake_.notify_all();
+        return;
+    }
+    for (size_t n = 0; n < settings_.inlineSearches && queued_ > 0; ++n) runNext(lock);
+}
+
+void PathService::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [&] { return running_ == 0 && (workers_.empty() || !canStart()); });
+}
+
+size_t PathService::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_;
+}
+
+PathService::Stats PathService::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.queued = queued_;
+    stats.waiting = pending_.size();
+    return stats;
+}
+
+TimingHistory::Summary PathService::latency(double windowSeconds) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latency_.summarize(now(), windowSeconds);
+}
+
+} // namespace arena::ecs
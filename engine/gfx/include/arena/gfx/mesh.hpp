@@ -2,12 +2,14 @@
 
 #include "arena/gl.hpp"
 #include <glm/glm.hpp>
+#include <cstddef>
 
 namespace arena::gfx {
 
 struct Mesh {
     GLuint vao = 0, vbo = 0, ibo = 0;
     GLsizei indexCount = 0;
+    size_t gpuBytes = 0; // vertex + index buffer storage
     
     // Create a grid mesh with thin quads forming lines
     static Mesh makeGrid(int half = 16, float cell = 1.0f);
@@ -29,6 +31,9 @@ struct Mesh {
     
     // Bind the mesh for rendering
     void bind() const;
+    
+    // Vertex and index buffer bytes currently allocated by all meshes
+    static size_t liveGpuBytes();
 };
 
 } // namespace arena::gfx
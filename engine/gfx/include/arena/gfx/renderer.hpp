@@ -10,7 +10,7 @@ namespace arena::gfx {
 
 struct FrameParams { 
     int fbW, fbH; 
-    float alpha; 
+    float alpha; // Clock::alpha(): blend factor between previous and current tick
 };
 
 struct DrawItem { 
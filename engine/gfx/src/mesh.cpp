@@ -2,10 +2,27 @@
 #include <glad/gl.h>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <cmath>
 
 namespace arena::gfx {
 
+namespace {
+
+// Bytes in live vertex/index buffers across all meshes, for the debug HUD
+std::atomic<size_t> g_liveGpuBytes{0};
+
+void TrackGpuBytes(Mesh& mesh, size_t bytes) {
+    mesh.gpuBytes = bytes;
+    g_liveGpuBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+} // namespace
+
+size_t Mesh::liveGpuBytes() {
+    return g_liveGpuBytes.load(std::memory_order_relaxed);
+}
+
 Mesh Mesh::makeGrid(int half, float cell) {
     Mesh mesh;
 
@@ -72,6 +89,7 @@ Mesh Mesh::makeGrid(int half, float cell) {
     glGenBuffers(1, &mesh.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    TrackGpuBytes(mesh, vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
 
     mesh.indexCount = static_cast<GLsizei>(indices.size());
 
@@ -160,6 +178,7 @@ Mesh Mesh::makeCube(float s) {
     glGenBuffers(1, &mesh.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    TrackGpuBytes(mesh, vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
     
     mesh.indexCount = static_cast<GLsizei>(indices.size());
     
@@ -246,6 +265,7 @@ Mesh Mesh::makeColoredCube(float s, float r, float g, float b) {
     glGenBuffers(1, &mesh.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    TrackGpuBytes(mesh, vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
     
     mesh.indexCount = static_cast<GLsizei>(indices.size());
     
@@ -302,6 +322,7 @@ Mesh Mesh::makeFloor(float size) {
     glGenBuffers(1, &mesh.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    TrackGpuBytes(mesh, vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
     
     mesh.indexCount = static_cast<GLsizei>(indices.size());
     
@@ -326,6 +347,8 @@ void Mesh::destroy() {
         glDeleteVertexArrays(1, &vao);
         vao = 0;
     }
+    g_liveGpuBytes.fetch_sub(gpuBytes, std::memory_order_relaxed);
+    gpuBytes = 0;
     indexCount = 0;
 }
 
@@ -463,6 +486,7 @@ Mesh Mesh::makeCoordinateAxes(float length, float thickness) {
     glGenBuffers(1, &mesh.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    TrackGpuBytes(mesh, vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
     
     mesh.indexCount = static_cast<GLsizei>(indices.size());
     
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::nav {
+
+// Abstract graph for hierarchical path search (HPA*) over a NavGrid.
+//
+// The grid is cut into clusters of clusterSize^2 columns, every level
+// included. Along each border between two clusters, the moves across it are
+// grouped into entrances: runs of crossings between the same pair of levels
+// whose cells are connected along the border on both sides. An entrance
+// shorter than 6 cells gets one pair of nodes at its middle, a longer one a
+// pair at each end. Nodes are joined across the border at cost 1 and, within
+// a cluster, by the cost of the shortest path that stays inside it. Costs are
+// in cells (1 straight, sqrt(2) diagonal), as in GridSearch.
+//
+// Diagonal moves across a border aren't entrances of their own; the two
+// straight moves beside one always are, so paths found through the graph are
+// at most a fraction of a cell longer per border for it.
+class ClusterGraph {
+public:
+    struct Edge {
+        uint32_t to;
+        float cost;
+    };
+
+    ClusterGraph() = default;
+    // Intra-cluster costs are found in parallel on pool, if given
+    ClusterGraph(const NavGrid& grid, int clusterSize, TaskPool* pool = nullptr);
+
+    // After cells in [x0, x1] x [z0, z1] (any level) were edited: rebuilds the
+    // entrances on every border of the clusters overlapping the box and the
+    // intra-cluster costs of the clusters on either side of those borders.
+    // The rest of the graph is kept, node ids included.
+    void update(const NavGrid& grid, int x0, int z0, int x1, int z1, TaskPool* pool = nullptr);
+
+    // Built for a grid of this shape (not a check that it's up to date)
+    bool matches(const NavGrid& grid) const {
+        return clusterSize_ > 0 && width_ == grid.width() && depth_ == grid.depth() && levels_ == grid.levels();
+    }
+    int clusterSize() const { return clusterSize_; }
+    int clustersX() const { return clustersX_; }
+    int clustersZ() const { return clustersZ_; }
+    uint32_t clusterOf(const Cell& c) const {
+        return static_cast<uint32_t>((c.y / clusterSize_) * clustersX_ + c.x / clusterSize_);
+    }
+
+    // Node ids are below nodeCapacity(); ids freed by update() are reused
+    size_t nodeCapacity() const { return nodes_.size(); }
+    size_t nodeCount() const { return nodes_.size() - free_.size(); }
+    size_t edgeCount() const;
+    bool live(uint32_t node) const { return nodes_[node].live; }
+    const Cell& cell(uint32_t node) const { return nodes_[node].cell; }
+    uint32_t cluster(uint32_t node) const { return nodes_[node].cluster; }
+    std::span<const Edge> edges(uint32_t node) const { return nodes_[node].edges; }
+    std::span<const uint32_t> clusterNodes(uint32_t cluster) const { return clusterNodes_[cluster]; }
+
+private:
+    struct Node {
+        Cell cell;
+        uint32_t cluster;
+        bool live;
+        uint32_t across; // edges across the border, ahead of those within the cluster
+        std::vector<Edge> edges;
+    };
+
+    uint32_t addNode(const Cell& cell, uint32_t border);
+    void clearBorder(uint32_t border);
+    // East borders are numbered by the cluster to their west, north ones by
+    // the cluster to their south plus the cluster count
+    void buildBorder(const NavGrid& grid, uint32_t border);
+    void buildIntraEdges(const NavGrid& grid, std::span<const uint32_t> clusters, TaskPool* pool);
+
+    int width_ = 0;
+    int depth_ = 0;
+    int levels_ = 0;
+    int clusterSize_ = 0;
+    int clustersX_ = 0;
+    int clustersZ_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    std::vector<std::vector<uint32_t>> clusterNodes_;
+    std::vector<std::vector<uint32_t>> borderNodes_;
+};
+
+// Dijkstra over the cells of one cluster, never leaving it. Reusable; not
+// thread-safe.
+class ClusterDijkstra {
+public:
+    static constexpr float kUnreached = 3.0e38f;
+
+    // Costs in cells from `from` to the cells of its cluster. With nodesOnly
+    // it stops once the graph's nodes in the cluster all have theirs, and
+    // other cells' costs may be too high.
+    void run(const NavGrid& grid, const ClusterGraph& graph, const Cell& from, bool nodesOnly = false);
+    // kUnreached if c is outside the cluster or can't be reached within it
+    float cost(const Cell& c) const;
+
+private:
+    int x0_ = 0;
+    int z0_ = 0;
+    int size_ = 0;
+    std::vector<float> dist_;
+    std::vector<uint8_t> target_; // node cells still to settle, with nodesOnly
+    std::vector<std::pair<float, uint32_t>> heap_;
+};
+
+} // namespace arena::nav
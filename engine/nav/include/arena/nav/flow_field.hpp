@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::nav {
+
+// The moves NavGrid::forEachMove makes into and out of each cell of a
+// NavGrid, a bit each: direction * 3 + from level - to level + 1, direction
+// in JumpPointTable::kDirs order. Flow fields follow them back from their
+// goal and pick each cell's way on without stepping the grid, so build this
+// once per grid and share it between them.
+class FlowMoves {
+public:
+    FlowMoves() = default;
+    explicit FlowMoves(const NavGrid& grid);
+
+    // Built for a grid of this shape (not a check that it's up to date)
+    bool matches(const NavGrid& grid) const {
+        return !into_.empty() && width_ == grid.width() && depth_ == grid.depth() && levels_ == grid.levels();
+    }
+    // After cells in [x0, x1] x [z0, z1] were edited: recomputes the cells
+    // whose moves they can change (two cells round the box, every level)
+    void update(const NavGrid& grid, int x0, int z0, int x1, int z1);
+    // By NavGrid::cellIndex
+    uint32_t into(size_t cell) const { return into_[cell]; }
+    uint32_t out(size_t cell) const { return out_[cell]; }
+
+private:
+    int width_ = 0;
+    int depth_ = 0;
+    int levels_ = 0;
+    std::vector<uint32_t> into_;
+    std::vector<uint32_t> out_;
+};
+
+// Costs to one goal cell from every cell of a NavGrid, and the move to take
+// from each, so any number of agents heading for the same goal can look up
+// their next step in O(1) instead of searching.
+//
+// Costs are in cells along the moves GridSearch makes (1 straight, sqrt(2)
+// diagonal, no corner cutting), found back from the goal, and each cell's
+// move is to the neighbour it's cheapest to go on from. Moves come from
+// FlowMoves, built for the field if none is given for the grid.
+// Without a pool (or with one that has no workers) that is one Dijkstra over
+// the whole grid. With workers the sweep runs by tile
+// (NavGridSettings::tileSize): a tile runs Dijkstra from the costs around its
+// edge and wakes the neighbours it can improve, until no tile can. Tiles that
+// don't touch (same row and column parity) run in parallel on pool. Costs
+// come out the same either way, up to float rounding. Dijkstra's open list
+// is bucketed by whole cells of cost rather than a heap: every move costs at
+// least one, so no cell popped from the lowest bucket can improve another in
+// it, and a bucket drains in any order.
+class FlowField {
+public:
+    static constexpr float kUnreached = 3.0e38f;
+    // direction() values besides JumpPointTable::kDirs indices
+    static constexpr uint8_t kGoal = 8;
+    static constexpr uint8_t kNone = 0xFF;
+
+    FlowField() = default;
+    FlowField(const NavGrid& grid, const Cell& goal, TaskPool* pool = nullptr, const FlowMoves* moves = nullptr);
+
+    const Cell& goal() const { return goal_; }
+    // Built for a grid of this shape (not a check that it's up to date)
+    bool matches(const NavGrid& grid) const {
+        return !cost_.empty() && width_ == grid.width() && depth_ == grid.depth() && levels_ == grid.levels();
+    }
+    // kUnreached if c can't reach the goal
+    float cost(const Cell& c) const { return cost_[index(c)]; }
+    uint8_t direction(const Cell& c) const { return dirs_[index(c)]; }
+    // The cell one move nearer the goal; false at the goal or if c can't
+    // reach it
+    bool next(const NavGrid& grid, const Cell& c, Cell& out) const;
+    // Unit direction on x/z from p towards the centre of the next cell (of
+    // the goal's, once on it); zero if p isn't on the grid or can't reach it
+    Vec3 steer(const NavGrid& grid, const Vec3& p) const;
+    // Whether any cell in [x0, x1] x [z0, z1], on any level, reaches the goal
+    bool reaches(int x0, int z0, int x1, int z1) const;
+
+private:
+    size_t index(const Cell& c) const { return (static_cast<size_t>(c.level) * depth_ + c.y) * width_ + c.x; }
+
+    Cell goal_{};
+    int width_ = 0;
+    int depth_ = 0;
+    int levels_ = 0;
+    std::vector<float> cost_;    // by NavGrid::cellIndex
+    std::vector<uint8_t> dirs_;
+};
+
+// Flow fields by goal cell, least recently used dropped first. Fields are
+// shared: one dropped while an agent group still holds it stays valid for
+// them. Safe to use from several threads; a miss builds outside the lock,
+// and other threads missing on the same goal meanwhile wait for that build
+// instead of starting their own. A field built from a grid older than a
+// clear() or invalidate() isn't kept, nor a build that threw: get()
+// rethrows to its caller and those waiting, and the next one builds again.
+class FlowFieldCache {
+public:
+    // get()'s generation for a grid that can't change during the call
+    static constexpr uint64_t kCurrent = UINT64_MAX;
+
+    explicit FlowFieldCache(size_t capacity = 8) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    // The field for goal, built on pool (if given) with moves (if they match
+    // the grid) when not cached or built for another grid shape. A grid that
+    // may be replaced meanwhile passes generation() as read before it was,
+    // so a build from a grid the cache has since been told changed isn't kept.
+    std::shared_ptr<const FlowField> get(const NavGrid& grid, const Cell& goal, TaskPool* pool = nullptr,
+                                         uint64_t generation = kCurrent, const FlowMoves* moves = nullptr);
+    // After the grid changed everywhere (a new bake)
+    void clear();
+    // After cells in [x0, x1] x [z0, z1] were edited: drops the fields that
+    // reach a cell in the box or next to it, and any still being built.
+    // Fields that don't can't have changed, as any new way in would start
+    // next to a reached cell.
+    void invalidate(int x0, int z0, int x1, int z1);
+
+    // Counts clear() and invalidate() calls
+    uint64_t generation() const;
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct Entry {
+        Cell goal;
+        uint64_t lastUse;
+        std::shared_ptr<const FlowField> field; // null while building
+        std::shared_future<std::shared_ptr<const FlowField>> building;
+    };
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    std::vector<Entry> entries_;
+    uint64_t clock_ = 0;
+    uint64_t generation_ = 0;   // bumped by clear() and invalidate()
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+} // namespace arena::nav
@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/nav/cluster_graph.hpp"
+#include "arena/nav/flow_field.hpp"
+#include "arena/nav/jump_points.hpp"
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::nav {
+
+enum class PathSearch {
+    AStar,        // plain A* over every cell
+    JumpPoints,   // JPS+ across uniform cells, A* elsewhere; same path costs
+    Hierarchical, // HPA* over the cluster graph for far-apart ends, JPS+ legs;
+                  // far fewer nodes, but slower than JPS+ on the stock arenas
+                  // and paths a few percent longer
+};
+
+// Everything a query reads, published as one. version counts publishes.
+struct NavSnapshot {
+    NavGrid grid;
+    JumpPointTable jumps;
+    ClusterGraph clusters;
+    FlowMoves moves; // shared by every flow field built on grid
+    uint64_t version = 0;
+};
+
+// INav over a baked NavGrid (see bakeNavGrid)
+//
+// Queries read the snapshot that was current when they started, so a bake
+// or re-bake publishing a new one (an atomic pointer swap) neither waits for
+// them nor changes anything under them.
+//
+// Editing: an editor reports what each edit covered with markDirty(min, max)
+// and, from IEditMode::markDirty, calls startRebake(). That copies the
+// current snapshot on a background thread, re-bakes the tiles the boxes
+// touch into it and updates the jump table, cluster graph and flow field
+// moves around them; applyRebake() at the next sync point
+// publishes the result and drops the flow fields it may have changed. The
+// world must not be edited while a re-bake runs (finishRebake() first).
+// On the 256 x 256 x 4 bench arenas the copy is the larger part of a
+// one-tile re-bake's table work: 4-5 ms for grid and table, against 1-2 ms
+// updating the table (a full build is 18-34 ms).
+class GridNav : public INav {
+public:
+    GridNav() = default;
+    explicit GridNav(const NavGridSettings& settings) : settings_(settings) {}
+
+    // Bakes the grid, its flow field moves, the jump table (for JumpPoints
+    // and Hierarchical) and the cluster graph (for Hierarchical, if
+    // settings.clusterSize > 0), and drops cached flow fields and any
+    // re-bake under way; false if nothing walkable was found
+    bool bakeFromWorld(const IWorld& world) override;
+    // Locates both ends (NavGrid::locate) and searches on this thread's
+    // context: with a cluster graph, HierarchicalSearch when they're more
+    // than two clusters apart, else (or if that fails) GridSearch. Safe to
+    // call from several threads at once.
+    Path findPath(const Vec3& start, const Vec3& goal) const override;
+    bool locate(const Vec3& p, Cell& out) const override { return snapshot()->grid.locate(p, out); }
+    // Flow field towards the cell under goal, for many agents heading there
+    // (see FlowField::steer); from the cache, built on the task pool on a
+    // miss. Null if goal isn't on the grid. Safe from several threads.
+    std::shared_ptr<const FlowField> flowField(const Vec3& goal) const;
+
+    // The world changed within [min, max]. Every tile within reach of the box
+    // (agent radius and a cell beyond it) is re-baked by the next re-bake.
+    void markDirty(const Vec3& min, const Vec3& max);
+    // Starts re-baking what's been marked dirty in the background; false if
+    // nothing is, or a re-bake is already running
+    bool startRebake(const IWorld& world);
+    // Publishes a finished re-bake; true if one was
+    bool applyRebake();
+    // Waits for a running re-bake and publishes it
+    void finishRebake();
+    bool rebakePending() const { return rebake_.valid(); }
+
+    // Pool for baking tiles in parallel; null (default) bakes on the caller
+    void setTaskPool(TaskPool* pool) { pool_ = pool; }
+    // JumpPoints by default; switching after a bake builds or drops the jump
+    // table and cluster graph to suit
+    void setPathSearch(PathSearch search);
+    PathSearch pathSearch() const { return search_; }
+    const NavGridSettings& settings() const { return settings_; }
+    // What queries start on now; holding it keeps it valid across publishes
+    std::shared_ptr<const NavSnapshot> snapshot() const { return current_.load(); }
+    uint64_t version() const { return snapshot()->version; }
+    // Parts of the current snapshot, valid until the next publish (a bake,
+    // applyRebake or setPathSearch)
+    const NavGrid& grid() const { return snapshot()->grid; }
+    const JumpPointTable& jumpPoints() const { return snapshot()->jumps; }
+    const ClusterGraph& clusterGraph() const { return snapshot()->clusters; }
+    const FlowFieldCache& flowFields() const { return flowFields_; }
+
+private:
+    // Cells [x0, x1] x [z0, z1], every level
+    struct CellBox {
+        int x0, z0, x1, z1;
+    };
+
+    void publish(std::shared_ptr<NavSnapshot> next);
+
+    NavGridSettings settings_;
+    TaskPool* pool_ = nullptr;
+    PathSearch search_ = PathSearch::JumpPoints;
+    std::atomic<std::shared_ptr<const NavSnapshot>> current_{std::make_shared<const NavSnapshot>()};
+    mutable FlowFieldCache flowFields_;
+    std::vector<CellBox> dirty_;
+    std::vector<CellBox> rebaking_;   // tile-aligned boxes of the running re-bake
+    std::future<std::shared_ptr<NavSnapshot>> rebake_;
+};
+
+} // namespace arena::nav
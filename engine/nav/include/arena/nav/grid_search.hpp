@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena::nav {
+
+class JumpPointTable;
+
+// A* over a NavGrid, reusable across queries. Moves go to the eight
+// neighbours (NavGrid::step) at cost 1 straight and sqrt(2) diagonally, in
+// cells; diagonals need both straight moves they cut past. Node state lives
+// in one array per grid cell stamped with a query generation, so nothing is
+// cleared between queries, and the open list is a 4-ary heap sized to the
+// grid. Given a JumpPointTable it runs JPS+ instead: uniform cells jump
+// straight to the next jump point, everything else expands as above, and
+// path costs are the same. Once sized to a grid and warmed up by a long
+// path, queries make no allocations. Not thread-safe: keep one per thread.
+class GridSearch {
+public:
+    // Shortest path from start to goal, straightened: waypoints are kept only
+    // where the straight line to the next one would leave the connected
+    // walkable cells (see gridLineOfSight). Paths with more waypoints than a
+    // Path holds are cut short; repath from the last one. Failed if either
+    // end isn't walkable or the goal can't be reached; straight away if the
+    // grid's regions are labelled and differ.
+    // Uses jumps if not null and built for a grid of this shape.
+    Path findPath(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps = nullptr);
+    // The same search, appending every cell along the path to out, start
+    // first and not straightened; false if there's no path
+    bool findCells(const NavGrid& grid, const Cell& start, const Cell& goal, std::vector<Cell>& out,
+                   const JumpPointTable* jumps = nullptr);
+
+    // Stats for the last query: nodes (jump points with JPS+) taken off the
+    // open list, and the path
+    // cost in metres (0 if no path)
+    size_t expanded() const { return expanded_; }
+    float cost() const { return cost_; }
+
+private:
+    struct Node {
+        uint32_t generation;
+        uint32_t parent;
+        float g;
+        uint32_t heapPos; // kClosed once expanded
+    };
+    struct HeapEntry {
+        float f, g;
+        uint32_t node;
+    };
+
+    void prepare(const NavGrid& grid);
+    void push(const HeapEntry& entry);
+    void siftUp(uint32_t pos);
+    HeapEntry pop();
+    void relax(uint32_t index, uint32_t parent, float g, float h);
+    void expandSteps(const NavGrid& grid, const Cell& cell, uint32_t index, float g, const Cell& goal);
+    void expandJumps(const NavGrid& grid, const JumpPointTable& jumps, const Cell& cell, uint32_t index, float g,
+                     const Cell& goal);
+    bool search(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps);
+    bool run(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps);
+    void collectCells(const NavGrid& grid, uint32_t goalIndex, std::vector<Cell>& out) const;
+
+    std::vector<Node> nodes_;
+    std::vector<HeapEntry> heap_;
+    uint32_t heapSize_ = 0;
+    uint32_t generation_ = 0;
+    std::vector<Cell> raw_; // unstraightened path
+    size_t expanded_ = 0;
+    float cost_ = 0.0f;
+};
+
+// Waypoints along cells (each one move on from the one before): the first
+// and last, and in between only where the straight line to the next would
+// leave the connected walkable cells. Cut short if out fills up.
+void straightenPath(const NavGrid& grid, std::span<const Cell> cells, Path& out);
+
+// Whether walking the straight line between the centres of a and b crosses
+// only walkable cells, each connected to the one before (through both side
+// cells where the line passes exactly through a corner), ending on b's level
+bool gridLineOfSight(const NavGrid& grid, const Cell& a, const Cell& b);
+
+} // namespace arena::nav
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/nav/cluster_graph.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena::nav {
+
+class JumpPointTable;
+
+// HPA* over a ClusterGraph, reusable across queries. plan() joins start and
+// goal to the nodes of their clusters and runs A* over the abstract graph,
+// giving a corridor of entrance cells; refine() turns legs of it into a
+// path by grid search between consecutive corridor cells, so a caller can
+// refine just the legs ahead of an agent and the rest when it gets there.
+// Paths are near-optimal rather than shortest: they pass through entrance
+// cells. Not thread-safe: keep one per thread.
+class HierarchicalSearch {
+public:
+    // False if either end isn't walkable, the graph isn't built for the
+    // grid's shape, the grid's regions are labelled and differ, or the
+    // abstract graph has no route. The goal is joined to its cluster as if
+    // moves there ran both ways; refining finds out if one doesn't.
+    bool plan(const ClusterGraph& graph, const NavGrid& grid, const Cell& start, const Cell& goal);
+    // The last plan, start first and goal last; leg i runs from corridor()[i]
+    // to corridor()[i + 1]
+    std::span<const Cell> corridor() const { return corridor_; }
+    size_t legCount() const { return corridor_.empty() ? 0 : corridor_.size() - 1; }
+    // Legs [first, first + count) of the last plan, grid searched one by one
+    // (with jumps if given) and straightened as a whole. Failed if a leg has
+    // no path; cut short like GridSearch paths if too long for a Path.
+    Path refine(const NavGrid& grid, size_t first, size_t count, const JumpPointTable* jumps = nullptr);
+    // plan() and refine() every leg
+    Path findPath(const ClusterGraph& graph, const NavGrid& grid, const Cell& start, const Cell& goal,
+                  const JumpPointTable* jumps = nullptr);
+
+    // The context refine() searches legs with; callers can run queries too
+    // short to be worth planning on it rather than keep a second one
+    GridSearch& gridSearch() { return cells_; }
+
+    // Stats for the last plan: abstract nodes taken off the open list, and
+    // the corridor's cost in metres (0 if none)
+    size_t expanded() const { return expanded_; }
+    float cost() const { return cost_; }
+
+private:
+    struct Node {
+        uint32_t generation;
+        uint32_t parent;
+        float g;
+        bool closed;
+    };
+    struct OpenEntry {
+        float f, g;
+        uint32_t node;
+        bool operator>(const OpenEntry& o) const { return f > o.f || (f == o.f && g < o.g); }
+    };
+
+    void relax(uint32_t node, uint32_t parent, float g, float h);
+
+    std::vector<Node> nodes_;        // graph nodes, then start and goal
+    std::vector<float> goalCosts_;   // per graph node; valid if goalStamps_ match
+    std::vector<uint32_t> goalStamps_;
+    std::vector<ClusterGraph::Edge> startEdges_;
+    std::vector<OpenEntry> open_;
+    uint32_t generation_ = 0;
+    ClusterDijkstra dijkstra_;
+    GridSearch cells_;
+    std::vector<Cell> corridor_;
+    std::vector<Cell> refined_;
+    size_t expanded_ = 0;
+    float cost_ = 0.0f;
+};
+
+} // namespace arena::nav
@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "arena/nav/nav_grid.hpp"
+
+namespace arena::nav {
+
+// Precomputed jump distances for Jump Point Search (JPS+) over a NavGrid.
+//
+// JPS only holds where the grid is uniform: a cell is uniform when every
+// neighbour walkable on its own level is a step away (no ledges) and no
+// neighbour on another level is (no ramps across levels), and when its
+// walkable neighbours on its level are all like that too. Jumps run across
+// uniform cells and stop at the first cell that isn't, which GridSearch then
+// expands like plain A*, so stairs, ramps and ledges cost nothing in
+// correctness, only in how far a jump gets.
+//
+// For each uniform cell and direction (kDirs order) the table holds d > 0 if
+// the next jump point is d steps away, else -d for d free steps before the
+// way is blocked. Straight jumps stop where a wall beside the line ends (a
+// forced neighbour, with diagonals not cutting corners); diagonal jumps stop
+// where either straight jump along the way would. After an edit, update()
+// recomputes the cells round the edited box and follows the changes back
+// along their lines, rather than building the table again.
+class JumpPointTable {
+public:
+    // +x, +z, -x, -z, then +x+z, -x+z, -x-z, +x-z
+    static constexpr int kDirs[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+
+    JumpPointTable() = default;
+    explicit JumpPointTable(const NavGrid& grid);
+
+    // Built for a grid of this shape (not a check that it's up to date)
+    bool matches(const NavGrid& grid) const {
+        return !jumps_.empty() && width_ == grid.width() && depth_ == grid.depth() && levels_ == grid.levels();
+    }
+    // After cells in [x0, x1] x [z0, z1] (any level) were edited:
+    // recomputes uniformity two cells round the box and jumps three round
+    // it, then each line back from those until its distances stop changing
+    void update(const NavGrid& grid, int x0, int z0, int x1, int z1);
+    // By NavGrid::cellIndex
+    bool uniform(size_t cell) const { return uniform_[cell] != 0; }
+    int distance(size_t cell, int dir) const { return jumps_[cell][dir]; }
+    size_t uniformCount() const;
+
+private:
+    // From the uniformity and the next cell's jumps already in the table
+    int16_t jump(const NavGrid& grid, int x, int z, int level, int dir) const;
+
+    int width_ = 0;
+    int depth_ = 0;
+    int levels_ = 0;
+    std::vector<uint8_t> uniform_;
+    std::vector<std::array<int16_t, 8>> jumps_;
+};
+
+} // namespace arena::nav
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "arena/contracts.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::nav {
+
+// Grid and agent parameters for a bake. Cell {x, y, level} covers
+// [origin.x + x * cellSize, +cellSize) on x and likewise row y on z; level l
+// holds the highest walkable floor with origin.y + l * levelHeight <= floor
+// height < origin.y + (l + 1) * levelHeight.
+struct NavGridSettings {
+    float origin[3] = {-64.0f, -1.0f, -64.0f};
+    float cellSize = 0.5f;
+    int width = 256;            // cells along x
+    int depth = 256;            // cells along z
+    int levels = 4;
+    float levelHeight = 4.0f;
+    float agentRadius = 0.4f;
+    float agentHeight = 1.8f;
+    float maxStep = 0.35f;      // climbable ledge; matches the character controller
+    float maxSlopeCos = 0.64f;  // ~50 degrees
+    int tileSize = 32;          // cells per tile side; tiles bake independently
+    int clusterSize = 16;       // cells per cluster side for hierarchical search; 0 for none
+};
+
+// Baked walkability: one bit per cell and level in 64-bit words (rows padded
+// to whole words), and the floor height of each cell in centimetres above
+// origin.y. Two walkable cells next to each other are connected when their
+// floors differ by at most maxStep, whatever their levels.
+class NavGrid {
+public:
+    NavGrid() = default;
+    // Everything blocked
+    explicit NavGrid(const NavGridSettings& settings);
+
+    const NavGridSettings& settings() const { return settings_; }
+    int width() const { return settings_.width; }
+    int depth() const { return settings_.depth; }
+    int levels() const { return settings_.levels; }
+    int wordsPerRow() const { return wordsPerRow_; }
+
+    bool inBounds(int x, int z, int level) const {
+        return x >= 0 && z >= 0 && level >= 0 && x < settings_.width && z < settings_.depth && level < settings_.levels;
+    }
+    bool walkable(int x, int z, int level) const {
+        return inBounds(x, z, level) && (bits_[wordIndex(x, z, level)] >> (x & 63) & 1u) != 0;
+    }
+    // Floor height of a walkable cell
+    float height(int x, int z, int level) const {
+        return settings_.origin[1] + heights_[cellIndex(x, z, level)] * 0.01f;
+    }
+    void setWalkable(int x, int z, int level, float y);
+    void setBlocked(int x, int z, int level);
+
+    // The walkable cell at (from.x + dx, from.y + dz) connected to from: its
+    // floor within maxStep of from's, on from's level or the one above or
+    // below (maxStep is assumed less than levelHeight). Same level first.
+    bool step(const Cell& from, int dx, int dz, Cell& to) const;
+    // Calls fn(to, diagonal) for each move out of from: straight steps, then
+    // diagonal ones where both straight steps beside them can be made (no
+    // corner cutting)
+    template <class Fn>
+    void forEachMove(const Cell& from, Fn&& fn) const;
+
+    // Connected regions: cells in different regions can't reach each other
+    // (moves are treated as two-way, so the converse doesn't hold when a
+    // ledge only connects one way). Labelled by labelRegions(), which
+    // bakeNavGrid calls; any edit after that forgets them.
+    void labelRegions();
+    bool regionsKnown() const { return !regions_.empty(); }
+    uint32_t region(const Cell& c) const { return regions_[cellIndex(c.x, c.y, c.level)]; }
+
+    // Dense index of a cell, level-major then z then x; below cellCount()
+    size_t cellCount() const { return heights_.size(); }
+    size_t cellIndex(int x, int z, int level) const {
+        return (static_cast<size_t>(level) * settings_.depth + z) * settings_.width + x;
+    }
+
+    // Rows of wordsPerRow() words for one level, z-major
+    std::span<const uint64_t> levelBits(int level) const {
+        size_t words = static_cast<size_t>(wordsPerRow_) * settings_.depth;
+        return {bits_.data() + words * level, words};
+    }
+    size_t walkableCount() const;
+
+    // The walkable cell under p: its column, and the highest floor no more
+    // than maxStep above p (else the lowest one above it). False if p is
+    // outside the grid or its column has no floor.
+    bool locate(const Vec3& p, Cell& out) const;
+    // Centre of the cell on its floor
+    Vec3 center(const Cell& c) const;
+
+private:
+    size_t wordIndex(int x, int z, int level) const {
+        return (static_cast<size_t>(level) * settings_.depth + z) * wordsPerRow_ + (x >> 6);
+    }
+
+    NavGridSettings settings_;
+    int wordsPerRow_ = 0;
+    int stepCm_ = 0;
+    std::vector<uint64_t> bits_;
+    std::vector<int16_t> heights_;
+    std::vector<uint32_t> regions_; // per cell; empty until labelled
+};
+
+inline bool NavGrid::step(const Cell& from, int dx, int dz, Cell& to) const {
+    int x = from.x + dx, z = from.y + dz;
+    if (x < 0 || z < 0 || x >= settings_.width || z >= settings_.depth) return false;
+    int floor = heights_[cellIndex(from.x, from.y, from.level)];
+    for (int level : {from.level, from.level - 1, from.level + 1}) {
+        if (level < 0 || level >= settings_.levels) continue;
+        if ((bits_[wordIndex(x, z, level)] >> (x & 63) & 1u) == 0) continue;
+        int rise = heights_[cellIndex(x, z, level)] - floor;
+        if (rise > stepCm_ || rise < -stepCm_) continue;
+        to = {x, z, level};
+        return true;
+    }
+    return false;
+}
+
+template <class Fn>
+void NavGrid::forEachMove(const Cell& from, Fn&& fn) const {
+    static constexpr int kMoves[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    static constexpr int kSides[4][2] = {{0, 1}, {2, 1}, {2, 3}, {0, 3}};
+    bool straight[4];
+    Cell to;
+    for (int d = 0; d < 4; ++d) {
+        straight[d] = step(from, kMoves[d][0], kMoves[d][1], to);
+        if (straight[d]) fn(to, false);
+    }
+    for (int d = 4; d < 8; ++d) {
+        if (straight[kSides[d - 4][0]] && straight[kSides[d - 4][1]] && step(from, kMoves[d][0], kMoves[d][1], to)) {
+            fn(to, true);
+        }
+    }
+}
+
+// Sample the world into a grid. Per column, batched downward rays find every
+// surface from the top of the highest level down; floors flat enough to stand
+// on get an upward headroom ray, then the agent capsule (lifted by maxStep, so
+// steps don't count) is nudged along +-x, +-z and +y with sweepCapsule to
+// check nothing is within its radius. Tiles of tileSize^2 columns are baked
+// in parallel on pool (the caller if null); the world's queries must be safe
+// to call from several threads.
+NavGrid bakeNavGrid(const IWorld& world, const NavGridSettings& settings, TaskPool* pool = nullptr);
+
+// Bake just the given tiles (index tz * tilesX + tx, as bakeNavGrid splits
+// the grid) into grid again, after the world changed within them, and
+// relabel its regions. Every other cell is kept as it was. Indices past the
+// last tile are skipped with a warning.
+void rebakeNavTiles(const IWorld& world, NavGrid& grid, std::span<const uint32_t> tiles, TaskPool* pool = nullptr);
+
+} // namespace arena::nav
@@ -0,0 +1,289 @@
+#include "arena/nav/cluster_graph.hpp"
+#include "arena/profiler.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace arena::nav {
+
+namespace {
+
+constexpr float kDiagonal = 1.41421356f;
+
+// Entrances at least this long get a node pair at each end instead of one
+// in the middle
+constexpr int kLongEntrance = 6;
+
+// One or both ways across a border at `along` cells from its start
+struct Crossing {
+    int along;
+    int levelA, levelB;
+    bool forward, back; // A to B, B to A
+};
+
+bool SameCell(const Cell& a, const Cell& b) { return a.x == b.x && a.y == b.y && a.level == b.level; }
+
+} // namespace
+
+ClusterGraph::ClusterGraph(const NavGrid& grid, int clusterSize, TaskPool* pool)
+    : width_(grid.width()), depth_(grid.depth()), levels_(grid.levels()), clusterSize_(std::max(clusterSize, 0)) {
+    if (clusterSize_ == 0 || width_ <= 0 || depth_ <= 0) {
+        clusterSize_ = 0;
+        return;
+    }
+    ARENA_PROFILE_SCOPE("NavClusterGraph");
+    clustersX_ = (width_ + clusterSize_ - 1) / clusterSize_;
+    clustersZ_ = (depth_ + clusterSize_ - 1) / clusterSize_;
+    uint32_t clusters = static_cast<uint32_t>(clustersX_ * clustersZ_);
+    clusterNodes_.resize(clusters);
+    borderNodes_.resize(clusters * 2);
+    for (uint32_t border = 0; border < clusters * 2; ++border) buildBorder(grid, border);
+
+    std::vector<uint32_t> all(clusters);
+    for (uint32_t c = 0; c < clusters; ++c) all[c] = c;
+    buildIntraEdges(grid, all, pool);
+}
+
+void ClusterGraph::update(const NavGrid& grid, int x0, int z0, int x1, int z1, TaskPool* pool) {
+    if (!matches(grid)) {
+        if (clusterSize_ > 0) *this = ClusterGraph(grid, clusterSize_, pool);
+        return;
+    }
+    ARENA_PROFILE_SCOPE("NavClusterUpdate");
+    x0 = std::clamp(x0, 0, width_ - 1);
+    x1 = std::clamp(x1, 0, width_ - 1);
+    z0 = std::clamp(z0, 0, depth_ - 1);
+    z1 = std::clamp(z1, 0, depth_ - 1);
+    uint32_t clusters = static_cast<uint32_t>(clustersX_ * clustersZ_);
+
+    // Every border of the clusters edited, then the clusters either side
+    std::vector<uint32_t> borders, touched;
+    for (int cz = z0 / clusterSize_; cz <= z1 / clusterSize_; ++cz) {
+        for (int cx = x0 / clusterSize_; cx <= x1 / clusterSize_; ++cx) {
+            uint32_t c = static_cast<uint32_t>(cz * clustersX_ + cx);
+            if (cx + 1 < clustersX_) borders.push_back(c);
+            if (cx > 0) borders.push_back(c - 1);
+            if (cz + 1 < clustersZ_) borders.push_back(clusters + c);
+            if (cz > 0) borders.push_back(clusters + c - clustersX_);
+        }
+    }
+    std::sort(borders.begin(), borders.end());
+    borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+    for (uint32_t border : borders) {
+        uint32_t c = border < clusters ? border : border - clusters;
+        touched.push_back(c);
+        touched.push_back(border < clusters ? c + 1 : c + clustersX_);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    for (uint32_t border : borders) clearBorder(border);
+    for (uint32_t border : borders) buildBorder(grid, border);
+    buildIntraEdges(grid, touched, pool);
+}
+
+size_t ClusterGraph::edgeCount() const {
+    size_t count = 0;
+    for (const Node& n : nodes_) count += n.edges.size();
+    return count;
+}
+
+uint32_t ClusterGraph::addNode(const Cell& cell, uint32_t border) {
+    uint32_t id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[id];
+    node.cell = cell;
+    node.cluster = clusterOf(cell);
+    node.live = true;
+    node.across = 0;
+    node.edges.clear();
+    clusterNodes_[node.cluster].push_back(id);
+    borderNodes_[border].push_back(id);
+    return id;
+}
+
+void ClusterGraph::clearBorder(uint32_t border) {
+    for (uint32_t id : borderNodes_[border]) {
+        Node& node = nodes_[id];
+        auto& list = clusterNodes_[node.cluster];
+        list.erase(std::find(list.begin(), list.end(), id));
+        node.live = false;
+        node.edges.clear();
+        free_.push_back(id);
+    }
+    borderNodes_[border].clear();
+}
+
+void ClusterGraph::buildBorder(const NavGrid& grid, uint32_t border) {
+    uint32_t clusters = static_cast<uint32_t>(clustersX_ * clustersZ_);
+    bool north = border >= clusters;
+    uint32_t c = north ? border - clusters : border;
+    int cx = static_cast<int>(c % clustersX_), cz = static_cast<int>(c / clustersX_);
+    // Side A's cells run from (ax, az) along (ux, uz); side B is (vx, vz) on
+    int ax, az, ux, uz, vx, vz, length;
+    if (!north) {
+        if (cx + 1 >= clustersX_) return;
+        ax = (cx + 1) * clusterSize_ - 1;
+        az = cz * clusterSize_;
+        ux = 0, uz = 1, vx = 1, vz = 0;
+        length = std::min(clusterSize_, depth_ - az);
+    } else {
+        if (cz + 1 >= clustersZ_) return;
+        ax = cx * clusterSize_;
+        az = (cz + 1) * clusterSize_ - 1;
+        ux = 1, uz = 0, vx = 0, vz = 1;
+        length = std::min(clusterSize_, width_ - ax);
+    }
+
+    std::vector<Crossing> crossings;
+    Cell to;
+    for (int i = 0; i < length; ++i) {
+        int x = ax + ux * i, z = az + uz * i;
+        for (int level = 0; level < levels_; ++level) {
+            if (grid.walkable(x, z, level) && grid.step({x, z, level}, vx, vz, to)) {
+                crossings.push_back({i, level, to.level, true, false});
+            }
+        }
+        for (int level = 0; level < levels_; ++level) {
+            if (!grid.walkable(x + vx, z + vz, level) || !grid.step({x + vx, z + vz, level}, -vx, -vz, to)) continue;
+            auto same = std::find_if(crossings.begin(), crossings.end(), [&](const Crossing& k) {
+                return k.along == i && k.levelA == to.level && k.levelB == level;
+            });
+            if (same != crossings.end()) {
+                same->back = true;
+            } else {
+                crossings.push_back({i, to.level, level, false, true});
+            }
+        }
+    }
+    std::sort(crossings.begin(), crossings.end(), [](const Crossing& a, const Crossing& b) {
+        if (a.levelA != b.levelA) return a.levelA < b.levelA;
+        if (a.levelB != b.levelB) return a.levelB < b.levelB;
+        return a.along < b.along;
+    });
+
+    auto sideA = [&](const Crossing& k) { return Cell{ax + ux * k.along, az + uz * k.along, k.levelA}; };
+    auto sideB = [&](const Crossing& k) { return Cell{ax + ux * k.along + vx, az + uz * k.along + vz, k.levelB}; };
+    // Next along the border the same way, one step on from prev on both sides
+    auto continues = [&](const Crossing& prev, const Crossing& k) {
+        if (k.levelA != prev.levelA || k.levelB != prev.levelB || k.along != prev.along + 1) return false;
+        if (k.forward != prev.forward || k.back != prev.back) return false;
+        Cell a, b;
+        return grid.step(sideA(prev), ux, uz, a) && SameCell(a, sideA(k)) && grid.step(sideB(prev), ux, uz, b) &&
+               SameCell(b, sideB(k));
+    };
+    auto addPair = [&](const Crossing& k) {
+        uint32_t a = addNode(sideA(k), border), b = addNode(sideB(k), border);
+        if (k.forward) {
+            nodes_[a].edges.push_back({b, 1.0f});
+            nodes_[a].across = 1;
+        }
+        if (k.back) {
+            nodes_[b].edges.push_back({a, 1.0f});
+            nodes_[b].across = 1;
+        }
+    };
+    for (size_t first = 0; first < crossings.size();) {
+        size_t last = first;
+        while (last + 1 < crossings.size() && continues(crossings[last], crossings[last + 1])) ++last;
+        if (last - first + 1 < kLongEntrance) {
+            addPair(crossings[(first + last) / 2]);
+        } else {
+            addPair(crossings[first]);
+            addPair(crossings[last]);
+        }
+        first = last + 1;
+    }
+}
+
+void ClusterGraph::buildIntraEdges(const NavGrid& grid, std::span<const uint32_t> clusters, TaskPool* pool) {
+    // Each cluster only touches its own nodes' edges. Ids freed by update()
+    // may already be reused elsewhere, so old edges within the cluster are
+    // dropped by position, not by where they lead.
+    auto build = [&](size_t begin, size_t end) {
+        ClusterDijkstra dijkstra;
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t c = clusters[i];
+            const auto& ids = clusterNodes_[c];
+            for (uint32_t id : ids) nodes_[id].edges.resize(nodes_[id].across);
+            for (uint32_t id : ids) {
+                dijkstra.run(grid, *this, nodes_[id].cell, true);
+                for (uint32_t other : ids) {
+                    if (other == id) continue;
+                    float cost = dijkstra.cost(nodes_[other].cell);
+                    if (cost < ClusterDijkstra::kUnreached) nodes_[id].edges.push_back({other, cost});
+                }
+            }
+        }
+    };
+    if (pool) {
+        pool->parallelFor(clusters.size(), 1, build);
+    } else {
+        build(0, clusters.size());
+    }
+}
+
+void ClusterDijkstra::run(const NavGrid& grid, const ClusterGraph& graph, const Cell& from, bool nodesOnly) {
+    size_ = graph.clusterSize();
+    x0_ = from.x / size_ * size_;
+    z0_ = from.y / size_ * size_;
+    int area = size_ * size_;
+    dist_.assign(static_cast<size_t>(area) * grid.levels(), kUnreached);
+    target_.resize(dist_.size());
+    heap_.clear();
+    heap_.reserve(dist_.size() * 8); // a push per move into a cell at most
+
+    auto local = [&](const Cell& c) { return static_cast<uint32_t>(c.level * area + (c.y - z0_) * size_ + (c.x - x0_)); };
+    auto inside = [&](const Cell& c) { return c.x >= x0_ && c.y >= z0_ && c.x < x0_ + size_ && c.y < z0_ + size_; };
+    std::span<const uint32_t> nodes = graph.clusterNodes(graph.clusterOf(from));
+    size_t remaining = 0;
+    if (nodesOnly) {
+        for (uint32_t id : nodes) {
+            uint8_t& target = target_[local(graph.cell(id))];
+            remaining += target == 0 ? 1 : 0;
+            target = 1;
+        }
+    }
+
+    constexpr std::greater<> kLater;
+    dist_[local(from)] = 0.0f;
+    heap_.push_back({0.0f, local(from)});
+    while (!heap_.empty() && (!nodesOnly || remaining > 0)) {
+        std::pop_heap(heap_.begin(), heap_.end(), kLater);
+        auto [d, index] = heap_.back();
+        heap_.pop_back();
+        if (d > dist_[index]) continue;
+        if (target_[index]) {
+            target_[index] = 0;
+            --remaining;
+        }
+        int rest = static_cast<int>(index) % area;
+        Cell cell{x0_ + rest % size_, z0_ + rest / size_, static_cast<int>(index) / area};
+        grid.forEachMove(cell, [&](const Cell& to, bool diagonal) {
+            if (!inside(to)) return;
+            float next = d + (diagonal ? kDiagonal : 1.0f);
+            uint32_t target = local(to);
+            if (next >= dist_[target]) return;
+            dist_[target] = next;
+            heap_.push_back({next, target});
+            std::push_heap(heap_.begin(), heap_.end(), kLater);
+        });
+    }
+    if (remaining > 0) {
+        for (uint32_t id : nodes) target_[local(graph.cell(id))] = 0;
+    }
+}
+
+float ClusterDijkstra::cost(const Cell& c) const {
+    if (c.x < x0_ || c.y < z0_ || c.x >= x0_ + size_ || c.y >= z0_ + size_) return kUnreached;
+    size_t index = static_cast<size_t>(c.level) * size_ * size_ + (c.y - z0_) * size_ + (c.x - x0_);
+    return index < dist_.size() ? dist_[index] : kUnreached;
+}
+
+} // namespace arena::nav
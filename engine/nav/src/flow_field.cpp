@@ -0,0 +1,425 @@
+#include "arena/nav/flow_field.hpp"
+#include "arena/profiler.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace arena::nav {
+
+namespace {
+
+constexpr float kDiagonal = 1.41421356f;
+constexpr int kMoves[8][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+
+// FlowMoves bits for the moves NavGrid::forEachMove would make into `to`
+uint32_t MovesInto(const NavGrid& grid, const Cell& to) {
+    uint32_t bits = 0;
+    for (int dir = 0; dir < 8; ++dir) {
+        int dx = kMoves[dir][0], dz = kMoves[dir][1];
+        int x = to.x - dx, z = to.y - dz;
+        for (int level = to.level - 1; level <= to.level + 1; ++level) {
+            if (!grid.walkable(x, z, level)) continue;
+            Cell from{x, z, level}, reached, side;
+            if (!grid.step(from, dx, dz, reached) || reached.level != to.level) continue;
+            if (dir >= 4 && (!grid.step(from, dx, 0, side) || !grid.step(from, 0, dz, side))) continue;
+            bits |= 1u << (dir * 3 + level - to.level + 1);
+        }
+    }
+    return bits;
+}
+
+// Each FlowMoves bit as a move back from its cell: the cell index step, the
+// column offset and the move's cost
+struct MovesBack {
+    ptrdiff_t index[24];
+    int dx[24], dz[24];
+    float cost[24];
+
+    MovesBack(int width, int depth) {
+        for (int bit = 0; bit < 24; ++bit) {
+            int dir = bit / 3, dl = bit % 3 - 1;
+            dx[bit] = -kMoves[dir][0];
+            dz[bit] = -kMoves[dir][1];
+            index[bit] = (static_cast<ptrdiff_t>(dl) * depth + dz[bit]) * width + dx[bit];
+            cost[bit] = dir >= 4 ? kDiagonal : 1.0f;
+        }
+    }
+};
+
+// Dijkstra's open list keyed by whole cells of cost. Every move costs at
+// least one, so nothing pushed while a bucket drains lands back in it: the
+// lowest bucket pops in any order and costs come out as with a heap. Buckets
+// are a ring over the live keys, doubled when they span more than it holds.
+class CostBuckets {
+public:
+    bool empty() const { return count_ == 0; }
+
+    void push(float d, uint32_t cell) {
+        size_t key = static_cast<size_t>(d);
+        if (count_ == 0) {
+            low_ = high_ = key;
+        } else if (key < low_ || key > high_) {
+            size_t lo = std::min(low_, key), hi = std::max(high_, key);
+            if (hi - lo >= ring_.size()) grow(hi - lo + 1);
+            low_ = lo;
+            high_ = hi;
+        }
+        if (ring_.empty()) grow(1);
+        ring_[key & (ring_.size() - 1)].push_back({d, cell});
+        ++count_;
+    }
+
+    std::pair<float, uint32_t> pop() {
+        for (;; ++low_) {
+            auto& bucket = ring_[low_ & (ring_.size() - 1)];
+            if (bucket.empty()) continue;
+            auto top = bucket.back();
+            bucket.pop_back();
+            --count_;
+            return top;
+        }
+    }
+
+private:
+    void grow(size_t span) {
+        size_t size = std::max<size_t>(ring_.size(), 8);
+        while (size < span) size *= 2;
+        if (size == ring_.size()) return;
+        std::vector<std::vector<std::pair<float, uint32_t>>> ring(size);
+        if (count_ > 0) {
+            for (size_t key = low_; key <= high_; ++key) ring[key & (size - 1)] = std::move(ring_[key & (ring_.size() - 1)]);
+        }
+        ring_ = std::move(ring);
+    }
+
+    std::vector<std::vector<std::pair<float, uint32_t>>> ring_;
+    size_t low_ = 0, high_ = 0, count_ = 0;
+};
+
+struct Tile {
+    int x0, z0, x1, z1; // cells [x0, x1) x [z0, z1)
+    bool contains(const Cell& c) const { return c.x >= x0 && c.y >= z0 && c.x < x1 && c.y < z1; }
+};
+
+} // namespace
+
+FlowMoves::FlowMoves(const NavGrid& grid)
+    : width_(grid.width()), depth_(grid.depth()), levels_(grid.levels()), into_(grid.cellCount(), 0),
+      out_(grid.cellCount(), 0) {
+    update(grid, 0, 0, width_ - 1, depth_ - 1);
+}
+
+void FlowMoves::update(const NavGrid& grid, int x0, int z0, int x1, int z1) {
+    // A move into a cell reads its neighbour and the neighbour's own
+    // neighbours (the corners a diagonal mustn't cut); moves out of a cell
+    // are moves into its neighbours, a cell further out
+    const MovesBack back(width_, depth_);
+    for (int reach : {2, 3}) {
+        int bx0 = std::max(x0 - reach, 0), bz0 = std::max(z0 - reach, 0);
+        int bx1 = std::min(x1 + reach, width_ - 1), bz1 = std::min(z1 + reach, depth_ - 1);
+        for (int level = 0; level < levels_; ++level) {
+            for (int z = bz0; z <= bz1; ++z) {
+                for (int x = bx0; x <= bx1; ++x) {
+                    size_t i = grid.cellIndex(x, z, level);
+                    if (!grid.walkable(x, z, level)) {
+                        into_[i] = out_[i] = 0;
+                        continue;
+                    }
+                    if (reach == 2) {
+                        into_[i] = MovesInto(grid, {x, z, level});
+                        continue;
+                    }
+                    uint32_t bits = 0;
+                    for (int bit = 0; bit < 24; ++bit) {
+                        int tx = x - back.dx[bit], tz = z - back.dz[bit], tl = level - (bit % 3 - 1);
+                        if (!grid.inBounds(tx, tz, tl)) continue;
+                        bits |= into_[grid.cellIndex(tx, tz, tl)] & 1u << bit;
+                    }
+                    out_[i] = bits;
+                }
+            }
+        }
+    }
+}
+
+FlowField::FlowField(const NavGrid& grid, const Cell& goal, TaskPool* pool, const FlowMoves* moves)
+    : goal_(goal), width_(grid.width()), depth_(grid.depth()), levels_(grid.levels()) {
+    ARENA_PROFILE_SCOPE("NavFlowField");
+    cost_.assign(grid.cellCount(), kUnreached);
+    dirs_.assign(grid.cellCount(), kNone);
+    if (!grid.walkable(goal.x, goal.y, goal.level)) return;
+    FlowMoves own;
+    if (!moves || !moves->matches(grid)) {
+        own = FlowMoves(grid);
+        moves = &own;
+    }
+    const MovesBack back(width_, depth_);
+
+    int size = std::max(grid.settings().tileSize, 1);
+    int tilesX = (width_ + size - 1) / size, tilesZ = (depth_ + size - 1) / size;
+    auto tileAt = [&](int tx, int tz) {
+        return Tile{tx * size, tz * size, std::min((tx + 1) * size, width_), std::min((tz + 1) * size, depth_)};
+    };
+    auto run = [&](size_t count, const std::function<void(size_t, size_t)>& fn) {
+        if (pool && count > 1) {
+            pool->parallelFor(count, 1, fn);
+        } else {
+            fn(0, count);
+        }
+    };
+
+    // A single thread does best with one Dijkstra back from the goal over the
+    // whole grid; tiles only pay for their re-sweeps when they run in parallel
+    cost_[index(goal)] = 0.0f;
+    if (!pool || pool->threadCount() == 0) {
+        CostBuckets open;
+        open.push(0.0f, static_cast<uint32_t>(index(goal)));
+        while (!open.empty()) {
+            auto [d, i] = open.pop();
+            if (d > cost_[i]) continue;
+            for (uint32_t m = moves->into(i); m; m &= m - 1) {
+                int bit = std::countr_zero(m);
+                uint32_t f = static_cast<uint32_t>(i + back.index[bit]);
+                float next = d + back.cost[bit];
+                if (next >= cost_[f]) continue;
+                cost_[f] = next;
+                open.push(next, f);
+            }
+        }
+    } else {
+        // Dijkstra back from the goal within one tile, from the costs of the
+        // cells around it, noting in wake (3x3 bits, the tile in the middle) which
+        // neighbours it can now improve
+        std::vector<uint8_t> active(static_cast<size_t>(tilesX) * tilesZ, 0);
+        std::vector<uint16_t> wake(active.size(), 0);
+        active[(goal.y / size) * tilesX + goal.x / size] = 1;
+        auto sweep = [&](int tx, int tz, CostBuckets& open) {
+            Tile tile = tileAt(tx, tz);
+            uint16_t woken = 0;
+            auto relax = [&](uint32_t i, float d) {
+                if (d >= cost_[i]) return;
+                cost_[i] = d;
+                open.push(d, i);
+            };
+            if (tile.contains(goal)) open.push(0.0f, static_cast<uint32_t>(index(goal)));
+            for (int level = 0; level < levels_; ++level) {
+                for (int z = tile.z0 - 1; z <= tile.z1; ++z) {
+                    for (int x = tile.x0 - 1; x <= tile.x1; ++x) {
+                        if (tile.contains({x, z, level}) || !grid.inBounds(x, z, level)) continue;
+                        size_t i = index({x, z, level});
+                        float d = cost_[i];
+                        if (d >= kUnreached) continue;
+                        for (uint32_t m = moves->into(i); m; m &= m - 1) {
+                            int bit = std::countr_zero(m);
+                            if (tile.contains({x + back.dx[bit], z + back.dz[bit], 0})) {
+                                relax(static_cast<uint32_t>(i + back.index[bit]), d + back.cost[bit]);
+                            }
+                        }
+                    }
+                }
+            }
+            while (!open.empty()) {
+                auto [d, i] = open.pop();
+                if (d > cost_[i]) continue;
+                int x = static_cast<int>(i % static_cast<uint32_t>(width_));
+                int z = static_cast<int>(i / static_cast<uint32_t>(width_) % static_cast<uint32_t>(depth_));
+                for (uint32_t m = moves->into(i); m; m &= m - 1) {
+                    int bit = std::countr_zero(m);
+                    Cell from{x + back.dx[bit], z + back.dz[bit], 0};
+                    uint32_t f = static_cast<uint32_t>(i + back.index[bit]);
+                    float next = d + back.cost[bit];
+                    if (tile.contains(from)) {
+                        relax(f, next);
+                    } else if (next < cost_[f]) {
+                        int wx = from.x < tile.x0 ? 0 : from.x >= tile.x1 ? 2 : 1;
+                        int wz = from.y < tile.z0 ? 0 : from.y >= tile.z1 ? 2 : 1;
+                        woken |= static_cast<uint16_t>(1u << (wz * 3 + wx));
+                    }
+                }
+            }
+            wake[tz * tilesX + tx] = woken;
+        };
+
+        // Tiles with the same row and column parity never touch, so each of the
+        // four parities runs in parallel without sharing a cell
+        std::vector<size_t> batch;
+        for (bool any = true; any;) {
+            any = false;
+            for (int parity = 0; parity < 4; ++parity) {
+                batch.clear();
+                for (int tz = parity >> 1; tz < tilesZ; tz += 2) {
+                    for (int tx = parity & 1; tx < tilesX; tx += 2) {
+                        size_t t = static_cast<size_t>(tz) * tilesX + tx;
+                        if (!active[t]) continue;
+                        active[t] = 0;
+                        batch.push_back(t);
+                    }
+                }
+                if (batch.empty()) continue;
+                any = true;
+                run(batch.size(), [&](size_t begin, size_t end) {
+                    CostBuckets open;
+                    for (size_t b = begin; b < end; ++b) {
+                        sweep(static_cast<int>(batch[b] % tilesX), static_cast<int>(batch[b] / tilesX), open);
+                    }
+                });
+                for (size_t t : batch) {
+                    int tx = static_cast<int>(t % tilesX), tz = static_cast<int>(t / tilesX);
+                    for (int bit = 0; bit < 9; ++bit) {
+                        if (wake[t] >> bit & 1u) active[(tz + bit / 3 - 1) * tilesX + tx + bit % 3 - 1] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Each cell moves to the neighbour it's cheapest to get to the goal from,
+    // the first in forEachMove's order on a tie (bits run by direction)
+    run(static_cast<size_t>(tilesX) * tilesZ, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            Tile tile = tileAt(static_cast<int>(t % tilesX), static_cast<int>(t / tilesX));
+            for (int level = 0; level < levels_; ++level) {
+                for (int z = tile.z0; z < tile.z1; ++z) {
+                    for (int x = tile.x0; x < tile.x1; ++x) {
+                        size_t cell = index({x, z, level});
+                        if (cost_[cell] >= kUnreached) continue;
+                        float best = kUnreached;
+                        uint8_t dir = kNone;
+                        for (uint32_t m = moves->out(cell); m; m &= m - 1) {
+                            int bit = std::countr_zero(m);
+                            float via = cost_[cell - back.index[bit]] + back.cost[bit];
+                            if (via >= best) continue;
+                            best = via;
+                            dir = static_cast<uint8_t>(bit / 3);
+                        }
+                        dirs_[cell] = dir;
+                    }
+                }
+            }
+        }
+    });
+    dirs_[index(goal)] = kGoal;
+}
+
+bool FlowField::next(const NavGrid& grid, const Cell& c, Cell& out) const {
+    uint8_t dir = direction(c);
+    if (dir >= kGoal) return false;
+    return grid.step(c, kMoves[dir][0], kMoves[dir][1], out);
+}
+
+Vec3 FlowField::steer(const NavGrid& grid, const Vec3& p) const {
+    Cell cell, to;
+    if (!grid.locate(p, cell) || cost(cell) >= kUnreached) return {};
+    if (!next(grid, cell, to)) to = goal_;
+    Vec3 target = grid.center(to);
+    float dx = target.x - p.x, dz = target.z - p.z, length = std::sqrt(dx * dx + dz * dz);
+    if (length < 1e-4f) return {};
+    return {dx / length, 0.0f, dz / length};
+}
+
+bool FlowField::reaches(int x0, int z0, int x1, int z1) const {
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, width_ - 1);
+    z1 = std::min(z1, depth_ - 1);
+    for (int level = 0; level < levels_; ++level) {
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                if (cost_[index({x, z, level})] < kUnreached) return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::get(const NavGrid& grid, const Cell& goal, TaskPool* pool,
+                                                     uint64_t generation, const FlowMoves* moves) {
+    auto same = [&](const Entry& e) { return e.goal.x == goal.x && e.goal.y == goal.y && e.goal.level == goal.level; };
+    std::promise<std::shared_ptr<const FlowField>> built;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (generation == kCurrent) generation = generation_;
+        auto it = std::find_if(entries_.begin(), entries_.end(), same);
+        if (it != entries_.end() && !it->field) {
+            // Someone else is building it
+            it->lastUse = ++clock_;
+            ++hits_;
+            auto building = it->building;
+            lock.unlock();
+            return building.get();
+        }
+        if (it != entries_.end() && it->field->matches(grid)) {
+            it->lastUse = ++clock_;
+            ++hits_;
+            return it->field;
+        }
+        if (it != entries_.end()) entries_.erase(it);
+        ++misses_;
+        if (entries_.size() >= capacity_) {
+            entries_.erase(std::min_element(entries_.begin(), entries_.end(),
+                                            [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; }));
+        }
+        entries_.push_back({goal, ++clock_, nullptr, built.get_future().share()});
+    }
+
+    std::shared_ptr<const FlowField> field;
+    try {
+        field = std::make_shared<const FlowField>(grid, goal, pool, moves);
+    } catch (...) {
+        // Waiters get the error too, and the next get() tries again
+        built.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(entries_.begin(), entries_.end(), same);
+        if (it != entries_.end() && !it->field) entries_.erase(it);
+        throw;
+    }
+    built.set_value(field);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(), same);
+    if (it == entries_.end() || it->field) return field;
+    // Built from a grid the cache has since been told changed
+    if (generation != generation_) {
+        entries_.erase(it);
+        return field;
+    }
+    it->field = field;
+    it->building = {};
+    return field;
+}
+
+void FlowFieldCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    ++generation_;
+}
+
+void FlowFieldCache::invalidate(int x0, int z0, int x1, int z1) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    std::erase_if(entries_, [&](const Entry& e) { return !e.field || e.field->reaches(x0 - 1, z0 - 1, x1 + 1, z1 + 1); });
+}
+
+uint64_t FlowFieldCache::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+size_t FlowFieldCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t FlowFieldCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t FlowFieldCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+} // namespace arena::nav
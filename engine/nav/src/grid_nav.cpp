@@ -0,0 +1,154 @@
+#include "arena/nav/grid_nav.hpp"
+#include "arena/log.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/hierarchical_search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace arena::nav {
+
+bool GridNav::bakeFromWorld(const IWorld& world) {
+    if (rebake_.valid()) rebake_.wait();
+    rebake_ = {};
+    dirty_.clear();
+    rebaking_.clear();
+
+    auto next = std::make_shared<NavSnapshot>();
+    next->grid = bakeNavGrid(world, settings_, pool_);
+    if (search_ != PathSearch::AStar) next->jumps = JumpPointTable(next->grid);
+    next->moves = FlowMoves(next->grid);
+    if (search_ == PathSearch::Hierarchical && settings_.clusterSize > 0) {
+        next->clusters = ClusterGraph(next->grid, settings_.clusterSize, pool_);
+    }
+    bool walkable = next->grid.walkableCount() > 0;
+    publish(std::move(next));
+    flowFields_.clear();
+    if (!walkable) {
+        ARENA_LOG_WARN(Nav, "bakeFromWorld: no walkable cells in %dx%dx%d grid", settings_.width, settings_.depth,
+                       settings_.levels);
+        return false;
+    }
+    return true;
+}
+
+Path GridNav::findPath(const Vec3& start, const Vec3& goal) const {
+    std::shared_ptr<const NavSnapshot> snap = current_.load();
+    const NavGrid& grid = snap->grid;
+    Cell from, to;
+    if (!grid.locate(start, from) || !grid.locate(goal, to)) return {};
+    const JumpPointTable* jumps = snap->jumps.matches(grid) ? &snap->jumps : nullptr;
+    thread_local HierarchicalSearch search;
+    if (snap->clusters.matches(grid) &&
+        std::max(std::abs(from.x - to.x), std::abs(from.y - to.y)) > 2 * snap->clusters.clusterSize()) {
+        Path path = search.findPath(snap->clusters, grid, from, to, jumps);
+        if (path.ok) return path;
+    }
+    return search.gridSearch().findPath(grid, from, to, jumps);
+}
+
+std::shared_ptr<const FlowField> GridNav::flowField(const Vec3& goal) const {
+    // Publishes come before the cache hears of them, so reading the
+    // generation first can only make a fresh field look stale, never the
+    // other way round
+    uint64_t generation = flowFields_.generation();
+    std::shared_ptr<const NavSnapshot> snap = current_.load();
+    Cell cell;
+    if (!snap->grid.locate(goal, cell)) return nullptr;
+    return flowFields_.get(snap->grid, cell, pool_, generation, &snap->moves);
+}
+
+void GridNav::markDirty(const Vec3& min, const Vec3& max) {
+    const NavGridSettings& s = settings_;
+    float margin = s.agentRadius + s.cellSize;
+    int x0 = static_cast<int>(std::floor((std::min(min.x, max.x) - margin - s.origin[0]) / s.cellSize));
+    int z0 = static_cast<int>(std::floor((std::min(min.z, max.z) - margin - s.origin[2]) / s.cellSize));
+    int x1 = static_cast<int>(std::floor((std::max(min.x, max.x) + margin - s.origin[0]) / s.cellSize));
+    int z1 = static_cast<int>(std::floor((std::max(min.z, max.z) + margin - s.origin[2]) / s.cellSize));
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, s.width - 1);
+    z1 = std::min(z1, s.depth - 1);
+    if (x0 > x1 || z0 > z1) return;
+    dirty_.push_back({x0, z0, x1, z1});
+}
+
+bool GridNav::startRebake(const IWorld& world) {
+    if (rebake_.valid() || dirty_.empty()) return false;
+    std::shared_ptr<const NavSnapshot> base = current_.load();
+    if (base->grid.cellCount() == 0) {
+        dirty_.clear();
+        return false;
+    }
+
+    // Whole tiles are re-baked, so any cell in one may change
+    int size = std::max(settings_.tileSize, 1);
+    int tilesX = (settings_.width + size - 1) / size;
+    std::vector<uint32_t> tiles;
+    rebaking_.clear();
+    for (const CellBox& box : dirty_) {
+        rebaking_.push_back({box.x0 / size * size, box.z0 / size * size,
+                             std::min((box.x1 / size + 1) * size, settings_.width) - 1,
+                             std::min((box.z1 / size + 1) * size, settings_.depth) - 1});
+        for (int tz = box.z0 / size; tz <= box.z1 / size; ++tz) {
+            for (int tx = box.x0 / size; tx <= box.x1 / size; ++tx) tiles.push_back(static_cast<uint32_t>(tz * tilesX + tx));
+        }
+    }
+    dirty_.clear();
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+    rebake_ = std::async(std::launch::async, [&world, pool = pool_, base, tiles = std::move(tiles), boxes = rebaking_] {
+        auto next = std::make_shared<NavSnapshot>(*base);
+        rebakeNavTiles(world, next->grid, tiles, pool);
+        if (next->jumps.matches(next->grid)) {
+            for (const CellBox& box : boxes) next->jumps.update(next->grid, box.x0, box.z0, box.x1, box.z1);
+        }
+        if (next->clusters.matches(next->grid)) {
+            for (const CellBox& box : boxes) next->clusters.update(next->grid, box.x0, box.z0, box.x1, box.z1, pool);
+        }
+        for (const CellBox& box : boxes) next->moves.update(next->grid, box.x0, box.z0, box.x1, box.z1);
+        return next;
+    });
+    return true;
+}
+
+bool GridNav::applyRebake() {
+    if (!rebake_.valid() || rebake_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    publish(rebake_.get());
+    for (const CellBox& box : rebaking_) flowFields_.invalidate(box.x0, box.z0, box.x1, box.z1);
+    rebaking_.clear();
+    return true;
+}
+
+void GridNav::finishRebake() {
+    if (!rebake_.valid()) return;
+    rebake_.wait();
+    applyRebake();
+}
+
+void GridNav::setPathSearch(PathSearch search) {
+    finishRebake();
+    search_ = search;
+    std::shared_ptr<const NavSnapshot> base = current_.load();
+    if (base->grid.cellCount() == 0) return;
+    bool wantJumps = search_ != PathSearch::AStar;
+    bool wantClusters = search_ == PathSearch::Hierarchical && settings_.clusterSize > 0;
+    if (wantJumps == base->jumps.matches(base->grid) && wantClusters == base->clusters.matches(base->grid)) return;
+    auto next = std::make_shared<NavSnapshot>(*base);
+    if (wantJumps != next->jumps.matches(next->grid)) {
+        next->jumps = wantJumps ? JumpPointTable(next->grid) : JumpPointTable();
+    }
+    if (wantClusters != next->clusters.matches(next->grid)) {
+        next->clusters = wantClusters ? ClusterGraph(next->grid, settings_.clusterSize, pool_) : ClusterGraph();
+    }
+    publish(std::move(next));
+}
+
+void GridNav::publish(std::shared_ptr<NavSnapshot> next) {
+    next->version = current_.load()->version + 1;
+    current_.store(std::move(next));
+}
+
+} // namespace arena::nav
@@ -0,0 +1,294 @@
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/jump_points.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace arena::nav {
+
+namespace {
+
+constexpr uint32_t kClosed = UINT32_MAX;
+constexpr float kDiagonal = 1.41421356f;
+
+constexpr auto& kDirs = JumpPointTable::kDirs;
+
+// Octile distance in cells: exact on an open grid, so never an overestimate
+float Octile(const Cell& a, const Cell& b) {
+    int dx = std::abs(a.x - b.x), dz = std::abs(a.y - b.y);
+    return static_cast<float>(std::max(dx, dz)) + (kDiagonal - 1.0f) * static_cast<float>(std::min(dx, dz));
+}
+
+int Sign(int v) { return (v > 0) - (v < 0); }
+
+int DirIndex(int dx, int dz) {
+    if (dz == 0) return dx > 0 ? 0 : 2;
+    if (dx == 0) return dz > 0 ? 1 : 3;
+    return dz > 0 ? (dx > 0 ? 4 : 5) : (dx < 0 ? 6 : 7);
+}
+
+Cell CellOf(uint32_t index, uint32_t width, uint32_t depth) {
+    uint32_t row = index / width;
+    return {static_cast<int>(index % width), static_cast<int>(row % depth), static_cast<int>(row / depth)};
+}
+
+// Lower f first; on ties the deeper node, which heads straight for the goal
+// instead of widening across equal-cost cells
+bool Before(float fa, float ga, float fb, float gb) { return fa < fb || (fa == fb && ga > gb); }
+
+} // namespace
+
+void GridSearch::prepare(const NavGrid& grid) {
+    size_t cells = grid.cellCount();
+    if (nodes_.size() < cells) {
+        nodes_.assign(cells, Node{0, 0, 0.0f, kClosed});
+        heap_.resize(cells);
+        // Room for all but very winding paths, whichever query comes first
+        raw_.reserve(4 * static_cast<size_t>(grid.width() + grid.depth()));
+        generation_ = 0;
+    }
+    if (++generation_ == 0) {
+        for (Node& n : nodes_) n.generation = 0;
+        generation_ = 1;
+    }
+    heapSize_ = 0;
+    expanded_ = 0;
+    cost_ = 0.0f;
+}
+
+void GridSearch::push(const HeapEntry& entry) {
+    uint32_t pos = heapSize_++;
+    heap_[pos] = entry;
+    siftUp(pos);
+}
+
+void GridSearch::siftUp(uint32_t pos) {
+    HeapEntry entry = heap_[pos];
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 4;
+        if (!Before(entry.f, entry.g, heap_[parent].f, heap_[parent].g)) break;
+        heap_[pos] = heap_[parent];
+        nodes_[heap_[pos].node].heapPos = pos;
+        pos = parent;
+    }
+    heap_[pos] = entry;
+    nodes_[entry.node].heapPos = pos;
+}
+
+GridSearch::HeapEntry GridSearch::pop() {
+    HeapEntry top = heap_[0];
+    nodes_[top.node].heapPos = kClosed;
+    if (--heapSize_ == 0) return top;
+
+    HeapEntry entry = heap_[heapSize_];
+    uint32_t pos = 0;
+    for (;;) {
+        uint32_t first = pos * 4 + 1;
+        if (first >= heapSize_) break;
+        uint32_t last = std::min(first + 4, heapSize_), best = first;
+        for (uint32_t c = first + 1; c < last; ++c) {
+            if (Before(heap_[c].f, heap_[c].g, heap_[best].f, heap_[best].g)) best = c;
+        }
+        if (!Before(heap_[best].f, heap_[best].g, entry.f, entry.g)) break;
+        heap_[pos] = heap_[best];
+        nodes_[heap_[pos].node].heapPos = pos;
+        pos = best;
+    }
+    heap_[pos] = entry;
+    nodes_[entry.node].heapPos = pos;
+    return top;
+}
+
+void GridSearch::relax(uint32_t index, uint32_t parent, float g, float h) {
+    Node& node = nodes_[index];
+    if (node.generation != generation_) {
+        node = {generation_, parent, g, kClosed};
+        push({g + h, g, index});
+    } else if (node.heapPos != kClosed && g < node.g) {
+        node.g = g;
+        node.parent = parent;
+        HeapEntry& entry = heap_[node.heapPos];
+        entry.f += g - entry.g;
+        entry.g = g;
+        siftUp(node.heapPos);
+    }
+}
+
+void GridSearch::expandSteps(const NavGrid& grid, const Cell& cell, uint32_t index, float g, const Cell& goal) {
+    grid.forEachMove(cell, [&](const Cell& next, bool diagonal) {
+        relax(static_cast<uint32_t>(grid.cellIndex(next.x, next.y, next.level)), index, g + (diagonal ? kDiagonal : 1.0f),
+              Octile(next, goal));
+    });
+}
+
+void GridSearch::expandJumps(const NavGrid& grid, const JumpPointTable& jumps, const Cell& cell, uint32_t index,
+                             float g, const Cell& goal) {
+    // Directions worth following from the way the cell was reached: ahead,
+    // and with diagonals not cutting corners, both sides after a straight move
+    int dirs[8], count = 0;
+    uint32_t parent = nodes_[index].parent;
+    if (parent == index) {
+        for (int d = 0; d < 8; ++d) dirs[count++] = d;
+    } else {
+        Cell from = CellOf(parent, static_cast<uint32_t>(grid.width()), static_cast<uint32_t>(grid.depth()));
+        int dx = Sign(cell.x - from.x), dz = Sign(cell.y - from.y);
+        if (dx != 0 && dz != 0) {
+            for (int d : {DirIndex(dx, 0), DirIndex(0, dz), DirIndex(dx, dz)}) dirs[count++] = d;
+        } else if (dx != 0) {
+            for (int d : {DirIndex(dx, 0), DirIndex(0, 1), DirIndex(0, -1), DirIndex(dx, 1), DirIndex(dx, -1)}) {
+                dirs[count++] = d;
+            }
+        } else {
+            for (int d : {DirIndex(0, dz), DirIndex(1, 0), DirIndex(-1, 0), DirIndex(1, dz), DirIndex(-1, dz)}) {
+                dirs[count++] = d;
+            }
+        }
+    }
+
+    bool goalLevel = goal.level == cell.level;
+    for (int i = 0; i < count; ++i) {
+        int d = dirs[i], dx = kDirs[d][0], dz = kDirs[d][1];
+        int jump = jumps.distance(index, d), reach = jump < 0 ? -jump : jump;
+        // Stop short at the goal, or where the goal is straight on from
+        // along a diagonal, if that comes before the jump point or wall
+        int toGoal;
+        if (d < 4) {
+            bool onLine = dx != 0 ? goal.y == cell.y : goal.x == cell.x;
+            toGoal = onLine ? (goal.x - cell.x) * dx + (goal.y - cell.y) * dz : 0;
+        } else {
+            toGoal = std::min((goal.x - cell.x) * dx, (goal.y - cell.y) * dz);
+        }
+        int steps;
+        if (goalLevel && toGoal > 0 && toGoal <= reach) {
+            steps = toGoal;
+        } else if (jump > 0) {
+            steps = jump;
+        } else {
+            continue;
+        }
+        Cell next{cell.x + dx * steps, cell.y + dz * steps, cell.level};
+        float cost = static_cast<float>(steps) * (d < 4 ? 1.0f : kDiagonal);
+        relax(static_cast<uint32_t>(grid.cellIndex(next.x, next.y, next.level)), index, g + cost, Octile(next, goal));
+    }
+}
+
+bool GridSearch::search(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps) {
+    uint32_t width = static_cast<uint32_t>(grid.width()), depth = static_cast<uint32_t>(grid.depth());
+    uint32_t startIndex = static_cast<uint32_t>(grid.cellIndex(start.x, start.y, start.level));
+    uint32_t goalIndex = static_cast<uint32_t>(grid.cellIndex(goal.x, goal.y, goal.level));
+    nodes_[startIndex] = {generation_, startIndex, 0.0f, kClosed};
+    push({Octile(start, goal), 0.0f, startIndex});
+
+    while (heapSize_ > 0) {
+        HeapEntry top = pop();
+        ++expanded_;
+        if (top.node == goalIndex) {
+            cost_ = top.g * grid.settings().cellSize;
+            return true;
+        }
+        Cell cell = CellOf(top.node, width, depth);
+        if (jumps && jumps->uniform(top.node)) {
+            expandJumps(grid, *jumps, cell, top.node, top.g, goal);
+        } else {
+            expandSteps(grid, cell, top.node, top.g, goal);
+        }
+    }
+    return false;
+}
+
+void GridSearch::collectCells(const NavGrid& grid, uint32_t goalIndex, std::vector<Cell>& out) const {
+    uint32_t width = static_cast<uint32_t>(grid.width()), depth = static_cast<uint32_t>(grid.depth());
+    size_t first = out.size();
+    for (uint32_t index = goalIndex;; index = nodes_[index].parent) {
+        Cell cell = CellOf(index, width, depth);
+        out.push_back(cell);
+        uint32_t parent = nodes_[index].parent;
+        if (parent == index) break;
+        // Jumps skip the cells between; all on the level they left from
+        Cell from = CellOf(parent, width, depth);
+        int dx = Sign(from.x - cell.x), dz = Sign(from.y - cell.y);
+        int steps = std::max(std::abs(from.x - cell.x), std::abs(from.y - cell.y));
+        for (int k = 1; k < steps; ++k) out.push_back({cell.x + dx * k, cell.y + dz * k, from.level});
+    }
+    std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+}
+
+bool GridSearch::run(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps) {
+    if (!grid.walkable(start.x, start.y, start.level) || !grid.walkable(goal.x, goal.y, goal.level)) return false;
+    prepare(grid);
+    // Otherwise a goal out of reach costs a flood of the whole region
+    if (grid.regionsKnown() && grid.region(start) != grid.region(goal)) return false;
+    if (jumps && !jumps->matches(grid)) jumps = nullptr;
+    return search(grid, start, goal, jumps);
+}
+
+Path GridSearch::findPath(const NavGrid& grid, const Cell& start, const Cell& goal, const JumpPointTable* jumps) {
+    ARENA_PROFILE_SCOPE("NavFindPath");
+    Path path;
+    if (!run(grid, start, goal, jumps)) return path;
+    raw_.clear();
+    collectCells(grid, static_cast<uint32_t>(grid.cellIndex(goal.x, goal.y, goal.level)), raw_);
+    straightenPath(grid, raw_, path);
+    path.ok = true;
+    return path;
+}
+
+bool GridSearch::findCells(const NavGrid& grid, const Cell& start, const Cell& goal, std::vector<Cell>& out,
+                           const JumpPointTable* jumps) {
+    if (!run(grid, start, goal, jumps)) return false;
+    collectCells(grid, static_cast<uint32_t>(grid.cellIndex(goal.x, goal.y, goal.level)), out);
+    return true;
+}
+
+void straightenPath(const NavGrid& grid, std::span<const Cell> cells, Path& out) {
+    out.count = 0;
+    if (cells.empty()) return;
+    // Only turns (and the last cell) can be waypoints: a straight run is made
+    // of the same moves the line test takes
+    auto turns = [&](size_t i) {
+        const Cell &prev = cells[i - 1], &cell = cells[i], &next = cells[i + 1];
+        return cell.x - prev.x != next.x - cell.x || cell.y - prev.y != next.y - cell.y;
+    };
+    constexpr int kCapacity = static_cast<int>(sizeof(out.points) / sizeof(out.points[0]));
+    size_t last = cells.size() - 1, anchor = 0, visible = 0;
+    out.points[out.count++] = cells[0];
+    for (size_t i = 1; i <= last; ++i) {
+        if (i < last && !turns(i)) continue;
+        if (visible != anchor && !gridLineOfSight(grid, cells[anchor], cells[i])) {
+            out.points[out.count++] = cells[visible];
+            anchor = visible;
+            if (out.count == kCapacity) return;
+        }
+        visible = i;
+    }
+    if (visible != anchor) out.points[out.count++] = cells[visible];
+}
+
+bool gridLineOfSight(const NavGrid& grid, const Cell& a, const Cell& b) {
+    if (!grid.walkable(a.x, a.y, a.level)) return false;
+    int dx = b.x - a.x, dz = b.y - a.y;
+    int sx = dx > 0 ? 1 : -1, sz = dz > 0 ? 1 : -1;
+    int64_t nx = std::abs(dx), nz = std::abs(dz);
+    Cell cell = a, side;
+    // The line crosses its (ix + 1)th x edge at t = (2 ix + 1) / 2 nx and
+    // likewise on z; compare crossings without dividing
+    for (int64_t ix = 0, iz = 0; ix < nx || iz < nz;) {
+        int64_t tx = (2 * ix + 1) * nz, tz = (2 * iz + 1) * nx;
+        if (tx == tz) {
+            if (!grid.step(cell, sx, 0, side) || !grid.step(cell, 0, sz, side)) return false;
+            if (!grid.step(cell, sx, sz, cell)) return false;
+            ++ix;
+            ++iz;
+        } else if (iz >= nz || (ix < nx && tx < tz)) {
+            if (!grid.step(cell, sx, 0, cell)) return false;
+            ++ix;
+        } else {
+            if (!grid.step(cell, 0, sz, cell)) return false;
+            ++iz;
+        }
+    }
+    return cell.level == b.level;
+}
+
+} // namespace arena::nav
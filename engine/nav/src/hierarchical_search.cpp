@@ -0,0 +1,131 @@
+#include "arena/nav/hierarchical_search.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+namespace arena::nav {
+
+namespace {
+
+float Octile(const Cell& a, const Cell& b) {
+    int dx = std::abs(a.x - b.x), dz = std::abs(a.y - b.y);
+    return static_cast<float>(std::max(dx, dz)) + 0.41421356f * static_cast<float>(std::min(dx, dz));
+}
+
+} // namespace
+
+void HierarchicalSearch::relax(uint32_t node, uint32_t parent, float g, float h) {
+    Node& n = nodes_[node];
+    if (n.generation == generation_ && (n.closed || g >= n.g)) return;
+    n = {generation_, parent, g, false};
+    open_.push_back({g + h, g, node});
+    std::push_heap(open_.begin(), open_.end(), std::greater<>());
+}
+
+bool HierarchicalSearch::plan(const ClusterGraph& graph, const NavGrid& grid, const Cell& start, const Cell& goal) {
+    ARENA_PROFILE_SCOPE("NavPlanCorridor");
+    corridor_.clear();
+    expanded_ = 0;
+    cost_ = 0.0f;
+    if (!graph.matches(grid)) return false;
+    if (!grid.walkable(start.x, start.y, start.level) || !grid.walkable(goal.x, goal.y, goal.level)) return false;
+    if (grid.regionsKnown() && grid.region(start) != grid.region(goal)) return false;
+
+    uint32_t capacity = static_cast<uint32_t>(graph.nodeCapacity());
+    uint32_t startNode = capacity, goalNode = capacity + 1;
+    if (nodes_.size() < capacity + 2) {
+        nodes_.assign(capacity + 2, Node{0, 0, 0.0f, false});
+        goalCosts_.assign(capacity, 0.0f);
+        goalStamps_.assign(capacity, 0);
+        generation_ = 0;
+        // Bounds, so repeated queries don't allocate: every edge relaxed once,
+        // plus the start's and the goal's; and as GridSearch, room for all
+        // but very winding paths
+        open_.reserve(graph.edgeCount() + 2 * capacity + 2);
+        startEdges_.reserve(capacity + 1);
+        corridor_.reserve(capacity + 2);
+        refined_.reserve(4 * static_cast<size_t>(grid.width() + grid.depth()));
+    }
+    if (++generation_ == 0) {
+        for (Node& n : nodes_) n.generation = 0;
+        std::fill(goalStamps_.begin(), goalStamps_.end(), 0u);
+        generation_ = 1;
+    }
+
+    // Start and goal join the nodes their clusters reach
+    uint32_t startCluster = graph.clusterOf(start), goalCluster = graph.clusterOf(goal);
+    startEdges_.clear();
+    dijkstra_.run(grid, graph, start, startCluster != goalCluster);
+    for (uint32_t id : graph.clusterNodes(startCluster)) {
+        float cost = dijkstra_.cost(graph.cell(id));
+        if (cost < ClusterDijkstra::kUnreached) startEdges_.push_back({id, cost});
+    }
+    if (startCluster == goalCluster) {
+        float cost = dijkstra_.cost(goal);
+        if (cost < ClusterDijkstra::kUnreached) startEdges_.push_back({goalNode, cost});
+    }
+    dijkstra_.run(grid, graph, goal, true);
+    for (uint32_t id : graph.clusterNodes(goalCluster)) {
+        float cost = dijkstra_.cost(graph.cell(id));
+        if (cost >= ClusterDijkstra::kUnreached) continue;
+        goalCosts_[id] = cost;
+        goalStamps_[id] = generation_;
+    }
+
+    auto cellOf = [&](uint32_t node) { return node == startNode ? start : node == goalNode ? goal : graph.cell(node); };
+    open_.clear();
+    nodes_[startNode] = {generation_, startNode, 0.0f, false};
+    open_.push_back({Octile(start, goal), 0.0f, startNode});
+    while (!open_.empty()) {
+        std::pop_heap(open_.begin(), open_.end(), std::greater<>());
+        OpenEntry top = open_.back();
+        open_.pop_back();
+        Node& node = nodes_[top.node];
+        if (node.closed || top.g > node.g) continue;
+        node.closed = true;
+        ++expanded_;
+        if (top.node == goalNode) break;
+
+        std::span<const ClusterGraph::Edge> edges =
+            top.node == startNode ? std::span<const ClusterGraph::Edge>(startEdges_) : graph.edges(top.node);
+        for (const auto& e : edges) relax(e.to, top.node, top.g + e.cost, Octile(cellOf(e.to), goal));
+        if (top.node < capacity && goalStamps_[top.node] == generation_) {
+            relax(goalNode, top.node, top.g + goalCosts_[top.node], 0.0f);
+        }
+    }
+    if (nodes_[goalNode].generation != generation_ || !nodes_[goalNode].closed) return false;
+
+    for (uint32_t id = goalNode;; id = nodes_[id].parent) {
+        corridor_.push_back(cellOf(id));
+        if (id == startNode) break;
+    }
+    std::reverse(corridor_.begin(), corridor_.end());
+    cost_ = nodes_[goalNode].g * grid.settings().cellSize;
+    return true;
+}
+
+Path HierarchicalSearch::refine(const NavGrid& grid, size_t first, size_t count, const JumpPointTable* jumps) {
+    ARENA_PROFILE_SCOPE("NavRefineCorridor");
+    Path path;
+    size_t end = std::min(first + count, legCount());
+    if (first >= end) return path;
+    refined_.clear();
+    for (size_t leg = first; leg < end; ++leg) {
+        // Each leg starts where the last one ended
+        if (!refined_.empty()) refined_.pop_back();
+        if (!cells_.findCells(grid, corridor_[leg], corridor_[leg + 1], refined_, jumps)) return path;
+    }
+    straightenPath(grid, refined_, path);
+    path.ok = true;
+    return path;
+}
+
+Path HierarchicalSearch::findPath(const ClusterGraph& graph, const NavGrid& grid, const Cell& start, const Cell& goal,
+                                  const JumpPointTable* jumps) {
+    if (!plan(graph, grid, start, goal)) return {};
+    return refine(grid, 0, legCount(), jumps);
+}
+
+} // namespace arena::nav
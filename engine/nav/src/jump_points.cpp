@@ -0,0 +1,197 @@
+#include "arena/nav/jump_points.hpp"
+#include "arena/profiler.hpp"
+#include <algorithm>
+#include <array>
+
+namespace arena::nav {
+
+namespace {
+
+// Every move out of the cell is exactly the flat-grid one on its level
+bool Regular(const NavGrid& grid, const Cell& c) {
+    for (const auto& d : JumpPointTable::kDirs) {
+        Cell to;
+        if (grid.step(c, d[0], d[1], to)) {
+            if (to.level != c.level) return false;
+        } else if (grid.walkable(c.x + d[0], c.y + d[1], c.level)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int StraightIndex(int dx, int dz) { return dx > 0 ? 0 : dz > 0 ? 1 : dx < 0 ? 2 : 3; }
+
+int Extend(int next) { return next > 0 ? next + 1 : next - 1; }
+
+} // namespace
+
+JumpPointTable::JumpPointTable(const NavGrid& grid)
+    : width_(grid.width()), depth_(grid.depth()), levels_(grid.levels()) {
+    ARENA_PROFILE_SCOPE("NavJumpTable");
+    size_t cells = grid.cellCount();
+    std::vector<uint8_t> regular(cells, 0);
+    uniform_.assign(cells, 0);
+    jumps_.assign(cells, {});
+
+    auto open = [&](int x, int z, int level) { return grid.walkable(x, z, level); };
+    for (int level = 0; level < levels_; ++level) {
+        for (int z = 0; z < depth_; ++z) {
+            for (int x = 0; x < width_; ++x) {
+                if (open(x, z, level)) regular[grid.cellIndex(x, z, level)] = Regular(grid, {x, z, level}) ? 1 : 0;
+            }
+        }
+    }
+    for (int level = 0; level < levels_; ++level) {
+        for (int z = 0; z < depth_; ++z) {
+            for (int x = 0; x < width_; ++x) {
+                if (!regular[grid.cellIndex(x, z, level)]) continue;
+                bool all = true;
+                for (const auto& d : kDirs) {
+                    int nx = x + d[0], nz = z + d[1];
+                    if (open(nx, nz, level) && !regular[grid.cellIndex(nx, nz, level)]) all = false;
+                }
+                uniform_[grid.cellIndex(x, z, level)] = all ? 1 : 0;
+            }
+        }
+    }
+
+    // Each direction is swept from its far end so the next cell along is
+    // always done first: straight ones, then diagonals, which read them
+    for (int dir = 0; dir < 8; ++dir) {
+        int dx = kDirs[dir][0], dz = kDirs[dir][1];
+        for (int level = 0; level < levels_; ++level) {
+            for (int zi = 0; zi < depth_; ++zi) {
+                int z = dz > 0 ? depth_ - 1 - zi : zi;
+                for (int xi = 0; xi < width_; ++xi) {
+                    int x = dx > 0 ? width_ - 1 - xi : xi;
+                    size_t index = grid.cellIndex(x, z, level);
+                    if (uniform_[index]) jumps_[index][dir] = jump(grid, x, z, level, dir);
+                }
+            }
+        }
+    }
+}
+
+int16_t JumpPointTable::jump(const NavGrid& grid, int x, int z, int level, int dir) const {
+    auto open = [&](int cx, int cz) { return grid.walkable(cx, cz, level); };
+    int dx = kDirs[dir][0], dz = kDirs[dir][1];
+    int nx = x + dx, nz = z + dz, jump;
+    if (!open(nx, nz) || (dir >= 4 && (!open(nx, z) || !open(x, nz)))) {
+        jump = 0;
+    } else if (size_t next = grid.cellIndex(nx, nz, level); !uniform_[next]) {
+        jump = 1;
+    } else if (dir < 4) {
+        // A wall beside the line ending here opens a turn the cell behind
+        // couldn't take
+        int px = dz != 0 ? 1 : 0, pz = dx != 0 ? 1 : 0;
+        bool forced = false;
+        for (int side : {1, -1}) {
+            forced = forced || (open(nx + side * px, nz + side * pz) && !open(x + side * px, z + side * pz));
+        }
+        jump = forced ? 1 : Extend(jumps_[next][dir]);
+    } else {
+        bool turn = jumps_[next][StraightIndex(dx, 0)] > 0 || jumps_[next][StraightIndex(0, dz)] > 0;
+        jump = turn ? 1 : Extend(jumps_[next][dir]);
+    }
+    return static_cast<int16_t>(std::clamp(jump, -32767, 32767));
+}
+
+void JumpPointTable::update(const NavGrid& grid, int x0, int z0, int x1, int z1) {
+    ARENA_PROFILE_SCOPE("NavJumpUpdate");
+    // Regularity reads a cell's neighbours, uniformity its neighbours'
+    // regularity, and a jump the uniformity of the cell after it and the
+    // cells beside that one: edits in the box reach three cells round it
+    auto clampBox = [&](int grow, int box[4]) {
+        box[0] = std::max(x0 - grow, 0);
+        box[1] = std::max(z0 - grow, 0);
+        box[2] = std::min(x1 + grow, width_ - 1);
+        box[3] = std::min(z1 + grow, depth_ - 1);
+    };
+    int near[4], far[4];
+    clampBox(2, near);
+    clampBox(3, far);
+    int farWidth = far[2] - far[0] + 1, farDepth = far[3] - far[1] + 1;
+    std::vector<uint8_t> regular(static_cast<size_t>(farWidth) * farDepth * levels_, 0);
+    auto regularAt = [&](int x, int z, int level) -> uint8_t& {
+        return regular[(static_cast<size_t>(level) * farDepth + z - far[1]) * farWidth + x - far[0]];
+    };
+    for (int level = 0; level < levels_; ++level) {
+        for (int z = far[1]; z <= far[3]; ++z) {
+            for (int x = far[0]; x <= far[2]; ++x) {
+                regularAt(x, z, level) = grid.walkable(x, z, level) && Regular(grid, {x, z, level}) ? 1 : 0;
+            }
+        }
+    }
+    for (int level = 0; level < levels_; ++level) {
+        for (int z = near[1]; z <= near[3]; ++z) {
+            for (int x = near[0]; x <= near[2]; ++x) {
+                bool all = regularAt(x, z, level) != 0;
+                for (const auto& d : kDirs) {
+                    int nx = x + d[0], nz = z + d[1];
+                    if (all && grid.walkable(nx, nz, level) && !regularAt(nx, nz, level)) all = false;
+                }
+                size_t index = grid.cellIndex(x, z, level);
+                uniform_[index] = all ? 1 : 0;
+                if (!all) jumps_[index] = {};
+            }
+        }
+    }
+
+    // Every cell in the far box is recomputed, and from each one back along
+    // its line until a distance comes out as it was. The cells behind an
+    // unchanged one read the same inputs as before. Seeds run from the far
+    // end of each line, as the full sweep does. Diagonals also start behind
+    // every cell whose straight distances changed.
+    std::vector<std::array<int, 3>> changed[4], seeds, order;
+    std::vector<uint32_t> first;
+    std::vector<uint8_t> done(grid.cellCount(), 0);
+    int span = width_ + depth_;
+    for (int dir = 0; dir < 8; ++dir) {
+        int dx = kDirs[dir][0], dz = kDirs[dir][1];
+        seeds.clear();
+        for (int level = 0; level < levels_; ++level) {
+            for (int z = far[1]; z <= far[3]; ++z) {
+                for (int x = far[0]; x <= far[2]; ++x) seeds.push_back({x, z, level});
+            }
+        }
+        if (dir >= 4) {
+            for (int straight : {StraightIndex(dx, 0), StraightIndex(0, dz)}) {
+                for (const auto& c : changed[straight]) seeds.push_back({c[0] - dx, c[1] - dz, c[2]});
+            }
+        }
+        // Counting sort on how far along the direction each seed is
+        auto along = [&](const std::array<int, 3>& c) { return static_cast<size_t>(c[0] * dx + c[1] * dz + span); };
+        first.assign(2 * span + 2, 0);
+        for (const auto& seed : seeds) ++first[along(seed) + 1];
+        for (size_t i = 1; i < first.size(); ++i) first[i] += first[i - 1];
+        order.resize(seeds.size());
+        for (const auto& seed : seeds) order[first[along(seed)]++] = seed;
+        std::fill(done.begin(), done.end(), 0);
+        for (auto seed = order.rbegin(); seed != order.rend(); ++seed) {
+            int x = (*seed)[0], z = (*seed)[1], level = (*seed)[2];
+            while (grid.inBounds(x, z, level)) {
+                size_t index = grid.cellIndex(x, z, level);
+                if (done[index]) break;
+                done[index] = 1;
+                bool moved = false;
+                if (uniform_[index]) {
+                    int16_t before = jumps_[index][dir];
+                    jumps_[index][dir] = jump(grid, x, z, level, dir);
+                    moved = jumps_[index][dir] != before;
+                }
+                if (moved && dir < 4) changed[dir].push_back({x, z, level});
+                bool inFar = x >= far[0] && x <= far[2] && z >= far[1] && z <= far[3];
+                if (!moved && !inFar) break;
+                x -= dx;
+                z -= dz;
+            }
+        }
+    }
+}
+
+size_t JumpPointTable::uniformCount() const {
+    return static_cast<size_t>(std::count(uniform_.begin(), uniform_.end(), uint8_t{1}));
+}
+
+} // namespace arena::nav
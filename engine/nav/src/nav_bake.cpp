@@ -0,0 +1,191 @@
+#include "arena/nav/nav_grid.hpp"
+#include "arena/log.hpp"
+#include "arena/profiler.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace arena::nav {
+
+namespace {
+
+// Surfaces followed down one column before giving up on it
+constexpr int kMaxSurfaces = 16;
+// Restart below a surface by this much so the next ray doesn't find it again
+constexpr float kPierce = 1e-3f;
+// Headroom rays start this far above the floor
+constexpr float kHeadroomLift = 0.02f;
+// Clearance nudge; anything within agentRadius + kNudge of the capsule blocks
+constexpr float kNudge = 0.01f;
+
+struct Sample {
+    int x, z, level;
+    float y;
+};
+
+struct Candidate {
+    uint32_t column; // index within the tile
+    float y;
+};
+
+// Capsule from maxStep above the floor up to agentHeight, nudged in each
+// direction: any overlap is pushed into by at least one of them
+bool HasClearance(const IWorld& world, const NavGridSettings& s, float x, float floorY, float z) {
+    float span = std::max(s.agentHeight - s.maxStep, 2.0f * s.agentRadius);
+    Capsule cap{s.agentRadius, std::max(0.0f, 0.5f * span - s.agentRadius)};
+    Vec3 center{x, floorY + s.maxStep + 0.5f * span, z};
+    static constexpr float kDirs[5][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}, {0, 1, 0}};
+    Vec3 out;
+    for (const auto& d : kDirs) {
+        if (world.sweepCapsule(cap, center, {d[0] * kNudge, d[1] * kNudge, d[2] * kNudge}, out)) return false;
+    }
+    return true;
+}
+
+void BakeTile(const IWorld& world, const NavGridSettings& s, int tileX, int tileZ, std::vector<Sample>& out) {
+    int x0 = tileX * s.tileSize, z0 = tileZ * s.tileSize;
+    int x1 = std::min(s.width, x0 + s.tileSize), z1 = std::min(s.depth, z0 + s.tileSize);
+    int columnsX = x1 - x0;
+    float bottom = s.origin[1];
+    float top = bottom + s.levels * s.levelHeight;
+
+    thread_local std::vector<Ray> rays;
+    thread_local std::vector<RayHit> hits;
+    thread_local std::vector<uint32_t> active, next;
+    thread_local std::vector<float> rayY;
+    thread_local std::vector<Candidate> candidates, open;
+
+    size_t columns = static_cast<size_t>(columnsX) * (z1 - z0);
+    auto columnX = [&](uint32_t c) { return s.origin[0] + (x0 + static_cast<int>(c % columnsX) + 0.5f) * s.cellSize; };
+    auto columnZ = [&](uint32_t c) { return s.origin[2] + (z0 + static_cast<int>(c / columnsX) + 0.5f) * s.cellSize; };
+
+    // Every surface in every column, top down, one batch per layer
+    active.resize(columns);
+    rayY.assign(columns, top);
+    for (uint32_t c = 0; c < columns; ++c) active[c] = c;
+    candidates.clear();
+    for (int layer = 0; layer < kMaxSurfaces && !active.empty(); ++layer) {
+        rays.resize(active.size());
+        hits.resize(active.size());
+        for (size_t i = 0; i < active.size(); ++i) {
+            uint32_t c = active[i];
+            rays[i] = {{columnX(c), rayY[c], columnZ(c)}, {0.0f, -1.0f, 0.0f}, rayY[c] - bottom};
+        }
+        world.raycastBatch(rays, hits);
+
+        next.clear();
+        for (size_t i = 0; i < active.size(); ++i) {
+            if (!hits[i].hit) continue;
+            uint32_t c = active[i];
+            if (hits[i].normal.y >= s.maxSlopeCos) candidates.push_back({c, hits[i].pos.y});
+            rayY[c] = hits[i].pos.y - kPierce;
+            if (rayY[c] > bottom) next.push_back(c);
+        }
+        active.swap(next);
+    }
+
+    // Headroom straight up, batched, before the more expensive capsule tests
+    float headroom = s.agentHeight - kHeadroomLift;
+    rays.resize(candidates.size());
+    hits.resize(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Candidate& c = candidates[i];
+        rays[i] = {{columnX(c.column), c.y + kHeadroomLift, columnZ(c.column)}, {0.0f, 1.0f, 0.0f}, headroom};
+    }
+    world.raycastBatch(rays, hits);
+    open.clear();
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!hits[i].hit) open.push_back(candidates[i]);
+    }
+
+    // Layers were found top down, so per column the first clear floor in a
+    // level's band is its highest
+    std::stable_sort(open.begin(), open.end(), [](const Candidate& a, const Candidate& b) { return a.column < b.column; });
+    int lastColumn = -1, lastLevel = -1;
+    for (const Candidate& c : open) {
+        int level = static_cast<int>(std::floor((c.y - bottom) / s.levelHeight));
+        if (level < 0 || level >= s.levels) continue;
+        if (static_cast<int>(c.column) == lastColumn && level == lastLevel) continue;
+        if (!HasClearance(world, s, columnX(c.column), c.y, columnZ(c.column))) continue;
+        lastColumn = static_cast<int>(c.column);
+        lastLevel = level;
+        out.push_back({x0 + static_cast<int>(c.column % columnsX), z0 + static_cast<int>(c.column / columnsX), level, c.y});
+    }
+}
+
+bool ValidSettings(const NavGridSettings& s) {
+    return s.width > 0 && s.depth > 0 && s.levels > 0 && s.tileSize > 0 && s.cellSize > 0.0f && s.levelHeight > 0.0f;
+}
+
+// Bakes tiles (index tz * tilesX + tx, or all of them if null) into grid,
+// whose cells there are blocked, and labels its regions
+void BakeTiles(const IWorld& world, NavGrid& grid, const uint32_t* tiles, size_t count, TaskPool* pool) {
+    const NavGridSettings& settings = grid.settings();
+    int tilesX = (settings.width + settings.tileSize - 1) / settings.tileSize;
+
+    // Tiles share bit words along their edges, so samples are gathered per
+    // tile and written once every tile is done
+    std::vector<std::vector<Sample>> samples(count);
+    auto bake = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t t = tiles ? tiles[i] : static_cast<uint32_t>(i);
+            BakeTile(world, settings, static_cast<int>(t % tilesX), static_cast<int>(t / tilesX), samples[i]);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(count, 1, bake);
+    } else {
+        bake(0, count);
+    }
+
+    for (const auto& tile : samples) {
+        for (const Sample& s : tile) grid.setWalkable(s.x, s.z, s.level, s.y);
+    }
+    grid.labelRegions();
+}
+
+} // namespace
+
+NavGrid bakeNavGrid(const IWorld& world, const NavGridSettings& settings, TaskPool* pool) {
+    ARENA_PROFILE_SCOPE("NavBake");
+    NavGrid grid(settings);
+    if (!ValidSettings(settings)) {
+        ARENA_LOG_WARN(Nav, "bakeNavGrid: empty or invalid grid %dx%dx%d", settings.width, settings.depth, settings.levels);
+        return grid;
+    }
+    int tilesX = (settings.width + settings.tileSize - 1) / settings.tileSize;
+    int tilesZ = (settings.depth + settings.tileSize - 1) / settings.tileSize;
+    BakeTiles(world, grid, nullptr, static_cast<size_t>(tilesX) * tilesZ, pool);
+    return grid;
+}
+
+void rebakeNavTiles(const IWorld& world, NavGrid& grid, std::span<const uint32_t> tiles, TaskPool* pool) {
+    ARENA_PROFILE_SCOPE("NavRebake");
+    const NavGridSettings& settings = grid.settings();
+    if (!ValidSettings(settings) || tiles.empty()) return;
+    int size = settings.tileSize;
+    int tilesX = (settings.width + size - 1) / size;
+    int tilesZ = (settings.depth + size - 1) / size;
+    uint32_t tileCount = static_cast<uint32_t>(tilesX) * static_cast<uint32_t>(tilesZ);
+    std::vector<uint32_t> inRange;
+    inRange.reserve(tiles.size());
+    for (uint32_t t : tiles) {
+        if (t < tileCount) inRange.push_back(t);
+    }
+    if (inRange.size() != tiles.size()) {
+        ARENA_LOG_WARN(Nav, "rebakeNavTiles: skipping %zu tiles outside the %dx%d tile grid", tiles.size() - inRange.size(),
+                       tilesX, tilesZ);
+    }
+    if (inRange.empty()) return;
+    for (uint32_t t : inRange) {
+        int x0 = static_cast<int>(t % tilesX) * size, z0 = static_cast<int>(t / tilesX) * size;
+        for (int level = 0; level < settings.levels; ++level) {
+            for (int z = z0; z < std::min(z0 + size, settings.depth); ++z) {
+                for (int x = x0; x < std::min(x0 + size, settings.width); ++x) grid.setBlocked(x, z, level);
+            }
+        }
+    }
+    BakeTiles(world, grid, inRange.data(), inRange.size(), pool);
+}
+
+} // namespace arena::nav
@@ -0,0 +1,85 @@
+#include "arena/nav/nav_grid.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace arena::nav {
+
+NavGrid::NavGrid(const NavGridSettings& settings)
+    : settings_(settings), wordsPerRow_((std::max(0, settings.width) + 63) / 64),
+      stepCm_(static_cast<int>(std::floor(settings.maxStep * 100.0f))) {
+    size_t rows = static_cast<size_t>(std::max(0, settings.depth)) * std::max(0, settings.levels);
+    bits_.assign(rows * wordsPerRow_, 0);
+    heights_.assign(rows * std::max(0, settings.width), 0);
+}
+
+void NavGrid::setWalkable(int x, int z, int level, float y) {
+    if (!inBounds(x, z, level)) return;
+    float cm = std::round((y - settings_.origin[1]) * 100.0f);
+    heights_[cellIndex(x, z, level)] = static_cast<int16_t>(std::clamp(cm, -32768.0f, 32767.0f));
+    bits_[wordIndex(x, z, level)] |= uint64_t{1} << (x & 63);
+    regions_.clear();
+}
+
+void NavGrid::setBlocked(int x, int z, int level) {
+    if (!inBounds(x, z, level)) return;
+    bits_[wordIndex(x, z, level)] &= ~(uint64_t{1} << (x & 63));
+    regions_.clear();
+}
+
+size_t NavGrid::walkableCount() const {
+    size_t count = 0;
+    for (uint64_t word : bits_) count += static_cast<size_t>(std::popcount(word));
+    return count;
+}
+
+void NavGrid::labelRegions() {
+    // Union-find over every move out of every walkable cell; a region is the
+    // lowest cell index in it
+    regions_.resize(heights_.size());
+    for (size_t i = 0; i < regions_.size(); ++i) regions_[i] = static_cast<uint32_t>(i);
+    auto root = [&](uint32_t i) {
+        while (regions_[i] != i) i = regions_[i] = regions_[regions_[i]];
+        return i;
+    };
+    for (int level = 0; level < settings_.levels; ++level) {
+        for (int z = 0; z < settings_.depth; ++z) {
+            for (int x = 0; x < settings_.width; ++x) {
+                if (!walkable(x, z, level)) continue;
+                forEachMove({x, z, level}, [&](const Cell& to, bool) {
+                    uint32_t a = root(static_cast<uint32_t>(cellIndex(x, z, level)));
+                    uint32_t b = root(static_cast<uint32_t>(cellIndex(to.x, to.y, to.level)));
+                    if (a != b) regions_[std::max(a, b)] = std::min(a, b);
+                });
+            }
+        }
+    }
+    for (size_t i = 0; i < regions_.size(); ++i) regions_[i] = root(static_cast<uint32_t>(i));
+}
+
+bool NavGrid::locate(const Vec3& p, Cell& out) const {
+    int x = static_cast<int>(std::floor((p.x - settings_.origin[0]) / settings_.cellSize));
+    int z = static_cast<int>(std::floor((p.z - settings_.origin[2]) / settings_.cellSize));
+    if (!inBounds(x, z, 0)) return false;
+
+    int below = -1, above = -1;
+    for (int level = 0; level < settings_.levels; ++level) {
+        if (!walkable(x, z, level)) continue;
+        if (height(x, z, level) <= p.y + settings_.maxStep) {
+            below = level;
+        } else if (above < 0) {
+            above = level;
+        }
+    }
+    int level = below >= 0 ? below : above;
+    if (level < 0) return false;
+    out = {x, z, level};
+    return true;
+}
+
+Vec3 NavGrid::center(const Cell& c) const {
+    return {settings_.origin[0] + (c.x + 0.5f) * settings_.cellSize, height(c.x, c.y, c.level),
+            settings_.origin[2] + (c.y + 0.5f) * settings_.cellSize};
+}
+
+} // namespace arena::nav
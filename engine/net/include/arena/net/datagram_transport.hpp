@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include "arena/contracts.hpp"
+
+namespace arena::net {
+
+// IPv4 address and port, both in host byte order
+struct Endpoint {
+    uint32_t address = 0;
+    uint16_t port = 0;
+
+    static Endpoint loopback(uint16_t port) { return {0x7f000001u, port}; }
+    bool operator==(const Endpoint&) const = default;
+};
+
+// ITransport over one UDP socket, with datagrams batched per tick: send()/
+// sendTo() only queue a datagram and flush() hands the queue to the kernel;
+// poll() collects what has arrived for receive()/receiveFrom() to drain.
+// Queues are fixed rings allocated by open(), so nothing is allocated per
+// datagram. A server calls poll() at the start of its tick and flush() at
+// the end. The backends (UdpTransport, UringTransport) differ in how they
+// talk to the kernel; openDatagramTransport picks the best one that works.
+//
+// send() goes to the peer: the one set with setPeer(), else whoever the
+// last datagram came from. Queueing, flush(), poll() and receiving are for
+// one thread (the tick's); stats() may be read from any.
+class DatagramTransport : public ITransport {
+public:
+    struct Settings {
+        uint16_t port = 0;            // 0 picks a free one; see localEndpoint()
+        bool loopbackOnly = false;    // bind 127.0.0.1 rather than every interface
+        size_t maxPacket = 1400;      // bytes; longer sends are refused, longer arrivals dropped
+        size_t sendSlots = 512;       // datagrams queued between flushes
+        size_t receiveSlots = 512;    // datagrams waiting for receive()
+        size_t batch = 64;            // datagrams per sendmmsg/recvmmsg
+        int socketBuffer = 1 << 20;   // SO_SNDBUF and SO_RCVBUF, bytes; 0 keeps the system's
+        bool ioThread = false;        // UdpTransport only
+    };
+
+    struct Stats {
+        uint64_t sent = 0;            // datagrams the kernel took
+        uint64_t received = 0;        // datagrams read off the socket
+        uint64_t sendCalls = 0;       // syscalls made sending
+        uint64_t receiveCalls = 0;    // syscalls made receiving
+        uint64_t sendDropped = 0;     // refused: too long, queue full, or the send failed
+        uint64_t receiveDropped = 0;  // read but dropped: too long or queue full
+        uint64_t lossSimDropped = 0;  // dropped by setLossSim
+    };
+
+    DatagramTransport() = default;
+    explicit DatagramTransport(const Settings& settings) : settings_(settings) {}
+    DatagramTransport(const DatagramTransport&) = delete;
+    DatagramTransport& operator=(const DatagramTransport&) = delete;
+
+    // Binds the socket and allocates the queues; false if the socket can't
+    // be opened or bound, or the backend isn't supported here
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual const char* backend() const = 0;
+    // Address 0 unless bound to loopback only
+    Endpoint localEndpoint() const { return local_; }
+
+    void setPeer(const Endpoint& peer) {
+        peer_ = peer;
+        fixedPeer_ = true;
+    }
+    Endpoint peer() const { return peer_; }
+
+    // Queues a datagram to the peer; false if there's none yet, or as sendTo
+    bool send(const void* data, size_t sz) override;
+    // Queues a datagram; false if it's longer than maxPacket or the queue is full
+    virtual bool sendTo(const Endpoint& to, const void* data, size_t sz) = 0;
+    // Next datagram received, cut to cap bytes; its length, or 0 if none
+    int receive(uint8_t* out, size_t cap) override;
+    virtual int receiveFrom(Endpoint& from, uint8_t* out, size_t cap) = 0;
+    // Drops pctLoss percent of arriving datagrams and holds the rest back
+    // up to msJitter milliseconds (in order, so later ones wait behind them)
+    void setLossSim(float pctLoss, int msJitter) override;
+
+    // Hands everything queued to the kernel; datagrams it has no room for
+    // stay queued for the next flush. Returns the count handed over here.
+    virtual size_t flush() = 0;
+    // Collects datagrams that have arrived, as many as the receive queue has
+    // room for (the rest wait in the socket); returns the count collected
+    virtual size_t poll() = 0;
+
+    Stats stats() const;
+    const Settings& settings() const { return settings_; }
+
+protected:
+    struct Slot {
+        Endpoint peer;
+        uint32_t size;
+        int64_t due;     // steady-clock ns before which receive() holds it back (setLossSim)
+    };
+
+    // Single-producer, single-consumer ring of slots with maxPacket bytes each
+    struct Ring {
+        std::vector<Slot> slots;
+        std::vector<uint8_t> bytes;
+        alignas(64) std::atomic<uint64_t> head{0};   // next to consume
+        alignas(64) std::atomic<uint64_t> tail{0};   // next to produce
+
+        void allocate(size_t count, size_t packet);
+        size_t capacity() const { return slots.size(); }
+        uint8_t* data(uint64_t index, size_t packet) { return bytes.data() + (index % slots.size()) * packet; }
+        Slot& slot(uint64_t index) { return slots[index % slots.size()]; }
+    };
+
+    bool validSettings() const;
+    // A non-blocking UDP socket bound as settings_ say, with local_ set to
+    // where; -1 (logged) if it can't be opened or bound
+    int openSocket();
+    // Copies a datagram into sendRing_; false (and counted) if it can't go
+    bool queueSend(const Endpoint& to, const void* data, size_t sz);
+    // Called by receiveFrom implementations for each datagram handed out
+    void receivedFrom(const Endpoint& from) {
+        if (!fixedPeer_) peer_ = from;
+    }
+    // On arrival: true if the loss sim drops it (counted), else sets due
+    bool lossSimDrop(int64_t& due);
+    static int64_t nowNs();
+
+    Settings settings_;
+    Endpoint local_;
+    Ring sendRing_;
+
+    std::atomic<uint64_t> sent_{0}, received_{0}, sendCalls_{0}, receiveCalls_{0};
+    std::atomic<uint64_t> sendDropped_{0}, receiveDropped_{0}, lossSimDropped_{0};
+
+private:
+    Endpoint peer_;
+    bool fixedPeer_ = false;
+    std::atomic<float> lossPct_{0.0f};
+    std::atomic<int> jitterMs_{0};
+    std::minstd_rand lossRng_{1};
+};
+
+// Opens the io_uring backend, or if the kernel can't run it (before 6.0,
+// or io_uring disabled) the sendmmsg one; null if neither opens
+std::unique_ptr<DatagramTransport> openDatagramTransport(const DatagramTransport::Settings& settings);
+
+} // namespace arena::net
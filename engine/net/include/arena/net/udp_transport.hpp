@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "arena/net/datagram_transport.hpp"
+
+namespace arena::net {
+
+// DatagramTransport on sendmmsg/recvmmsg (Linux; open() fails elsewhere).
+//
+// flush() sends the queue batch datagrams per syscall and poll() reads
+// with recvmmsg into a second ring that receive() drains.
+//
+// With Settings::ioThread a dedicated thread does the syscalls instead:
+// it reads datagrams as they arrive (dropping them if the receive queue is
+// full, as the kernel would) and sends when flush() wakes it, so the tick
+// only copies in and out of the rings. poll() does nothing then, and
+// flush() returns 0.
+class UdpTransport : public DatagramTransport {
+public:
+    UdpTransport();
+    explicit UdpTransport(const Settings& settings);
+    ~UdpTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return socket_ >= 0; }
+    const char* backend() const override { return "sendmmsg"; }
+
+    bool sendTo(const Endpoint& to, const void* data, size_t sz) override;
+    int receiveFrom(Endpoint& from, uint8_t* out, size_t cap) override;
+    size_t flush() override;
+    size_t poll() override;
+
+private:
+    size_t sendQueued();
+    size_t receiveWaiting(bool dropWhenFull);
+    void wakeIo();
+    void runIo();
+
+    int socket_ = -1;
+    int wake_ = -1;       // eventfd flush() signals the I/O thread on
+    Ring receiveRing_;
+    // sendmmsg/recvmmsg arguments for one batch; defined with the socket code
+    struct Batch;
+    std::unique_ptr<Batch> batch_;
+
+    std::thread io_;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace arena::net
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include "arena/net/datagram_transport.hpp"
+
+namespace arena::net {
+
+// DatagramTransport on io_uring (Linux 6.0+; open() fails elsewhere, and
+// openDatagramTransport falls back to UdpTransport).
+//
+// One multishot recvmsg stays armed on the socket, receiving into a ring of
+// buffers registered with the kernel (a provided-buffer ring of receiveSlots,
+// rounded up to a power of two): each datagram lands in a free buffer and
+// the kernel posts a completion as it arrives, with no syscall per datagram
+// or per batch. poll() only reads the completion queue, and receive()
+// copies a datagram out and hands its buffer straight back. flush() puts a
+// sendmsg per queued datagram on the submission queue and submits the lot
+// with one io_uring_enter; sends complete in the background and free their
+// slots at the next poll() or flush(). So a tick costs one syscall however
+// many clients there are, plus one in poll() on the rare tick the receive
+// has to be re-armed (the kernel stops it when every buffer is held).
+//
+// open() arms the receive, which also checks the kernel supports it.
+// Settings::batch and ioThread don't apply.
+class UringTransport : public DatagramTransport {
+public:
+    UringTransport();
+    explicit UringTransport(const Settings& settings);
+    ~UringTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return socket_ >= 0; }
+    const char* backend() const override { return "io_uring"; }
+
+    bool sendTo(const Endpoint& to, const void* data, size_t sz) override;
+    int receiveFrom(Endpoint& from, uint8_t* out, size_t cap) override;
+    size_t flush() override;
+    size_t poll() override;
+
+private:
+    // Submission and completion rings, buffers and per-slot send arguments;
+    // defined with the io_uring code
+    struct Queues;
+
+    bool armReceive();
+    // Submits what's on the submission queue, counting the call in calls;
+    // false on an error other than the kernel being busy
+    bool enter(std::atomic<uint64_t>& calls);
+    // Takes every completion posted; returns the datagrams received
+    size_t harvest();
+    void recycle(uint16_t buffer);
+
+    int socket_ = -1;
+    uint64_t submitted_ = 0;    // sends up to here are on the submission queue
+    std::unique_ptr<Queues> queues_;
+};
+
+} // namespace arena::net
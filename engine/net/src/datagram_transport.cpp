@@ -0,0 +1,145 @@
+#include "arena/net/datagram_transport.hpp"
+#include "arena/log.hpp"
+#include "arena/net/udp_transport.hpp"
+#include "arena/net/uring_transport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace arena::net {
+
+namespace {
+
+// sendmmsg and recvmmsg take at most this many messages (UIO_MAXIOV)
+constexpr size_t kMaxBatch = 1024;
+// Largest UDP payload over IPv4
+constexpr size_t kMaxDatagram = 65507;
+
+} // namespace
+
+void DatagramTransport::Ring::allocate(size_t count, size_t packet) {
+    slots.assign(count, Slot{});
+    bytes.assign(count * packet, 0);
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+}
+
+bool DatagramTransport::send(const void* data, size_t sz) {
+    if (peer_.port == 0) return false;
+    return sendTo(peer_, data, sz);
+}
+
+int DatagramTransport::receive(uint8_t* out, size_t cap) {
+    Endpoint from;
+    return receiveFrom(from, out, cap);
+}
+
+void DatagramTransport::setLossSim(float pctLoss, int msJitter) {
+    lossPct_.store(std::clamp(pctLoss, 0.0f, 100.0f), std::memory_order_relaxed);
+    jitterMs_.store(std::max(msJitter, 0), std::memory_order_relaxed);
+}
+
+DatagramTransport::Stats DatagramTransport::stats() const {
+    Stats s;
+    s.sent = sent_.load(std::memory_order_relaxed);
+    s.received = received_.load(std::memory_order_relaxed);
+    s.sendCalls = sendCalls_.load(std::memory_order_relaxed);
+    s.receiveCalls = receiveCalls_.load(std::memory_order_relaxed);
+    s.sendDropped = sendDropped_.load(std::memory_order_relaxed);
+    s.receiveDropped = receiveDropped_.load(std::memory_order_relaxed);
+    s.lossSimDropped = lossSimDropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool DatagramTransport::validSettings() const {
+    const Settings& s = settings_;
+    if (s.maxPacket == 0 || s.maxPacket > kMaxDatagram || s.sendSlots == 0 || s.receiveSlots == 0 || s.batch == 0 ||
+        s.batch > kMaxBatch) {
+        ARENA_LOG_WARN(Net, "%s transport: bad settings (maxPacket %zu, slots %zu/%zu, batch %zu)", backend(),
+                       s.maxPacket, s.sendSlots, s.receiveSlots, s.batch);
+        return false;
+    }
+    return true;
+}
+
+int DatagramTransport::openSocket() {
+#if defined(__linux__)
+    const Settings& s = settings_;
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ARENA_LOG_WARN(Net, "%s transport: socket: %s", backend(), std::strerror(errno));
+        return -1;
+    }
+    if (s.socketBuffer > 0) {
+        // The kernel caps these at net.core.{w,r}mem_max; less is still fine
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &s.socketBuffer, sizeof(s.socketBuffer));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &s.socketBuffer, sizeof(s.socketBuffer));
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(s.loopbackOnly ? Endpoint::loopback(0).address : 0u);
+    addr.sin_port = htons(s.port);
+    socklen_t length = sizeof(addr);
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), length) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+        ARENA_LOG_WARN(Net, "%s transport: bind to port %u: %s", backend(), s.port, std::strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+    local_ = {ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port)};
+    return fd;
+#else
+    ARENA_LOG_WARN(Net, "%s transport: not supported on this platform", backend());
+    return -1;
+#endif
+}
+
+bool DatagramTransport::queueSend(const Endpoint& to, const void* data, size_t sz) {
+    uint64_t tail = sendRing_.tail.load(std::memory_order_relaxed);
+    if (sz > settings_.maxPacket || tail - sendRing_.head.load(std::memory_order_acquire) >= sendRing_.capacity()) {
+        sendDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Slot& slot = sendRing_.slot(tail);
+    slot.peer = to;
+    slot.size = static_cast<uint32_t>(sz);
+    slot.due = 0;
+    if (sz > 0) std::memcpy(sendRing_.data(tail, settings_.maxPacket), data, sz);
+    sendRing_.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool DatagramTransport::lossSimDrop(int64_t& due) {
+    float loss = lossPct_.load(std::memory_order_relaxed);
+    if (loss > 0.0f && std::uniform_real_distribution<float>(0.0f, 100.0f)(lossRng_) < loss) {
+        lossSimDropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    int jitter = jitterMs_.load(std::memory_order_relaxed);
+    due = jitter > 0 ? nowNs() + std::uniform_int_distribution<int64_t>(0, jitter * 1000000ll)(lossRng_) : 0;
+    return false;
+}
+
+int64_t DatagramTransport::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::unique_ptr<DatagramTransport> openDatagramTransport(const DatagramTransport::Settings& settings) {
+    std::unique_ptr<DatagramTransport> transport = std::make_unique<UringTransport>(settings);
+    if (transport->open()) return transport;
+    ARENA_LOG_INFO(Net, "io_uring transport unavailable; using sendmmsg");
+    transport = std::make_unique<UdpTransport>(settings);
+    if (transport->open()) return transport;
+    return nullptr;
+}
+
+} // namespace arena::net
@@ -0,0 +1,256 @@
+#include "arena/net/udp_transport.hpp"
+#include "arena/log.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace arena::net {
+
+#if defined(__linux__)
+struct UdpTransport::Batch {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+    std::vector<sockaddr_in> addresses;
+    std::vector<uint8_t> scratch;   // what the I/O thread reads into when the receive queue is full
+};
+#else
+struct UdpTransport::Batch {};
+#endif
+
+UdpTransport::UdpTransport() = default;
+UdpTransport::UdpTransport(const Settings& settings) : DatagramTransport(settings) {}
+UdpTransport::~UdpTransport() { close(); }
+
+bool UdpTransport::sendTo(const Endpoint& to, const void* data, size_t sz) {
+    if (socket_ < 0) return false;
+    return queueSend(to, data, sz);
+}
+
+int UdpTransport::receiveFrom(Endpoint& from, uint8_t* out, size_t cap) {
+    if (socket_ < 0) return 0;
+    uint64_t head = receiveRing_.head.load(std::memory_order_relaxed);
+    if (head == receiveRing_.tail.load(std::memory_order_acquire)) return 0;
+    const Slot& slot = receiveRing_.slot(head);
+    if (slot.due != 0 && slot.due > nowNs()) return 0;
+    size_t n = std::min<size_t>(slot.size, cap);
+    if (n > 0) std::memcpy(out, receiveRing_.data(head, settings_.maxPacket), n);
+    from = slot.peer;
+    receivedFrom(slot.peer);
+    receiveRing_.head.store(head + 1, std::memory_order_release);
+    return static_cast<int>(n);
+}
+
+size_t UdpTransport::flush() {
+    if (socket_ < 0) return 0;
+    if (io_.joinable()) {
+        if (sendRing_.head.load(std::memory_order_acquire) != sendRing_.tail.load(std::memory_order_relaxed)) wakeIo();
+        return 0;
+    }
+    return sendQueued();
+}
+
+size_t UdpTransport::poll() {
+    if (socket_ < 0 || io_.joinable()) return 0;
+    return receiveWaiting(false);
+}
+
+#if defined(__linux__)
+
+namespace {
+
+sockaddr_in ToSockaddr(const Endpoint& e) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(e.address);
+    addr.sin_port = htons(e.port);
+    return addr;
+}
+
+Endpoint FromSockaddr(const sockaddr_in& addr) { return {ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port)}; }
+
+} // namespace
+
+bool UdpTransport::open() {
+    close();
+    const Settings& s = settings_;
+    if (!validSettings()) return false;
+
+    int fd = openSocket();
+    if (fd < 0) return false;
+    if (s.ioThread) {
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_ < 0) {
+            ARENA_LOG_WARN(Net, "UdpTransport: eventfd: %s", std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+    }
+
+    batch_ = std::make_unique<Batch>();
+    batch_->messages.resize(s.batch);
+    batch_->vectors.resize(s.batch);
+    batch_->addresses.resize(s.batch);
+    if (s.ioThread) batch_->scratch.resize(s.batch * s.maxPacket);
+    sendRing_.allocate(s.sendSlots, s.maxPacket);
+    receiveRing_.allocate(s.receiveSlots, s.maxPacket);
+
+    socket_ = fd;
+    if (s.ioThread) {
+        stopping_.store(false, std::memory_order_relaxed);
+        io_ = std::thread(&UdpTransport::runIo, this);
+    }
+    return true;
+}
+
+void UdpTransport::close() {
+    if (io_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        wakeIo();
+        io_.join();
+    }
+    if (wake_ >= 0) ::close(wake_);
+    if (socket_ >= 0) ::close(socket_);
+    wake_ = -1;
+    socket_ = -1;
+}
+
+size_t UdpTransport::sendQueued() {
+    Batch& b = *batch_;
+    size_t packet = settings_.maxPacket, total = 0;
+    uint64_t head = sendRing_.head.load(std::memory_order_relaxed);
+    uint64_t tail = sendRing_.tail.load(std::memory_order_acquire);
+    while (head < tail) {
+        unsigned count = static_cast<unsigned>(std::min<uint64_t>(tail - head, b.messages.size()));
+        for (unsigned i = 0; i < count; ++i) {
+            const Slot& slot = sendRing_.slot(head + i);
+            b.addresses[i] = ToSockaddr(slot.peer);
+            b.vectors[i] = {sendRing_.data(head + i, packet), slot.size};
+            msghdr& header = b.messages[i].msg_hdr;
+            header = {};
+            header.msg_name = &b.addresses[i];
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &b.vectors[i];
+            header.msg_iovlen = 1;
+        }
+        int n = ::sendmmsg(socket_, b.messages.data(), count, 0);
+        sendCalls_.fetch_add(1, std::memory_order_relaxed);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) break; // no room; the rest waits
+            // The first datagram can't go at all (bad address, no route):
+            // drop it rather than hold up the ones behind it
+            sendDropped_.fetch_add(1, std::memory_order_relaxed);
+            n = 1;
+        } else {
+            total += static_cast<size_t>(n);
+        }
+        head += static_cast<uint64_t>(n);
+        sendRing_.head.store(head, std::memory_order_release);
+    }
+    sent_.fetch_add(total, std::memory_order_relaxed);
+    return total;
+}
+
+size_t UdpTransport::receiveWaiting(bool dropWhenFull) {
+    Batch& b = *batch_;
+    size_t packet = settings_.maxPacket, total = 0;
+    uint64_t tail = receiveRing_.tail.load(std::memory_order_relaxed);
+    for (;;) {
+        size_t room = receiveRing_.capacity() - (tail - receiveRing_.head.load(std::memory_order_acquire));
+        bool dropping = room == 0;
+        if (dropping && !dropWhenFull) break;
+        unsigned count = static_cast<unsigned>(dropping ? b.messages.size() : std::min(room, b.messages.size()));
+        for (unsigned i = 0; i < count; ++i) {
+            uint8_t* buffer = dropping ? b.scratch.data() + i * packet : receiveRing_.data(tail + i, packet);
+            b.vectors[i] = {buffer, packet};
+            msghdr& header = b.messages[i].msg_hdr;
+            header = {};
+            header.msg_name = &b.addresses[i];
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &b.vectors[i];
+            header.msg_iovlen = 1;
+        }
+        int n = ::recvmmsg(socket_, b.messages.data(), count, MSG_DONTWAIT, nullptr);
+        receiveCalls_.fetch_add(1, std::memory_order_relaxed);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        received_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        if (dropping) {
+            receiveDropped_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            continue;
+        }
+
+        uint64_t kept = 0;
+        for (int i = 0; i < n; ++i) {
+            const mmsghdr& message = b.messages[i];
+            int64_t due = 0;
+            if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+                receiveDropped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (lossSimDrop(due)) continue;
+            // Close up behind any dropped above
+            if (kept != static_cast<uint64_t>(i)) {
+                std::memcpy(receiveRing_.data(tail + kept, packet), receiveRing_.data(tail + i, packet), message.msg_len);
+            }
+            Slot& slot = receiveRing_.slot(tail + kept);
+            slot.peer = FromSockaddr(b.addresses[i]);
+            slot.size = message.msg_len;
+            slot.due = due;
+            ++kept;
+        }
+        tail += kept;
+        total += kept;
+        receiveRing_.tail.store(tail, std::memory_order_release);
+        if (static_cast<unsigned>(n) < count) break; // nothing more waiting
+    }
+    return total;
+}
+
+void UdpTransport::wakeIo() {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = ::write(wake_, &one, sizeof(one));
+}
+
+void UdpTransport::runIo() {
+    pollfd fds[2] = {{socket_, POLLIN, 0}, {wake_, POLLIN, 0}};
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Datagrams left queued by a full socket go when it has room again
+        bool backlog = sendRing_.head.load(std::memory_order_relaxed) != sendRing_.tail.load(std::memory_order_acquire);
+        fds[0].events = static_cast<short>(POLLIN | (backlog ? POLLOUT : 0));
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            ARENA_LOG_ERROR(Net, "UdpTransport: poll: %s", std::strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            [[maybe_unused]] ssize_t got = ::read(wake_, &count, sizeof(count));
+        }
+        if (fds[0].revents & POLLIN) receiveWaiting(true);
+        sendQueued();
+    }
+}
+
+#else
+
+bool UdpTransport::open() { return openSocket() >= 0; }
+
+void UdpTransport::close() { socket_ = -1; }
+size_t UdpTransport::sendQueued() { return 0; }
+size_t UdpTransport::receiveWaiting(bool) { return 0; }
+void UdpTransport::wakeIo() {}
+void UdpTransport::runIo() {}
+
+#endif
+
+} // namespace arena::net
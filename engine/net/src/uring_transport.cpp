@@ -0,0 +1,446 @@
+#include "arena/net/uring_transport.hpp"
+#include "arena/log.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace arena::net {
+
+#if defined(__linux__)
+
+namespace {
+
+// user_data of the multishot receive and of its cancel; a send's is its
+// sequence number in sendRing_
+constexpr uint64_t kReceiveTag = ~0ull;
+constexpr uint64_t kCancelTag = ~0ull - 1;
+constexpr uint16_t kBufferGroup = 0;
+// Kernel limits on submission queue entries and provided buffers per ring
+constexpr size_t kMaxEntries = 32768;
+constexpr size_t kMaxBuffers = 32768;
+// Each receive buffer starts with the kernel's header and the sender's address
+constexpr size_t kReceiveHeader = sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in);
+
+sockaddr_in ToSockaddr(const Endpoint& e) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(e.address);
+    addr.sin_port = htons(e.port);
+    return addr;
+}
+
+Endpoint FromSockaddr(const sockaddr_in& addr) { return {ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port)}; }
+
+// glibc has no wrappers for these; liburing would, but the three calls are
+// all this needs
+int Setup(unsigned entries, io_uring_params& params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int Enter(int ring, unsigned submit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring, submit, minComplete, flags, nullptr, 0));
+}
+
+int Register(int ring, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring, opcode, arg, count));
+}
+
+// Ring indices shared with the kernel
+unsigned LoadAcquire(const unsigned* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void StoreRelease(unsigned* p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+} // namespace
+
+struct UringTransport::Queues {
+    struct Arrival {
+        uint16_t buffer;
+        uint32_t size;
+        int64_t due;
+    };
+
+    int ring = -1;
+    void* rings = MAP_FAILED;
+    size_t ringsSize = 0;
+    void* sqes = MAP_FAILED;
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0, sqEntries = 0;
+    unsigned sqLocalTail = 0;   // entries filled in; the kernel sees them at the next enter
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    // Provided-buffer ring: the kernel takes buffers from it, receive()
+    // gives them back
+    void* bufferRing = MAP_FAILED;
+    size_t bufferRingSize = 0;
+    unsigned bufferCount = 0;
+    uint16_t bufferTail = 0;
+    size_t bufferSize = 0;
+    std::vector<uint8_t> bufferBytes;
+    msghdr receiveHeader{};   // tells the multishot receive how much room to leave for the address
+    bool receiveArmed = false;
+
+    // Received datagrams waiting for receive(), in arrival order
+    std::vector<Arrival> arrivals;
+    uint64_t arrivalHead = 0, arrivalTail = 0;
+
+    // Per send slot: what its sendmsg points at, and whether it's still with the kernel
+    std::vector<msghdr> sendHeaders;
+    std::vector<iovec> sendVectors;
+    std::vector<sockaddr_in> sendAddresses;
+    std::vector<uint8_t> inFlight;
+    size_t sendsInFlight = 0;
+
+    ~Queues() {
+        if (bufferRing != MAP_FAILED) ::munmap(bufferRing, bufferRingSize);
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqesSize);
+        if (rings != MAP_FAILED) ::munmap(rings, ringsSize);
+        if (ring >= 0) ::close(ring);
+    }
+
+    bool map(const io_uring_params& p) {
+        // Kernels from 5.4 share one mapping between both rings
+        if (!(p.features & IORING_FEAT_SINGLE_MMAP)) return false;
+        ringsSize = std::max(p.sq_off.array + p.sq_entries * sizeof(unsigned),
+                             p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe));
+        rings = ::mmap(nullptr, ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+        if (rings == MAP_FAILED || sqes == MAP_FAILED) return false;
+
+        auto* base = static_cast<uint8_t*>(rings);
+        sqHead = reinterpret_cast<unsigned*>(base + p.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(base + p.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(base + p.sq_off.ring_mask);
+        sqEntries = p.sq_entries;
+        sqLocalTail = *sqTail;
+        // Entry i of the submission queue is always sqe i
+        auto* array = reinterpret_cast<unsigned*>(base + p.sq_off.array);
+        for (unsigned i = 0; i < sqEntries; ++i) array[i] = i;
+        cqHead = reinterpret_cast<unsigned*>(base + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + p.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + p.cq_off.cqes);
+        return true;
+    }
+
+    // The next free submission queue entry, zeroed; null if the queue is full
+    io_uring_sqe* next() {
+        if (sqLocalTail - LoadAcquire(sqHead) >= sqEntries) return nullptr;
+        auto* sqe = static_cast<io_uring_sqe*>(sqes) + (sqLocalTail++ & sqMask);
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    uint8_t* buffer(uint16_t id) { return bufferBytes.data() + id * bufferSize; }
+};
+
+UringTransport::UringTransport() = default;
+UringTransport::UringTransport(const Settings& settings) : DatagramTransport(settings) {}
+UringTransport::~UringTransport() { close(); }
+
+bool UringTransport::open() {
+    close();
+    const Settings& s = settings_;
+    if (!validSettings()) return false;
+    int fd = openSocket();
+    if (fd < 0) return false;
+    // io_uring waits for the socket itself (it polls instead of failing a
+    // request with EAGAIN), as long as the socket doesn't ask not to
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    auto q = std::make_unique<Queues>();
+    q->bufferCount = static_cast<unsigned>(std::bit_ceil(std::min(s.receiveSlots, kMaxBuffers)));
+    // Room for every send slot plus the receive and its cancel
+    unsigned entries = static_cast<unsigned>(std::bit_ceil(std::min(s.sendSlots + 2, kMaxEntries)));
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = std::min(2 * (entries + q->bufferCount), 2u * static_cast<unsigned>(kMaxEntries));
+    q->ring = Setup(entries, params);
+    const char* failed = nullptr;
+    if (q->ring < 0) {
+        failed = "io_uring_setup";
+    } else if (!q->map(params)) {
+        failed = "mapping the rings";
+    } else {
+        q->bufferRingSize = q->bufferCount * sizeof(io_uring_buf);
+        q->bufferRing = ::mmap(nullptr, q->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uintptr_t>(q->bufferRing);
+        reg.ring_entries = q->bufferCount;
+        reg.bgid = kBufferGroup;
+        // Provided-buffer rings are 5.19+
+        if (q->bufferRing == MAP_FAILED || Register(q->ring, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+            failed = "registering receive buffers";
+        }
+    }
+    if (failed) {
+        ARENA_LOG_INFO(Net, "UringTransport: %s: %s", failed, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    q->bufferSize = kReceiveHeader + s.maxPacket;
+    q->bufferBytes.assign(q->bufferCount * q->bufferSize, 0);
+    q->receiveHeader.msg_namelen = sizeof(sockaddr_in);
+    q->arrivals.resize(q->bufferCount);
+    q->sendHeaders.resize(s.sendSlots);
+    q->sendVectors.resize(s.sendSlots);
+    q->sendAddresses.resize(s.sendSlots);
+    q->inFlight.assign(s.sendSlots, 0);
+    sendRing_.allocate(s.sendSlots, s.maxPacket);
+    submitted_ = 0;
+    socket_ = fd;
+    queues_ = std::move(q);
+    for (unsigned i = 0; i < queues_->bufferCount; ++i) recycle(static_cast<uint16_t>(i));
+
+    // A kernel without multishot recvmsg (before 6.0) fails the request
+    // straight away rather than leaving it armed
+    bool armed = armReceive() && enter(receiveCalls_);
+    if (armed) {
+        harvest();
+        armed = queues_->receiveArmed;
+    }
+    if (!armed) {
+        ARENA_LOG_INFO(Net, "UringTransport: multishot receive not supported");
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UringTransport::close() {
+    if (queues_) {
+        Queues& q = *queues_;
+        harvest();
+        if (q.receiveArmed) {
+            if (io_uring_sqe* sqe = q.next()) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = -1;
+                sqe->addr = kReceiveTag;
+                sqe->user_data = kCancelTag;
+            }
+        }
+        // The kernel may still write into the receive buffers or read the
+        // send slots until their requests complete
+        for (int tries = 0; (q.receiveArmed || q.sendsInFlight > 0) && tries < 1000; ++tries) {
+            if (tries > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (!enter(receiveCalls_)) break;
+            harvest();
+        }
+        if (q.receiveArmed || q.sendsInFlight > 0) {
+            ARENA_LOG_WARN(Net, "UringTransport: requests still in flight at close; leaking their memory");
+            ::close(q.ring);
+            q.ring = -1;
+            (void)queues_.release();
+        }
+        queues_.reset();
+    }
+    if (socket_ >= 0) ::close(socket_);
+    socket_ = -1;
+}
+
+bool UringTransport::sendTo(const Endpoint& to, const void* data, size_t sz) {
+    if (socket_ < 0) return false;
+    return queueSend(to, data, sz);
+}
+
+int UringTransport::receiveFrom(Endpoint& from, uint8_t* out, size_t cap) {
+    if (socket_ < 0) return 0;
+    Queues& q = *queues_;
+    if (q.arrivalHead == q.arrivalTail) return 0;
+    const Queues::Arrival& arrival = q.arrivals[q.arrivalHead % q.arrivals.size()];
+    if (arrival.due != 0 && arrival.due > nowNs()) return 0;
+    const uint8_t* buffer = q.buffer(arrival.buffer);
+    sockaddr_in addr;
+    std::memcpy(&addr, buffer + sizeof(io_uring_recvmsg_out), sizeof(addr));
+    size_t n = std::min<size_t>(arrival.size, cap);
+    if (n > 0) std::memcpy(out, buffer + kReceiveHeader, n);
+    from = FromSockaddr(addr);
+    receivedFrom(from);
+    recycle(arrival.buffer);
+    ++q.arrivalHead;
+    return static_cast<int>(n);
+}
+
+size_t UringTransport::flush() {
+    if (socket_ < 0) return 0;
+    Queues& q = *queues_;
+    harvest();
+    size_t queued = 0;
+    uint64_t tail = sendRing_.tail.load(std::memory_order_acquire);
+    for (; submitted_ < tail; ++submitted_, ++queued) {
+        io_uring_sqe* sqe = q.next();
+        if (!sqe) break;
+        size_t i = submitted_ % sendRing_.capacity();
+        const Slot& slot = sendRing_.slot(submitted_);
+        q.sendAddresses[i] = ToSockaddr(slot.peer);
+        q.sendVectors[i] = {sendRing_.data(submitted_, settings_.maxPacket), slot.size};
+        msghdr& header = q.sendHeaders[i];
+        header = {};
+        header.msg_name = &q.sendAddresses[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov = &q.sendVectors[i];
+        header.msg_iovlen = 1;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = socket_;
+        sqe->addr = reinterpret_cast<uintptr_t>(&header);
+        sqe->len = 1;
+        sqe->user_data = submitted_;
+        q.inFlight[i] = 1;
+        ++q.sendsInFlight;
+    }
+    if (queued > 0) enter(sendCalls_);
+    return queued;
+}
+
+size_t UringTransport::poll() {
+    if (socket_ < 0) return 0;
+    Queues& q = *queues_;
+    size_t got = harvest();
+    // Datagrams that came while the receive was stopped are waiting in the
+    // socket and arrive as soon as it's re-armed
+    if (!q.receiveArmed && q.arrivalTail - q.arrivalHead < q.bufferCount && armReceive() && enter(receiveCalls_)) {
+        got += harvest();
+    }
+    return got;
+}
+
+bool UringTransport::armReceive() {
+    Queues& q = *queues_;
+    io_uring_sqe* sqe = q.next();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_;
+    sqe->addr = reinterpret_cast<uintptr_t>(&q.receiveHeader);
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = kReceiveTag;
+    q.receiveArmed = true;
+    return true;
+}
+
+bool UringTransport::enter(std::atomic<uint64_t>& calls) {
+    Queues& q = *queues_;
+    StoreRelease(q.sqTail, q.sqLocalTail);
+    unsigned pending = q.sqLocalTail - LoadAcquire(q.sqHead);
+    for (;;) {
+        int n = Enter(q.ring, pending, 0, IORING_ENTER_GETEVENTS);
+        calls.fetch_add(1, std::memory_order_relaxed);
+        if (n >= 0) return true;
+        if (errno == EINTR) continue;
+        // Completion queue backed up, or out of memory for now: the entries
+        // stay queued and go with the next enter
+        if (errno == EBUSY || errno == EAGAIN) return true;
+        ARENA_LOG_ERROR(Net, "UringTransport: io_uring_enter: %s", std::strerror(errno));
+        return false;
+    }
+}
+
+size_t UringTransport::harvest() {
+    Queues& q = *queues_;
+    size_t got = 0;
+    unsigned head = *q.cqHead, tail = LoadAcquire(q.cqTail);
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = q.cqes[head & q.cqMask];
+        if (cqe.user_data == kCancelTag) continue;
+        if (cqe.user_data != kReceiveTag) {
+            size_t i = cqe.user_data % sendRing_.capacity();
+            q.inFlight[i] = 0;
+            --q.sendsInFlight;
+            if (cqe.res >= 0) {
+                sent_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                sendDropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        // The kernel stops a multishot receive on an error, most often
+        // ENOBUFS when every buffer is waiting for receive()
+        if (!(cqe.flags & IORING_CQE_F_MORE)) q.receiveArmed = false;
+        if (cqe.res < 0 || !(cqe.flags & IORING_CQE_F_BUFFER)) {
+            if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+                ARENA_LOG_WARN(Net, "UringTransport: receive: %s", std::strerror(-cqe.res));
+            }
+            continue;
+        }
+        auto id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        received_.fetch_add(1, std::memory_order_relaxed);
+        io_uring_recvmsg_out out;
+        std::memcpy(&out, q.buffer(id), sizeof(out));
+        int64_t due = 0;
+        if (static_cast<size_t>(cqe.res) < kReceiveHeader || (out.flags & MSG_TRUNC)) {
+            receiveDropped_.fetch_add(1, std::memory_order_relaxed);
+            recycle(id);
+            continue;
+        }
+        if (lossSimDrop(due)) {
+            recycle(id);
+            continue;
+        }
+        size_t size = std::min<size_t>(out.payloadlen, static_cast<size_t>(cqe.res) - kReceiveHeader);
+        q.arrivals[q.arrivalTail++ % q.arrivals.size()] = {id, static_cast<uint32_t>(size), due};
+        ++got;
+    }
+    StoreRelease(q.cqHead, head);
+
+    // Send slots free up in order, once the kernel is done with them
+    uint64_t done = sendRing_.head.load(std::memory_order_relaxed);
+    while (done < submitted_ && !q.inFlight[done % sendRing_.capacity()]) ++done;
+    sendRing_.head.store(done, std::memory_order_release);
+    return got;
+}
+
+void UringTransport::recycle(uint16_t buffer) {
+    Queues& q = *queues_;
+    auto* ring = static_cast<io_uring_buf_ring*>(q.bufferRing);
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(ring)[q.bufferTail & (q.bufferCount - 1)];
+    entry.addr = reinterpret_cast<uintptr_t>(q.buffer(buffer));
+    entry.len = static_cast<uint32_t>(q.bufferSize);
+    entry.bid = buffer;
+    ++q.bufferTail;
+    __atomic_store_n(&ring->tail, q.bufferTail, __ATOMIC_RELEASE);
+}
+
+#else
+
+struct UringTransport::Queues {};
+
+UringTransport::UringTransport() = default;
+UringTransport::UringTransport(const Settings& settings) : DatagramTransport(settings) {}
+UringTransport::~UringTransport() = default;
+
+bool UringTransport::open() { return false; }
+void UringTransport::close() {}
+bool UringTransport::sendTo(const Endpoint&, const void*, size_t) { return false; }
+int UringTransport::receiveFrom(Endpoint&, uint8_t*, size_t) { return 0; }
+size_t UringTransport::flush() { return 0; }
+size_t UringTransport::poll() { return 0; }
+bool UringTransport::armReceive() { return false; }
+bool UringTransport::enter(std::atomic<uint64_t>&) { return false; }
+size_t UringTransport::harvest() { return 0; }
+void UringTransport::recycle(uint16_t) {}
+
+#endif
+
+} // namespace arena::net
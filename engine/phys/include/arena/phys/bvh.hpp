@@ -0,0 +1,495 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define ARENA_PHYS_SSE 1
+#else
+#define ARENA_PHYS_SSE 0
+#endif
+
+namespace arena::phys {
+
+struct Aabb {
+    float min[3]{ 1e30f,  1e30f,  1e30f};
+    float max[3]{-1e30f, -1e30f, -1e30f};
+
+    void grow(const float p[3]) {
+        for (int a = 0; a < 3; ++a) {
+            min[a] = p[a] < min[a] ? p[a] : min[a];
+            max[a] = p[a] > max[a] ? p[a] : max[a];
+        }
+    }
+    void grow(const Aabb& b) {
+        for (int a = 0; a < 3; ++a) {
+            min[a] = b.min[a] < min[a] ? b.min[a] : min[a];
+            max[a] = b.max[a] > max[a] ? b.max[a] : max[a];
+        }
+    }
+    bool valid() const { return min[0] <= max[0]; }
+    float surfaceArea() const {
+        if (!valid()) return 0.0f;
+        float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+// Triangle in world space, stored as v0 plus edges for Moller-Trumbore.
+// id is unique across the world and breaks ties between equal hit distances.
+struct Triangle {
+    float v0[3];
+    float e1[3];
+    float e2[3];
+    uint32_t id;
+
+    static Triangle fromVertices(const float a[3], const float b[3], const float c[3], uint32_t id);
+    Aabb bounds() const;
+};
+
+// 4-wide BVH node with child bounds in SoA form so one SIMD slab test covers
+// all four children. Two cache lines; children are packed into the first
+// `count` lanes.
+struct alignas(64) Node4 {
+    float minX[4], minY[4], minZ[4];
+    float maxX[4], maxY[4], maxZ[4];
+    uint32_t child[4];
+    uint32_t count;
+    uint32_t pad[3];
+};
+static_assert(sizeof(Node4) == 128, "Node4 should span exactly two cache lines");
+
+// Child encoding: inner node index, or a leaf of up to kMaxLeafSize primitives
+constexpr uint32_t kLeafBit = 0x80000000u;
+constexpr uint32_t kMaxLeafSize = 8;
+
+inline bool isLeaf(uint32_t child) { return (child & kLeafBit) != 0; }
+inline uint32_t leafFirst(uint32_t child) { return (child & ~kLeafBit) >> 3; }
+inline uint32_t leafCount(uint32_t child) { return (child & 7u) + 1; }
+inline uint32_t makeLeaf(uint32_t first, uint32_t count) { return kLeafBit | (first << 3) | (count - 1); }
+
+// Build a BVH4 over primitive bounds with binned SAH. order receives the
+// primitive index for each leaf slot; leaves reference ranges of it. The
+// root is nodes[0]. Returns false if there are no primitives.
+bool buildBvh4(const std::vector<Aabb>& primBounds, std::vector<Node4>& nodes, std::vector<uint32_t>& order);
+
+// buildBvh4 in bounded steps, for rebuilds that mustn't stall the thread
+// running them. Keeps its own copy of the bounds; the result is identical.
+class Bvh4Builder {
+public:
+    explicit Bvh4Builder(std::vector<Aabb> primBounds);
+    ~Bvh4Builder();
+
+    // Split nodes until about work primitives have been binned, at least one
+    // node per call. True once the tree is complete.
+    bool step(size_t work);
+    // Once step() has returned true; call at most once. Same outputs as buildBvh4.
+    bool finish(std::vector<Node4>& nodes, std::vector<uint32_t>& order);
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+// Ray prepared for traversal. dir need not be normalized; t is in units of dir.
+struct Ray4 {
+    float origin[3];
+    float dir[3];
+    float invDir[3];
+    float tMax;
+    // Float offset into a Node4 of the slab each axis enters through (minX..
+    // for positive directions, maxX.. for negative) and leaves through
+    uint32_t nearSlab[3];
+    uint32_t farSlab[3];
+
+    Ray4(const float o[3], const float d[3], float tMax);
+};
+
+struct TriangleHit {
+    float t;
+    float u, v;
+    uint32_t tri; // index into the triangle array that was traversed
+    uint32_t id;  // Triangle::id
+};
+
+// Non-owning view of a triangle BVH (owned vectors, or a mapped cache file)
+struct BlasView {
+    const Node4* nodes = nullptr;
+    const Triangle* tris = nullptr;
+    uint32_t nodeCount = 0;
+    uint32_t triCount = 0;
+};
+
+// Nearest hit with t in [0, best.t]; on equal t the lower Triangle::id wins so
+// results don't depend on traversal order. Returns true if best was improved.
+bool intersect(const BlasView& blas, const Ray4& ray, TriangleHit& best);
+
+// Bottom-level BVH owning its triangles (reordered to match the leaves)
+struct Blas {
+    std::vector<Node4> nodes;
+    std::vector<Triangle> tris;
+    Aabb bounds;
+
+    static Blas build(std::vector<Triangle> triangles);
+    BlasView view() const {
+        return {nodes.data(), tris.data(), static_cast<uint32_t>(nodes.size()), static_cast<uint32_t>(tris.size())};
+    }
+};
+
+// Slab test against all four children at once: returns a bit per child lane the
+// ray enters within [0, tMax] and writes the entry distances
+inline uint32_t intersectNode(const Node4& node, const Ray4& ray, float tMax, float tEntry[4]) {
+    // The ray's octant picks which of each min/max pair is entered first, so
+    // the near and far distances need no min/max between them
+    const float* slabs = node.minX;
+#if ARENA_PHYS_SSE
+    const __m128 ox = _mm_set1_ps(ray.origin[0]), oy = _mm_set1_ps(ray.origin[1]), oz = _mm_set1_ps(ray.origin[2]);
+    const __m128 ix = _mm_set1_ps(ray.invDir[0]), iy = _mm_set1_ps(ray.invDir[1]), iz = _mm_set1_ps(ray.invDir[2]);
+    __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.nearSlab[0]), ox), ix);
+    __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.farSlab[0]), ox), ix);
+    __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.nearSlab[1]), oy), iy);
+    __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.farSlab[1]), oy), iy);
+    __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.nearSlab[2]), oz), iz);
+    __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(slabs + ray.farSlab[2]), oz), iz);
+    __m128 tNear = _mm_max_ps(_mm_max_ps(tx0, ty0), _mm_max_ps(tz0, _mm_setzero_ps()));
+    __m128 tFar = _mm_min_ps(_mm_min_ps(tx1, ty1), _mm_min_ps(tz1, _mm_set1_ps(tMax)));
+    _mm_storeu_ps(tEntry, tNear);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) & ((1u << node.count) - 1u);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < node.count; ++i) {
+        float tx0 = (slabs[ray.nearSlab[0] + i] - ray.origin[0]) * ray.invDir[0];
+        float tx1 = (slabs[ray.farSlab[0] + i] - ray.origin[0]) * ray.invDir[0];
+        float ty0 = (slabs[ray.nearSlab[1] + i] - ray.origin[1]) * ray.invDir[1];
+        float ty1 = (slabs[ray.farSlab[1] + i] - ray.origin[1]) * ray.invDir[1];
+        float tz0 = (slabs[ray.nearSlab[2] + i] - ray.origin[2]) * ray.invDir[2];
+        float tz1 = (slabs[ray.farSlab[2] + i] - ray.origin[2]) * ray.invDir[2];
+        float tNear = std::max(std::max(tx0, ty0), std::max(tz0, 0.0f));
+        float tFar = std::min(std::min(tx1, ty1), std::min(tz1, tMax));
+        tEntry[i] = tNear;
+        if (tNear <= tFar) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// Slab test against the four child boxes grown by ext on each axis: the boxes
+// a point moving along the ray would have to enter for a shape with those
+// half-extents to touch the originals. Conservative culling for sweeps.
+inline uint32_t intersectNodeExpanded(const Node4& node, const Ray4& ray, const float ext[3], float tMax, float tEntry[4]) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < node.count; ++i) {
+        float tx0 = (node.minX[i] - ext[0] - ray.origin[0]) * ray.invDir[0], tx1 = (node.maxX[i] + ext[0] - ray.origin[0]) * ray.invDir[0];
+        float ty0 = (node.minY[i] - ext[1] - ray.origin[1]) * ray.invDir[1], ty1 = (node.maxY[i] + ext[1] - ray.origin[1]) * ray.invDir[1];
+        float tz0 = (node.minZ[i] - ext[2] - ray.origin[2]) * ray.invDir[2], tz1 = (node.maxZ[i] + ext[2] - ray.origin[2]) * ray.invDir[2];
+        float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+        float tFar = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+        tEntry[i] = tNear;
+        if (tNear <= tFar) mask |= 1u << i;
+    }
+    return mask;
+}
+
+// Traversal stack: N entries inline, spilling to the heap past that. Trees
+// built in one go stay far shallower than N, but incremental inserts can
+// skew them, and dropping an entry would silently lose hits.
+template <class T, int N>
+class TraversalStack {
+public:
+    bool empty() const { return size_ == 0; }
+    void push(const T& value) {
+        if (size_ < N) {
+            inline_[size_] = value;
+        } else {
+            spill_.push_back(value);
+        }
+        ++size_;
+    }
+    T pop() {
+        --size_;
+        if (size_ < N) return inline_[size_];
+        T value = spill_.back();
+        spill_.pop_back();
+        return value;
+    }
+
+private:
+    T inline_[N];
+    std::vector<T> spill_;
+    int size_ = 0;
+};
+
+// Start loading a node that will be visited after the current subtree
+inline void prefetchChild(const Node4* nodes, uint32_t child) {
+#if ARENA_PHYS_SSE
+    if (isLeaf(child)) return;
+    const char* line = reinterpret_cast<const char*>(nodes + child);
+    _mm_prefetch(line, _MM_HINT_T0);
+    _mm_prefetch(line + 64, _MM_HINT_T0);
+#else
+    (void)nodes;
+    (void)child;
+#endif
+}
+
+// Front-to-back traversal of a BVH4 rooted at nodes[0]. nodeTest(node, tMax,
+// tEntry) returns the mask of children to visit (as intersectNode does);
+// leafFn(first, count) tests a leaf's primitive range and returns the new
+// closest distance, and nodes entered beyond it are culled. The single-hit
+// case (most nodes on typical level geometry) descends without touching the
+// stack, and the ordering is done on the hit mask to keep branches predictable.
+template <class NodeTest, class LeafFn>
+inline void traverseBvh4With(const Node4* nodes, float tMax, NodeTest&& nodeTest, LeafFn&& leafFn) {
+    struct Entry { uint32_t child; float t; };
+    TraversalStack<Entry, 64> stack;
+    uint32_t current = 0;
+
+    for (;;) {
+        while (!isLeaf(current)) {
+            const Node4& node = nodes[current];
+            float tEntry[4];
+            uint32_t mask = nodeTest(node, tMax, tEntry);
+            if (!mask) goto pop;
+
+            uint32_t a = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+            if (!mask) {
+                current = node.child[a];
+                continue;
+            }
+            uint32_t b = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+            if (tEntry[b] < tEntry[a]) std::swap(a, b);
+            if (!mask) {
+                prefetchChild(nodes, node.child[b]);
+                stack.push({node.child[b], tEntry[b]});
+                current = node.child[a];
+                continue;
+            }
+
+            // Three or four children: insertion sort by entry distance, push all
+            // but the nearest far-to-near
+            Entry hits[4] = {{node.child[a], tEntry[a]}, {node.child[b], tEntry[b]}};
+            int n = 2;
+            while (mask) {
+                uint32_t c = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+                Entry h{node.child[c], tEntry[c]};
+                int j = n++;
+                while (j > 0 && hits[j - 1].t > h.t) {
+                    hits[j] = hits[j - 1];
+                    --j;
+                }
+                hits[j] = h;
+            }
+            for (int i = n - 1; i > 0; --i) {
+                prefetchChild(nodes, hits[i].child);
+                stack.push(hits[i]);
+            }
+            current = hits[0].child;
+        }
+
+        tMax = leafFn(leafFirst(current), leafCount(current));
+
+    pop:
+        for (;;) {
+            if (stack.empty()) return;
+            Entry e = stack.pop();
+            if (e.t <= tMax) {
+                current = e.child;
+                break;
+            }
+        }
+    }
+}
+
+// Nearest-first ray traversal
+template <class LeafFn>
+inline void traverseBvh4(const Node4* nodes, const Ray4& ray, float tMax, LeafFn&& leafFn) {
+    traverseBvh4With(nodes, tMax, [&](const Node4& node, float t, float tEntry[4]) {
+        return intersectNode(node, ray, t, tEntry);
+    }, leafFn);
+}
+
+// Up to four rays sharing a direction octant, one per SIMD lane. Each lane
+// holds the values a Ray4 of that ray would, so box and triangle tests give
+// it exactly what its single-ray traversal would. Boxes are first culled
+// once for the whole packet against bounds on the lanes' origins and
+// inverse directions.
+struct alignas(16) RayPacket {
+    float origin[3][4];
+    float dir[3][4];
+    float invDir[3][4];
+    // Per axis, repeated in all four floats: the lane origin furthest along
+    // the direction (so the nearest slab entry) and the one furthest behind,
+    // and the smallest and largest inverse direction
+    float nearOrigin[3][4];
+    float farOrigin[3][4];
+    float invLow[3][4];
+    float invHigh[3][4];
+    uint32_t nearSlab[3];
+    uint32_t farSlab[3];
+
+    // Unused lanes may repeat another and be left out of the ray masks.
+    // prepare() fills in the rest once all four lanes are set.
+    void setLane(uint32_t lane, const float o[3], const float d[3]) {
+        for (int a = 0; a < 3; ++a) {
+            origin[a][lane] = o[a];
+            dir[a][lane] = d[a];
+        }
+    }
+    void prepare();
+};
+
+// Nearest hit per active lane (bit per lane in rays), as intersect() would
+// find for each ray alone. Returns the lanes whose best was improved.
+uint32_t intersectPacket(const BlasView& blas, const RayPacket& packet, uint32_t rays, TriangleHit best[4]);
+
+// Slab test of the four children against the whole packet: a child is
+// entered if some ray with a tMax up to tLimit could enter it, going by
+// interval bounds over the lanes. Rounding is monotonic, so every child a
+// single lane's intersectNode would enter passes. Writes a lower bound on
+// the lanes' entry distances per child; returns a bit per child entered.
+inline uint32_t intersectNodePacket(const Node4& node, const RayPacket& packet, float tLimit, float tEntry[4]) {
+    const float* slabs = node.minX;
+#if ARENA_PHYS_SSE
+    // Entry is bounded below and exit above by the box corner products
+    auto lower = [&](int a) {
+        __m128 d = _mm_sub_ps(_mm_load_ps(slabs + packet.nearSlab[a]), _mm_load_ps(packet.nearOrigin[a]));
+        return _mm_min_ps(_mm_mul_ps(d, _mm_load_ps(packet.invLow[a])), _mm_mul_ps(d, _mm_load_ps(packet.invHigh[a])));
+    };
+    auto upper = [&](int a) {
+        __m128 d = _mm_sub_ps(_mm_load_ps(slabs + packet.farSlab[a]), _mm_load_ps(packet.farOrigin[a]));
+        return _mm_max_ps(_mm_mul_ps(d, _mm_load_ps(packet.invLow[a])), _mm_mul_ps(d, _mm_load_ps(packet.invHigh[a])));
+    };
+    __m128 tNear = _mm_max_ps(_mm_max_ps(lower(0), lower(1)), _mm_max_ps(lower(2), _mm_setzero_ps()));
+    __m128 tFar = _mm_min_ps(_mm_min_ps(upper(0), upper(1)), _mm_min_ps(upper(2), _mm_set1_ps(tLimit)));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+    _mm_storeu_ps(tEntry, tNear);
+    return mask & ((1u << node.count) - 1u);
+#else
+    uint32_t mask = 0;
+    for (uint32_t c = 0; c < node.count; ++c) {
+        float tNear = 0.0f, tFar = tLimit;
+        for (int a = 0; a < 3; ++a) {
+            float d0 = slabs[packet.nearSlab[a] + c] - packet.nearOrigin[a][0];
+            float d1 = slabs[packet.farSlab[a] + c] - packet.farOrigin[a][0];
+            tNear = std::max(tNear, std::min(d0 * packet.invLow[a][0], d0 * packet.invHigh[a][0]));
+            tFar = std::min(tFar, std::max(d1 * packet.invLow[a][0], d1 * packet.invHigh[a][0]));
+        }
+        tEntry[c] = tNear;
+        if (tNear <= tFar) mask |= 1u << c;
+    }
+    return mask;
+#endif
+}
+
+// The rays (bit per lane) that enter child c of node, each with exactly the
+// arithmetic intersectNode does for that ray alone
+inline uint32_t intersectChildPacket(const Node4& node, uint32_t c, const RayPacket& packet, const float tMax[4],
+                                     uint32_t rays) {
+    const float* slabs = node.minX;
+#if ARENA_PHYS_SSE
+    auto slab = [&](uint32_t offset, int a) {
+        return _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(slabs[offset + c]), _mm_load_ps(packet.origin[a])),
+                          _mm_load_ps(packet.invDir[a]));
+    };
+    __m128 tNear = _mm_max_ps(_mm_max_ps(slab(packet.nearSlab[0], 0), slab(packet.nearSlab[1], 1)),
+                              _mm_max_ps(slab(packet.nearSlab[2], 2), _mm_setzero_ps()));
+    __m128 tFar = _mm_min_ps(_mm_min_ps(slab(packet.farSlab[0], 0), slab(packet.farSlab[1], 1)),
+                             _mm_min_ps(slab(packet.farSlab[2], 2), _mm_loadu_ps(tMax)));
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) & rays;
+#else
+    uint32_t hits = 0;
+    for (uint32_t m = rays; m; m &= m - 1) {
+        uint32_t r = static_cast<uint32_t>(std::countr_zero(m));
+        float t[6];
+        for (int a = 0; a < 3; ++a) {
+            t[a] = (slabs[packet.nearSlab[a] + c] - packet.origin[a][r]) * packet.invDir[a][r];
+            t[3 + a] = (slabs[packet.farSlab[a] + c] - packet.origin[a][r]) * packet.invDir[a][r];
+        }
+        float tNear = std::max(std::max(t[0], t[1]), std::max(t[2], 0.0f));
+        float tFar = std::min(std::min(t[3], t[4]), std::min(t[5], tMax[r]));
+        if (tNear <= tFar) hits |= 1u << r;
+    }
+    return hits;
+#endif
+}
+
+// Front-to-back traversal of a BVH4 for a packet. A node's children are
+// culled once for the packet, then each survivor is visited with just the
+// rays whose own slab test enters it, nearest entry bound first, so every
+// ray tests the boxes and triangles its single-ray traversal could reach.
+// leafFn(first, count, rays) tests a leaf against those rays and lowers
+// their entries in tMax.
+template <class LeafFn>
+inline void traversePacket4(const Node4* nodes, const RayPacket& packet, float tMax[4], uint32_t rays, LeafFn&& leafFn) {
+    struct Entry { uint32_t child; uint32_t rays; float t; };
+    TraversalStack<Entry, 64> stack;
+    uint32_t current = 0;
+    auto limit = [&] {
+        float t = 0.0f;
+        for (uint32_t m = rays; m; m &= m - 1) t = std::max(t, tMax[std::countr_zero(m)]);
+        return t;
+    };
+    float tLimit = limit();
+
+    for (;;) {
+        while (!isLeaf(current)) {
+            const Node4& node = nodes[current];
+            float tEntry[4];
+            uint32_t mask = intersectNodePacket(node, packet, tLimit, tEntry);
+
+            Entry hits[4];
+            int n = 0;
+            while (mask) {
+                uint32_t c = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+                uint32_t childRays = intersectChildPacket(node, c, packet, tMax, rays);
+                if (!childRays) continue;
+                Entry h{node.child[c], childRays, tEntry[c]};
+                int j = n++;
+                while (j > 0 && hits[j - 1].t > h.t) {
+                    hits[j] = hits[j - 1];
+                    --j;
+                }
+                hits[j] = h;
+            }
+            if (n == 0) goto pop;
+            for (int i = n - 1; i > 0; --i) {
+                prefetchChild(nodes, hits[i].child);
+                stack.push(hits[i]);
+            }
+            current = hits[0].child;
+            rays = hits[0].rays;
+        }
+
+        leafFn(leafFirst(current), leafCount(current), rays);
+        tLimit = limit();
+
+    pop:
+        for (;;) {
+            if (stack.empty()) return;
+            Entry e = stack.pop();
+            // Keep the rays whose closest hit so far isn't nearer than the entry
+            uint32_t live = 0;
+            for (uint32_t m = e.rays; m; m &= m - 1) {
+                uint32_t r = static_cast<uint32_t>(std::countr_zero(m));
+                if (e.t <= tMax[r]) live |= 1u << r;
+            }
+            if (live) {
+                current = e.child;
+                if (live != rays) {
+                    rays = live;
+                    tLimit = limit();
+                }
+                break;
+            }
+        }
+    }
+}
+
+} // namespace arena::phys
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "arena/mapped_file.hpp"
+#include "arena/phys/bvh.hpp"
+
+namespace arena::phys {
+
+// Static BVH cache file. Everything is located by byte offsets from the start
+// of the file and every section starts on a 64-byte boundary, so a mapping can
+// be walked in place: Node4 children are node indices and leaves are triangle
+// ranges, neither needs fixing up. Layout:
+//
+//   BvhCacheHeader
+//   BvhCacheMesh[meshCount]
+//   Node4[tlasNodeCount]      top level
+//   uint32_t[meshCount]       top-level leaf slot -> mesh
+//   per mesh: Node4[nodeCount], Triangle[triCount]
+//
+// The header carries the content hash of the geometry it was built from; a
+// file whose hash, version, byte order or struct sizes don't match is ignored.
+// Opening also walks every node once, so a damaged file can't send traversal
+// outside the mapping or round a cycle.
+constexpr uint32_t kBvhCacheVersion = 1;
+
+struct BvhCacheHeader {
+    char magic[8];           // "ARENABVH"
+    uint32_t version;
+    uint32_t byteOrder;      // 0x01020304 in the writer's byte order
+    uint32_t nodeSize;       // sizeof(Node4)
+    uint32_t triangleSize;   // sizeof(Triangle)
+    uint64_t contentHash;
+    uint64_t fileSize;
+    uint64_t triangleCount;
+    uint32_t meshCount;
+    uint32_t tlasNodeCount;
+    uint64_t meshTableOffset;
+    uint64_t tlasOffset;
+    uint64_t tlasOrderOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct BvhCacheMesh {
+    uint64_t nodesOffset;
+    uint64_t trisOffset;
+    uint32_t nodeCount;
+    uint32_t triCount;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// Hash of a mesh's triangles (positions and ids), chained from seed
+uint64_t hashTriangles(std::span<const Triangle> tris, uint64_t seed);
+
+// Write a cache file, going through a temporary and a rename so a process
+// mapping the same path never sees a partial file. False on I/O failure.
+bool writeBvhCache(const std::string& path, uint64_t contentHash, std::span<const Node4> tlas,
+                   std::span<const uint32_t> tlasOrder, std::span<const Blas> meshes, const Aabb& bounds,
+                   uint64_t triangleCount);
+
+// A cache file mapped read-only and checked; the views point into the mapping
+class MappedBvh {
+public:
+    // Null if the file is missing, malformed, or built from other geometry
+    static std::unique_ptr<MappedBvh> open(const std::string& path, uint64_t contentHash);
+
+    const Node4* tlas() const { return tlas_; }
+    const uint32_t* tlasOrder() const { return tlasOrder_; }
+    std::span<const BlasView> meshes() const { return meshes_; }
+    std::span<const Aabb> meshBounds() const { return meshBounds_; }
+    const Aabb& bounds() const { return bounds_; }
+    uint64_t triangleCount() const { return triangleCount_; }
+    size_t fileSize() const { return file_.size(); }
+
+private:
+    MappedFile file_;
+    const Node4* tlas_ = nullptr;
+    const uint32_t* tlasOrder_ = nullptr;
+    std::vector<BlasView> meshes_;
+    std::vector<Aabb> meshBounds_;
+    Aabb bounds_;
+    uint64_t triangleCount_ = 0;
+};
+
+} // namespace arena::phys
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "arena/phys/bvh.hpp"
+
+namespace arena::phys {
+
+// A capsule moving through the world: its core segment runs from
+// center - axis to center + axis, the shape is every point within radius of
+// that segment, and it moves by delta.
+struct CapsuleSweep {
+    float center[3];
+    float axis[3];
+    float radius;
+    float delta[3];
+};
+
+struct SweepHit {
+    float t;         // fraction of delta travelled at first contact
+    float normal[3]; // unit contact normal, pointing from the surface to the capsule
+    uint32_t id;     // Triangle::id
+};
+
+// Exact time of first contact against one triangle, treated as the ray of the
+// capsule centre against the triangle grown by the capsule (faces, edge and
+// vertex features of the rounded prism). Improves best if the contact is
+// earlier, or equally early on a lower triangle id. Starting in contact and
+// moving further in counts as contact at t = 0; moving out of an overlap
+// doesn't, so a capsule resting on a surface can always leave it.
+bool sweepTriangle(const CapsuleSweep& sweep, const Triangle& tri, SweepHit& best);
+
+// Nearest contact over a triangle BVH. Nodes are culled by the centre ray
+// against their boxes grown by the capsule's half-extents (the swept AABB),
+// and by the closest contact so far. No allocation.
+bool sweep(const BlasView& blas, const CapsuleSweep& sweep, SweepHit& best);
+
+// Swept-AABB node test shared with the top level of a two-level BVH
+struct SweptBounds {
+    Ray4 ray; // capsule centre along delta, t in fractions of delta
+    float ext[3];
+
+    explicit SweptBounds(const CapsuleSweep& sweep);
+};
+
+} // namespace arena::phys
@@ -0,0 +1,184 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "arena/contracts.hpp"
+#include "arena/phys/bvh.hpp"
+#include "arena/phys/bvh_cache.hpp"
+#include "arena/phys/capsule_sweep.hpp"
+
+namespace arena { class TaskPool; }
+
+namespace arena::phys {
+
+// Geometry behind a MeshHandle: xyz positions and triangle indices
+struct MeshGeometry {
+    std::span<const float> positions;
+    std::span<const uint32_t> indices;
+};
+
+// Looks up the CPU-side geometry of a mesh; false if the handle is unknown
+using MeshResolver = std::function<bool(MeshHandle, MeshGeometry&)>;
+
+// Static level geometry as a two-level BVH: each registered mesh instance is
+// baked into world space under its own 4-wide BVH, with a small top-level BVH4
+// over the meshes. Queries are const and safe to run from many threads while
+// no registration or edit is in progress.
+//
+// Meshes added or removed one at a time (editor walls) update the top level in
+// place: an insert descends by least surface-area growth and takes a free lane
+// or splits a leaf, a removal drops the mesh from its leaf, and both refit the
+// bounds up to the root. Once that has degraded the top level's SAH cost by
+// kRebuildCostRatio over the last full build, a full rebuild starts from a
+// snapshot of the mesh bounds and runs in slices of about kRebuildSliceWork
+// binned meshes: applyRebuild() advances it one slice, and once it completes
+// swaps it in and replays the edits made meanwhile, starting another if the
+// replay has degraded it as far again. Hosts call it once per tick before
+// queries start and every edit calls it first, so no edit waits on a whole
+// build, and a rebuild over n meshes lands within about n log2(n) /
+// kRebuildSliceWork edits or ticks, which bounds how far edits can degrade
+// the tree meanwhile. Slots freed by removals are reused by later inserts.
+//
+// raycastBatch sorts each block of rays by a hash of direction octant and
+// origin cell, then traces runs of up to four rays that start in the same
+// cell and point the same way as one packet: each node is loaded and culled
+// once for all of them and each triangle tested against all four at once.
+// Rays with no such neighbours run the single-ray traversal. A packet lane
+// does the same box and triangle arithmetic as its ray alone, so every
+// result is identical to raycast() on the same ray. Large batches are split
+// across a task pool when one is set.
+//
+// Throughput is what bench_raycast measures: 1.5-2 Mrays/s per core for
+// scattered single rays over a 100k-triangle arena, 3-4 Mrays/s once the
+// scene fits in L2 (2.1 GHz, SSE2). Each ray walks ~10 nodes one dependent
+// load and slab test at a time. The original tens of millions of rays/s per
+// core is out of reach for that walk, so hitscan budgets should assume the
+// measured figure. Getting closer needs wider nodes on AVX builds, rather
+// than more tuning of this traversal.
+//
+// sweepCapsule moves an upright capsule (core segment centre +/- halfHeight
+// on y) by delta, sliding along what it touches: up to kMaxSlides contacts
+// per call, stopping kContactSkin short of each so the next move starts
+// clear. It returns true if anything was touched. It doesn't allocate.
+//
+// Level loads register between beginBatch() and endBatch(cacheDir): meshes
+// are only baked to world-space triangles and hashed until the end, where the
+// BVHs are either mapped straight from <cacheDir>/static_<hash>.bvh or built
+// once and written there for the next start (see bvh_cache.hpp). A mapped
+// world is queried in place; registering more geometry later copies it back
+// into owned memory first.
+//
+// Hits against static geometry report entity 0.
+class StaticWorld : public IWorld {
+public:
+    static constexpr int kMaxSlides = 4;
+    static constexpr float kContactSkin = 0.005f;
+    static constexpr uint32_t kNoMesh = UINT32_MAX;
+    static constexpr float kRebuildCostRatio = 1.3f;
+    static constexpr size_t kRebuildSliceWork = 2048;
+
+    explicit StaticWorld(MeshResolver resolver);
+
+    // world is column-major (glm / OpenGL layout)
+    void registerStaticMesh(MeshHandle mh, const Mat4& world) override;
+    RayHit raycast(const Vec3& origin, const Vec3& dir, float maxDist) const override;
+    bool sweepCapsule(const Capsule& cap, const Vec3& start, const Vec3& delta, Vec3& outPos) const override;
+    void raycastBatch(std::span<const Ray> rays, std::span<RayHit> out) const override;
+
+    // Pool for splitting large batches; null (default) keeps batches on the caller
+    void setTaskPool(TaskPool* pool) { pool_ = pool; }
+
+    // Register raw world-space triangles (tools, tests, procedural geometry).
+    // Returns the mesh id for removeMesh, or kNoMesh if no triangle was valid.
+    uint32_t addTriangles(std::span<const float> positions, std::span<const uint32_t> indices);
+    // False if the id is unknown, already removed, or still in an open batch
+    bool removeMesh(uint32_t mesh);
+
+    // Advance a pending rebuild one slice, swapping it in once complete; true if one was applied
+    bool applyRebuild();
+    // Complete a pending rebuild, and any the replay starts, and apply them
+    void finishRebuild();
+    bool rebuildPending() const { return rebuild_ != nullptr; }
+    // Top-level SAH cost (lane areas over root area, leaves weighted by mesh count)
+    float topLevelCost() const;
+
+    // Defer BVH builds until endBatch. Queries see nothing new until then.
+    void beginBatch();
+    // Build, or map from the cache in cacheDir (empty: no cache), everything
+    // registered since beginBatch. Returns true if the cache was used.
+    bool endBatch(const std::string& cacheDir = {});
+
+    // Hash of every triangle registered and every mesh removed, in order
+    uint64_t contentHash() const { return contentHash_; }
+    bool isMapped() const { return mapped_ != nullptr; }
+
+    size_t meshCount() const { return liveMeshes_; }
+    size_t triangleCount() const { return triangleCount_; }
+    const Aabb& bounds() const { return bounds_; }
+
+private:
+    // Nearest triangle hit along the ray across every mesh
+    bool intersectAll(const Ray4& ray, TriangleHit& best, uint32_t& meshIndex) const;
+    // The same for each packet lane in rays; returns the lanes that hit
+    uint32_t intersectAll(const RayPacket& packet, uint32_t rays, TriangleHit best[4], uint32_t meshIndex[4]) const;
+    RayHit hitResult(const float o[3], const float d[3], const TriangleHit& best, uint32_t mesh) const;
+    // raycast() once the direction is unit length
+    RayHit raycastUnit(const float o[3], const float d[3], float maxDist) const;
+    // raycastBatch over rays [begin, end), at most kPacketBlock of them
+    void raycastBlock(std::span<const Ray> rays, std::span<RayHit> out, size_t begin, size_t end) const;
+    // Nearest capsule contact across every mesh
+    bool sweepAll(const CapsuleSweep& sweep, SweepHit& best) const;
+
+    struct TopLevelBuild {
+        std::vector<Node4> nodes;
+        std::vector<uint32_t> order;
+    };
+
+    // Full synchronous top-level build over the live meshes
+    void rebuildTopLevel();
+    void installTopLevel(TopLevelBuild built);
+    void startRebuild();
+    void discardRebuild();
+    void insertTopLevel(uint32_t mesh);
+    // A TLAS leaf slot for mesh: one freed by a removal, else a new one
+    uint32_t takeSlot(uint32_t mesh);
+    // Recompute a leaf lane from its live meshes, dropping it if none are left
+    void refitLeaf(uint32_t node, uint32_t lane);
+    // Refit ancestors of node up to the root, dropping emptied nodes
+    void refitUp(uint32_t node);
+    void removeLane(uint32_t node, uint32_t lane);
+    void afterEdit(uint32_t mesh);
+    // Copy a mapped cache into owned meshes so more can be added
+    void detachMapped();
+
+    MeshResolver resolver_;
+    TaskPool* pool_ = nullptr;
+    std::vector<Blas> meshes_;
+    std::vector<Node4> tlas_;
+    std::vector<uint32_t> tlasOrder_;  // TLAS leaf slot -> mesh index
+    std::vector<uint32_t> freeSlots_;  // tlasOrder_ slots of dropped leaves
+    std::vector<uint32_t> tlasParent_; // node -> parent node << 2 | lane
+    std::vector<uint32_t> meshSlot_;   // mesh -> node << 2 | lane of its TLAS leaf
+    size_t liveMeshes_ = 0;
+    float builtCost_ = 0.0f;
+    std::unique_ptr<Bvh4Builder> rebuild_;
+    std::vector<uint32_t> rebuildIds_; // rebuild primitive -> mesh index
+    std::vector<uint32_t> editedSinceSnapshot_;
+    Aabb bounds_; // grows only; removals leave it conservative
+    size_t triangleCount_ = 0;
+    uint32_t nextTriangleId_ = 0; // never reused, so ids stay unique across removals
+    uint64_t contentHash_ = 0;
+
+    // What queries walk: the owned vectors above, or a mapped cache file
+    std::vector<BlasView> views_;
+    const Node4* tlasNodes_ = nullptr;
+    const uint32_t* tlasSlots_ = nullptr;
+    std::unique_ptr<MappedBvh> mapped_;
+
+    bool batching_ = false;
+    std::vector<std::vector<Triangle>> pending_;
+};
+
+} // namespace arena::phys
@@ -0,0 +1,499 @@
+#include "arena/phys/bvh.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace arena::phys {
+
+namespace {
+
+constexpr int kBins = 16;
+constexpr uint32_t kPreferredLeafSize = 4;
+
+// Binary BVH produced by the SAH builder, collapsed to Node4 afterwards
+struct BuildNode {
+    Aabb bounds;
+    uint32_t left = 0, right = 0;
+    uint32_t first = 0, count = 0;
+    bool leaf = false;
+};
+
+class Builder {
+public:
+    Builder(const std::vector<Aabb>& boxes, std::vector<uint32_t>& order)
+        : boxes_(boxes), order_(order), centroids_(boxes.size() * 3) {
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            for (int a = 0; a < 3; ++a) {
+                centroids_[i * 3 + a] = 0.5f * (boxes[i].min[a] + boxes[i].max[a]);
+            }
+        }
+        nodes_.reserve(boxes.size() * 2);
+    }
+
+    // Queue the root over order[first, first + count) for step()
+    void start(uint32_t first, uint32_t count) { pending_.push_back({kNoParent, first, count}); }
+
+    // Split queued nodes depth first, left child first, so nodes come out in
+    // the order a recursive build would make them. Stops once about work
+    // primitives have been visited, after at least one node; true when done.
+    bool step(size_t work) {
+        size_t visited = 0;
+        while (!pending_.empty() && (visited == 0 || visited < work)) {
+            Task task = pending_.back();
+            pending_.pop_back();
+            visited += task.count;
+            split(task);
+        }
+        return pending_.empty();
+    }
+
+    // Collapse the finished binary tree into nodes, root at nodes[0]
+    void finish(std::vector<Node4>& out) const {
+        out.clear();
+        out.reserve(nodes_.size() / 2 + 1);
+        uint32_t root = 0;
+        if (nodes_[root].leaf) {
+            // A single leaf still needs a node so traversal always starts at nodes[0]
+            out.emplace_back();
+            uint32_t encoded = makeLeaf(nodes_[root].first, nodes_[root].count);
+            fillLanes(out[0], &root, &encoded, 1);
+        } else {
+            collapse(root, out);
+        }
+    }
+
+    // Collapse binary node b into Node4s; returns the encoded child reference
+    uint32_t collapse(uint32_t b, std::vector<Node4>& out) const {
+        const BuildNode& node = nodes_[b];
+        if (node.leaf) return makeLeaf(node.first, node.count);
+
+        // Open the largest inner child until there are four
+        uint32_t children[4] = {node.left, node.right};
+        uint32_t count = 2;
+        while (count < 4) {
+            int pick = -1;
+            float pickArea = -1.0f;
+            for (uint32_t i = 0; i < count; ++i) {
+                const BuildNode& c = nodes_[children[i]];
+                if (!c.leaf && c.bounds.surfaceArea() > pickArea) {
+                    pickArea = c.bounds.surfaceArea();
+                    pick = static_cast<int>(i);
+                }
+            }
+            if (pick < 0) break;
+            uint32_t opened = children[pick];
+            children[pick] = nodes_[opened].left;
+            children[count++] = nodes_[opened].right;
+        }
+
+        uint32_t index = static_cast<uint32_t>(out.size());
+        out.emplace_back();
+        uint32_t encoded[4];
+        for (uint32_t i = 0; i < count; ++i) encoded[i] = collapse(children[i], out);
+
+        Node4& n = out[index];
+        fillLanes(n, children, encoded, count);
+        return index;
+    }
+
+    void fillLanes(Node4& n, const uint32_t* children, const uint32_t* encoded, uint32_t count) const {
+        for (uint32_t i = 0; i < 4; ++i) {
+            // Unused lanes are masked by count; give them empty bounds anyway
+            Aabb box = i < count ? nodes_[children[i]].bounds : Aabb();
+            n.minX[i] = box.min[0]; n.minY[i] = box.min[1]; n.minZ[i] = box.min[2];
+            n.maxX[i] = box.max[0]; n.maxY[i] = box.max[1]; n.maxZ[i] = box.max[2];
+            n.child[i] = i < count ? encoded[i] : 0;
+        }
+        n.count = count;
+        n.pad[0] = n.pad[1] = n.pad[2] = 0;
+    }
+
+private:
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    // A node still to be made over order[first, first + count); parent is
+    // the parent's index << 1, with the low bit set for a right child
+    struct Task {
+        uint32_t parent, first, count;
+    };
+
+    void split(const Task& task) {
+        uint32_t first = task.first, count = task.count;
+        uint32_t index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        if (task.parent != kNoParent) {
+            BuildNode& parent = nodes_[task.parent >> 1];
+            (task.parent & 1 ? parent.right : parent.left) = index;
+        }
+
+        Aabb bounds, centroidBounds;
+        for (uint32_t i = first; i < first + count; ++i) {
+            bounds.grow(boxes_[order_[i]]);
+            centroidBounds.grow(&centroids_[order_[i] * 3]);
+        }
+        nodes_[index].bounds = bounds;
+
+        if (count == 1) return makeLeafNode(index, first, count);
+
+        // Binned SAH over the axis-aligned centroid bins of all three axes
+        float bestCost = 1e30f;
+        int bestAxis = -1, bestSplit = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            float lo = centroidBounds.min[axis], extent = centroidBounds.max[axis] - lo;
+            if (extent <= 0.0f) continue;
+            float scale = kBins / extent;
+
+            Aabb binBounds[kBins];
+            uint32_t binCount[kBins] = {};
+            for (uint32_t i = first; i < first + count; ++i) {
+                int b = std::min(kBins - 1, static_cast<int>((centroids_[order_[i] * 3 + axis] - lo) * scale));
+                binBounds[b].grow(boxes_[order_[i]]);
+                ++binCount[b];
+            }
+
+            // Sweep from the right to get suffix areas, then from the left
+            float rightArea[kBins];
+            uint32_t rightCount[kBins];
+            Aabb acc;
+            uint32_t n = 0;
+            for (int b = kBins - 1; b > 0; --b) {
+                acc.grow(binBounds[b]);
+                n += binCount[b];
+                rightArea[b] = acc.surfaceArea();
+                rightCount[b] = n;
+            }
+            acc = Aabb();
+            n = 0;
+            for (int b = 0; b < kBins - 1; ++b) {
+                acc.grow(binBounds[b]);
+                n += binCount[b];
+                if (n == 0 || rightCount[b + 1] == 0) continue;
+                float cost = acc.surfaceArea() * n + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // Leaf when splitting isn't cheaper (traversal step costs about one triangle test)
+        float parentArea = bounds.surfaceArea();
+        float splitCost = parentArea > 0.0f ? 1.0f + bestCost / parentArea : 1e30f;
+        if (count <= kPreferredLeafSize && (bestAxis < 0 || splitCost >= static_cast<float>(count))) {
+            return makeLeafNode(index, first, count);
+        }
+
+        uint32_t mid;
+        if (bestAxis >= 0) {
+            float lo = centroidBounds.min[bestAxis];
+            float scale = kBins / (centroidBounds.max[bestAxis] - lo);
+            uint32_t* begin = order_.data() + first;
+            uint32_t* split = std::partition(begin, begin + count, [&](uint32_t prim) {
+                int b = std::min(kBins - 1, static_cast<int>((centroids_[prim * 3 + bestAxis] - lo) * scale));
+                return b < bestSplit;
+            });
+            mid = static_cast<uint32_t>(split - order_.data());
+        } else {
+            // Coincident centroids: any split is as good as another
+            if (count <= kMaxLeafSize) return makeLeafNode(index, first, count);
+            mid = first + count / 2;
+        }
+
+        // Popped left first
+        pending_.push_back({index << 1 | 1, mid, first + count - mid});
+        pending_.push_back({index << 1, first, mid - first});
+    }
+
+    void makeLeafNode(uint32_t index, uint32_t first, uint32_t count) {
+        nodes_[index].leaf = true;
+        nodes_[index].first = first;
+        nodes_[index].count = count;
+    }
+
+    const std::vector<Aabb>& boxes_;
+    std::vector<uint32_t>& order_;
+    std::vector<float> centroids_;
+    std::vector<BuildNode> nodes_;
+    std::vector<Task> pending_;
+};
+
+inline void Cross(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline float Dot(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Moller-Trumbore, two-sided. The barycentric and distance tests run on the
+// numerators against |det|, so only a hit pays for the divide.
+inline bool IntersectTriangle(const Triangle& tri, const float origin[3], const float dir[3], float& t, float& u, float& v) {
+    float p[3];
+    Cross(dir, tri.e2, p);
+    float det = Dot(tri.e1, p);
+    if (std::fabs(det) < 1e-12f) return false;
+    float absDet = std::fabs(det), sign = det < 0.0f ? -1.0f : 1.0f;
+    float s[3] = {origin[0] - tri.v0[0], origin[1] - tri.v0[1], origin[2] - tri.v0[2]};
+    float uNum = Dot(s, p) * sign;
+    if (uNum < 0.0f || uNum > absDet) return false;
+    float q[3];
+    Cross(s, tri.e1, q);
+    float vNum = Dot(dir, q) * sign;
+    if (vNum < 0.0f || uNum + vNum > absDet) return false;
+    float tNum = Dot(tri.e2, q) * sign;
+    if (tNum < 0.0f) return false;
+    float inv = 1.0f / absDet;
+    u = uNum * inv;
+    v = vNum * inv;
+    t = tNum * inv;
+    return true;
+}
+
+// IntersectTriangle for the packet lanes in rays, with the same arithmetic
+// per lane. Returns the lanes that hit.
+inline uint32_t IntersectTrianglePacket(const Triangle& tri, const RayPacket& packet, uint32_t rays,
+                                        float t[4], float u[4], float v[4]) {
+#if ARENA_PHYS_SSE
+    const __m128 dx = _mm_load_ps(packet.dir[0]), dy = _mm_load_ps(packet.dir[1]), dz = _mm_load_ps(packet.dir[2]);
+    const __m128 e1x = _mm_set1_ps(tri.e1[0]), e1y = _mm_set1_ps(tri.e1[1]), e1z = _mm_set1_ps(tri.e1[2]);
+    const __m128 e2x = _mm_set1_ps(tri.e2[0]), e2y = _mm_set1_ps(tri.e2[1]), e2z = _mm_set1_ps(tri.e2[2]);
+    const __m128 zero = _mm_setzero_ps(), signBit = _mm_set1_ps(-0.0f);
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    __m128 absDet = _mm_andnot_ps(signBit, det);
+    // Flipping the sign bit where det < 0 is the scalar path's * -1
+    __m128 sign = _mm_and_ps(_mm_cmplt_ps(det, zero), signBit);
+    __m128 sx = _mm_sub_ps(_mm_load_ps(packet.origin[0]), _mm_set1_ps(tri.v0[0]));
+    __m128 sy = _mm_sub_ps(_mm_load_ps(packet.origin[1]), _mm_set1_ps(tri.v0[1]));
+    __m128 sz = _mm_sub_ps(_mm_load_ps(packet.origin[2]), _mm_set1_ps(tri.v0[2]));
+    __m128 uNum = _mm_xor_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), sign);
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 vNum = _mm_xor_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), sign);
+    __m128 tNum = _mm_xor_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), sign);
+    __m128 miss = _mm_or_ps(_mm_cmplt_ps(absDet, _mm_set1_ps(1e-12f)), _mm_cmplt_ps(uNum, zero));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(uNum, absDet), _mm_cmplt_ps(vNum, zero)));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(_mm_add_ps(uNum, vNum), absDet), _mm_cmplt_ps(tNum, zero)));
+    uint32_t hits = ~static_cast<uint32_t>(_mm_movemask_ps(miss)) & rays;
+    if (!hits) return 0;
+    __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), absDet);
+    _mm_storeu_ps(t, _mm_mul_ps(tNum, inv));
+    _mm_storeu_ps(u, _mm_mul_ps(uNum, inv));
+    _mm_storeu_ps(v, _mm_mul_ps(vNum, inv));
+    return hits;
+#else
+    uint32_t hits = 0;
+    for (uint32_t r = 0; r < 4; ++r) {
+        if (!(rays & (1u << r))) continue;
+        float o[3] = {packet.origin[0][r], packet.origin[1][r], packet.origin[2][r]};
+        float d[3] = {packet.dir[0][r], packet.dir[1][r], packet.dir[2][r]};
+        if (IntersectTriangle(tri, o, d, t[r], u[r], v[r])) hits |= 1u << r;
+    }
+    return hits;
+#endif
+}
+
+} // namespace
+
+Triangle Triangle::fromVertices(const float a[3], const float b[3], const float c[3], uint32_t id) {
+    Triangle t;
+    for (int i = 0; i < 3; ++i) {
+        t.v0[i] = a[i];
+        t.e1[i] = b[i] - a[i];
+        t.e2[i] = c[i] - a[i];
+    }
+    t.id = id;
+    return t;
+}
+
+Aabb Triangle::bounds() const {
+    Aabb box;
+    float v1[3] = {v0[0] + e1[0], v0[1] + e1[1], v0[2] + e1[2]};
+    float v2[3] = {v0[0] + e2[0], v0[1] + e2[1], v0[2] + e2[2]};
+    box.grow(v0);
+    box.grow(v1);
+    box.grow(v2);
+    return box;
+}
+
+Ray4::Ray4(const float o[3], const float d[3], float tMax_) : tMax(tMax_) {
+    // Read both before writing, as o or d may point into this ray
+    const float ox = o[0], oy = o[1], oz = o[2], dx = d[0], dy = d[1], dz = d[2];
+    origin[0] = ox; origin[1] = oy; origin[2] = oz;
+    dir[0] = dx; dir[1] = dy; dir[2] = dz;
+#if ARENA_PHYS_SSE
+    // Avoid inf * 0 = NaN in the slab test for axis-parallel rays, then one
+    // packed divide; branch free, as ray signs are a coin toss
+    const __m128 signBit = _mm_set1_ps(-0.0f), tiny = _mm_set1_ps(1e-30f);
+    __m128 dv = _mm_setr_ps(dx, dy, dz, 1.0f);
+    __m128 big = _mm_cmpgt_ps(_mm_andnot_ps(signBit, dv), tiny);
+    __m128 safe = _mm_or_ps(_mm_and_ps(big, dv), _mm_andnot_ps(big, _mm_or_ps(_mm_and_ps(dv, signBit), tiny)));
+    float inv[4];
+    _mm_storeu_ps(inv, _mm_div_ps(_mm_set1_ps(1.0f), safe));
+    uint32_t negative = static_cast<uint32_t>(_mm_movemask_ps(safe));
+    for (uint32_t a = 0; a < 3; ++a) {
+        invDir[a] = inv[a];
+        // Node4 stores minX, minY, minZ then maxX, maxY, maxZ, four floats each
+        uint32_t flip = 12u * ((negative >> a) & 1u);
+        nearSlab[a] = 4u * a + flip;
+        farSlab[a] = 4u * a + 12u - flip;
+    }
+#else
+    for (int a = 0; a < 3; ++a) {
+        float safe = std::fabs(dir[a]) > 1e-30f ? dir[a] : (std::signbit(dir[a]) ? -1e-30f : 1e-30f);
+        invDir[a] = 1.0f / safe;
+        nearSlab[a] = std::signbit(safe) ? 12u + 4u * a : 4u * a;
+        farSlab[a] = std::signbit(safe) ? 4u * a : 12u + 4u * a;
+    }
+#endif
+}
+
+bool buildBvh4(const std::vector<Aabb>& primBounds, std::vector<Node4>& nodes, std::vector<uint32_t>& order) {
+    nodes.clear();
+    order.resize(primBounds.size());
+    if (primBounds.empty()) return false;
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    Builder builder(primBounds, order);
+    builder.start(0, static_cast<uint32_t>(primBounds.size()));
+    builder.step(SIZE_MAX);
+    builder.finish(nodes);
+    return true;
+}
+
+struct Bvh4Builder::State {
+    std::vector<Aabb> boxes;
+    std::vector<uint32_t> order;
+    Builder builder;
+
+    explicit State(std::vector<Aabb> primBounds)
+        : boxes(std::move(primBounds)), order(boxes.size()), builder(boxes, order) {
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        if (!boxes.empty()) builder.start(0, static_cast<uint32_t>(boxes.size()));
+    }
+};
+
+Bvh4Builder::Bvh4Builder(std::vector<Aabb> primBounds) : state_(std::make_unique<State>(std::move(primBounds))) {}
+
+Bvh4Builder::~Bvh4Builder() = default;
+
+bool Bvh4Builder::step(size_t work) { return state_->builder.step(work); }
+
+bool Bvh4Builder::finish(std::vector<Node4>& nodes, std::vector<uint32_t>& order) {
+    nodes.clear();
+    order = std::move(state_->order);
+    if (state_->boxes.empty()) return false;
+    state_->builder.finish(nodes);
+    return true;
+}
+
+bool intersect(const BlasView& blas, const Ray4& ray, TriangleHit& best) {
+    if (blas.nodeCount == 0) return false;
+
+    bool improved = false;
+    traverseBvh4(blas.nodes, ray, best.t, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            const Triangle& tri = blas.tris[i];
+            float t, u, v;
+            if (!IntersectTriangle(tri, ray.origin, ray.dir, t, u, v)) continue;
+            if (t < best.t || (t == best.t && tri.id < best.id)) {
+                best = {t, u, v, i, tri.id};
+                improved = true;
+            }
+        }
+        return best.t;
+    });
+    return improved;
+}
+
+void RayPacket::prepare() {
+    for (int a = 0; a < 3; ++a) {
+        // Node4 offsets as in Ray4, taken from lane 0's octant
+        bool negative = std::signbit(dir[a][0]);
+        nearSlab[a] = negative ? 12u + 4u * a : 4u * a;
+        farSlab[a] = negative ? 4u * a : 12u + 4u * a;
+#if ARENA_PHYS_SSE
+        // Ray4's safe direction and packed divide, four lanes at once
+        const __m128 signBit = _mm_set1_ps(-0.0f), tiny = _mm_set1_ps(1e-30f);
+        __m128 d = _mm_load_ps(dir[a]);
+        __m128 big = _mm_cmpgt_ps(_mm_andnot_ps(signBit, d), tiny);
+        __m128 safe = _mm_or_ps(_mm_and_ps(big, d), _mm_andnot_ps(big, _mm_or_ps(_mm_and_ps(d, signBit), tiny)));
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), safe);
+        _mm_store_ps(invDir[a], inv);
+
+        auto reduce = [](__m128 v, auto op) {
+            v = op(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return op(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        };
+        auto min = [](__m128 x, __m128 y) { return _mm_min_ps(x, y); };
+        auto max = [](__m128 x, __m128 y) { return _mm_max_ps(x, y); };
+        __m128 o = _mm_load_ps(origin[a]);
+        __m128 lowest = reduce(o, min), highest = reduce(o, max);
+        _mm_store_ps(nearOrigin[a], negative ? lowest : highest);
+        _mm_store_ps(farOrigin[a], negative ? highest : lowest);
+        _mm_store_ps(invLow[a], reduce(inv, min));
+        _mm_store_ps(invHigh[a], reduce(inv, max));
+#else
+        for (int i = 0; i < 4; ++i) {
+            float d = dir[a][i];
+            float safe = std::fabs(d) > 1e-30f ? d : (std::signbit(d) ? -1e-30f : 1e-30f);
+            invDir[a][i] = 1.0f / safe;
+        }
+        float lowest = *std::min_element(origin[a], origin[a] + 4);
+        float highest = *std::max_element(origin[a], origin[a] + 4);
+        float low = *std::min_element(invDir[a], invDir[a] + 4);
+        float high = *std::max_element(invDir[a], invDir[a] + 4);
+        for (int i = 0; i < 4; ++i) {
+            nearOrigin[a][i] = negative ? lowest : highest;
+            farOrigin[a][i] = negative ? highest : lowest;
+            invLow[a][i] = low;
+            invHigh[a][i] = high;
+        }
+#endif
+    }
+}
+
+uint32_t intersectPacket(const BlasView& blas, const RayPacket& packet, uint32_t rays, TriangleHit best[4]) {
+    if (blas.nodeCount == 0) return 0;
+
+    float tMax[4] = {best[0].t, best[1].t, best[2].t, best[3].t};
+    uint32_t improved = 0;
+    traversePacket4(blas.nodes, packet, tMax, rays, [&](uint32_t first, uint32_t count, uint32_t active) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            const Triangle& tri = blas.tris[i];
+            float t[4], u[4], v[4];
+            for (uint32_t m = IntersectTrianglePacket(tri, packet, active, t, u, v); m; m &= m - 1) {
+                uint32_t r = static_cast<uint32_t>(std::countr_zero(m));
+                if (t[r] < best[r].t || (t[r] == best[r].t && tri.id < best[r].id)) {
+                    best[r] = {t[r], u[r], v[r], i, tri.id};
+                    tMax[r] = t[r];
+                    improved |= 1u << r;
+                }
+            }
+        }
+    });
+    return improved;
+}
+
+Blas Blas::build(std::vector<Triangle> triangles) {
+    Blas blas;
+    std::vector<Aabb> boxes(triangles.size());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        boxes[i] = triangles[i].bounds();
+        blas.bounds.grow(boxes[i]);
+    }
+
+    std::vector<uint32_t> order;
+    buildBvh4(boxes, blas.nodes, order);
+
+    blas.tris.resize(triangles.size());
+    for (size_t i = 0; i < order.size(); ++i) blas.tris[i] = triangles[order[i]];
+    return blas;
+}
+
+} // namespace arena::phys
@@ -0,0 +1,231 @@
+#include "arena/phys/bvh_cache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <type_traits>
+
+namespace arena::phys {
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'R', 'E', 'N', 'A', 'B', 'V', 'H'};
+constexpr uint32_t kByteOrder = 0x01020304u;
+constexpr uint64_t kSectionAlign = 64;
+
+static_assert(std::is_trivially_copyable_v<Node4> && std::is_trivially_copyable_v<Triangle>,
+              "cached BVH data is written and mapped as raw bytes");
+static_assert(sizeof(Triangle) == 40, "Triangle layout is part of the cache format");
+
+uint64_t AlignUp(uint64_t v) { return (v + kSectionAlign - 1) & ~(kSectionAlign - 1); }
+
+// count elements of elemSize starting at offset fit in a file of size bytes
+bool InRange(uint64_t offset, uint64_t count, uint64_t elemSize, uint64_t size) {
+    return offset <= size && count <= (size - offset) / elemSize;
+}
+
+uint64_t Rotl(uint64_t v, int s) { return (v << s) | (v >> (64 - s)); }
+
+uint64_t Mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+class Writer {
+public:
+    explicit Writer(const std::string& path) : out_(path, std::ios::binary | std::ios::trunc) {}
+
+    bool ok() const { return static_cast<bool>(out_); }
+    uint64_t offset() const { return offset_; }
+
+    void bytes(const void* data, uint64_t size) {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        offset_ += size;
+    }
+    void padTo(uint64_t target) {
+        static const char zeros[kSectionAlign] = {};
+        while (offset_ < target) bytes(zeros, std::min<uint64_t>(kSectionAlign, target - offset_));
+    }
+    bool close() {
+        out_.close();
+        return static_cast<bool>(out_);
+    }
+
+private:
+    std::ofstream out_;
+    uint64_t offset_ = 0;
+};
+
+// The writer only stores freshly built trees: every node has one to four
+// lanes, inner children come after their parent (so there are no cycles) and
+// leaves index within leafLimit
+bool ValidTree(const Node4* nodes, uint32_t nodeCount, uint32_t leafLimit) {
+    for (uint32_t n = 0; n < nodeCount; ++n) {
+        const Node4& node = nodes[n];
+        if (node.count == 0 || node.count > 4) return false;
+        for (uint32_t lane = 0; lane < node.count; ++lane) {
+            uint32_t child = node.child[lane];
+            bool ok = isLeaf(child) ? leafFirst(child) + leafCount(child) <= leafLimit
+                                    : child > n && child < nodeCount;
+            if (!ok) return false;
+        }
+    }
+    return true;
+}
+
+void CopyBounds(const Aabb& box, float min[3], float max[3]) {
+    std::memcpy(min, box.min, sizeof(box.min));
+    std::memcpy(max, box.max, sizeof(box.max));
+}
+
+} // namespace
+
+uint64_t hashTriangles(std::span<const Triangle> tris, uint64_t seed) {
+    // Word-at-a-time multiply/rotate over the raw triangle bytes, then a final mix
+    uint64_t h = seed ^ (static_cast<uint64_t>(tris.size()) * 0x9e3779b97f4a7c15ull);
+    const auto* p = reinterpret_cast<const uint8_t*>(tris.data());
+    size_t bytes = tris.size_bytes();
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = Rotl(h ^ (w * 0x87c37b91114253d5ull), 31) * 0x4cf5ad432745937full;
+    }
+    for (; i < bytes; ++i) h = (h ^ p[i]) * 0x100000001b3ull;
+    return Mix(h);
+}
+
+bool writeBvhCache(const std::string& path, uint64_t contentHash, std::span<const Node4> tlas,
+                   std::span<const uint32_t> tlasOrder, std::span<const Blas> meshes, const Aabb& bounds,
+                   uint64_t triangleCount) {
+    if (meshes.empty() || tlas.empty() || tlasOrder.size() != meshes.size()) return false;
+
+    // Lay the sections out first so the header and mesh table can go out in one pass
+    BvhCacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kBvhCacheVersion;
+    header.byteOrder = kByteOrder;
+    header.nodeSize = sizeof(Node4);
+    header.triangleSize = sizeof(Triangle);
+    header.contentHash = contentHash;
+    header.triangleCount = triangleCount;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.tlasNodeCount = static_cast<uint32_t>(tlas.size());
+    CopyBounds(bounds, header.boundsMin, header.boundsMax);
+
+    uint64_t offset = AlignUp(sizeof(BvhCacheHeader));
+    header.meshTableOffset = offset;
+    offset = AlignUp(offset + meshes.size() * sizeof(BvhCacheMesh));
+    header.tlasOffset = offset;
+    offset += tlas.size_bytes();
+    header.tlasOrderOffset = offset;
+    offset += tlasOrder.size_bytes();
+
+    std::vector<BvhCacheMesh> table(meshes.size());
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        const Blas& blas = meshes[m];
+        BvhCacheMesh& entry = table[m];
+        entry.nodeCount = static_cast<uint32_t>(blas.nodes.size());
+        entry.triCount = static_cast<uint32_t>(blas.tris.size());
+        CopyBounds(blas.bounds, entry.boundsMin, entry.boundsMax);
+        entry.nodesOffset = offset = AlignUp(offset);
+        offset += blas.nodes.size() * sizeof(Node4);
+        entry.trisOffset = offset = AlignUp(offset);
+        offset += blas.tris.size() * sizeof(Triangle);
+    }
+    header.fileSize = offset;
+
+    // Unique temporary next to the target, renamed over it once complete
+    uint64_t salt = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                    std::hash<std::thread::id>{}(std::this_thread::get_id());
+    std::string temp = path + ".tmp" + std::to_string(salt & 0xffffffu);
+    {
+        Writer out(temp);
+        if (!out.ok()) return false;
+        out.bytes(&header, sizeof(header));
+        out.padTo(header.meshTableOffset);
+        out.bytes(table.data(), table.size() * sizeof(BvhCacheMesh));
+        out.padTo(header.tlasOffset);
+        out.bytes(tlas.data(), tlas.size_bytes());
+        out.bytes(tlasOrder.data(), tlasOrder.size_bytes());
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            out.padTo(table[m].nodesOffset);
+            out.bytes(meshes[m].nodes.data(), meshes[m].nodes.size() * sizeof(Node4));
+            out.padTo(table[m].trisOffset);
+            out.bytes(meshes[m].tris.data(), meshes[m].tris.size() * sizeof(Triangle));
+        }
+        if (!out.close() || out.offset() != header.fileSize) {
+            std::error_code ignored;
+            std::filesystem::remove(temp, ignored);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<MappedBvh> MappedBvh::open(const std::string& path, uint64_t contentHash) {
+    auto bvh = std::unique_ptr<MappedBvh>(new MappedBvh());
+    if (!bvh->file_.open(path)) return nullptr;
+
+    // The mapping is page aligned, so every 64-byte aligned offset is too
+    const uint8_t* base = bvh->file_.data();
+    uint64_t size = bvh->file_.size();
+    if (size < sizeof(BvhCacheHeader)) return nullptr;
+    const auto& h = *reinterpret_cast<const BvhCacheHeader*>(base);
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kBvhCacheVersion ||
+        h.byteOrder != kByteOrder || h.nodeSize != sizeof(Node4) || h.triangleSize != sizeof(Triangle)) {
+        return nullptr;
+    }
+    if (h.contentHash != contentHash || h.fileSize != size || h.meshCount == 0 || h.tlasNodeCount == 0) {
+        return nullptr;
+    }
+    if (h.meshTableOffset % kSectionAlign || h.tlasOffset % kSectionAlign || h.tlasOrderOffset % sizeof(uint32_t) ||
+        !InRange(h.meshTableOffset, h.meshCount, sizeof(BvhCacheMesh), size) ||
+        !InRange(h.tlasOffset, h.tlasNodeCount, sizeof(Node4), size) ||
+        !InRange(h.tlasOrderOffset, h.meshCount, sizeof(uint32_t), size)) {
+        return nullptr;
+    }
+
+    const auto* table = reinterpret_cast<const BvhCacheMesh*>(base + h.meshTableOffset);
+    const auto* order = reinterpret_cast<const uint32_t*>(base + h.tlasOrderOffset);
+    bvh->meshes_.resize(h.meshCount);
+    bvh->meshBounds_.resize(h.meshCount);
+    for (uint32_t m = 0; m < h.meshCount; ++m) {
+        const BvhCacheMesh& entry = table[m];
+        if (order[m] >= h.meshCount || entry.nodeCount == 0 || entry.nodesOffset % kSectionAlign ||
+            entry.trisOffset % alignof(Triangle) || !InRange(entry.nodesOffset, entry.nodeCount, sizeof(Node4), size) ||
+            !InRange(entry.trisOffset, entry.triCount, sizeof(Triangle), size)) {
+            return nullptr;
+        }
+        auto* nodes = reinterpret_cast<const Node4*>(base + entry.nodesOffset);
+        if (!ValidTree(nodes, entry.nodeCount, entry.triCount)) return nullptr;
+        bvh->meshes_[m] = {nodes, reinterpret_cast<const Triangle*>(base + entry.trisOffset), entry.nodeCount,
+                           entry.triCount};
+        std::memcpy(bvh->meshBounds_[m].min, entry.boundsMin, sizeof(entry.boundsMin));
+        std::memcpy(bvh->meshBounds_[m].max, entry.boundsMax, sizeof(entry.boundsMax));
+    }
+
+    bvh->tlas_ = reinterpret_cast<const Node4*>(base + h.tlasOffset);
+    if (!ValidTree(bvh->tlas_, h.tlasNodeCount, h.meshCount)) return nullptr;
+    bvh->tlasOrder_ = order;
+    std::memcpy(bvh->bounds_.min, h.boundsMin, sizeof(h.boundsMin));
+    std::memcpy(bvh->bounds_.max, h.boundsMax, sizeof(h.boundsMax));
+    bvh->triangleCount_ = h.triangleCount;
+    return bvh;
+}
+
+} // namespace arena::phys
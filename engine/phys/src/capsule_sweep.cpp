@@ -0,0 +1,195 @@
+#include "arena/phys/capsule_sweep.hpp"
+#include <cmath>
+
+namespace arena::phys {
+
+namespace {
+
+constexpr float kTiny = 1e-12f;
+// Slack on the culling bounds so contacts exactly on a box face aren't lost
+constexpr float kBoundsSlack = 1e-4f;
+
+struct V3 {
+    float x, y, z;
+};
+
+inline V3 Load(const float p[3]) { return {p[0], p[1], p[2]}; }
+inline V3 operator+(V3 a, V3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline V3 operator-(V3 a, V3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline V3 operator-(V3 a) { return {-a.x, -a.y, -a.z}; }
+inline V3 operator*(V3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+inline float Dot(V3 a, V3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline V3 Cross(V3 a, V3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+inline V3 NormalizeOr(V3 v, V3 fallback) {
+    float len2 = Dot(v, v);
+    return len2 > kTiny ? v * (1.0f / std::sqrt(len2)) : fallback;
+}
+
+// Earliest contact among the features of one triangle
+struct Contact {
+    float t;
+    V3 normal;
+    bool found = false;
+
+    void consider(float tc, V3 n) {
+        if (tc < 0.0f || tc > t) return;
+        if (found && tc == t) return; // first feature wins ties within a triangle
+        t = tc;
+        normal = n;
+        found = true;
+    }
+};
+
+// Point p (already in the polygon's plane) inside the triangle o + a*s + b*u,
+// s, u >= 0, s + u <= 1; or the parallelogram s, u in [0, 1]
+inline bool Inside(V3 p, V3 o, V3 a, V3 b, bool parallelogram) {
+    V3 w = p - o;
+    float aa = Dot(a, a), ab = Dot(a, b), bb = Dot(b, b);
+    float wa = Dot(w, a), wb = Dot(w, b);
+    float denom = aa * bb - ab * ab;
+    if (std::fabs(denom) <= kTiny) return false;
+    float s = (bb * wa - ab * wb) / denom;
+    float u = (aa * wb - ab * wa) / denom;
+    if (s < 0.0f || u < 0.0f) return false;
+    return parallelogram ? (s <= 1.0f && u <= 1.0f) : (s + u <= 1.0f);
+}
+
+// Polygon (triangle or parallelogram o, a, b with unit normal n) grown by r:
+// the centre meets one of its two offset faces
+void Face(V3 c, V3 d, V3 o, V3 a, V3 b, V3 n, float r, bool parallelogram, Contact& contact) {
+    for (float side : {1.0f, -1.0f}) {
+        V3 ns = n * side;
+        float dist = Dot(c - o, ns);
+        float approach = Dot(d, ns);
+        if (dist < 0.0f || approach >= 0.0f) continue; // behind this side, or moving away
+        float t = dist > r ? (dist - r) / -approach : 0.0f;
+        if (t > contact.t) continue;
+        V3 at = c + d * t;
+        V3 onPlane = at - ns * Dot(at - o, ns);
+        if (Inside(onPlane, o, a, b, parallelogram)) contact.consider(t, ns);
+    }
+}
+
+// Sphere of radius r around q
+void Sphere(V3 c, V3 d, V3 q, float r, Contact& contact) {
+    V3 m = c - q;
+    float b = Dot(m, d);
+    if (b >= 0.0f) return; // not closing in
+    float cc = Dot(m, m) - r * r;
+    if (cc <= 0.0f) {
+        contact.consider(0.0f, NormalizeOr(m, -d));
+        return;
+    }
+    float a = Dot(d, d);
+    float disc = b * b - a * cc;
+    if (disc < 0.0f) return;
+    float t = (-b - std::sqrt(disc)) / a;
+    contact.consider(t, (c + d * t - q) * (1.0f / r));
+}
+
+// Side of the cylinder of radius r around segment p..q (the ends are spheres)
+void Cylinder(V3 c, V3 d, V3 p, V3 q, float r, Contact& contact) {
+    V3 e = q - p;
+    float ee = Dot(e, e);
+    if (ee <= kTiny) return;
+    V3 m = c - p;
+    V3 dr = d - e * (Dot(d, e) / ee); // components across the axis
+    V3 mr = m - e * (Dot(m, e) / ee);
+    float b = Dot(mr, dr);
+    if (b >= 0.0f) return;
+    float cc = Dot(mr, mr) - r * r;
+    if (cc <= 0.0f) {
+        float s = Dot(m, e) / ee;
+        if (s >= 0.0f && s <= 1.0f) contact.consider(0.0f, NormalizeOr(mr, -d));
+        return;
+    }
+    float a = Dot(dr, dr);
+    if (a <= kTiny) return;
+    float disc = b * b - a * cc;
+    if (disc < 0.0f) return;
+    float t = (-b - std::sqrt(disc)) / a;
+    if (t > contact.t) return;
+    V3 at = c + d * t;
+    float s = Dot(at - p, e) / ee;
+    if (s < 0.0f || s > 1.0f) return;
+    contact.consider(t, (at - p - e * s) * (1.0f / r));
+}
+
+} // namespace
+
+SweptBounds::SweptBounds(const CapsuleSweep& sweep) : ray(sweep.center, sweep.delta, 1.0f) {
+    for (int a = 0; a < 3; ++a) ext[a] = std::fabs(sweep.axis[a]) + sweep.radius + kBoundsSlack;
+}
+
+bool sweepTriangle(const CapsuleSweep& sweep, const Triangle& tri, SweepHit& best) {
+    const V3 c = Load(sweep.center), d = Load(sweep.delta), axis = Load(sweep.axis);
+    const float r = sweep.radius;
+    const V3 v[3] = {Load(tri.v0), Load(tri.v0) + Load(tri.e1), Load(tri.v0) + Load(tri.e2)};
+
+    // Cheap reject: triangle bounds against the bounds swept up to the best contact
+    for (int a = 0; a < 3; ++a) {
+        float c0 = sweep.center[a], c1 = c0 + sweep.delta[a] * best.t;
+        float ext = std::fabs(sweep.axis[a]) + r;
+        float lo = std::fmin(c0, c1) - ext, hi = std::fmax(c0, c1) + ext;
+        float tmin = std::fmin(tri.v0[a], std::fmin(tri.v0[a] + tri.e1[a], tri.v0[a] + tri.e2[a]));
+        float tmax = std::fmax(tri.v0[a], std::fmax(tri.v0[a] + tri.e1[a], tri.v0[a] + tri.e2[a]));
+        if (tmax < lo || tmin > hi) return false;
+    }
+
+    Contact contact;
+    contact.t = best.t;
+    const bool hasAxis = Dot(axis, axis) > kTiny;
+    const float shifts[2] = {-1.0f, 1.0f};
+    const int shiftCount = hasAxis ? 2 : 1;
+
+    // Faces: the triangle at either end of the core segment
+    V3 e1 = Load(tri.e1), e2 = Load(tri.e2);
+    V3 faceNormal = Cross(e1, e2);
+    if (Dot(faceNormal, faceNormal) > kTiny) {
+        faceNormal = NormalizeOr(faceNormal, faceNormal);
+        for (int s = 0; s < shiftCount; ++s) Face(c, d, v[0] + axis * shifts[s], e1, e2, faceNormal, r, false, contact);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        V3 p = v[i], q = v[(i + 1) % 3];
+        // Edges against the ends of the core segment, and their end spheres
+        for (int s = 0; s < shiftCount; ++s) {
+            V3 shift = axis * shifts[s];
+            Cylinder(c, d, p + shift, q + shift, r, contact);
+            Sphere(c, d, p + shift, r, contact);
+        }
+        if (!hasAxis) continue;
+        // Edges against the side of the capsule: the flat face swept by the edge
+        // along the segment, and the vertex against the side
+        V3 sideNormal = Cross(q - p, axis);
+        if (Dot(sideNormal, sideNormal) > kTiny) {
+            Face(c, d, p - axis, q - p, axis * 2.0f, NormalizeOr(sideNormal, sideNormal), r, true, contact);
+        }
+        Cylinder(c, d, p - axis, p + axis, r, contact);
+    }
+
+    if (!contact.found) return false;
+    if (contact.t == best.t && best.id != UINT32_MAX && tri.id >= best.id) return false;
+    best.t = contact.t;
+    best.normal[0] = contact.normal.x;
+    best.normal[1] = contact.normal.y;
+    best.normal[2] = contact.normal.z;
+    best.id = tri.id;
+    return true;
+}
+
+bool sweep(const BlasView& blas, const CapsuleSweep& capsule, SweepHit& best) {
+    if (blas.nodeCount == 0) return false;
+    SweptBounds bounds(capsule);
+    bool improved = false;
+    traverseBvh4With(blas.nodes, best.t, [&](const Node4& node, float tMax, float tEntry[4]) {
+        return intersectNodeExpanded(node, bounds.ray, bounds.ext, tMax, tEntry);
+    }, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; ++i) improved |= sweepTriangle(capsule, blas.tris[i], best);
+        return best.t;
+    });
+    return improved;
+}
+
+} // namespace arena::phys
@@ -0,0 +1,697 @@
+#include "arena/phys/static_world.hpp"
+#include "arena/log.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <utility>
+
+namespace arena::phys {
+
+namespace {
+
+// Batches at least this large are split across the task pool
+constexpr size_t kParallelBatch = 4096;
+constexpr size_t kParallelGrain = 1024;
+
+// Batches are sorted and packed into packets this many rays at a time
+constexpr size_t kPacketBlock = 256;
+// Rays share a packet when they start in the same cell of this size (m),
+// have the same direction octant and point within acos(kPacketMinCos) of
+// the packet's first ray
+constexpr float kPacketCell = 1.0f;
+constexpr float kPacketMinCos = 0.95f;
+
+void TransformPoint(const Mat4& m, const float* p, float out[3]) {
+    for (int r = 0; r < 3; ++r) {
+        out[r] = m.m[r] * p[0] + m.m[4 + r] * p[1] + m.m[8 + r] * p[2] + m.m[12 + r];
+    }
+}
+
+// No TLAS parent (the root) or no TLAS leaf (a removed mesh)
+constexpr uint32_t kNoSlot = UINT32_MAX;
+
+Aabb LaneBounds(const Node4& node, uint32_t lane) {
+    Aabb box;
+    box.min[0] = node.minX[lane];
+    box.min[1] = node.minY[lane];
+    box.min[2] = node.minZ[lane];
+    box.max[0] = node.maxX[lane];
+    box.max[1] = node.maxY[lane];
+    box.max[2] = node.maxZ[lane];
+    return box;
+}
+
+void SetLane(Node4& node, uint32_t lane, const Aabb& box) {
+    node.minX[lane] = box.min[0];
+    node.minY[lane] = box.min[1];
+    node.minZ[lane] = box.min[2];
+    node.maxX[lane] = box.max[0];
+    node.maxY[lane] = box.max[1];
+    node.maxZ[lane] = box.max[2];
+}
+
+Aabb NodeBounds(const Node4& node) {
+    Aabb box;
+    for (uint32_t lane = 0; lane < node.count; ++lane) box.grow(LaneBounds(node, lane));
+    return box;
+}
+
+// Unit direction so t is a distance; false if the ray can't hit anything
+bool UnitRay(const Vec3& origin, const Vec3& dir, float maxDist, float o[3], float d[3]) {
+    float len = std::sqrt(dir.x * dir.x + dir.y * dir.y + dir.z * dir.z);
+    if (len <= 0.0f || !(maxDist > 0.0f)) return false;
+    o[0] = origin.x;
+    o[1] = origin.y;
+    o[2] = origin.z;
+    d[0] = dir.x / len;
+    d[1] = dir.y / len;
+    d[2] = dir.z / len;
+    return true;
+}
+
+// Origin cell coordinate on one axis, clamped into 16 bits
+uint64_t PacketCell(float v) {
+    float c = v / kPacketCell + 32768.0f;
+    c = c > 0.0f ? c : 0.0f; // also catches NaN
+    c = c < 65535.0f ? c : 65535.0f;
+    return static_cast<uint64_t>(static_cast<uint32_t>(c));
+}
+
+} // namespace
+
+StaticWorld::StaticWorld(MeshResolver resolver) : resolver_(std::move(resolver)) {}
+
+void StaticWorld::registerStaticMesh(MeshHandle mh, const Mat4& world) {
+    MeshGeometry geometry;
+    if (!resolver_ || !resolver_(mh, geometry)) {
+        ARENA_LOG_WARN(Phys, "registerStaticMesh: unknown mesh %u", mh.id);
+        return;
+    }
+
+    std::vector<float> transformed(geometry.positions.size());
+    for (size_t v = 0; v + 2 < geometry.positions.size(); v += 3) {
+        TransformPoint(world, &geometry.positions[v], &transformed[v]);
+    }
+    addTriangles(transformed, geometry.indices);
+}
+
+uint32_t StaticWorld::addTriangles(std::span<const float> positions, std::span<const uint32_t> indices) {
+    size_t vertexCount = positions.size() / 3;
+    std::vector<Triangle> triangles;
+    triangles.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) continue;
+        uint32_t id = nextTriangleId_ + static_cast<uint32_t>(triangles.size());
+        triangles.push_back(Triangle::fromVertices(&positions[indices[i] * 3], &positions[indices[i + 1] * 3],
+                                                   &positions[indices[i + 2] * 3], id));
+    }
+    if (triangles.empty()) return kNoMesh;
+    nextTriangleId_ += static_cast<uint32_t>(triangles.size());
+
+    uint32_t mesh = static_cast<uint32_t>(views_.size() + pending_.size());
+    triangleCount_ += triangles.size();
+    contentHash_ = hashTriangles(triangles, contentHash_);
+    if (batching_) {
+        pending_.push_back(std::move(triangles));
+        return mesh;
+    }
+
+    applyRebuild();
+    bool incremental = !mapped_ && tlasNodes_;
+    detachMapped();
+    meshes_.push_back(Blas::build(std::move(triangles)));
+    bounds_.grow(meshes_.back().bounds);
+    if (!incremental) {
+        rebuildTopLevel();
+        return mesh;
+    }
+
+    views_.push_back(meshes_.back().view());
+    meshSlot_.push_back(kNoSlot);
+    ++liveMeshes_;
+    insertTopLevel(mesh);
+    afterEdit(mesh);
+    return mesh;
+}
+
+bool StaticWorld::removeMesh(uint32_t mesh) {
+    if (mesh >= views_.size() || views_[mesh].nodeCount == 0) return false;
+
+    applyRebuild();
+    triangleCount_ -= views_[mesh].triCount;
+    contentHash_ = hashTriangles({}, contentHash_ ^ (0x9e3779b97f4a7c15ull * (mesh + 1ull)));
+    if (mapped_) {
+        detachMapped();
+        meshes_[mesh] = Blas{};
+        rebuildTopLevel();
+        return true;
+    }
+
+    meshes_[mesh] = Blas{};
+    views_[mesh] = {};
+    --liveMeshes_;
+    uint32_t slot = std::exchange(meshSlot_[mesh], kNoSlot);
+    refitLeaf(slot >> 2, slot & 3);
+    afterEdit(mesh);
+    return true;
+}
+
+void StaticWorld::beginBatch() { batching_ = true; }
+
+bool StaticWorld::endBatch(const std::string& cacheDir) {
+    if (!batching_) return false;
+    batching_ = false;
+    if (pending_.empty()) return false;
+
+    // The hash covers everything registered so far, so a hit replaces the whole world
+    std::string path;
+    if (!cacheDir.empty()) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "static_%016" PRIx64 ".bvh", contentHash_);
+        path = (std::filesystem::path(cacheDir) / name).string();
+        auto cached = MappedBvh::open(path, contentHash_);
+        if (cached && cached->triangleCount() == triangleCount_) {
+            discardRebuild();
+            mapped_ = std::move(cached);
+            meshes_.clear();
+            tlas_.clear();
+            tlasOrder_.clear();
+            tlasParent_.clear();
+            meshSlot_.clear();
+            pending_.clear();
+            views_.assign(mapped_->meshes().begin(), mapped_->meshes().end());
+            liveMeshes_ = views_.size();
+            tlasNodes_ = mapped_->tlas();
+            tlasSlots_ = mapped_->tlasOrder();
+            bounds_ = mapped_->bounds();
+            return true;
+        }
+    }
+
+    detachMapped();
+    for (auto& triangles : pending_) {
+        meshes_.push_back(Blas::build(std::move(triangles)));
+        bounds_.grow(meshes_.back().bounds);
+    }
+    pending_.clear();
+    rebuildTopLevel();
+
+    // Only a world of whole registrations can be cached; removals leave holes in the mesh ids
+    if (!path.empty() && liveMeshes_ == meshes_.size()) {
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        if (!writeBvhCache(path, contentHash_, tlas_, tlasOrder_, meshes_, bounds_, triangleCount_)) {
+            ARENA_LOG_WARN(Phys, "Couldn't write static BVH cache %s", path.c_str());
+        }
+    }
+    return false;
+}
+
+void StaticWorld::detachMapped() {
+    if (!mapped_) return;
+    auto views = mapped_->meshes();
+    auto boxes = mapped_->meshBounds();
+    meshes_.clear();
+    meshes_.reserve(views.size());
+    for (size_t m = 0; m < views.size(); ++m) {
+        Blas& blas = meshes_.emplace_back();
+        blas.nodes.assign(views[m].nodes, views[m].nodes + views[m].nodeCount);
+        blas.tris.assign(views[m].tris, views[m].tris + views[m].triCount);
+        blas.bounds = boxes[m];
+    }
+    mapped_.reset();
+}
+
+void StaticWorld::rebuildTopLevel() {
+    discardRebuild();
+    TopLevelBuild built;
+    std::vector<Aabb> boxes;
+    std::vector<uint32_t> ids;
+    views_.clear();
+    for (uint32_t m = 0; m < meshes_.size(); ++m) {
+        views_.push_back(meshes_[m].view());
+        if (meshes_[m].nodes.empty()) continue;
+        boxes.push_back(meshes_[m].bounds);
+        ids.push_back(m);
+    }
+    buildBvh4(boxes, built.nodes, built.order);
+    for (auto& slot : built.order) slot = ids[slot];
+    installTopLevel(std::move(built));
+}
+
+void StaticWorld::installTopLevel(TopLevelBuild built) {
+    tlas_ = std::move(built.nodes);
+    tlasOrder_ = std::move(built.order);
+    freeSlots_.clear();
+    tlasParent_.assign(tlas_.size(), kNoSlot);
+    meshSlot_.assign(views_.size(), kNoSlot);
+    liveMeshes_ = 0;
+    for (auto& view : views_) liveMeshes_ += view.nodeCount != 0;
+
+    for (uint32_t n = 0; n < tlas_.size(); ++n) {
+        const Node4& node = tlas_[n];
+        for (uint32_t lane = 0; lane < node.count; ++lane) {
+            uint32_t child = node.child[lane];
+            if (!isLeaf(child)) {
+                tlasParent_[child] = n << 2 | lane;
+                continue;
+            }
+            for (uint32_t i = leafFirst(child); i < leafFirst(child) + leafCount(child); ++i) {
+                meshSlot_[tlasOrder_[i]] = n << 2 | lane;
+            }
+        }
+    }
+    tlasNodes_ = tlas_.empty() ? nullptr : tlas_.data();
+    tlasSlots_ = tlasOrder_.data();
+    builtCost_ = topLevelCost();
+}
+
+void StaticWorld::startRebuild() {
+    std::vector<Aabb> boxes;
+    std::vector<uint32_t> ids;
+    boxes.reserve(liveMeshes_);
+    ids.reserve(liveMeshes_);
+    for (uint32_t m = 0; m < meshes_.size(); ++m) {
+        if (views_[m].nodeCount == 0) continue;
+        boxes.push_back(meshes_[m].bounds);
+        ids.push_back(m);
+    }
+    editedSinceSnapshot_.clear();
+    rebuild_ = std::make_unique<Bvh4Builder>(std::move(boxes));
+    rebuildIds_ = std::move(ids);
+}
+
+void StaticWorld::discardRebuild() {
+    rebuild_.reset();
+    editedSinceSnapshot_.clear();
+}
+
+bool StaticWorld::applyRebuild() {
+    if (!rebuild_ || !rebuild_->step(kRebuildSliceWork)) return false;
+    TopLevelBuild built;
+    rebuild_->finish(built.nodes, built.order);
+    rebuild_.reset();
+    for (auto& slot : built.order) slot = rebuildIds_[slot];
+    installTopLevel(std::move(built));
+
+    // Bring the snapshot up to date with the edits made while it was built
+    for (uint32_t mesh : editedSinceSnapshot_) {
+        bool live = views_[mesh].nodeCount != 0;
+        if (live && meshSlot_[mesh] == kNoSlot) {
+            insertTopLevel(mesh);
+        } else if (!live && meshSlot_[mesh] != kNoSlot) {
+            uint32_t slot = std::exchange(meshSlot_[mesh], kNoSlot);
+            refitLeaf(slot >> 2, slot & 3);
+        }
+    }
+    editedSinceSnapshot_.clear();
+    tlasNodes_ = tlas_.empty() ? nullptr : tlas_.data();
+    tlasSlots_ = tlasOrder_.data();
+
+    // builtCost_ is the fresh build's; if the replay alone has degraded it
+    // that far, build again from the current meshes
+    if (topLevelCost() > builtCost_ * kRebuildCostRatio) startRebuild();
+    return true;
+}
+
+void StaticWorld::finishRebuild() {
+    while (rebuild_) {
+        rebuild_->step(SIZE_MAX);
+        applyRebuild();
+    }
+}
+
+void StaticWorld::insertTopLevel(uint32_t mesh) {
+    const Aabb& box = meshes_[mesh].bounds;
+    uint32_t node = 0;
+    for (;;) {
+        Node4& current = tlas_[node];
+        if (current.count < 4) {
+            uint32_t lane = current.count++;
+            SetLane(current, lane, box);
+            current.child[lane] = makeLeaf(takeSlot(mesh), 1);
+            meshSlot_[mesh] = node << 2 | lane;
+            break;
+        }
+
+        // Least surface-area growth, then the smaller lane
+        uint32_t best = 0;
+        float bestGrowth = 0.0f, bestArea = 0.0f;
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            Aabb grown = LaneBounds(current, lane);
+            float area = grown.surfaceArea();
+            grown.grow(box);
+            float growth = grown.surfaceArea() - area;
+            if (lane == 0 || growth < bestGrowth || (growth == bestGrowth && area < bestArea)) {
+                best = lane;
+                bestGrowth = growth;
+                bestArea = area;
+            }
+        }
+        uint32_t child = current.child[best];
+        if (!isLeaf(child)) {
+            node = child;
+            continue;
+        }
+
+        // Full node over a leaf: push the leaf down into a new node beside the mesh
+        Node4 split{};
+        split.count = 2;
+        SetLane(split, 0, LaneBounds(current, best));
+        split.child[0] = child;
+        SetLane(split, 1, box);
+        split.child[1] = makeLeaf(takeSlot(mesh), 1);
+
+        uint32_t added = static_cast<uint32_t>(tlas_.size());
+        current.child[best] = added;
+        tlas_.push_back(split);
+        tlasParent_.push_back(node << 2 | best);
+        for (uint32_t i = leafFirst(child); i < leafFirst(child) + leafCount(child); ++i) {
+            if (meshSlot_[tlasOrder_[i]] != kNoSlot) meshSlot_[tlasOrder_[i]] = added << 2;
+        }
+        meshSlot_[mesh] = added << 2 | 1;
+        node = added;
+        break;
+    }
+    refitUp(node);
+}
+
+uint32_t StaticWorld::takeSlot(uint32_t mesh) {
+    if (freeSlots_.empty()) {
+        tlasOrder_.push_back(mesh);
+        return static_cast<uint32_t>(tlasOrder_.size() - 1);
+    }
+    uint32_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    tlasOrder_[slot] = mesh;
+    return slot;
+}
+
+void StaticWorld::refitLeaf(uint32_t node, uint32_t lane) {
+    uint32_t child = tlas_[node].child[lane];
+    Aabb box;
+    for (uint32_t i = leafFirst(child); i < leafFirst(child) + leafCount(child); ++i) {
+        if (views_[tlasOrder_[i]].nodeCount != 0) box.grow(meshes_[tlasOrder_[i]].bounds);
+    }
+    if (box.valid()) {
+        SetLane(tlas_[node], lane, box);
+    } else {
+        // Removed meshes still waiting to be replayed may point here too
+        for (uint32_t i = leafFirst(child); i < leafFirst(child) + leafCount(child); ++i) {
+            meshSlot_[tlasOrder_[i]] = kNoSlot;
+            freeSlots_.push_back(i);
+        }
+        removeLane(node, lane);
+    }
+    refitUp(node);
+}
+
+void StaticWorld::refitUp(uint32_t node) {
+    while (tlasParent_[node] != kNoSlot) {
+        uint32_t parent = tlasParent_[node] >> 2, lane = tlasParent_[node] & 3;
+        if (tlas_[node].count == 0) {
+            removeLane(parent, lane);
+        } else {
+            SetLane(tlas_[parent], lane, NodeBounds(tlas_[node]));
+        }
+        node = parent;
+    }
+}
+
+void StaticWorld::removeLane(uint32_t node, uint32_t lane) {
+    // Lanes stay packed: the last one moves into the hole
+    Node4& n = tlas_[node];
+    uint32_t last = --n.count;
+    if (lane == last) return;
+    SetLane(n, lane, LaneBounds(n, last));
+    uint32_t child = n.child[lane] = n.child[last];
+    if (!isLeaf(child)) {
+        tlasParent_[child] = node << 2 | lane;
+        return;
+    }
+    for (uint32_t i = leafFirst(child); i < leafFirst(child) + leafCount(child); ++i) {
+        if (meshSlot_[tlasOrder_[i]] != kNoSlot) meshSlot_[tlasOrder_[i]] = node << 2 | lane;
+    }
+}
+
+void StaticWorld::afterEdit(uint32_t mesh) {
+    tlasNodes_ = tlas_.data();
+    tlasSlots_ = tlasOrder_.data();
+    if (rebuild_) {
+        // Replayed once the rebuild lands; every edit has already advanced it a slice
+        editedSinceSnapshot_.push_back(mesh);
+    } else if (topLevelCost() > builtCost_ * kRebuildCostRatio) {
+        startRebuild();
+    }
+}
+
+float StaticWorld::topLevelCost() const {
+    if (!tlasNodes_) return 0.0f;
+    float rootArea = NodeBounds(tlasNodes_[0]).surfaceArea();
+    if (rootArea <= 0.0f) return 0.0f;
+
+    float cost = 0.0f;
+    TraversalStack<uint32_t, 64> stack;
+    stack.push(0);
+    while (!stack.empty()) {
+        const Node4& node = tlasNodes_[stack.pop()];
+        for (uint32_t lane = 0; lane < node.count; ++lane) {
+            float area = LaneBounds(node, lane).surfaceArea();
+            uint32_t child = node.child[lane];
+            if (isLeaf(child)) {
+                cost += area * static_cast<float>(leafCount(child));
+            } else {
+                cost += area;
+                stack.push(child);
+            }
+        }
+    }
+    return cost / rootArea;
+}
+
+bool StaticWorld::intersectAll(const Ray4& ray, TriangleHit& best, uint32_t& meshIndex) const {
+    if (!tlasNodes_) return false;
+
+    bool found = false;
+    traverseBvh4(tlasNodes_, ray, best.t, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            uint32_t mesh = tlasSlots_[i];
+            if (intersect(views_[mesh], ray, best)) {
+                meshIndex = mesh;
+                found = true;
+            }
+        }
+        return best.t;
+    });
+    return found;
+}
+
+uint32_t StaticWorld::intersectAll(const RayPacket& packet, uint32_t rays, TriangleHit best[4], uint32_t meshIndex[4]) const {
+    if (!tlasNodes_) return 0;
+
+    float tMax[4] = {best[0].t, best[1].t, best[2].t, best[3].t};
+    uint32_t found = 0;
+    traversePacket4(tlasNodes_, packet, tMax, rays, [&](uint32_t first, uint32_t count, uint32_t active) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            uint32_t mesh = tlasSlots_[i];
+            for (uint32_t m = intersectPacket(views_[mesh], packet, active, best); m; m &= m - 1) {
+                uint32_t r = static_cast<uint32_t>(std::countr_zero(m));
+                meshIndex[r] = mesh;
+                tMax[r] = best[r].t;
+                found |= 1u << r;
+            }
+        }
+    });
+    return found;
+}
+
+RayHit StaticWorld::hitResult(const float o[3], const float d[3], const TriangleHit& best, uint32_t mesh) const {
+    const Triangle& tri = views_[mesh].tris[best.tri];
+    float n[3] = {
+        tri.e1[1] * tri.e2[2] - tri.e1[2] * tri.e2[1],
+        tri.e1[2] * tri.e2[0] - tri.e1[0] * tri.e2[2],
+        tri.e1[0] * tri.e2[1] - tri.e1[1] * tri.e2[0],
+    };
+    float nlen = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    // Face the normal back towards the ray origin
+    float sign = (n[0] * d[0] + n[1] * d[1] + n[2] * d[2]) > 0.0f ? -1.0f : 1.0f;
+    float scale = nlen > 0.0f ? sign / nlen : 0.0f;
+
+    RayHit result;
+    result.hit = true;
+    result.t = best.t;
+    result.pos = {o[0] + d[0] * best.t, o[1] + d[1] * best.t, o[2] + d[2] * best.t};
+    result.normal = {n[0] * scale, n[1] * scale, n[2] * scale};
+    result.entity = 0;
+    return result;
+}
+
+RayHit StaticWorld::raycast(const Vec3& origin, const Vec3& dir, float maxDist) const {
+    float o[3], d[3];
+    if (!UnitRay(origin, dir, maxDist, o, d)) return RayHit{};
+    return raycastUnit(o, d, maxDist);
+}
+
+RayHit StaticWorld::raycastUnit(const float o[3], const float d[3], float maxDist) const {
+    Ray4 ray(o, d, maxDist);
+
+    TriangleHit best{maxDist, 0.0f, 0.0f, 0, UINT32_MAX};
+    uint32_t mesh = 0;
+    if (!intersectAll(ray, best, mesh)) return RayHit{};
+    return hitResult(o, d, best, mesh);
+}
+
+void StaticWorld::raycastBlock(std::span<const Ray> rays, std::span<RayHit> out, size_t begin, size_t end) const {
+    // Counting sort of the block on a hash of octant and origin cell,
+    // keeping the caller's order within a bucket, so rays from one shot or
+    // sight cone end up adjacent
+    static_assert(kPacketBlock <= 256);
+    uint64_t key[kPacketBlock];
+    uint32_t bucketOf[kPacketBlock], start[257] = {};
+    uint8_t order[kPacketBlock];
+    float o[kPacketBlock][3], d[kPacketBlock][3];
+    size_t count = end - begin;
+    for (size_t k = 0; k < count; ++k) {
+        const Ray& ray = rays[begin + k];
+        if (!UnitRay(ray.origin, ray.dir, ray.maxDist, o[k], d[k])) {
+            out[begin + k] = RayHit{};
+            bucketOf[k] = 256;
+            continue;
+        }
+        uint64_t octant = (std::signbit(d[k][0]) ? 1u : 0u) | (std::signbit(d[k][1]) ? 2u : 0u) |
+                          (std::signbit(d[k][2]) ? 4u : 0u);
+        key[k] = octant << 48 | PacketCell(o[k][0]) << 32 | PacketCell(o[k][1]) << 16 | PacketCell(o[k][2]);
+        bucketOf[k] = static_cast<uint32_t>((key[k] * 0x9E3779B97F4A7C15ull) >> 56);
+        ++start[bucketOf[k] + 1];
+    }
+    for (size_t b = 1; b <= 256; ++b) start[b] += start[b - 1];
+    for (size_t k = 0; k < count; ++k) {
+        if (bucketOf[k] < 256) order[start[bucketOf[k]]++] = static_cast<uint8_t>(k);
+    }
+    count = start[255];
+
+    for (size_t s = 0; s < count;) {
+        // Up to four adjacent rays with the same octant and cell and nearly
+        // the same direction go as a packet; anything else runs on its own
+        const uint32_t first = order[s];
+        size_t lanes = 1;
+        while (lanes < 4 && s + lanes < count && key[order[s + lanes]] == key[first]) {
+            const float* other = d[order[s + lanes]];
+            if (d[first][0] * other[0] + d[first][1] * other[1] + d[first][2] * other[2] < kPacketMinCos) break;
+            ++lanes;
+        }
+        if (lanes == 1) {
+            out[begin + first] = raycastUnit(o[first], d[first], rays[begin + first].maxDist);
+            ++s;
+            continue;
+        }
+
+        RayPacket packet;
+        TriangleHit best[4];
+        uint32_t mesh[4] = {};
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            // Spare lanes repeat the first ray and stay masked off
+            uint32_t k = order[s + (lane < lanes ? lane : 0)];
+            packet.setLane(lane, o[k], d[k]);
+            best[lane] = {rays[begin + k].maxDist, 0.0f, 0.0f, 0, UINT32_MAX};
+        }
+        packet.prepare();
+        uint32_t found = intersectAll(packet, (1u << lanes) - 1u, best, mesh);
+        for (uint32_t lane = 0; lane < lanes; ++lane) {
+            uint32_t k = order[s + lane];
+            out[begin + k] = (found & (1u << lane)) ? hitResult(o[k], d[k], best[lane], mesh[lane]) : RayHit{};
+        }
+        s += lanes;
+    }
+}
+
+void StaticWorld::raycastBatch(std::span<const Ray> rays, std::span<RayHit> out) const {
+    size_t count = std::min(rays.size(), out.size());
+    if (count == 0) return;
+
+    auto trace = [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block += kPacketBlock) {
+            raycastBlock(rays, out, block, std::min(end, block + kPacketBlock));
+        }
+    };
+    if (pool_ && count >= kParallelBatch) {
+        pool_->parallelFor(count, kParallelGrain, trace);
+    } else {
+        trace(0, count);
+    }
+}
+
+bool StaticWorld::sweepAll(const CapsuleSweep& sweep, SweepHit& best) const {
+    if (!tlasNodes_) return false;
+
+    SweptBounds bounds(sweep);
+    bool found = false;
+    traverseBvh4With(tlasNodes_, best.t, [&](const Node4& node, float tMax, float tEntry[4]) {
+        return intersectNodeExpanded(node, bounds.ray, bounds.ext, tMax, tEntry);
+    }, [&](uint32_t first, uint32_t count) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            found |= phys::sweep(views_[tlasSlots_[i]], sweep, best);
+        }
+        return best.t;
+    });
+    return found;
+}
+
+bool StaticWorld::sweepCapsule(const Capsule& cap, const Vec3& start, const Vec3& delta, Vec3& outPos) const {
+    float pos[3] = {start.x, start.y, start.z};
+    float move[3] = {delta.x, delta.y, delta.z};
+    float lastNormal[3] = {0.0f, 0.0f, 0.0f};
+    bool touched = false;
+
+    for (int slide = 0; slide < kMaxSlides; ++slide) {
+        float len = std::sqrt(move[0] * move[0] + move[1] * move[1] + move[2] * move[2]);
+        if (len <= 1e-6f) break;
+
+        CapsuleSweep sweep{{pos[0], pos[1], pos[2]}, {0.0f, cap.halfHeight, 0.0f}, cap.radius, {move[0], move[1], move[2]}};
+        SweepHit hit{1.0f, {0.0f, 0.0f, 0.0f}, UINT32_MAX};
+        if (!sweepAll(sweep, hit)) {
+            for (int a = 0; a < 3; ++a) pos[a] += move[a];
+            break;
+        }
+        touched = true;
+
+        // Stop a skin short of the contact, then slide the rest along the surface
+        float travel = std::max(0.0f, hit.t - kContactSkin / len);
+        float rest[3];
+        for (int a = 0; a < 3; ++a) {
+            pos[a] += move[a] * travel;
+            rest[a] = move[a] * (1.0f - travel);
+        }
+        const float* n = hit.normal;
+        float into = rest[0] * n[0] + rest[1] * n[1] + rest[2] * n[2];
+        if (into < 0.0f) {
+            for (int a = 0; a < 3; ++a) rest[a] -= n[a] * into;
+        }
+
+        // Wedged between this surface and the last: run along the crease
+        if (slide > 0 && rest[0] * lastNormal[0] + rest[1] * lastNormal[1] + rest[2] * lastNormal[2] < 0.0f) {
+            float crease[3] = {
+                lastNormal[1] * n[2] - lastNormal[2] * n[1],
+                lastNormal[2] * n[0] - lastNormal[0] * n[2],
+                lastNormal[0] * n[1] - lastNormal[1] * n[0],
+            };
+            float len2 = crease[0] * crease[0] + crease[1] * crease[1] + crease[2] * crease[2];
+            float along = len2 > 1e-12f ? (rest[0] * crease[0] + rest[1] * crease[1] + rest[2] * crease[2]) / len2 : 0.0f;
+            for (int a = 0; a < 3; ++a) rest[a] = crease[a] * along;
+        }
+
+        for (int a = 0; a < 3; ++a) {
+            move[a] = rest[a];
+            lastNormal[a] = n[a];
+        }
+    }
+
+    outPos = {pos[0], pos[1], pos[2]};
+    return touched;
+}
+
+} // namespace arena::phys
@@ -0,0 +1,79 @@
+#include "ArenaInstance.hpp"
+#include "arena/profiler.hpp"
+#include <chrono>
+#include <utility>
+
+ArenaInstance::ArenaInstance(uint32_t id, int tickHz, std::shared_ptr<const SharedAssets> assets)
+    : id_(id), assets_(std::move(assets)) {
+    clock_.setTickRate(tickHz);
+    if (!assets_) {
+        assets_ = std::make_shared<const SharedAssets>();
+    }
+}
+
+void ArenaInstance::addSystem(std::string name, SystemFn fn) {
+    systems_.push_back({std::move(name), std::move(fn)});
+}
+
+void ArenaInstance::tick() {
+    clock_.advance();
+    simulate();
+}
+
+uint32_t ArenaInstance::step(double frameSeconds) {
+    uint32_t steps = clock_.step(frameSeconds);
+    for (uint32_t i = 0; i < steps; ++i) {
+        simulate();
+    }
+    return steps;
+}
+
+void ArenaInstance::simulate() {
+    ARENA_PROFILE_SCOPE("ArenaInstance::simulate");
+    // Tick cost feeds the scheduler's load balancing; it never reaches the simulation
+    auto start = std::chrono::steady_clock::now();
+    
+    // One counter read per boundary: each system's end is the next one's start
+    arena::perf::CounterValues tickStart, before, after;
+    bool counting = arena::perf::read(tickStart);
+    before = tickStart;
+    
+    interpolation_.capture(registry_);
+    if (counting && arena::perf::read(after)) {
+        captureCounters_.add(after - before);
+        before = after;
+    }
+    
+    for (auto& system : systems_) {
+        system.fn(*this);
+        if (counting && arena::perf::read(after)) {
+            system.counters.add(after - before);
+            before = after;
+        }
+    }
+    
+    if (counting) {
+        arena::perf::CounterValues delta = before - tickStart;
+        tickCounters_.add(delta);
+        
+        static const arena::profile::CounterTrack track{
+            "Tick counters", {"cycles", "instructions", "llcMisses", "branchMisses"}, 4};
+        double values[4] = {double(delta.cycles), double(delta.instructions), double(delta.llcMisses), double(delta.branchMisses)};
+        arena::profile::counterSample(track, values);
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lastTickSeconds_ = seconds;
+    const double smoothing = 0.1;
+    avgTickSeconds_ = avgTickSeconds_ == 0.0 ? seconds : avgTickSeconds_ + (seconds - avgTickSeconds_) * smoothing;
+}
+
+std::vector<arena::perf::ReportEntry> ArenaInstance::counterReport() const {
+    std::vector<arena::perf::ReportEntry> report;
+    report.push_back({"tick", tickCounters_});
+    report.push_back({"interpolation capture", captureCounters_});
+    for (auto& system : systems_) {
+        report.push_back({system.name, system.counters});
+    }
+    return report;
+}
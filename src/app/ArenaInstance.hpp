@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Clock.hpp"
+#include "arena/ecs/registry.hpp"
+#include "arena/ecs/interpolation_system.hpp"
+#include "arena/sun_lighting.hpp"
+#include "arena/perf_counters.hpp"
+
+// Read-only data shared by every arena hosted in a process. Arenas hold it via
+// shared_ptr<const SharedAssets> so it is loaded once, not once per match.
+struct SharedAssets {
+    // CPU-side mesh geometry: xyz positions + triangle indices
+    struct MeshData {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+    };
+    
+    std::vector<MeshData> meshes; // MeshHandle id N is meshes[N - 1]
+};
+
+// One match: its own registry, clock and subsystems. Nothing in here is shared
+// with other arenas except the read-only assets, so arenas can tick on any thread.
+class ArenaInstance {
+public:
+    using SystemFn = std::function<void(ArenaInstance&)>;
+    
+    ArenaInstance(uint32_t id, int tickHz, std::shared_ptr<const SharedAssets> assets);
+    
+    // Systems run in registration order once per tick
+    void addSystem(std::string name, SystemFn fn);
+    
+    // Advance exactly one fixed tick (no wall-clock input)
+    void tick();
+    
+    // Advance by a frame of wall time, running every tick that became due
+    uint32_t step(double frameSeconds);
+    
+    uint32_t id() const { return id_; }
+    Clock& clock() { return clock_; }
+    const Clock& clock() const { return clock_; }
+    arena::ecs::Registry& registry() { return registry_; }
+    arena::ecs::InterpolationSystem& interpolation() { return interpolation_; }
+    arena::SunLighting& sunLighting() { return sunLighting_; }
+    const SharedAssets& assets() const { return *assets_; }
+    
+    // Smoothed CPU cost of one tick, and the share of a core it needs at its tick rate
+    double averageTickSeconds() const { return avgTickSeconds_; }
+    double load() const { return clock_.dt > 0.0 ? avgTickSeconds_ / clock_.dt : 0.0; }
+    
+    // CPU cost of the most recent tick
+    double lastTickSeconds() const { return lastTickSeconds_; }
+    
+    // Hardware counter totals per tick ("tick"), for the interpolation capture
+    // and per system, gathered while arena::perf sampling is enabled
+    std::vector<arena::perf::ReportEntry> counterReport() const;
+    
+private:
+    struct System {
+        std::string name;
+        SystemFn fn;
+        arena::perf::CounterTotals counters;
+    };
+    
+    // Run the systems for the tick the clock just advanced to
+    void simulate();
+    
+    uint32_t id_;
+    Clock clock_;
+    arena::ecs::Registry registry_;
+    arena::ecs::InterpolationSystem interpolation_;
+    arena::SunLighting sunLighting_;
+    std::shared_ptr<const SharedAssets> assets_;
+    std::vector<System> systems_;
+    double avgTickSeconds_ = 0.0;
+    double lastTickSeconds_ = 0.0;
+    arena::perf::CounterTotals tickCounters_;
+    arena::perf::CounterTotals captureCounters_;
+};
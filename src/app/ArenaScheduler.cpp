@@ -0,0 +1,297 @@
+#include "ArenaScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include "arena/profiler.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+int64_t SteadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PinToCpu(std::thread& thread, unsigned cpu) {
+#if defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread; (void)cpu;
+#endif
+}
+
+} // namespace
+
+ArenaScheduler::ArenaScheduler(const ArenaSchedulerOptions& options) : options_(options) {
+    unsigned count = options_.workers;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+ArenaScheduler::~ArenaScheduler() {
+    stop();
+}
+
+ArenaInstance& ArenaScheduler::add(std::unique_ptr<ArenaInstance> arena) {
+    ArenaInstance& ref = *arena;
+    
+    // New arenas have no cost history yet, so balance on arena count first
+    Worker* target = workers_.front().get();
+    size_t bestCount = SIZE_MAX;
+    double bestLoad = 0.0;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        double load = loadOf(*worker);
+        size_t count = worker->slots.size();
+        if (count < bestCount || (count == bestCount && load < bestLoad)) {
+            target = worker.get();
+            bestCount = count;
+            bestLoad = load;
+        }
+    }
+    
+    auto slot = std::make_unique<Slot>();
+    slot->arena = std::move(arena);
+    slot->nextDeadline = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(target->mutex);
+    target->slots.push_back(std::move(slot));
+    ++total_;
+    return ref;
+}
+
+void ArenaScheduler::start() {
+    if (running_.exchange(true)) return;
+    
+    nextRebalanceNs_ = SteadyNs() + static_cast<int64_t>(options_.rebalanceIntervalSec * 1e9);
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread(&ArenaScheduler::run, this, i);
+        if (options_.pinThreads) {
+            PinToCpu(workers_[i]->thread, i % hardware);
+        }
+    }
+}
+
+void ArenaScheduler::stop() {
+    if (!running_.exchange(false)) return;
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void ArenaScheduler::wait() {
+    if (options_.maxTicks == 0) return; // would never finish
+    while (running_ && finished_.load() < total_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stop();
+}
+
+void ArenaScheduler::run(unsigned index) {
+    Worker& self = *workers_[index];
+    char threadName[32];
+    std::snprintf(threadName, sizeof(threadName), "Arena worker %u", index);
+    ARENA_PROFILE_THREAD(threadName);
+    
+    // Catching up more than this many ticks at once just digs a deeper hole
+    const int maxCatchUpTicks = 5;
+    
+    std::vector<Slot*> pass;
+    while (running_) {
+        auto now = std::chrono::steady_clock::now();
+        auto wake = now + std::chrono::milliseconds(5);
+        bool didWork = false;
+        
+        // The lock is only held to claim or release a slot, never across a
+        // tick, so rebalance() and the stats calls don't wait on a busy worker
+        pass.clear();
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            for (auto& slot : self.slots) {
+                if (!slot->finished) pass.push_back(slot.get());
+            }
+        }
+        
+        for (Slot* slot : pass) {
+            ArenaInstance& arena = *slot->arena;
+            int due = 0;
+            {
+                std::lock_guard<std::mutex> lock(self.mutex);
+                // Migrated away since the pass started
+                bool ours = std::any_of(self.slots.begin(), self.slots.end(),
+                    [&](const std::unique_ptr<Slot>& s) { return s.get() == slot; });
+                if (!ours) continue;
+                
+                auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(arena.clock().dt));
+                if (options_.unthrottled) {
+                    due = 1;
+                } else {
+                    if (now - slot->nextDeadline > period * maxCatchUpTicks) {
+                        slot->nextDeadline = now; // fell too far behind; drop the backlog
+                    }
+                    while (slot->nextDeadline <= now && due < maxCatchUpTicks) {
+                        slot->nextDeadline += period;
+                        ++due;
+                    }
+                }
+                wake = std::min(wake, slot->nextDeadline);
+                if (due == 0) continue;
+                slot->busy = true;
+            }
+            
+            bool finished = false;
+            for (int i = 0; i < due; ++i) {
+                arena.tick();
+                didWork = true;
+                if (options_.maxTicks && arena.clock().ticks >= options_.maxTicks) {
+                    finished = true;
+                    break;
+                }
+            }
+            
+            std::lock_guard<std::mutex> lock(self.mutex);
+            slot->busy = false;
+            slot->load = arena.load();
+            if (finished) {
+                slot->finished = true;
+                ++finished_;
+            }
+        }
+        
+        maybeRebalance();
+        
+        if (options_.unthrottled) {
+            if (!didWork) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else {
+            std::this_thread::sleep_until(wake);
+        }
+    }
+}
+
+void ArenaScheduler::maybeRebalance() {
+    int64_t now = SteadyNs();
+    int64_t due = nextRebalanceNs_.load(std::memory_order_relaxed);
+    if (now < due) return;
+    
+    // Only one worker per interval pays for the rebalance
+    int64_t next = now + static_cast<int64_t>(options_.rebalanceIntervalSec * 1e9);
+    if (!nextRebalanceNs_.compare_exchange_strong(due, next)) return;
+    rebalance();
+}
+
+bool ArenaScheduler::rebalance() {
+    if (workers_.size() < 2) return false;
+    std::lock_guard<std::mutex> guard(rebalanceMutex_);
+    
+    std::vector<double> loads = workerLoads();
+    size_t busiest = std::max_element(loads.begin(), loads.end()) - loads.begin();
+    size_t idlest = std::min_element(loads.begin(), loads.end()) - loads.begin();
+    if (busiest == idlest) return false;
+    
+    Worker& from = *workers_[busiest];
+    Worker& to = *workers_[idlest];
+    std::scoped_lock lock(from.mutex, to.mutex);
+    
+    // An arena mid-tick stays put; pickArenaToMove skips zero loads
+    std::vector<double> arenaLoads;
+    arenaLoads.reserve(from.slots.size());
+    for (auto& slot : from.slots) {
+        arenaLoads.push_back(slot->finished || slot->busy ? 0.0 : slot->load);
+    }
+    
+    int pick = pickArenaToMove(arenaLoads, loadOf(from), loadOf(to));
+    if (pick < 0) return false;
+    
+    to.slots.push_back(std::move(from.slots[pick]));
+    from.slots.erase(from.slots.begin() + pick);
+    ++migrations_;
+    return true;
+}
+
+int ArenaScheduler::pickArenaToMove(const std::vector<double>& arenaLoads, double busiestLoad, double idlestLoad) {
+    // Moving load x gives (busiest - x, idlest + x); it only helps while x < gap
+    double gap = busiestLoad - idlestLoad;
+    int best = -1;
+    for (size_t i = 0; i < arenaLoads.size(); ++i) {
+        double x = arenaLoads[i];
+        if (x <= 0.0 || x >= gap) continue;
+        // Closest to half the gap evens the pair out best
+        if (best < 0 || std::abs(gap * 0.5 - x) < std::abs(gap * 0.5 - arenaLoads[best])) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+size_t ArenaScheduler::arenaCount() const {
+    return total_.load();
+}
+
+std::vector<double> ArenaScheduler::workerLoads() const {
+    std::vector<double> loads;
+    loads.reserve(workers_.size());
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        loads.push_back(loadOf(*worker));
+    }
+    return loads;
+}
+
+std::vector<size_t> ArenaScheduler::arenasPerWorker() const {
+    std::vector<size_t> counts;
+    counts.reserve(workers_.size());
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        counts.push_back(worker->slots.size());
+    }
+    return counts;
+}
+
+std::vector<arena::perf::ReportEntry> ArenaScheduler::counterReport() const {
+    std::vector<arena::perf::ReportEntry> merged;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (auto& slot : worker->slots) {
+            for (auto& entry : slot->arena->counterReport()) {
+                auto it = std::find_if(merged.begin(), merged.end(),
+                    [&](const arena::perf::ReportEntry& e) { return e.name == entry.name; });
+                if (it == merged.end()) {
+                    merged.push_back(entry);
+                } else {
+                    it->totals += entry.totals;
+                }
+            }
+        }
+    }
+    return merged;
+}
+
+double ArenaScheduler::loadOf(const Worker& worker) {
+    double load = 0.0;
+    for (auto& slot : worker.slots) {
+        if (!slot->finished) load += slot->load;
+    }
+    return load;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ArenaInstance.hpp"
+
+struct ArenaSchedulerOptions {
+    unsigned workers = 0;              // 0 = one per hardware thread
+    bool pinThreads = true;            // pin worker i to CPU i % hardware threads
+    bool unthrottled = false;          // tick back-to-back instead of at each arena's tick rate
+    uint64_t maxTicks = 0;             // retire an arena after this many ticks (0 = run until stop())
+    double rebalanceIntervalSec = 1.0; // how often busy workers hand arenas to idle ones
+};
+
+// Hosts many arenas in one process. Each arena lives on exactly one worker
+// thread at a time, so its registry is never touched concurrently; arenas are
+// only migrated between ticks when one worker carries noticeably more load.
+class ArenaScheduler {
+public:
+    explicit ArenaScheduler(const ArenaSchedulerOptions& options = {});
+    ~ArenaScheduler();
+    
+    ArenaScheduler(const ArenaScheduler&) = delete;
+    ArenaScheduler& operator=(const ArenaScheduler&) = delete;
+    
+    // Hand an arena to the least-loaded worker; safe before or after start()
+    ArenaInstance& add(std::unique_ptr<ArenaInstance> arena);
+    
+    void start();
+    void stop();
+    
+    // Block until every arena has run options.maxTicks ticks, then stop
+    void wait();
+    
+    // Move an arena from the busiest worker to the idlest one if that narrows the gap
+    bool rebalance();
+    
+    unsigned workerCount() const { return static_cast<unsigned>(workers_.size()); }
+    size_t arenaCount() const;
+    std::vector<double> workerLoads() const;     // share of a core per worker
+    std::vector<size_t> arenasPerWorker() const;
+    uint64_t migrations() const { return migrations_.load(); }
+    
+    // Hardware counter totals summed over every arena, matched by entry name;
+    // reads the arenas themselves, so call it once the workers are stopped
+    std::vector<arena::perf::ReportEntry> counterReport() const;
+    
+    // Index of the arena to move off a worker with these per-arena loads, or -1 if
+    // no move helps. Prefers the arena closest to half the gap between the two workers.
+    static int pickArenaToMove(const std::vector<double>& arenaLoads, double busiestLoad, double idlestLoad);
+    
+private:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    
+    // Everything but the arena itself is guarded by the owning worker's mutex.
+    // The arena is ticked with that mutex released, while busy is set.
+    struct Slot {
+        std::unique_ptr<ArenaInstance> arena;
+        TimePoint nextDeadline;
+        double load = 0.0;    // arena->load() after its last tick
+        bool finished = false;
+        bool busy = false;    // being ticked; rebalance() leaves it where it is
+    };
+    
+    struct Worker {
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> slots; // heap slots stay put while a worker ticks one unlocked
+        std::thread thread;
+    };
+    
+    void run(unsigned index);
+    void maybeRebalance();
+    static double loadOf(const Worker& worker); // caller holds worker.mutex
+    
+    ArenaSchedulerOptions options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> total_{0};
+    std::atomic<size_t> finished_{0};
+    std::atomic<uint64_t> migrations_{0};
+    std::atomic<int64_t> nextRebalanceNs_{0};
+    std::mutex rebalanceMutex_;
+};
@@ -17,12 +17,31 @@ struct Clock {
         }
     }
     
-    void step(double frameSeconds) {
+    // Returns the number of fixed ticks that became due during this frame so
+    // the caller can run the simulation once per tick
+    uint32_t step(double frameSeconds) {
         lastDt = frameSeconds;  // Store the last frame time
         accumulator += frameSeconds;
+        uint32_t stepped = 0;
         while (accumulator + 1e-12 >= dt) { 
             accumulator -= dt; 
             ++ticks; 
+            ++stepped;
         }
+        return stepped;
+    }
+    
+    // Advance exactly one fixed tick without consuming wall time; used by
+    // fast-forward simulation where ticks are not paced to real time
+    void advance() {
+        ++ticks;
+    }
+    
+    // Fraction of a tick left in the accumulator, in [0, 1]. Rendering blends
+    // the previous and current tick's state by this amount.
+    double alpha() const {
+        if (dt <= 0.0) return 0.0;
+        double a = accumulator / dt;
+        return a < 0.0 ? 0.0 : (a > 1.0 ? 1.0 : a);
     }
 };
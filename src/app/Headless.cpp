@@ -2,6 +2,7 @@
 #include <thread>
 #include "Clock.hpp"
 #include "Config.hpp"
+#include "Headless.hpp"
 
 // High-resolution timer wrapper using standard C++ chrono
 static double NowSeconds() {
@@ -47,3 +48,34 @@ extern "C" int RunHeadlessForMs(int ms, int tickHz) {
     
     return static_cast<int>(clock.ticks);
 }
+
+SimulationReport RunHeadlessTicks(uint64_t ticks, int tickHz, bool unthrottled, SimTickFn onTick, void* user) {
+    Clock clock;
+    clock.setTickRate(tickHz);
+    
+    // Wall time is only sampled around the run (and for pacing when throttled);
+    // the simulation itself only ever sees whole dt steps
+    auto wallStart = std::chrono::steady_clock::now();
+    auto tickPeriod = std::chrono::duration<double>(clock.dt);
+    
+    for (uint64_t i = 0; i < ticks; ++i) {
+        if (!unthrottled) {
+            auto deadline = wallStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(tickPeriod * static_cast<double>(i + 1));
+            std::this_thread::sleep_until(deadline);
+        }
+        
+        clock.advance();
+        if (onTick) {
+            onTick(clock, user);
+        }
+    }
+    
+    auto wallEnd = std::chrono::steady_clock::now();
+    
+    SimulationReport report;
+    report.ticks = clock.ticks;
+    report.simSeconds = static_cast<double>(clock.ticks) * clock.dt;
+    report.wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    report.ticksPerSecond = report.wallSeconds > 0.0 ? report.ticks / report.wallSeconds : 0.0;
+    return report;
+}
@@ -9,4 +9,25 @@ int RunHeadlessForMs(int ms, int tickHz);
 
 #ifdef __cplusplus
 }
+
+#include <cstdint>
+
+struct Clock;
+
+// Outcome of a fixed-tick-count simulation run
+struct SimulationReport {
+    uint64_t ticks = 0;          // fixed ticks simulated
+    double simSeconds = 0.0;     // simulated time (ticks * dt)
+    double wallSeconds = 0.0;    // real time the run took
+    double ticksPerSecond = 0.0; // ticks / wallSeconds
+};
+
+// Called once per simulated tick, after the clock has advanced
+using SimTickFn = void (*)(const Clock& clock, void* user);
+
+// Run exactly `ticks` fixed steps at tickHz. Unthrottled runs advance the clock
+// by exact dt steps as fast as the CPU allows, with no sleeping and no wall-clock
+// reads between ticks; otherwise each tick waits for its real-time deadline.
+SimulationReport RunHeadlessTicks(uint64_t ticks, int tickHz, bool unthrottled,
+                                  SimTickFn onTick = nullptr, void* user = nullptr);
 #endif
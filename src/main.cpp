@@ -1,4 +1,6 @@
 #include <iostream>
+#include <algorithm>
+#include <memory>
 #include <chrono>
 #include <thread>
 #include <string>
@@ -9,6 +11,9 @@
 
 #include "app/Clock.hpp"
 #include "app/Config.hpp"
+#include "app/Headless.hpp"
+#include "app/ArenaInstance.hpp"
+#include "app/ArenaScheduler.hpp"
 #include "arena/input.hpp"
 #include "arena/ecs/registry.hpp"
 #include "arena/ecs/camera_system.hpp"
@@ -17,6 +22,11 @@
 #include "arena/gfx/shader.hpp"
 #include "arena/gfx/mesh.hpp"
 #include "arena/sun_lighting.hpp"
+#include "arena/log.hpp"
+#include "arena/profiler.hpp"
+#include "arena/frame_stats.hpp"
+#include "arena/debug_hud.hpp"
+#include "arena/perf_counters.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -28,20 +38,16 @@ static double NowSeconds() {
     return duration.count() / 1e9;
 }
 
-// Simple logging macro with timestamps
-#define LOG(msg) std::cout << "[" << NowSeconds() << "] " << msg << std::endl
+// Application log lines; the logger adds the timestamp and writes them off-thread
+#define LOG(...) ARENA_LOG_INFO(App, __VA_ARGS__)
 
 // Global input state
 static arena::InputState g_inputState;
 
-// Global ECS registry and camera system
-static arena::ecs::Registry g_registry;
+// Camera system (stateless) and the local player's camera entity
 static arena::ecs::CameraSystem g_cameraSystem;
 static arena::ecs::Entity g_cameraEntityId = 0;
 
-// Global sun lighting system
-static arena::SunLighting g_sunLighting;
-
 // Input state accessor
 arena::InputState& getInputState() { return g_inputState; }
 
@@ -58,15 +64,14 @@ void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
         lastX = xpos;
         lastY = ypos;
         firstMove = false;
-        std::cout << "First mouse position: " << xpos << ", " << ypos << std::endl;
+        ARENA_LOG_TRACE(Input, "First mouse position: %.1f, %.1f", xpos, ypos);
         return;
     }
     
     double dx = xpos - lastX;
     double dy = ypos - lastY;
     
-    // Debug: Always log mouse movement to see if callback is working
-    std::cout << "Mouse callback: pos(" << xpos << ", " << ypos << ") delta(" << dx << ", " << dy << ")" << std::endl;
+    ARENA_LOG_TRACE(Input, "Mouse callback: pos(%.1f, %.1f) delta(%.1f, %.1f)", xpos, ypos, dx, dy);
     
     arena::handleMouseMove(g_inputState, dx, dy);
     
@@ -85,6 +90,12 @@ struct Args {
     bool server = false;
     std::string configPath = "config/engine.ini";
     int runForMs = -1; // -1 means run indefinitely
+    long long simulateTicks = 0; // >0 runs exactly this many ticks headless, then exits
+    bool unthrottled = false;    // don't pace --simulate-ticks to real time
+    int arenas = 1;              // matches hosted by this process (headless only)
+    int workers = 0;             // scheduler threads for --arenas; 0 = one per core
+    std::string profilePath;     // capture profiler zones for the whole run into this trace
+    std::string perfJsonPath;    // sample hardware counters per tick/system, write them here
     
     void parse(int argc, char* argv[]) {
         for (int i = 1; i < argc; i++) {
@@ -100,6 +111,30 @@ struct Args {
                 } catch (...) {
                     std::cout << "Warning: Invalid --runForMs value, ignoring" << std::endl;
                 }
+            } else if (arg.substr(0, 17) == "--simulate-ticks=") {
+                try {
+                    simulateTicks = std::stoll(arg.substr(17));
+                } catch (...) {
+                    std::cout << "Warning: Invalid --simulate-ticks value, ignoring" << std::endl;
+                }
+            } else if (arg == "--unthrottled") {
+                unthrottled = true;
+            } else if (arg.substr(0, 9) == "--arenas=") {
+                try {
+                    arenas = std::max(1, std::stoi(arg.substr(9)));
+                } catch (...) {
+                    std::cout << "Warning: Invalid --arenas value, ignoring" << std::endl;
+                }
+            } else if (arg.substr(0, 10) == "--workers=") {
+                try {
+                    workers = std::max(0, std::stoi(arg.substr(10)));
+                } catch (...) {
+                    std::cout << "Warning: Invalid --workers value, ignoring" << std::endl;
+                }
+            } else if (arg.substr(0, 10) == "--profile=") {
+                profilePath = arg.substr(10);
+            } else if (arg.substr(0, 16) == "--perf-counters=") {
+                perfJsonPath = arg.substr(16);
             } else if (arg == "--help" || arg == "-h") {
                 std::cout << "Arena Engine\n";
                 std::cout << "Usage: arena [options]\n";
@@ -107,6 +142,12 @@ struct Args {
                 std::cout << "  --server              Run in headless mode (no window)\n";
                 std::cout << "  --config=<path>       Load configuration from file\n";
                 std::cout << "  --runForMs=<ms>       Run for specified milliseconds then exit\n";
+                std::cout << "  --simulate-ticks=<n>  Simulate exactly n ticks headless, report ticks/sec, exit\n";
+                std::cout << "  --unthrottled         With --simulate-ticks, run as fast as the CPU allows\n";
+                std::cout << "  --arenas=<n>          Host n matches in this process (implies --server)\n";
+                std::cout << "  --workers=<n>         Worker threads for --arenas (default: one per core)\n";
+                std::cout << "  --profile=<path>      Capture profiler zones, write a Chrome trace on exit\n";
+                std::cout << "  --perf-counters=<path> Sample HW counters per tick and system (Linux), write JSON on exit\n";
                 std::cout << "  --help, -h            Show this help message\n";
                 exit(0);
             }
@@ -114,26 +155,138 @@ struct Args {
     }
 };
 
+// Write per-tick/per-system hardware counter totals collected during the run
+static void WritePerfReport(const Args& args, const std::vector<arena::perf::ReportEntry>& report) {
+    if (args.perfJsonPath.empty()) return;
+    if (arena::perf::writeBenchmarkJson(args.perfJsonPath, "arena", report)) {
+        LOG("Wrote hardware counter report to %s", args.perfJsonPath);
+    } else {
+        ARENA_LOG_ERROR(App, "Failed to write hardware counter report to %s", args.perfJsonPath);
+    }
+}
+
+// Host args.arenas matches on a worker pool until --runForMs / --simulate-ticks is done
+static int RunArenaServer(const Args& args, const Config& config, std::shared_ptr<const SharedAssets> assets) {
+    ArenaSchedulerOptions options;
+    options.workers = static_cast<unsigned>(args.workers);
+    options.unthrottled = args.unthrottled;
+    options.maxTicks = args.simulateTicks > 0 ? static_cast<uint64_t>(args.simulateTicks) : 0;
+    
+    ArenaScheduler scheduler(options);
+    for (int i = 0; i < args.arenas; ++i) {
+        scheduler.add(std::make_unique<ArenaInstance>(static_cast<uint32_t>(i), config.tick_hz, assets));
+    }
+    LOG("Hosting %d arenas on %zu worker threads", args.arenas, scheduler.workerCount());
+    
+    double startTime = NowSeconds();
+    scheduler.start();
+    
+    if (options.maxTicks > 0) {
+        scheduler.wait();
+    } else {
+        double lastLogTime = startTime;
+        while (args.runForMs <= 0 || (NowSeconds() - startTime) * 1000.0 < args.runForMs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (NowSeconds() - lastLogTime >= 1.0) {
+                auto loads = scheduler.workerLoads();
+                auto counts = scheduler.arenasPerWorker();
+                for (size_t w = 0; w < loads.size(); ++w) {
+                    LOG("Worker %zu: %zu arenas, load %.1f%%", w, counts[w], loads[w] * 100.0);
+                }
+                lastLogTime = NowSeconds();
+            }
+        }
+        scheduler.stop();
+    }
+    
+    double wallSeconds = NowSeconds() - startTime;
+    LOG("Arena server done after %.3f s (%llu migrations)", wallSeconds, scheduler.migrations());
+    if (options.maxTicks > 0 && wallSeconds > 0.0) {
+        LOG("Throughput: %.0f ticks/sec across all arenas", options.maxTicks * args.arenas / wallSeconds);
+    }
+    WritePerfReport(args, scheduler.counterReport());
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Initialize timing first
     double initTime = NowSeconds();
     
+    // Drain queued log lines on every exit path
+    struct LogShutdown { ~LogShutdown() { arena::log::shutdown(); } } logShutdown;
+    
     Args args;
     args.parse(argc, argv);
     
+    // Profile the whole run and write the trace on every exit path
+    struct ProfileCapture {
+        std::string path;
+        explicit ProfileCapture(std::string p) : path(std::move(p)) {
+            if (path.empty()) return;
+            ARENA_PROFILE_THREAD("Main");
+            arena::profile::beginCapture();
+        }
+        ~ProfileCapture() {
+            if (path.empty()) return;
+            arena::profile::endCapture();
+            if (arena::profile::exportChromeTrace(path)) {
+                LOG("Wrote profiler trace to %s (%llu events overwritten)", path, arena::profile::overwrittenCount());
+            } else {
+                ARENA_LOG_ERROR(App, "Failed to write profiler trace to %s", path);
+            }
+        }
+    } profileCapture(args.profilePath);
+    
+    if (!args.perfJsonPath.empty()) {
+        arena::perf::setEnabled(true);
+        if (!arena::perf::available()) {
+            ARENA_LOG_WARN(App, "Hardware counters unavailable (Linux only; check perf_event_paranoid)");
+        }
+    }
+    
     LOG("Starting Arena Engine");
     
     // Load configuration first
     Config config;
     if (config.loadFromFile(args.configPath)) {
-        LOG("Loaded config from: " << args.configPath);
-        LOG("Tick rate: " << config.tick_hz << " Hz");
-        LOG("Window size: " << config.window_w << "x" << config.window_h);
+        LOG("Loaded config from: %s", args.configPath);
+        LOG("Tick rate: %d Hz", config.tick_hz);
+        LOG("Window size: %dx%d", config.window_w, config.window_h);
     } else {
-        LOG("Warning: Could not load config from " << args.configPath << ", using defaults");
+        ARENA_LOG_WARN(App, "Could not load config from %s, using defaults", args.configPath);
+    }
+    
+    // Assets loaded once and shared read-only by every arena in the process
+    auto assets = std::make_shared<const SharedAssets>();
+    
+    if (args.arenas > 1) {
+        return RunArenaServer(args, config, assets);
+    }
+    
+    // This process's match: registry, clock and subsystems
+    ArenaInstance instance(0, config.tick_hz, assets);
+    
+    // Fixed tick-count simulation: headless, no wall-clock in the sim, then exit
+    if (args.simulateTicks > 0) {
+        LOG("Simulating %lld ticks at %d Hz (%s)", args.simulateTicks, config.tick_hz,
+            args.unthrottled ? "unthrottled" : "real-time");
+        
+        SimulationReport report = RunHeadlessTicks(
+            static_cast<uint64_t>(args.simulateTicks), config.tick_hz, args.unthrottled,
+            [](const Clock&, void* user) {
+                static_cast<ArenaInstance*>(user)->tick();
+                ARENA_PROFILE_FRAME(); // each tick is a frame in headless runs
+            }, &instance);
+        
+        LOG("Simulated %llu ticks (%.3f s sim time) in %.3f s wall time",
+            report.ticks, report.simSeconds, report.wallSeconds);
+        LOG("Throughput: %.0f ticks/sec (%.1fx real-time)", report.ticksPerSecond,
+            report.simSeconds / (report.wallSeconds > 0.0 ? report.wallSeconds : 1.0));
+        WritePerfReport(args, instance.counterReport());
+        return 0;
     }
     
-        arena::gfx::GLContext glContext;
+    arena::gfx::GLContext glContext;
     arena::gfx::Shader basicShader;
     arena::gfx::Mesh gridMesh;
     arena::gfx::Mesh coordinateAxesMesh;
@@ -146,7 +299,7 @@ int main(int argc, char* argv[]) {
         
         // Initialize GL context with OpenGL 4.5 core profile and sRGB
         if (!glContext.initialize(config.window_w, config.window_h, "Arena Engine")) {
-            LOG("ERROR: Failed to initialize GL context");
+            ARENA_LOG_ERROR(App, "Failed to initialize GL context");
             return -1;
         }
         
@@ -157,7 +310,7 @@ int main(int argc, char* argv[]) {
         
         // Load basic shader (with lighting support)
         if (!basicShader.load("assets/shaders/basic.vert", "assets/shaders/basic.frag")) {
-            LOG("ERROR: Failed to load basic shader");
+            ARENA_LOG_ERROR(Render, "Failed to load basic shader");
             return -1;
         }
         LOG("Basic shader loaded successfully");
@@ -181,26 +334,50 @@ int main(int argc, char* argv[]) {
         // LOG("Text HUD system initialized successfully");
         
         // Create camera entity with Transform and CameraController components
-        g_cameraEntityId = g_registry.create();
-        g_registry.add<arena::ecs::Transform>(g_cameraEntityId,
+        g_cameraEntityId = instance.registry().create();
+        instance.registry().add<arena::ecs::Transform>(g_cameraEntityId,
             {{0, 1.6f, 5},   // position: a little above the ground
              {0, -0.35f, 0}, // yaw, pitch, roll: slight downward pitch
              {1, 1, 1}});
-        g_registry.add<arena::ecs::CameraController>(g_cameraEntityId, {5.0f, 0.01f});
-        LOG("Created camera entity with ID: " << g_cameraEntityId);
+        instance.registry().add<arena::ecs::CameraController>(g_cameraEntityId, {5.0f, 0.01f});
+        LOG("Created camera entity with ID: %u", g_cameraEntityId);
     }
     
-    // Initialize clock with config
-    Clock clock;
-    clock.setTickRate(config.tick_hz);
+    // The arena's clock was initialized from config
+    Clock& clock = instance.clock();
+    arena::ecs::Registry& registry = instance.registry();
+    arena::SunLighting& sunLighting = instance.sunLighting();
     
     double last = NowSeconds();
     double lastLogTime = last;
     double startTime = last;
+    double pendingMouseDx = 0.0, pendingMouseDy = 0.0;
+    
+    // Rolling timings for the HUD, fed from profiler zone totals every frame
+    arena::FrameStats frameStats;
+    arena::profile::ZoneTotal zoneTotals[32];
+    if (!args.server) {
+        arena::profile::setFrameTotalsEnabled(true);
+        frameStats.trackSubsystem("Input");
+        frameStats.trackSubsystem("ArenaInstance::simulate");
+        frameStats.trackSubsystem("Render");
+    }
+    
+    if (!args.server) {
+        instance.addSystem("camera", [&](ArenaInstance& self) {
+            // The first tick of the frame gets all mouse movement seen since the last tick
+            arena::InputState tickInput = g_inputState;
+            tickInput.mouseDx = pendingMouseDx;
+            tickInput.mouseDy = pendingMouseDy;
+            pendingMouseDx = pendingMouseDy = 0.0;
+            
+            g_cameraSystem.update(static_cast<float>(self.clock().dt), tickInput, self.registry());
+        });
+    }
     
     LOG("Engine loop starting...");
     if (args.runForMs > 0) {
-        LOG("Will run for " << args.runForMs << "ms then exit");
+        LOG("Will run for %dms then exit", args.runForMs);
     }
     
     // Main engine loop
@@ -223,13 +400,19 @@ int main(int argc, char* argv[]) {
             acc = 0.0;
         }
         
+        // The previous iteration's time and zone totals (rolled over by ARENA_PROFILE_FRAME)
+        frameStats.recordFrame(now, frame);
+        frameStats.recordSubsystems(zoneTotals, arena::profile::lastFrameTotals(zoneTotals, 32));
+        
         // Begin frame for input system
         if (!args.server) {
+            ARENA_PROFILE_SCOPE("Input");
             arena::beginFrame(g_inputState);
             glContext.pollEvents();
             
-            // Update camera system with current input state
-            g_cameraSystem.update(frame, g_inputState, g_registry);
+            // Mouse deltas are per-frame; bank them until a tick consumes them
+            pendingMouseDx += g_inputState.mouseDx;
+            pendingMouseDy += g_inputState.mouseDy;
             
             // Debug: Show input state changes
             static bool lastW = false, lastA = false, lastS = false, lastD = false;
@@ -239,56 +422,56 @@ int main(int argc, char* argv[]) {
             // Check for key state changes
             if (g_inputState.keys[GLFW_KEY_W] != lastW) {
                 lastW = g_inputState.keys[GLFW_KEY_W];
-                if (lastW) LOG("W key PRESSED");
-                else LOG("W key RELEASED");
+                if (lastW) ARENA_LOG_INFO(Input, "W key PRESSED");
+                else ARENA_LOG_INFO(Input, "W key RELEASED");
             }
             
             if (g_inputState.keys[GLFW_KEY_A] != lastA) {
                 lastA = g_inputState.keys[GLFW_KEY_A];
-                if (lastA) LOG("A key PRESSED");
-                else LOG("A key RELEASED");
+                if (lastA) ARENA_LOG_INFO(Input, "A key PRESSED");
+                else ARENA_LOG_INFO(Input, "A key RELEASED");
             }
             
             if (g_inputState.keys[GLFW_KEY_S] != lastS) {
                 lastS = g_inputState.keys[GLFW_KEY_S];
-                if (lastS) LOG("S key PRESSED");
-                else LOG("S key RELEASED");
+                if (lastS) ARENA_LOG_INFO(Input, "S key PRESSED");
+                else ARENA_LOG_INFO(Input, "S key RELEASED");
             }
             
             if (g_inputState.keys[GLFW_KEY_D] != lastD) {
                 lastD = g_inputState.keys[GLFW_KEY_D];
-                if (lastD) LOG("D key PRESSED");
-                else LOG("D key RELEASED");
+                if (lastD) ARENA_LOG_INFO(Input, "D key PRESSED");
+                else ARENA_LOG_INFO(Input, "D key RELEASED");
             }
             
             if (g_inputState.keys[GLFW_KEY_SPACE] != lastSpace) {
                 lastSpace = g_inputState.keys[GLFW_KEY_SPACE];
-                if (lastSpace) LOG("SPACE key PRESSED");
-                else LOG("SPACE key RELEASED");
+                if (lastSpace) ARENA_LOG_INFO(Input, "SPACE key PRESSED");
+                else ARENA_LOG_INFO(Input, "SPACE key RELEASED");
             }
             
             if (g_inputState.keys[GLFW_KEY_C] != lastC) {
                 lastC = g_inputState.keys[GLFW_KEY_C];
-                if (lastC) LOG("C key PRESSED");
-                else LOG("C key RELEASED");
+                if (lastC) ARENA_LOG_INFO(Input, "C key PRESSED");
+                else ARENA_LOG_INFO(Input, "C key RELEASED");
             }
             
             // Check for mouse button changes
             if (g_inputState.mouseButtons[GLFW_MOUSE_BUTTON_LEFT] != lastLeftClick) {
                 lastLeftClick = g_inputState.mouseButtons[GLFW_MOUSE_BUTTON_LEFT];
-                if (lastLeftClick) LOG("Left mouse button PRESSED");
-                else LOG("Left mouse button RELEASED");
+                if (lastLeftClick) ARENA_LOG_INFO(Input, "Left mouse button PRESSED");
+                else ARENA_LOG_INFO(Input, "Left mouse button RELEASED");
             }
             
             if (g_inputState.mouseButtons[GLFW_MOUSE_BUTTON_RIGHT] != lastRightClick) {
                 lastRightClick = g_inputState.mouseButtons[GLFW_MOUSE_BUTTON_RIGHT];
-                if (lastRightClick) LOG("Right mouse button PRESSED");
-                else LOG("Right mouse button RELEASED");
+                if (lastRightClick) ARENA_LOG_INFO(Input, "Right mouse button PRESSED");
+                else ARENA_LOG_INFO(Input, "Right mouse button RELEASED");
             }
             
             // Show mouse movement (only when there is movement)
             if (g_inputState.mouseDx != 0.0 || g_inputState.mouseDy != 0.0) {
-                LOG("Mouse moved: dx=" << g_inputState.mouseDx << " dy=" << g_inputState.mouseDy);
+                ARENA_LOG_TRACE(Input, "Mouse moved: dx=%.1f dy=%.1f", g_inputState.mouseDx, g_inputState.mouseDy);
             }
             
             // Handle sun time controls
@@ -297,37 +480,35 @@ int main(int argc, char* argv[]) {
             if (g_inputState.keys[GLFW_KEY_LEFT_BRACKET] != lastLeftBracket) {
                 lastLeftBracket = g_inputState.keys[GLFW_KEY_LEFT_BRACKET];
                 if (lastLeftBracket) {
-                    g_sunLighting.adjustTime(-1.0f); // Move time backward by 1 hour
-                    LOG("Sun time adjusted: " << g_sunLighting.getTimeOfDay() << ":00");
+                    sunLighting.adjustTime(-1.0f); // Move time backward by 1 hour
+                    LOG("Sun time adjusted: %.0f:00", sunLighting.getTimeOfDay());
                 }
             }
             
             if (g_inputState.keys[GLFW_KEY_RIGHT_BRACKET] != lastRightBracket) {
                 lastRightBracket = g_inputState.keys[GLFW_KEY_RIGHT_BRACKET];
                 if (lastRightBracket) {
-                    g_sunLighting.adjustTime(1.0f); // Move time forward by 1 hour
-                    LOG("Sun time adjusted: " << g_sunLighting.getTimeOfDay() << ":00");
+                    sunLighting.adjustTime(1.0f); // Move time forward by 1 hour
+                    LOG("Sun time adjusted: %.0f:00", sunLighting.getTimeOfDay());
                 }
             }
             
             // Show current key states every 60 frames for debugging
             static int keyDebugCounter = 0;
             if (++keyDebugCounter % 60 == 0) {
-                LOG("Key states - W:" << g_inputState.keys[GLFW_KEY_W] 
-                    << " A:" << g_inputState.keys[GLFW_KEY_A] 
-                    << " S:" << g_inputState.keys[GLFW_KEY_S] 
-                    << " D:" << g_inputState.keys[GLFW_KEY_D]
-                    << " SPACE:" << g_inputState.keys[GLFW_KEY_SPACE]
-                    << " C:" << g_inputState.keys[GLFW_KEY_C]);
+                ARENA_LOG_DEBUG(Input, "Key states - W:%d A:%d S:%d D:%d SPACE:%d C:%d",
+                    g_inputState.keys[GLFW_KEY_W], g_inputState.keys[GLFW_KEY_A],
+                    g_inputState.keys[GLFW_KEY_S], g_inputState.keys[GLFW_KEY_D],
+                    g_inputState.keys[GLFW_KEY_SPACE], g_inputState.keys[GLFW_KEY_C]);
             }
             
             // Show camera position and rotation
             static int logCounter = 0;
             if (++logCounter % 60 == 0) { // Log every 60 frames (about once per second at 60Hz)
-                auto* cameraTransform = g_registry.get<arena::ecs::Transform>(g_cameraEntityId);
+                auto* cameraTransform = registry.get<arena::ecs::Transform>(g_cameraEntityId);
                 if (cameraTransform) {
-                    LOG("Camera pos: (" << cameraTransform->pos[0] << ", " << cameraTransform->pos[1] << ", " << cameraTransform->pos[2] << ")");
-                    LOG("Camera rot: (" << cameraTransform->rotYawPitchRoll[0] << ", " << cameraTransform->rotYawPitchRoll[1] << ", " << cameraTransform->rotYawPitchRoll[2] << ")");
+                    ARENA_LOG_DEBUG(App, "Camera pos: (%.2f, %.2f, %.2f)", cameraTransform->pos[0], cameraTransform->pos[1], cameraTransform->pos[2]);
+                    ARENA_LOG_DEBUG(App, "Camera rot: (%.2f, %.2f, %.2f)", cameraTransform->rotYawPitchRoll[0], cameraTransform->rotYawPitchRoll[1], cameraTransform->rotYawPitchRoll[2]);
                 }
             }
         }
@@ -336,17 +517,19 @@ int main(int argc, char* argv[]) {
         if (args.runForMs > 0) {
             double elapsedMs = (now - startTime) * 1000.0;
             if (elapsedMs >= args.runForMs) {
-                LOG("Reached --runForMs limit (" << args.runForMs << "ms), exiting");
+                LOG("Reached --runForMs limit (%dms), exiting", args.runForMs);
                 break;
             }
         }
         
-        clock.step(frame); // Fixed-step simulation
+        if (instance.step(frame) > 0) { // Fixed-step simulation
+            frameStats.recordTick(now, instance.lastTickSeconds());
+        }
         
         // Log tick count every second
         if (now - lastLogTime >= 1.0) {
             double actualRate = clock.ticks / (now - startTime);
-            LOG("Ticks: " << clock.ticks << " (accum: " << clock.accumulator << ", rate: " << actualRate << " Hz, target: " << config.tick_hz << " Hz)");
+            LOG("Ticks: %llu (accum: %.4f, rate: %.2f Hz, target: %d Hz)", clock.ticks, clock.accumulator, actualRate, config.tick_hz);
             lastLogTime = now;
         }
         
@@ -358,6 +541,10 @@ int main(int argc, char* argv[]) {
                 break;
             }
             
+            ARENA_PROFILE_SCOPE("Render");
+            
+            frameStats.setMemory(registry.memoryBytes(), arena::gfx::Mesh::liveGpuBytes());
+            
             // Check for shader hot-reload
             basicShader.reloadIfChanged();
             
@@ -369,18 +556,20 @@ int main(int argc, char* argv[]) {
             glContext.getFramebufferSize(&fbW, &fbH);
             glViewport(0, 0, fbW, fbH);
             
-            // Get camera transform for view matrix
-            auto* cameraTransform = g_registry.get<arena::ecs::Transform>(g_cameraEntityId);
-            if (cameraTransform) {
+            // Get camera transform for view matrix, blended between the last two ticks
+            if (registry.has<arena::ecs::Transform>(g_cameraEntityId)) {
+                arena::ecs::Transform cameraTransform =
+                    instance.interpolation().extract(registry, g_cameraEntityId, static_cast<float>(clock.alpha()));
+
                 // View = R_x(-pitch) * R_y(-yaw) * T(-pos)
                 glm::mat4 view = glm::mat4(1.0f);
                 glm::vec3 camPos(
-                    cameraTransform->pos[0],
-                    cameraTransform->pos[1],
-                    cameraTransform->pos[2]
+                    cameraTransform.pos[0],
+                    cameraTransform.pos[1],
+                    cameraTransform.pos[2]
                 );
-                float yaw   = cameraTransform->rotYawPitchRoll[0];
-                float pitch = cameraTransform->rotYawPitchRoll[1];
+                float yaw   = cameraTransform.rotYawPitchRoll[0];
+                float pitch = cameraTransform.rotYawPitchRoll[1];
 
                 view = glm::rotate(view, -pitch, glm::vec3(1.0f, 0.0f, 0.0f));
                 view = glm::rotate(view, -yaw,   glm::vec3(0.0f, 1.0f, 0.0f));
@@ -418,16 +607,16 @@ int main(int argc, char* argv[]) {
                 GLint sunColorLoc = basicShader.uni("uSunColor");
                 
                 if (sunDirLoc != -1) {
-                    glm::vec3 sunDir = g_sunLighting.getSunDirection();
+                    glm::vec3 sunDir = sunLighting.getSunDirection();
                     glUniform3fv(sunDirLoc, 1, &sunDir[0]);
                 }
                 if (sunColorLoc != -1) {
-                    glm::vec3 sunColor = g_sunLighting.getSunColor();
+                    glm::vec3 sunColor = sunLighting.getSunColor();
                     glUniform3fv(sunColorLoc, 1, &sunColor[0]);
                 }
                 
                 // Set background color based on sun lighting
-                glm::vec3 ambientColor = g_sunLighting.getAmbientColor();
+                glm::vec3 ambientColor = sunLighting.getAmbientColor();
                 glClearColor(ambientColor.r, ambientColor.g, ambientColor.b, 1.0f);
                 glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -460,21 +649,26 @@ int main(int argc, char* argv[]) {
                 
                 // Draw sun time info
                 char timeStr[32];
-                snprintf(timeStr, sizeof(timeStr), "Sun Time: %.1f:00", g_sunLighting.getTimeOfDay());
+                snprintf(timeStr, sizeof(timeStr), "Sun Time: %.1f:00", sunLighting.getTimeOfDay());
                 arena::hud::TextHud_DrawLine(10, 100, timeStr, 0.8f, 0.8f, 1.0f);
                 
                 // Draw sun direction info
-                glm::vec3 sunDir = g_sunLighting.getSunDirection();
+                glm::vec3 sunDir = sunLighting.getSunDirection();
                 snprintf(timeStr, sizeof(timeStr), "Sun Dir: (%.2f, %.2f, %.2f)", sunDir.x, sunDir.y, sunDir.z);
                 arena::hud::TextHud_DrawLine(10, 120, timeStr, 0.8f, 0.8f, 1.0f);
+                
+                // Rolling frame/tick timings, hitches, subsystem breakdown and memory
+                arena::DebugHud::draw(10, 140, clock, g_inputState, frameStats, now);
             }
             
             // Swap buffers
+            ARENA_PROFILE_SCOPE("SwapBuffers");
             glContext.swapBuffers();
         }
         
         // Small sleep to prevent 100% CPU usage
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ARENA_PROFILE_FRAME();
     }
     
     // Cleanup text HUD system
@@ -491,10 +685,11 @@ int main(int argc, char* argv[]) {
     double finalRate = clock.ticks / totalTime;
     
     LOG("Final Results:");
-    LOG("Total time: " << totalTime << " seconds");
-    LOG("Total ticks: " << clock.ticks);
-    LOG("Average rate: " << finalRate << " Hz (target: " << config.tick_hz << " Hz)");
-    LOG("Rate accuracy: " << (finalRate / config.tick_hz * 100.0) << "%");
+    LOG("Total time: %.3f seconds", totalTime);
+    LOG("Total ticks: %llu", clock.ticks);
+    LOG("Average rate: %.2f Hz (target: %d Hz)", finalRate, config.tick_hz);
+    LOG("Rate accuracy: %.1f%%", finalRate / config.tick_hz * 100.0);
+    WritePerfReport(args, instance.counterReport());
     
     return 0;
 }
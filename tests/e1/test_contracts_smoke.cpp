@@ -64,6 +64,10 @@ TEST_CASE("contracts smoke across mocks + ECS") {
   phys.registerStaticMesh(mh, Mat4{});
   auto hit = phys.raycast({0,0,0},{0,0,1}, 100.f);
   REQUIRE(hit.hit); REQUIRE(hit.entity != 0);
+  Ray rays[2] = {{{0,0,0},{0,0,1},100.f}, {{0,0,0},{1,0,0},100.f}};
+  RayHit hits[2];
+  phys.raycastBatch(rays, hits);
+  REQUIRE(hits[0].hit); REQUIRE(hits[1].entity == hit.entity);
 
   // nav: bake + path
   REQUIRE(nav.bakeFromWorld(phys));
@@ -29,3 +29,10 @@ TEST_CASE("sparse set add/remove/get/view") {
   r.remove<A>(e1);
   REQUIRE_FALSE(r.has<A>(e1));
 }
+
+TEST_CASE("memoryBytes grows with component storage") {
+  Registry r;
+  size_t empty = r.memoryBytes();
+  for (int i = 0; i < 100; ++i) { auto e = r.create(); r.add<A>(e, {i}); }
+  REQUIRE(r.memoryBytes() >= empty + 100 * (sizeof(A) + sizeof(Entity)));
+}
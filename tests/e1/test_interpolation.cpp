@@ -0,0 +1,47 @@
+#include <catch2/catch_all.hpp>
+#include <arena/ecs/registry.hpp>
+#include <arena/ecs/components.hpp>
+#include <arena/ecs/interpolation_system.hpp>
+#include <cmath>
+using namespace arena::ecs;
+
+TEST_CASE("interpolation blends previous and current tick") {
+  Registry r; InterpolationSystem interp;
+  auto e = r.create();
+  r.add<Transform>(e, {{0,0,0}, {0,0,0}, {1,1,1}});
+
+  interp.capture(r);
+  REQUIRE(r.has<PreviousTransform>(e));
+
+  // Simulate one tick of movement
+  auto* t = r.get<Transform>(e);
+  t->pos[0] = 2.0f; t->rotYawPitchRoll[1] = 0.5f;
+
+  auto half = interp.extract(r, e, 0.5f);
+  REQUIRE(std::abs(half.pos[0] - 1.0f) < 1e-6f);
+  REQUIRE(std::abs(half.rotYawPitchRoll[1] - 0.25f) < 1e-6f);
+
+  auto start = interp.extract(r, e, 0.0f);
+  auto end = interp.extract(r, e, 1.0f);
+  REQUIRE(start.pos[0] == 0.0f);
+  REQUIRE(std::abs(end.pos[0] - 2.0f) < 1e-6f);
+}
+
+TEST_CASE("interpolation takes the shortest arc across +-pi") {
+  const float pi = 3.14159265f;
+  Transform a{}, b{};
+  a.rotYawPitchRoll[0] = pi - 0.1f;
+  b.rotYawPitchRoll[0] = -pi + 0.1f;
+
+  auto mid = InterpolationSystem::interpolate(a, b, 0.5f);
+  // Halfway along the 0.2 rad arc is +-pi, not 0
+  REQUIRE(std::abs(std::abs(mid.rotYawPitchRoll[0]) - pi) < 1e-4f);
+}
+
+TEST_CASE("entities without history extract their current transform") {
+  Registry r; InterpolationSystem interp;
+  auto e = r.create();
+  r.add<Transform>(e, {{3,4,5}, {0,0,0}, {1,1,1}});
+  auto t = interp.extract(r, e, 0.25f);
+  REQUIRE(t.pos[0] == 3.0f); REQUIRE(t.pos[2] == 5.0f);
+}
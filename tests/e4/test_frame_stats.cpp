@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/frame_stats.hpp"
+#include "arena/profiler.hpp"
+#include <cmath>
+
+using arena::FrameStats;
+using arena::TimingHistory;
+
+TEST_CASE("TimingHistory summarizes only samples inside the window", "[frame_stats]") {
+  TimingHistory history(256);
+  // 100 old slow samples, then 100 recent fast ones
+  for (int i = 0; i < 100; ++i) history.push(i * 0.01, 50.0f);
+  for (int i = 0; i < 100; ++i) history.push(10.0 + i * 0.01, 1.0f + static_cast<float>(i % 10));
+
+  auto s = history.summarize(11.0, 2.0);
+  REQUIRE(s.count == 100);
+  REQUIRE(s.min == 1.0f);
+  REQUIRE(s.max == 10.0f);
+  REQUIRE(std::abs(s.avg - 5.5f) < 1e-4f);
+  REQUIRE(s.p99 == 10.0f);
+
+  auto all = history.summarize(11.0, 100.0);
+  REQUIRE(all.count == 200);
+  REQUIRE(all.max == 50.0f);
+}
+
+TEST_CASE("TimingHistory wraps and exposes ring order for plotting", "[frame_stats]") {
+  TimingHistory history(4);
+  for (int i = 1; i <= 6; ++i) history.push(i, static_cast<float>(i));
+
+  REQUIRE(history.size() == 4);
+  REQUIRE(history.latest() == 6.0f);
+  // Oldest surviving sample is 3
+  REQUIRE(history.values()[history.offset()] == 3.0f);
+  auto s = history.summarize(6.0, 100.0);
+  REQUIRE(s.count == 4);
+  REQUIRE(s.min == 3.0f);
+}
+
+TEST_CASE("FrameStats counts frames far above the running average as hitches", "[frame_stats]") {
+  FrameStats stats(128, 5.0);
+  double t = 0.0;
+  for (int i = 0; i < 30; ++i) { t += 0.016; stats.recordFrame(t, 0.016); }
+  REQUIRE(stats.hitchCount() == 0);
+
+  t += 0.050;
+  stats.recordFrame(t, 0.050);
+  REQUIRE(stats.hitchCount() == 1);
+  REQUIRE(stats.lastHitchTime() == t);
+
+  // Normal jitter is not a hitch
+  t += 0.020;
+  stats.recordFrame(t, 0.020);
+  REQUIRE(stats.hitchCount() == 1);
+}
+
+TEST_CASE("FrameStats maps profiler zones onto tracked subsystems", "[frame_stats]") {
+  FrameStats stats(16, 5.0);
+  REQUIRE(stats.trackSubsystem("Render"));
+  REQUIRE(stats.trackSubsystem("Sim"));
+  REQUIRE(stats.trackSubsystem("Render")); // already tracked
+  REQUIRE(stats.subsystemCount() == 2);
+
+  arena::profile::ZoneTotal zones[] = {{"Sim", 2.0, 3}, {"Untracked", 9.0, 1}, {"Render", 4.0, 1}};
+  stats.recordFrame(0.016, 0.016);
+  stats.recordSubsystems(zones, 3);
+  REQUIRE(stats.subsystemMs(0, 0) == 4.0f);
+  REQUIRE(stats.subsystemMs(0, 1) == 2.0f);
+
+  // A frame without zone data starts from zero
+  stats.recordFrame(0.032, 0.016);
+  REQUIRE(stats.subsystemMs(1, 0) == 0.0f);
+
+  for (size_t i = stats.subsystemCount(); i < FrameStats::kMaxSubsystems; ++i) {
+    static char names[FrameStats::kMaxSubsystems][8];
+    names[i][0] = static_cast<char>('a' + i);
+    REQUIRE(stats.trackSubsystem(names[i]));
+  }
+  REQUIRE_FALSE(stats.trackSubsystem("Overflow"));
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/log.hpp"
+#include "../support/allocation_counter.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::mutex g_mutex;
+std::vector<std::string> g_lines;
+
+void CaptureSink(const char* line, size_t len, arena::log::Level, arena::log::Category, void*) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_lines.emplace_back(line, len);
+}
+
+// Route the logger into g_lines for the duration of a test
+struct CaptureScope {
+  CaptureScope() {
+    arena::log::setSink(&CaptureSink);
+    arena::log::setLevel(arena::log::Level::Trace);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_lines.clear();
+  }
+  ~CaptureScope() {
+    arena::log::flush();
+    arena::log::setSink(nullptr);
+    arena::log::setLevel(arena::log::Level::Info);
+  }
+  std::vector<std::string> lines() {
+    arena::log::flush();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_lines;
+  }
+};
+
+bool EndsWith(const std::string& s, const std::string& suffix) {
+  return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+TEST_CASE("log formats captured arguments on the logger thread", "[log]") {
+  CaptureScope capture;
+  std::string name = "arena";
+  ARENA_LOG_INFO(App, "x=%d y=%.2f s=%s u=%u big=%llu", -5, 1.5f, name, 7u, 1ull << 40);
+  ARENA_LOG_WARN(Net, "100%% done, missing %d");
+
+  auto lines = capture.lines();
+  REQUIRE(lines.size() == 2);
+  REQUIRE(EndsWith(lines[0], "[INFO] [app] x=-5 y=1.50 s=arena u=7 big=1099511627776"));
+  REQUIRE(EndsWith(lines[1], "[WARN] [net] 100% done, missing %d"));
+}
+
+TEST_CASE("log copies string arguments at the call site", "[log]") {
+  CaptureScope capture;
+  char buffer[16] = "before";
+  ARENA_LOG_INFO(App, "value=%s", buffer);
+  buffer[0] = 'X';
+
+  auto lines = capture.lines();
+  REQUIRE(lines.size() == 1);
+  REQUIRE(EndsWith(lines[0], "value=before"));
+}
+
+TEST_CASE("log filters by per-category level", "[log]") {
+  CaptureScope capture;
+  arena::log::setLevel(arena::log::Category::Input, arena::log::Level::Warn);
+  REQUIRE_FALSE(arena::log::enabled(arena::log::Category::Input, arena::log::Level::Info));
+
+  ARENA_LOG_INFO(Input, "filtered");
+  ARENA_LOG_ERROR(Input, "kept");
+  ARENA_LOG_DEBUG(App, "also kept");
+
+  auto lines = capture.lines();
+  REQUIRE(lines.size() == 2);
+  REQUIRE(EndsWith(lines[0], "kept"));
+  REQUIRE(EndsWith(lines[1], "also kept"));
+}
+
+TEST_CASE("log rate limits noisy categories and reports suppressed lines", "[log]") {
+  CaptureScope capture;
+  arena::log::setRateLimit(arena::log::Category::Phys, 10);
+  for (int i = 0; i < 100; ++i) {
+    ARENA_LOG_INFO(Phys, "contact %d", i);
+  }
+  ARENA_LOG_ERROR(Phys, "errors are never rate limited");
+
+  auto lines = capture.lines();
+  REQUIRE(lines.size() == 11);
+
+  // The suppression notice is written once the one-second window has rolled over
+  bool reported = false;
+  for (int i = 0; i < 40 && !reported; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (auto& line : capture.lines()) {
+      if (line.find("suppressed 90 phys lines") != std::string::npos) reported = true;
+    }
+  }
+  REQUIRE(reported);
+  arena::log::setRateLimit(arena::log::Category::Phys, 200);
+}
+
+TEST_CASE("log hot path does not allocate", "[log]") {
+  CaptureScope capture;
+  arena::log::setRateLimit(arena::log::Category::Sim, 0);
+  ARENA_LOG_INFO(Sim, "warm up %d", 0);
+  arena::log::flush();
+
+  std::string label = "tick";
+  size_t before = arena::test::allocationCount();
+  for (int i = 0; i < 1000; ++i) {
+    ARENA_LOG_DEBUG(Sim, "%s %d took %.3f ms", label, i, 0.25 * i);
+  }
+  size_t after = arena::test::allocationCount();
+  REQUIRE(after == before);
+
+  REQUIRE(capture.lines().size() == 1001);
+  arena::log::setRateLimit(arena::log::Category::Sim, 200);
+}
+
+TEST_CASE("log accepts records from many threads", "[log]") {
+  CaptureScope capture;
+  arena::log::setRateLimit(arena::log::Category::Nav, 0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < 500; ++i) ARENA_LOG_INFO(Nav, "thread %d line %d", t, i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  REQUIRE(capture.lines().size() == 2000);
+  arena::log::setRateLimit(arena::log::Category::Nav, 200);
+}
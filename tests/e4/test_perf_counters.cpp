@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/perf_counters.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using arena::perf::CounterTotals;
+using arena::perf::CounterValues;
+
+TEST_CASE("Counter deltas and totals add up", "[perf]") {
+  CounterValues a{100, 250, 3, 7};
+  CounterValues b{160, 400, 5, 9};
+  CounterValues d = b - a;
+  REQUIRE(d.cycles == 60);
+  REQUIRE(d.instructions == 150);
+  REQUIRE(d.llcMisses == 2);
+  REQUIRE(d.branchMisses == 2);
+
+  CounterTotals totals;
+  totals.add(d);
+  totals.add(d);
+  REQUIRE(totals.samples == 2);
+  REQUIRE(totals.sum.instructions == 300);
+}
+
+TEST_CASE("Reads do nothing while sampling is disabled", "[perf]") {
+  arena::perf::setEnabled(false);
+  CounterValues v;
+  REQUIRE_FALSE(arena::perf::read(v));
+}
+
+TEST_CASE("Thread counters measure work when the kernel allows it", "[perf]") {
+  arena::perf::ThreadCounters counters;
+  if (!counters.open()) {
+    WARN("perf_event_open unavailable here; skipping counter checks");
+    CounterValues v;
+    REQUIRE_FALSE(counters.read(v));
+    return;
+  }
+
+  CounterValues before, after;
+  REQUIRE(counters.read(before));
+  volatile uint64_t sink = 0;
+  for (uint64_t i = 0; i < 1000000; ++i) sink = sink + i;
+  REQUIRE(counters.read(after));
+
+  CounterValues d = after - before;
+  REQUIRE(d.instructions >= 1000000);
+  REQUIRE(d.cycles > 0);
+}
+
+TEST_CASE("Benchmark JSON lists every entry with derived rates", "[perf]") {
+  CounterTotals tick;
+  tick.add({2000, 3000, 10, 20});
+  tick.add({2000, 3000, 10, 20});
+  std::vector<arena::perf::ReportEntry> entries = {{"tick", tick}, {"camera", CounterTotals{}}};
+
+  const std::string path = "test_perf_counters.json";
+  REQUIRE(arena::perf::writeBenchmarkJson(path, "unit", entries));
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string json = ss.str();
+  in.close();
+  std::remove(path.c_str());
+
+  REQUIRE(json.find("\"benchmark\": \"unit\"") != std::string::npos);
+  REQUIRE(json.find("\"name\": \"tick\", \"samples\": 2, \"cycles\": 4000, \"instructions\": 6000") != std::string::npos);
+  REQUIRE(json.find("\"ipc\": 1.500") != std::string::npos);
+  REQUIRE(json.find("\"cyclesPerSample\": 2000.0") != std::string::npos);
+  REQUIRE(json.find("\"name\": \"camera\", \"samples\": 0") != std::string::npos);
+}
+
+TEST_CASE("Benchmark JSON escapes names", "[perf]") {
+  std::vector<arena::perf::ReportEntry> entries = {{"say \"hi\"\\there\n", CounterTotals{}}};
+  const std::string path = "test_perf_counters_escape.json";
+  REQUIRE(arena::perf::writeBenchmarkJson(path, "a\\b", entries));
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string json = ss.str();
+  in.close();
+  std::remove(path.c_str());
+
+  REQUIRE(json.find("\"benchmark\": \"a\\\\b\"") != std::string::npos);
+  REQUIRE(json.find("\"name\": \"say \\\"hi\\\"\\\\there\\u000a\", \"samples\": 0") != std::string::npos);
+}
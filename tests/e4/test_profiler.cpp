@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/profiler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+void BusyWaitMs(double ms) {
+  auto end = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+void ProfiledWork() {
+  ARENA_PROFILE_SCOPE("ProfiledWork");
+  BusyWaitMs(1.0);
+}
+
+void ProfiledOuter() {
+  ARENA_PROFILE_SCOPE("ProfiledOuter");
+  ProfiledWork();
+  ProfiledWork();
+}
+
+const arena::profile::ZoneTotal* FindTotal(const std::vector<arena::profile::ZoneTotal>& totals, const std::string& name) {
+  for (auto& total : totals) {
+    if (name == total.name) return &total;
+  }
+  return nullptr;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+size_t CountOccurrences(const std::string& haystack, const std::string& needle) {
+  size_t count = 0;
+  for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+} // namespace
+
+TEST_CASE("Zones cost nothing and record nothing while the profiler is off", "[profiler]") {
+  arena::profile::setFrameTotalsEnabled(false);
+  arena::profile::endCapture();
+  arena::profile::frameMark();
+
+  ProfiledOuter();
+  arena::profile::frameMark();
+
+  REQUIRE(FindTotal(arena::profile::lastFrameTotals(), "ProfiledWork") == nullptr);
+}
+
+TEST_CASE("Frame totals accumulate per zone and roll over at frame marks", "[profiler]") {
+  arena::profile::setFrameTotalsEnabled(true);
+  arena::profile::frameMark();
+
+  ProfiledOuter();
+  arena::profile::frameMark();
+
+  auto totals = arena::profile::lastFrameTotals();
+  auto* work = FindTotal(totals, "ProfiledWork");
+  auto* outer = FindTotal(totals, "ProfiledOuter");
+  REQUIRE(work != nullptr);
+  REQUIRE(outer != nullptr);
+  REQUIRE(work->calls == 2);
+  REQUIRE(outer->calls == 1);
+  REQUIRE(work->ms >= 1.5);
+  REQUIRE(outer->ms >= work->ms);
+  REQUIRE(arena::profile::lastFrameMs() >= outer->ms);
+
+  // An empty frame clears the totals
+  arena::profile::frameMark();
+  REQUIRE(FindTotal(arena::profile::lastFrameTotals(), "ProfiledWork") == nullptr);
+
+  arena::profile::setFrameTotalsEnabled(false);
+}
+
+TEST_CASE("Captures export Chrome trace JSON with zones, threads and frames", "[profiler]") {
+  arena::profile::setThreadName("Main");
+  arena::profile::beginCapture();
+
+  ProfiledOuter();
+  std::thread worker([] {
+    arena::profile::setThreadName("Worker");
+    ProfiledWork();
+  });
+  worker.join();
+  arena::profile::frameMark();
+
+  arena::profile::endCapture();
+  ProfiledWork(); // after the capture: must not appear
+
+  const std::string path = "test_profiler_trace.json";
+  REQUIRE(arena::profile::exportChromeTrace(path));
+  std::string json = ReadFile(path);
+  std::remove(path.c_str());
+
+  REQUIRE(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+  REQUIRE(json.find("]}") != std::string::npos);
+  REQUIRE(CountOccurrences(json, "\"name\":\"ProfiledWork\"") == 3);
+  REQUIRE(CountOccurrences(json, "\"name\":\"ProfiledOuter\"") == 1);
+  REQUIRE(json.find("\"args\":{\"name\":\"Main\"}") != std::string::npos);
+  REQUIRE(json.find("\"args\":{\"name\":\"Worker\"}") != std::string::npos);
+  REQUIRE(CountOccurrences(json, "\"cat\":\"frame\"") == 1);
+  REQUIRE(arena::profile::overwrittenCount() == 0);
+}
+
+TEST_CASE("A new capture discards events from the previous one", "[profiler]") {
+  arena::profile::beginCapture();
+  ProfiledWork();
+  arena::profile::endCapture();
+
+  arena::profile::beginCapture();
+  arena::profile::endCapture();
+
+  const std::string path = "test_profiler_empty.json";
+  REQUIRE(arena::profile::exportChromeTrace(path));
+  std::string json = ReadFile(path);
+  std::remove(path.c_str());
+
+  REQUIRE(CountOccurrences(json, "\"name\":\"ProfiledWork\"") == 0);
+}
+
+TEST_CASE("Counter samples export as Chrome counter events", "[profiler]") {
+  static const arena::profile::CounterTrack track{"Test counters", {"cycles", "misses"}, 2};
+  double values[2] = {1234.0, 5.0};
+  arena::profile::counterSample(track, values); // not capturing: dropped
+
+  arena::profile::beginCapture();
+  arena::profile::counterSample(track, values);
+  arena::profile::endCapture();
+
+  const std::string path = "test_profiler_counters.json";
+  REQUIRE(arena::profile::exportChromeTrace(path));
+  std::string json = ReadFile(path);
+  std::remove(path.c_str());
+
+  REQUIRE(CountOccurrences(json, "\"ph\":\"C\"") == 1);
+  REQUIRE(json.find("\"args\":{\"cycles\":1234,\"misses\":5}") != std::string::npos);
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/task_pool.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("parallelFor covers every index exactly once", "[task_pool]") {
+  arena::TaskPool pool(3);
+  REQUIRE(pool.threadCount() == 3);
+
+  // Catch assertions aren't thread-safe; collect from the chunks, check after
+  std::vector<std::atomic<int>> seen(10007);
+  std::atomic<bool> badRange{false};
+  pool.parallelFor(seen.size(), 64, [&](size_t begin, size_t end) {
+    if (begin >= end || end > seen.size()) badRange = true;
+    for (size_t i = begin; i < end && i < seen.size(); ++i) seen[i].fetch_add(1);
+  });
+  REQUIRE_FALSE(badRange.load());
+  for (auto& count : seen) REQUIRE(count.load() == 1);
+
+  // Empty and single-chunk ranges run inline
+  int calls = 0;
+  pool.parallelFor(0, 16, [&](size_t, size_t) { ++calls; });
+  pool.parallelFor(10, 16, [&](size_t begin, size_t end) {
+    REQUIRE(begin == 0);
+    REQUIRE(end == 10);
+    ++calls;
+  });
+  REQUIRE(calls == 1);
+}
+
+TEST_CASE("Concurrent and nested parallelFor calls complete", "[task_pool]") {
+  arena::TaskPool pool(2);
+  std::atomic<long> total{0};
+
+  auto job = [&] {
+    for (int round = 0; round < 50; ++round) {
+      pool.parallelFor(64, 8, [&](size_t begin, size_t end) {
+        // Nested call from inside a chunk, possibly on a pool thread
+        pool.parallelFor(end - begin, 2, [&](size_t b, size_t e) { total.fetch_add(static_cast<long>(e - b)); });
+      });
+    }
+  };
+  std::thread a(job), b(job);
+  job();
+  a.join();
+  b.join();
+
+  REQUIRE(total.load() == 3L * 50 * 64);
+}
@@ -0,0 +1,186 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/ecs/avoidance_system.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+
+namespace {
+
+constexpr float kDt = 1.0f / 60.0f;
+constexpr float kPi = 3.14159265f;
+
+struct Walker {
+  Entity e;
+  float goal[2];
+};
+
+Entity Spawn(Registry& r, float x, float z) {
+  Entity e = r.create();
+  Transform t;
+  t.pos[0] = x; t.pos[2] = z;
+  r.add<Transform>(e, t);
+  r.add<AvoidanceAgent>(e, {});
+  return e;
+}
+
+// Heads each walker straight for its goal, stopping on it
+void Steer(Registry& r, const std::vector<Walker>& walkers) {
+  for (const Walker& w : walkers) {
+    auto* t = r.get<Transform>(w.e);
+    auto* a = r.get<AvoidanceAgent>(w.e);
+    float dx = w.goal[0] - t->pos[0], dz = w.goal[1] - t->pos[2];
+    float dist = std::sqrt(dx * dx + dz * dz);
+    float speed = std::min(a->maxSpeed, dist / kDt);
+    a->preferred[0] = dist > 1e-4f ? dx / dist * speed : 0.0f;
+    a->preferred[1] = dist > 1e-4f ? dz / dist * speed : 0.0f;
+  }
+}
+
+// Moves each walker by the velocity it was given
+void Move(Registry& r, const std::vector<Walker>& walkers) {
+  for (const Walker& w : walkers) {
+    auto* t = r.get<Transform>(w.e);
+    auto* a = r.get<AvoidanceAgent>(w.e);
+    t->pos[0] += a->velocity[0] * kDt;
+    t->pos[2] += a->velocity[1] * kDt;
+  }
+}
+
+// Closest any two walkers came, as a fraction of their combined radius
+float Run(AvoidanceSystem& system, Registry& r, const std::vector<Walker>& walkers, int ticks) {
+  float closest = 1e9f;
+  for (int i = 0; i < ticks; ++i) {
+    Steer(r, walkers);
+    system.update(kDt, r);
+    Move(r, walkers);
+    for (size_t a = 0; a < walkers.size(); ++a) {
+      for (size_t b = a + 1; b < walkers.size(); ++b) {
+        const auto* ta = r.get<Transform>(walkers[a].e);
+        const auto* tb = r.get<Transform>(walkers[b].e);
+        float dx = ta->pos[0] - tb->pos[0], dz = ta->pos[2] - tb->pos[2];
+        float combined = r.get<AvoidanceAgent>(walkers[a].e)->radius + r.get<AvoidanceAgent>(walkers[b].e)->radius;
+        closest = std::min(closest, std::sqrt(dx * dx + dz * dz) / combined);
+      }
+    }
+  }
+  return closest;
+}
+
+bool Arrived(Registry& r, const std::vector<Walker>& walkers, float within) {
+  for (const Walker& w : walkers) {
+    const auto* t = r.get<Transform>(w.e);
+    float dx = w.goal[0] - t->pos[0], dz = w.goal[1] - t->pos[2];
+    if (dx * dx + dz * dz > within * within) return false;
+  }
+  return true;
+}
+
+// count agents round a circle, each heading for the opposite side
+std::vector<Walker> Circle(Registry& r, int count, float radius) {
+  std::vector<Walker> walkers;
+  for (int i = 0; i < count; ++i) {
+    float angle = 2.0f * kPi * i / count;
+    float x = radius * std::cos(angle), z = radius * std::sin(angle);
+    walkers.push_back({Spawn(r, x, z), {-x, -z}});
+  }
+  return walkers;
+}
+
+} // namespace
+
+TEST_CASE("Two agents head-on pass each other", "[avoidance]") {
+  Registry r;
+  // Slightly off the line, as they never quite are in play
+  std::vector<Walker> walkers = {{Spawn(r, -6.0f, 0.0f), {6.0f, 0.0f}}, {Spawn(r, 6.0f, 0.05f), {-6.0f, 0.05f}}};
+  AvoidanceSystem system;
+  float closest = Run(system, r, walkers, 240);
+  REQUIRE(system.agentCount() == 2);
+  REQUIRE(closest >= 0.95f);
+  REQUIRE(Arrived(r, walkers, 0.1f));
+
+  // Exactly on the line works too
+  Registry exact;
+  walkers = {{Spawn(exact, -6.0f, 0.0f), {6.0f, 0.0f}}, {Spawn(exact, 6.0f, 0.0f), {-6.0f, 0.0f}}};
+  REQUIRE(Run(system, exact, walkers, 240) >= 0.95f);
+  REQUIRE(Arrived(exact, walkers, 0.1f));
+}
+
+TEST_CASE("Two groups cross through each other", "[avoidance]") {
+  Registry r;
+  std::vector<Walker> walkers;
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 5; ++col) {
+      float x = 10.0f + 1.5f * col, z = 1.5f * (row - 1.5f);
+      walkers.push_back({Spawn(r, -x, z), {x, z}});
+      walkers.push_back({Spawn(r, x, z + 0.75f), {-x, z + 0.75f}});
+    }
+  }
+  AvoidanceSystem system;
+  float closest = Run(system, r, walkers, 1200);
+  REQUIRE(closest >= 0.95f);
+  REQUIRE(Arrived(r, walkers, 0.25f));
+}
+
+TEST_CASE("Agents without a Transform are left alone", "[avoidance]") {
+  Registry r;
+  Entity loose = r.create();
+  AvoidanceAgent agent;
+  agent.preferred[0] = 1.0f;
+  r.add<AvoidanceAgent>(loose, agent);
+  Entity placed = Spawn(r, 0.0f, 0.0f);
+  r.get<AvoidanceAgent>(placed)->preferred[1] = 2.0f;
+
+  AvoidanceSystem system;
+  system.update(kDt, r);
+  REQUIRE(system.agentCount() == 1);
+  REQUIRE(r.get<AvoidanceAgent>(loose)->velocity[0] == 0.0f);
+  REQUIRE(r.get<AvoidanceAgent>(placed)->velocity[0] == 0.0f);
+  REQUIRE(r.get<AvoidanceAgent>(placed)->velocity[1] == 2.0f);
+}
+
+TEST_CASE("Avoidance drives CharacterInput at the controller's speed", "[avoidance]") {
+  Registry r;
+  Entity e = Spawn(r, 0.0f, 0.0f);
+  CharacterController controller;
+  controller.speed = 5.0f;
+  r.add<CharacterController>(e, controller);
+  r.add<CharacterInput>(e, {});
+  auto* agent = r.get<AvoidanceAgent>(e);
+  agent->preferred[0] = 2.5f;
+  agent->preferred[1] = -1.0f;
+
+  // Without a controller the agent's own maxSpeed is a full stick
+  Entity bare = Spawn(r, 20.0f, 0.0f);
+  r.add<CharacterInput>(bare, {});
+  r.get<AvoidanceAgent>(bare)->preferred[0] = r.get<AvoidanceAgent>(bare)->maxSpeed;
+
+  AvoidanceSystem system;
+  system.update(kDt, r);
+  REQUIRE(r.get<CharacterInput>(e)->move[0] == 0.5f);
+  REQUIRE(r.get<CharacterInput>(e)->move[1] == -0.2f);
+  REQUIRE(r.get<CharacterInput>(bare)->move[0] == 1.0f);
+}
+
+TEST_CASE("Parallel avoidance matches serial", "[avoidance]") {
+  Registry serial, parallel;
+  std::vector<Walker> ws = Circle(serial, 300, 25.0f);
+  std::vector<Walker> wp = Circle(parallel, 300, 25.0f);
+
+  AvoidanceSystem a, b;
+  TaskPool pool(3);
+  b.setTaskPool(&pool);
+  Run(a, serial, ws, 30);
+  Run(b, parallel, wp, 30);
+
+  auto& as = serial.storage<AvoidanceAgent>();
+  auto& ap = parallel.storage<AvoidanceAgent>();
+  REQUIRE(as.data.size() == ap.data.size());
+  for (size_t i = 0; i < as.data.size(); ++i) {
+    REQUIRE(as.data[i].velocity[0] == ap.data[i].velocity[0]);
+    REQUIRE(as.data[i].velocity[1] == ap.data[i].velocity[1]);
+  }
+}
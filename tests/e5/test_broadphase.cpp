@@ -0,0 +1,196 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/ecs/broadphase_system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace arena::ecs;
+
+namespace {
+
+Collider Box(float hx, float hy, float hz, bool isStatic = false) {
+  Collider c;
+  c.shape = 1;
+  c.params[0] = hx; c.params[1] = hy; c.params[2] = hz;
+  c.isStatic = isStatic;
+  return c;
+}
+
+Collider Capsule(float radius, float halfHeight) {
+  Collider c;
+  c.shape = 2;
+  c.params[0] = radius; c.params[1] = halfHeight;
+  c.isStatic = false;
+  return c;
+}
+
+Transform At(float x, float y, float z) {
+  Transform t;
+  t.pos[0] = x; t.pos[1] = y; t.pos[2] = z;
+  return t;
+}
+
+// Every overlapping, not-both-static pair by testing all of them
+std::vector<ColliderPair> BruteForce(Registry& r) {
+  struct Item { Entity e; float min[3], max[3]; bool isStatic; };
+  std::vector<Item> items;
+  auto& colliders = r.storage<Collider>();
+  for (size_t i = 0; i < colliders.data.size(); ++i) {
+    Entity e = colliders.denseToEntity[i];
+    auto* t = r.get<Transform>(e);
+    Item item{e, {}, {}, colliders.data[i].isStatic};
+    if (t && BroadphaseSystem::colliderBounds(*t, colliders.data[i], item.min, item.max)) items.push_back(item);
+  }
+  std::vector<ColliderPair> pairs;
+  for (size_t i = 0; i < items.size(); ++i) {
+    for (size_t j = 0; j < items.size(); ++j) {
+      const Item& p = items[i];
+      const Item& q = items[j];
+      if (p.e >= q.e || (p.isStatic && q.isStatic)) continue;
+      bool overlap = true;
+      for (int a = 0; a < 3; ++a) overlap &= p.min[a] <= q.max[a] && q.min[a] <= p.max[a];
+      if (overlap) pairs.push_back({p.e, q.e});
+    }
+  }
+  std::sort(pairs.begin(), pairs.end(), [](const ColliderPair& x, const ColliderPair& y) {
+    return x.a != y.a ? x.a < y.a : x.b < y.b;
+  });
+  return pairs;
+}
+
+std::vector<ColliderPair> ToVector(std::span<const ColliderPair> pairs) {
+  return {pairs.begin(), pairs.end()};
+}
+
+} // namespace
+
+TEST_CASE("Collider bounds follow shape, rotation and scale", "[broadphase]") {
+  float min[3], max[3];
+
+  Transform t = At(1, 2, 3);
+  REQUIRE(BroadphaseSystem::colliderBounds(t, Box(1, 2, 3), min, max));
+  REQUIRE(min[0] == 0.0f);
+  REQUIRE(max[1] == 4.0f);
+  REQUIRE(max[2] == 6.0f);
+
+  // Quarter turn of yaw swaps the x and z extents
+  t.rotYawPitchRoll[0] = 1.5707964f;
+  REQUIRE(BroadphaseSystem::colliderBounds(t, Box(1, 2, 3), min, max));
+  REQUIRE(std::abs((max[0] - min[0]) - 6.0f) < 1e-4f);
+  REQUIRE(std::abs((max[2] - min[2]) - 2.0f) < 1e-4f);
+
+  // Upright capsule: radius sideways, radius + half height vertically, scaled
+  Transform c = At(0, 0, 0);
+  c.scale[1] = 2.0f;
+  REQUIRE(BroadphaseSystem::colliderBounds(c, Capsule(0.5f, 0.4f), min, max));
+  REQUIRE(max[0] == 0.5f);
+  REQUIRE(std::abs(max[1] - 1.3f) < 1e-6f);
+
+  REQUIRE_FALSE(BroadphaseSystem::colliderBounds(c, Collider{}, min, max));
+}
+
+TEST_CASE("Broadphase pairs match brute force as colliders move", "[broadphase]") {
+  Registry r;
+  BroadphaseSystem broadphase(2.0f);
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> pos(-20.0f, 20.0f), size(0.1f, 0.9f), step(-0.6f, 0.6f);
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 600; ++i) {
+    Entity e = r.create();
+    r.add<Transform>(e, At(pos(rng), pos(rng) * 0.2f, pos(rng)));
+    if (i % 5 == 0) {
+      r.add<Collider>(e, Capsule(size(rng) * 0.5f, size(rng)));
+    } else {
+      r.add<Collider>(e, Box(size(rng), size(rng), size(rng), i % 7 == 0));
+    }
+    entities.push_back(e);
+  }
+  // A few wider than a cell, including a static floor slab
+  for (int i = 0; i < 3; ++i) {
+    Entity e = r.create();
+    r.add<Transform>(e, At(pos(rng), 0, pos(rng)));
+    r.add<Collider>(e, Box(3.0f + i, 0.5f, 2.5f, i == 0));
+    entities.push_back(e);
+  }
+
+  for (int tick = 0; tick < 20; ++tick) {
+    auto pairs = ToVector(broadphase.update(r));
+    auto expected = BruteForce(r);
+    REQUIRE(!expected.empty());
+    REQUIRE(pairs == expected);
+
+    // Move a third of the dynamic colliders, spin some, destroy and respawn a few
+    for (size_t i = 0; i < entities.size(); ++i) {
+      if (i % 3 != static_cast<size_t>(tick % 3) || r.get<Collider>(entities[i])->isStatic) continue;
+      auto* t = r.get<Transform>(entities[i]);
+      t->pos[0] += step(rng);
+      t->pos[2] += step(rng);
+      if (i % 11 == 0) t->rotYawPitchRoll[0] += 0.3f;
+    }
+    for (int k = 0; k < 5; ++k) {
+      size_t victim = (tick * 37 + k * 101) % entities.size();
+      r.destroy(entities[victim]);
+      Entity e = r.create();
+      r.add<Transform>(e, At(pos(rng), 0, pos(rng)));
+      r.add<Collider>(e, Box(size(rng), size(rng), size(rng)));
+      entities[victim] = e;
+    }
+  }
+}
+
+TEST_CASE("Broadphase only refreshes colliders that changed", "[broadphase]") {
+  Registry r;
+  BroadphaseSystem broadphase;
+  Entity a = r.create();
+  Entity b = r.create();
+  Entity c = r.create();
+  r.add<Transform>(a, At(0, 0, 0));
+  r.add<Collider>(a, Box(0.5f, 0.5f, 0.5f));
+  r.add<Transform>(b, At(0.8f, 0, 0));
+  r.add<Collider>(b, Box(0.5f, 0.5f, 0.5f));
+  r.add<Transform>(c, At(10, 0, 0));
+  r.add<Collider>(c, Capsule(0.4f, 0.5f));
+
+  REQUIRE(ToVector(broadphase.update(r)) == std::vector<ColliderPair>{{a, b}});
+  REQUIRE(broadphase.refreshedCount() == 3);
+
+  REQUIRE(ToVector(broadphase.update(r)) == std::vector<ColliderPair>{{a, b}});
+  REQUIRE(broadphase.refreshedCount() == 0);
+
+  // c walks over to b, across several cells
+  r.get<Transform>(c)->pos[0] = 1.5f;
+  REQUIRE(ToVector(broadphase.update(r)) == std::vector<ColliderPair>{{a, b}, {b, c}});
+  REQUIRE(broadphase.refreshedCount() == 1);
+
+  // Losing the Collider or the entity drops its pairs
+  r.remove<Collider>(a);
+  REQUIRE(ToVector(broadphase.update(r)) == std::vector<ColliderPair>{{b, c}});
+  r.destroy(c);
+  REQUIRE(broadphase.update(r).empty());
+  REQUIRE(broadphase.proxyCount() == 1);
+}
+
+TEST_CASE("Broadphase pair order doesn't depend on storage order", "[broadphase]") {
+  // Same scene, components added in opposite orders
+  Registry forward, backward;
+  std::vector<Entity> ids;
+  for (int i = 0; i < 200; ++i) {
+    ids.push_back(forward.create());
+    backward.create();
+  }
+  auto place = [](Registry& r, Entity e) {
+    float x = static_cast<float>(e % 20) * 0.7f, z = static_cast<float>(e / 20) * 0.7f;
+    r.add<Transform>(e, At(x, 0, z));
+    r.add<Collider>(e, Box(0.4f, 0.4f, 0.4f, e % 4 == 0));
+  };
+  for (Entity e : ids) place(forward, e);
+  for (auto it = ids.rbegin(); it != ids.rend(); ++it) place(backward, *it);
+
+  BroadphaseSystem a, b(1.0f);
+  auto pairsA = ToVector(a.update(forward));
+  auto pairsB = ToVector(b.update(backward));
+  REQUIRE(!pairsA.empty());
+  REQUIRE(pairsA == pairsB);
+}
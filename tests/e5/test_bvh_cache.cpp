@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/phys/static_world.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace arena;
+using namespace arena::phys;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Scratch directory removed when the test ends
+struct TempDir {
+  fs::path path;
+  TempDir() {
+    path = fs::temp_directory_path() / ("arena_bvh_cache_" + std::to_string(std::random_device{}()));
+    fs::create_directories(path);
+  }
+  ~TempDir() {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+  }
+  std::string str() const { return path.string(); }
+};
+
+// A few meshes of random triangles, registered as one batch
+void LoadLevel(StaticWorld& world, uint32_t seed, const std::string& cacheDir, bool* usedCache = nullptr) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> center(-40.0f, 40.0f), offset(-3.0f, 3.0f);
+  world.beginBatch();
+  for (int mesh = 0; mesh < 6; ++mesh) {
+    std::vector<float> pos;
+    std::vector<uint32_t> idx;
+    for (int t = 0; t < 300; ++t) {
+      float c[3] = {center(rng), center(rng), center(rng)};
+      for (int v = 0; v < 3; ++v) {
+        for (int a = 0; a < 3; ++a) pos.push_back(c[a] + offset(rng));
+        idx.push_back(static_cast<uint32_t>(idx.size()));
+      }
+    }
+    world.addTriangles(pos, idx);
+  }
+  bool used = world.endBatch(cacheDir);
+  if (usedCache) *usedCache = used;
+}
+
+std::vector<Ray> RandomRays(uint32_t seed, int count) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> p(-50.0f, 50.0f), d(-1.0f, 1.0f);
+  std::vector<Ray> rays(count);
+  for (auto& ray : rays) ray = Ray{{p(rng), p(rng), p(rng)}, {d(rng), d(rng), d(rng) + 0.01f}, 200.0f};
+  return rays;
+}
+
+fs::path CacheFile(const TempDir& dir) {
+  for (auto& entry : fs::directory_iterator(dir.path)) {
+    if (entry.path().extension() == ".bvh") return entry.path();
+  }
+  return {};
+}
+
+} // namespace
+
+TEST_CASE("A mapped BVH cache answers queries exactly like the built world", "[phys][bvhcache]") {
+  TempDir dir;
+  StaticWorld built(nullptr);
+  bool usedCache = true;
+  LoadLevel(built, 7, dir.str(), &usedCache);
+  REQUIRE_FALSE(usedCache);
+  REQUIRE_FALSE(built.isMapped());
+  REQUIRE(fs::exists(CacheFile(dir)));
+
+  StaticWorld mapped(nullptr);
+  LoadLevel(mapped, 7, dir.str(), &usedCache);
+  REQUIRE(usedCache);
+  REQUIRE(mapped.isMapped());
+  REQUIRE(mapped.contentHash() == built.contentHash());
+  REQUIRE(mapped.meshCount() == built.meshCount());
+  REQUIRE(mapped.triangleCount() == built.triangleCount());
+
+  for (const Ray& ray : RandomRays(11, 2000)) {
+    RayHit a = built.raycast(ray.origin, ray.dir, ray.maxDist);
+    RayHit b = mapped.raycast(ray.origin, ray.dir, ray.maxDist);
+    REQUIRE(a.hit == b.hit);
+    if (!a.hit) continue;
+    REQUIRE(a.t == b.t);
+    REQUIRE(a.normal.x == b.normal.x);
+    REQUIRE(a.normal.y == b.normal.y);
+    REQUIRE(a.normal.z == b.normal.z);
+  }
+
+  Capsule cap{0.4f, 0.5f};
+  Vec3 outA, outB;
+  REQUIRE(built.sweepCapsule(cap, {0, 0, -60}, {0, 0, 120}, outA) ==
+          mapped.sweepCapsule(cap, {0, 0, -60}, {0, 0, 120}, outB));
+  REQUIRE(outA.z == outB.z);
+}
+
+TEST_CASE("Different geometry misses the cache and damaged files are rejected", "[phys][bvhcache]") {
+  TempDir dir;
+  StaticWorld first(nullptr);
+  LoadLevel(first, 1, dir.str());
+  fs::path file = CacheFile(dir);
+  REQUIRE(MappedBvh::open(file.string(), first.contentHash()) != nullptr);
+
+  // Other geometry hashes differently and builds its own file
+  StaticWorld other(nullptr);
+  bool usedCache = true;
+  LoadLevel(other, 2, dir.str(), &usedCache);
+  REQUIRE_FALSE(usedCache);
+  REQUIRE(other.contentHash() != first.contentHash());
+  REQUIRE(MappedBvh::open(file.string(), other.contentHash()) == nullptr);
+
+  // Truncated
+  fs::path truncated = dir.path / "truncated.bvh";
+  fs::copy_file(file, truncated);
+  fs::resize_file(truncated, fs::file_size(file) - 64);
+  REQUIRE(MappedBvh::open(truncated.string(), first.contentHash()) == nullptr);
+
+  // Wrong version
+  fs::path stale = dir.path / "stale.bvh";
+  fs::copy_file(file, stale);
+  {
+    std::fstream f(stale, std::ios::in | std::ios::out | std::ios::binary);
+    uint32_t version = kBvhCacheVersion + 1;
+    f.seekp(offsetof(BvhCacheHeader, version));
+    f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  REQUIRE(MappedBvh::open(stale.string(), first.contentHash()) == nullptr);
+  REQUIRE(MappedBvh::open((dir.path / "missing.bvh").string(), first.contentHash()) == nullptr);
+
+  // Intact header, but a mesh root that points back at itself or a top-level
+  // leaf past the mesh table
+  BvhCacheHeader header;
+  BvhCacheMesh mesh;
+  {
+    std::ifstream f(file, std::ios::binary);
+    f.read(reinterpret_cast<char*>(&header), sizeof(header));
+    f.seekg(static_cast<std::streamoff>(header.meshTableOffset));
+    f.read(reinterpret_cast<char*>(&mesh), sizeof(mesh));
+  }
+  auto patchChild = [&](const char* name, uint64_t nodeOffset, uint32_t child) {
+    fs::path patched = dir.path / name;
+    fs::copy_file(file, patched);
+    std::fstream f(patched, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(static_cast<std::streamoff>(nodeOffset + offsetof(Node4, child)));
+    f.write(reinterpret_cast<const char*>(&child), sizeof(child));
+    return patched.string();
+  };
+  REQUIRE(MappedBvh::open(patchChild("cycle.bvh", mesh.nodesOffset, 0), first.contentHash()) == nullptr);
+  REQUIRE(MappedBvh::open(patchChild("leaf.bvh", header.tlasOffset, makeLeaf(header.meshCount, 1)),
+                          first.contentHash()) == nullptr);
+}
+
+TEST_CASE("Geometry added after a cached load is merged into the world", "[phys][bvhcache]") {
+  TempDir dir;
+  StaticWorld seed(nullptr);
+  LoadLevel(seed, 3, dir.str());
+
+  StaticWorld world(nullptr);
+  LoadLevel(world, 3, dir.str());
+  REQUIRE(world.isMapped());
+  size_t before = world.triangleCount();
+
+  std::vector<float> floor = {-100, -60, -100, 100, -60, -100, 100, -60, 100, -100, -60, 100};
+  std::vector<uint32_t> idx = {0, 1, 2, 0, 2, 3};
+  world.addTriangles(floor, idx);
+  REQUIRE_FALSE(world.isMapped());
+  REQUIRE(world.triangleCount() == before + 2);
+  REQUIRE(world.meshCount() == seed.meshCount() + 1);
+
+  RayHit down = world.raycast({90, -55, 90}, {0, -1, 0}, 10);
+  REQUIRE(down.hit);
+  REQUIRE(down.t == 5.0f);
+  for (const Ray& ray : RandomRays(5, 500)) {
+    RayHit a = seed.raycast(ray.origin, ray.dir, ray.maxDist);
+    RayHit b = world.raycast(ray.origin, ray.dir, ray.maxDist);
+    if (a.hit) REQUIRE((b.hit && b.t <= a.t));
+  }
+}
@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/phys/capsule_sweep.hpp"
+#include "arena/phys/static_world.hpp"
+#include "../support/allocation_counter.hpp"
+#include "../support/world_fixtures.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::phys;
+using namespace arena::test;
+
+namespace {
+
+struct P { float x, y, z; };
+P Sub(P a, P b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+P Add(P a, P b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+P Mul(P a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+float Dot(P a, P b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+P ClosestOnTriangle(P p, P a, P b, P c) {
+  P ab = Sub(b, a), ac = Sub(c, a), ap = Sub(p, a);
+  float d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+  if (d1 <= 0 && d2 <= 0) return a;
+  P bp = Sub(p, b);
+  float d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+  if (d3 >= 0 && d4 <= d3) return b;
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0 && d1 >= 0 && d3 <= 0) return Add(a, Mul(ab, d1 / (d1 - d3)));
+  P cp = Sub(p, c);
+  float d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+  if (d6 >= 0 && d5 <= d6) return c;
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0 && d2 >= 0 && d6 <= 0) return Add(a, Mul(ac, d2 / (d2 - d6)));
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+    return Add(b, Mul(Sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+  }
+  float denom = 1.0f / (va + vb + vc);
+  return Add(a, Add(Mul(ab, vb * denom), Mul(ac, vc * denom)));
+}
+
+// Distance from the capsule's core segment to the triangle, sampled along the
+// segment; the distance is 1-Lipschitz along it so the error is at most half a step
+float SegmentTriangleDistance(P center, P axis, P a, P b, P c, int samples) {
+  float best = 1e30f;
+  for (int i = 0; i <= samples; ++i) {
+    float s = samples ? -1.0f + 2.0f * i / samples : 0.0f;
+    P p = Add(center, Mul(axis, s));
+    P q = ClosestOnTriangle(p, a, b, c);
+    best = std::fmin(best, std::sqrt(Dot(Sub(p, q), Sub(p, q))));
+  }
+  return best;
+}
+
+StaticWorld FloorAndWalls() {
+  StaticWorld world(nullptr);
+  AddQuad(world, {-20, 0, -20}, {20, 0, -20}, {20, 0, 20}, {-20, 0, 20}); // floor y = 0
+  AddQuad(world, {5, 0, -20}, {5, 0, 20}, {5, 10, 20}, {5, 10, -20});     // wall x = 5
+  AddQuad(world, {-20, 0, 5}, {20, 0, 5}, {20, 10, 5}, {-20, 10, 5});     // wall z = 5
+  return world;
+}
+
+} // namespace
+
+TEST_CASE("Sweep time of impact matches the sampled distance on random triangles", "[phys][sweep]") {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f), positive(0.1f, 1.0f);
+  const int samples = 1024;
+  int contacts = 0;
+
+  for (int iter = 0; iter < 1000; ++iter) {
+    P a{unit(rng) * 3, unit(rng) * 3, unit(rng) * 3};
+    P b{unit(rng) * 3, unit(rng) * 3, unit(rng) * 3};
+    P c{unit(rng) * 3, unit(rng) * 3, unit(rng) * 3};
+    Triangle tri = Triangle::fromVertices(&a.x, &b.x, &c.x, 1);
+
+    float radius = positive(rng) * 0.8f;
+    P axis{0, iter % 3 == 0 ? 0.0f : positive(rng), 0};
+    P start{unit(rng) * 6, unit(rng) * 6, unit(rng) * 6};
+    // Aim roughly at the triangle so most sweeps make contact
+    P centroid = Mul(Add(a, Add(b, c)), 1.0f / 3.0f);
+    P delta = Add(Mul(Sub(centroid, start), 1.0f + positive(rng)), {unit(rng), unit(rng), unit(rng)});
+    float step = 2.0f * axis.y / samples * 0.5f;
+    if (SegmentTriangleDistance(start, axis, a, b, c, samples) - step <= radius + 1e-3f) continue; // starts touching
+
+    CapsuleSweep sweep{{start.x, start.y, start.z}, {axis.x, axis.y, axis.z}, radius, {delta.x, delta.y, delta.z}};
+    SweepHit hit{1.0f, {0, 0, 0}, UINT32_MAX};
+    bool found = sweepTriangle(sweep, tri, hit);
+
+    // Nothing touches before the reported time (or over the whole move)
+    float until = found ? hit.t : 1.0f;
+    for (int k = 0; k < 32; ++k) {
+      P at = Add(start, Mul(delta, until * k / 32.0f));
+      REQUIRE(SegmentTriangleDistance(at, axis, a, b, c, samples) - step > radius - 2e-3f);
+    }
+    if (!found) continue;
+
+    // At the reported time the capsule is touching, and the normal points at it
+    ++contacts;
+    P at = Add(start, Mul(delta, hit.t));
+    float dist = SegmentTriangleDistance(at, axis, a, b, c, samples);
+    REQUIRE(dist - step <= radius + 2e-3f);
+    REQUIRE(dist >= radius - 2e-3f);
+    REQUIRE(std::fabs(hit.normal[0] * hit.normal[0] + hit.normal[1] * hit.normal[1] + hit.normal[2] * hit.normal[2] - 1.0f) < 1e-3f);
+    REQUIRE(Dot({hit.normal[0], hit.normal[1], hit.normal[2]}, delta) < 0.0f);
+  }
+  REQUIRE(contacts > 250);
+}
+
+TEST_CASE("A falling capsule lands a skin above the floor", "[phys][sweep]") {
+  StaticWorld world = FloorAndWalls();
+  Capsule cap{0.4f, 0.5f};
+  Vec3 out{};
+  REQUIRE(world.sweepCapsule(cap, {0, 3, 0}, {0, -5, 0}, out));
+  REQUIRE(out.y > 0.9f);
+  REQUIRE(out.y <= 0.9f + 2 * StaticWorld::kContactSkin);
+  REQUIRE(out.x == 0.0f);
+
+  // Resting there: moving up or across the floor isn't blocked
+  Vec3 up{};
+  REQUIRE_FALSE(world.sweepCapsule(cap, out, {0, 1, 0}, up));
+  REQUIRE(up.y == out.y + 1);
+  Vec3 across{};
+  REQUIRE_FALSE(world.sweepCapsule(cap, out, {-2, 0, -3}, across));
+  REQUIRE(across.x == -2.0f);
+}
+
+TEST_CASE("Capsules slide along walls and stop in corners", "[phys][sweep]") {
+  StaticWorld world = FloorAndWalls();
+  Capsule cap{0.5f, 0.5f};
+
+  // Diagonally into the x = 5 wall: blocked in x, keeps going in z
+  Vec3 out{};
+  REQUIRE(world.sweepCapsule(cap, {3, 2, -10}, {4, 0, 4}, out));
+  REQUIRE(out.x < 4.5f);
+  REQUIRE(out.x > 4.5f - 2 * StaticWorld::kContactSkin);
+  REQUIRE(out.z > -6.1f);
+  REQUIRE(out.y == 2.0f);
+
+  // Into the corner of both walls: held off each by the radius
+  Vec3 corner{};
+  REQUIRE(world.sweepCapsule(cap, {0, 2, 0}, {10, 0, 8}, corner));
+  REQUIRE(corner.x < 4.5f);
+  REQUIRE(corner.z < 4.5f);
+  REQUIRE(corner.x > 4.4f);
+  REQUIRE(corner.z > 4.4f);
+
+  // A miss travels the full distance
+  Vec3 free{};
+  REQUIRE_FALSE(world.sweepCapsule(cap, {0, 2, 0}, {-3, 1, -3}, free));
+  REQUIRE(free.x == -3.0f);
+  REQUIRE(free.y == 3.0f);
+}
+
+TEST_CASE("Capsules don't tunnel through thin geometry at speed", "[phys][sweep]") {
+  StaticWorld world(nullptr);
+  AddQuad(world, {-1, -1, 0}, {1, -1, 0}, {1, 1, 0}, {-1, 1, 0}); // zero-thickness panel at z = 0
+  Vec3 out{};
+  REQUIRE(world.sweepCapsule({0.1f, 0.2f}, {0, 0, -50}, {0, 0, 100}, out));
+  REQUIRE(out.z < -0.1f);
+  REQUIRE(out.z > -0.1f - 2 * StaticWorld::kContactSkin);
+}
+
+TEST_CASE("sweepCapsule does not allocate", "[phys][sweep]") {
+  StaticWorld world = FloorAndWalls();
+  Capsule cap{0.4f, 0.6f};
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+  size_t before = arena::test::allocationCount();
+  Vec3 out{};
+  for (int i = 0; i < 1000; ++i) {
+    world.sweepCapsule(cap, {unit(rng) * 4, 1.5f + unit(rng), unit(rng) * 4}, {unit(rng) * 3, unit(rng), unit(rng) * 3}, out);
+  }
+  REQUIRE(arena::test::allocationCount() == before);
+}
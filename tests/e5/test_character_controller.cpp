@@ -0,0 +1,192 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/ecs/character_controller_system.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "../support/world_fixtures.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+constexpr float kDt = 1.0f / 60.0f;
+
+// Closed axis-aligned box
+void AddBox(StaticWorld& world, Vec3 lo, Vec3 hi) {
+  std::vector<float> pos = {lo.x, lo.y, lo.z, hi.x, lo.y, lo.z, hi.x, lo.y, hi.z, lo.x, lo.y, hi.z,
+                            lo.x, hi.y, lo.z, hi.x, hi.y, lo.z, hi.x, hi.y, hi.z, lo.x, hi.y, hi.z};
+  std::vector<uint32_t> idx = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                               1, 2, 6, 1, 6, 5, 2, 3, 7, 2, 7, 6, 3, 0, 4, 3, 4, 7};
+  world.addTriangles(pos, idx);
+}
+
+StaticWorld Floor() {
+  StaticWorld world(nullptr);
+  AddQuad(world, {-50, 0, -50}, {-50, 0, 50}, {50, 0, 50}, {50, 0, -50});
+  return world;
+}
+
+Entity Spawn(Registry& r, float x, float y, float z) {
+  Entity e = r.create();
+  Transform t;
+  t.pos[0] = x; t.pos[1] = y; t.pos[2] = z;
+  r.add<Transform>(e, t);
+  r.add<CharacterController>(e, {});
+  r.add<CharacterInput>(e, {});
+  return e;
+}
+
+void Run(CharacterControllerSystem& system, Registry& r, const IWorld& world, int ticks) {
+  for (int i = 0; i < ticks; ++i) system.update(kDt, r, world);
+}
+
+// Centre height of a default controller (radius 0.4, height 1.8) standing at floor height y
+float Standing(float y) { return y + 0.9f; }
+
+} // namespace
+
+TEST_CASE("Controllers fall, land and walk at their speed", "[character]") {
+  StaticWorld world = Floor();
+  Registry r;
+  CharacterControllerSystem system;
+  Entity e = Spawn(r, 0, 3, 0);
+
+  Run(system, r, world, 60);
+  REQUIRE(r.get<CharacterController>(e)->grounded);
+  REQUIRE(std::abs(r.get<Transform>(e)->pos[1] - Standing(0)) < 0.02f);
+
+  r.get<CharacterInput>(e)->move[0] = 1.0f;
+  Run(system, r, world, 60);
+  auto* t = r.get<Transform>(e);
+  REQUIRE(std::abs(t->pos[0] - 5.5f) < 0.05f);
+  REQUIRE(std::abs(t->pos[1] - Standing(0)) < 0.02f);
+  REQUIRE(r.get<CharacterController>(e)->grounded);
+
+  // Diagonal input is clamped to the same speed
+  t->pos[0] = 0.0f;
+  r.get<CharacterInput>(e)->move[1] = 1.0f;
+  Run(system, r, world, 60);
+  float dist = std::hypot(t->pos[0], t->pos[2]);
+  REQUIRE(std::abs(dist - 5.5f) < 0.05f);
+}
+
+TEST_CASE("Controllers jump and land again", "[character]") {
+  StaticWorld world = Floor();
+  Registry r;
+  CharacterControllerSystem system;
+  Entity e = Spawn(r, 0, Standing(0), 0);
+  Run(system, r, world, 2);
+  REQUIRE(r.get<CharacterController>(e)->grounded);
+
+  r.get<CharacterInput>(e)->jump = true;
+  system.update(kDt, r, world);
+  r.get<CharacterInput>(e)->jump = false;
+  REQUIRE_FALSE(r.get<CharacterController>(e)->grounded);
+
+  float peak = 0.0f;
+  int airborne = 0;
+  while (!r.get<CharacterController>(e)->grounded && airborne < 300) {
+    system.update(kDt, r, world);
+    peak = std::max(peak, r.get<Transform>(e)->pos[1]);
+    ++airborne;
+  }
+  // v^2 / 2g = 6.5^2 / 40 ~ 1.06 m
+  REQUIRE(peak - Standing(0) > 0.9f);
+  REQUIRE(peak - Standing(0) < 1.2f);
+  REQUIRE(airborne < 60);
+  REQUIRE(std::abs(r.get<Transform>(e)->pos[1] - Standing(0)) < 0.02f);
+}
+
+TEST_CASE("Controllers step up ledges but not walls", "[character]") {
+  StaticWorld world = Floor();
+  AddBox(world, {2, 0, -5}, {4, 0.3f, 5});   // 30 cm step
+  AddBox(world, {2, 0, 5}, {4, 1.0f, 15});   // 1 m block
+  Registry r;
+  CharacterControllerSystem system;
+  Entity stepper = Spawn(r, 0, Standing(0), 0);
+  Entity blocked = Spawn(r, 0, Standing(0), 10);
+  r.get<CharacterInput>(stepper)->move[0] = 1.0f;
+  r.get<CharacterInput>(blocked)->move[0] = 1.0f;
+
+  Run(system, r, world, 40);
+  auto* up = r.get<Transform>(stepper);
+  REQUIRE(up->pos[0] > 2.5f);
+  REQUIRE(std::abs(up->pos[1] - Standing(0.3f)) < 0.02f);
+  REQUIRE(r.get<CharacterController>(stepper)->grounded);
+
+  auto* wall = r.get<Transform>(blocked);
+  REQUIRE(wall->pos[0] < 2.0f - 0.4f + 0.01f);
+  REQUIRE(std::abs(wall->pos[1] - Standing(0)) < 0.02f);
+
+  // Walking off the far side follows the ground back down
+  Run(system, r, world, 40);
+  REQUIRE(up->pos[0] > 4.5f);
+  REQUIRE(std::abs(up->pos[1] - Standing(0)) < 0.02f);
+  REQUIRE(r.get<CharacterController>(stepper)->grounded);
+}
+
+TEST_CASE("Controllers walk up gentle ramps and slide off steep ones", "[character]") {
+  StaticWorld world = Floor();
+  // 30 degree ramp rising along +x from x = 2, and a 65 degree one along -x from x = -2
+  float gentle = std::tan(30.0f * 3.14159265f / 180.0f), steep = std::tan(65.0f * 3.14159265f / 180.0f);
+  AddQuad(world, {2, 0, -5}, {2, 0, 5}, {12, 10 * gentle, 5}, {12, 10 * gentle, -5});
+  AddQuad(world, {-2, 0, 5}, {-2, 0, -5}, {-6, 4 * steep, -5}, {-6, 4 * steep, 5});
+  Registry r;
+  CharacterControllerSystem system;
+  Entity climber = Spawn(r, 0, Standing(0), 0);
+  r.get<CharacterInput>(climber)->move[0] = 1.0f;
+
+  Run(system, r, world, 90);
+  auto* t = r.get<Transform>(climber);
+  REQUIRE(t->pos[0] > 5.0f);
+  REQUIRE(t->pos[1] > Standing(0) + (t->pos[0] - 2.5f) * gentle * 0.8f);
+  REQUIRE(r.get<CharacterController>(climber)->grounded);
+
+  // Standing still on the ramp doesn't creep downhill
+  r.get<CharacterInput>(climber)->move[0] = 0.0f;
+  float x = t->pos[0], y = t->pos[1];
+  Run(system, r, world, 120);
+  REQUIRE(std::abs(t->pos[0] - x) < 0.01f);
+  REQUIRE(std::abs(t->pos[1] - y) < 0.01f);
+
+  Entity slider = Spawn(r, -1, Standing(0), 0);
+  r.get<CharacterInput>(slider)->move[0] = -1.0f;
+  Run(system, r, world, 120);
+  REQUIRE(r.get<Transform>(slider)->pos[1] < Standing(0) + 1.0f);
+}
+
+TEST_CASE("Parallel controller updates match serial ones", "[character]") {
+  StaticWorld world = Floor();
+  for (int i = 0; i < 20; ++i) {
+    float x = -40.0f + 4.0f * i;
+    AddBox(world, {x, 0, -3}, {x + 1.5f, 0.2f + 0.05f * (i % 6), 3});
+  }
+
+  Registry serial, parallel;
+  for (Registry* r : {&serial, &parallel}) {
+    for (int i = 0; i < 264; ++i) {
+      Entity e = Spawn(*r, -40.0f + 0.3f * i, 1.5f, -20.0f + 0.15f * i);
+      auto* input = r->get<CharacterInput>(e);
+      input->move[0] = std::cos(0.37f * i);
+      input->move[1] = std::sin(0.37f * i);
+      input->jump = i % 17 == 0;
+    }
+  }
+
+  CharacterControllerSystem a, b;
+  TaskPool pool(3);
+  b.setTaskPool(&pool);
+  Run(a, serial, world, 60);
+  Run(b, parallel, world, 60);
+
+  auto& ts = serial.storage<Transform>();
+  auto& tp = parallel.storage<Transform>();
+  REQUIRE(ts.data.size() == tp.data.size());
+  for (size_t i = 0; i < ts.data.size(); ++i) {
+    for (int k = 0; k < 3; ++k) REQUIRE(ts.data[i].pos[k] == tp.data[i].pos[k]);
+  }
+}
@@ -0,0 +1,153 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/ecs/lag_compensation.hpp"
+#include "arena/phys/static_world.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+
+namespace {
+
+Entity SpawnCharacter(Registry& r, float x, float y, float z) {
+  Entity e = r.create();
+  Transform t;
+  t.pos[0] = x; t.pos[1] = y; t.pos[2] = z;
+  r.add<Transform>(e, t);
+  r.add<CharacterController>(e, {}); // radius 0.4, height 1.8
+  return e;
+}
+
+// Shot along +z at height y from x
+Ray ShotAt(float x, float y) { return Ray{{x, y, -10.0f}, {0.0f, 0.0f, 1.0f}, 100.0f}; }
+
+} // namespace
+
+TEST_CASE("Shots hit hitboxes where they were on the requested tick", "[lagcomp]") {
+  Registry r;
+  LagCompensationSystem history(32, 8);
+  Entity runner = SpawnCharacter(r, 0, 1, 0);
+
+  // Runs along +x at one metre per tick
+  for (uint32_t tick = 100; tick < 140; ++tick) {
+    r.get<Transform>(runner)->pos[0] = static_cast<float>(tick - 100);
+    history.record(tick, r);
+  }
+
+  RewindHit now = history.raycastAtTick(139, ShotAt(39, 1));
+  REQUIRE(now.hit);
+  REQUIRE(now.character);
+  REQUIRE(now.entity == runner);
+  REQUIRE(std::abs(now.t - 9.6f) < 1e-4f);
+  REQUIRE(std::abs(now.normal.z + 1.0f) < 1e-4f);
+
+  // Where the client saw it ten ticks ago, and not where it is now
+  REQUIRE(history.raycastAtTick(129, ShotAt(29, 1)).entity == runner);
+  REQUIRE_FALSE(history.raycastAtTick(129, ShotAt(39, 1)).hit);
+  REQUIRE_FALSE(history.raycastAtTick(139, ShotAt(29, 1)).hit);
+
+  // Head and feet are the capsule's end spheres
+  REQUIRE(history.raycastAtTick(139, ShotAt(39, 1.85f)).hit);
+  REQUIRE_FALSE(history.raycastAtTick(139, ShotAt(39, 1.95f)).hit);
+
+  // Only the last 32 ticks are kept
+  REQUIRE(history.hasTick(108));
+  REQUIRE_FALSE(history.hasTick(107));
+  REQUIRE_FALSE(history.raycastAtTick(107, ShotAt(7, 1)).hit);
+  REQUIRE_FALSE(history.hasTick(140));
+}
+
+TEST_CASE("Shots between ticks blend the two poses", "[lagcomp]") {
+  Registry r;
+  LagCompensationSystem history;
+  Entity e = SpawnCharacter(r, 0, 1, 0);
+  history.record(10, r);
+  r.get<Transform>(e)->pos[0] = 2.0f;
+  history.record(11, r);
+
+  // A quarter of the way from tick 10 to 11 the capsule spans x in [0.1, 0.9]
+  REQUIRE(history.raycastAtTick(11, ShotAt(0.85f, 1), LagCompensationSystem::kIgnoreNone, nullptr, 0.25f).hit);
+  REQUIRE_FALSE(history.raycastAtTick(11, ShotAt(0.95f, 1), LagCompensationSystem::kIgnoreNone, nullptr, 0.25f).hit);
+  REQUIRE_FALSE(history.raycastAtTick(11, ShotAt(0.85f, 1)).hit);
+}
+
+TEST_CASE("Walls block rewound shots and shooters don't hit themselves", "[lagcomp]") {
+  phys::StaticWorld world(nullptr);
+  std::vector<float> wall = {-5, 0, -2, 5, 0, -2, 5, 3, -2, -5, 3, -2};
+  std::vector<uint32_t> idx = {0, 1, 2, 0, 2, 3};
+  world.addTriangles(wall, idx);
+
+  Registry r;
+  LagCompensationSystem history;
+  Entity shooter = SpawnCharacter(r, 0, 1, -10);
+  Entity target = SpawnCharacter(r, 0, 1, 0);
+  Entity exposed = SpawnCharacter(r, 8, 1, 0);
+  history.record(5, r);
+
+  Ray through{{0, 1, -10}, {0, 0, 1}, 50};
+  // Leaving a hitbox from inside doesn't hit it
+  REQUIRE(history.raycastAtTick(5, through).entity == target);
+  RewindHit blocked = history.raycastAtTick(5, through, shooter, &world);
+  REQUIRE(blocked.hit);
+  REQUIRE_FALSE(blocked.character);
+  REQUIRE(std::abs(blocked.t - 8.0f) < 1e-4f);
+  RewindHit open = history.raycastAtTick(5, through, shooter);
+  REQUIRE(open.character);
+  REQUIRE(open.entity == target);
+
+  Ray clear{{8, 1, -10}, {0, 0, 1}, 50};
+  REQUIRE(history.raycastAtTick(5, clear, shooter, &world).entity == exposed);
+}
+
+TEST_CASE("Box colliders are rewound as yawed boxes", "[lagcomp]") {
+  Registry r;
+  LagCompensationSystem history;
+  Entity crate = r.create();
+  Transform t;
+  t.rotYawPitchRoll[0] = 3.14159265f / 4.0f;
+  r.add<Transform>(crate, t);
+  r.add<CharacterController>(crate, {});
+  Collider box;
+  box.shape = 1;
+  box.params[0] = 1.0f; box.params[1] = 1.0f; box.params[2] = 1.0f;
+  r.add<Collider>(crate, box);
+  history.record(1, r);
+
+  auto poses = history.posesAt(1);
+  REQUIRE(poses.size() == 1);
+  REQUIRE(poses[0].shape == 1);
+
+  // Turned 45 degrees the box reaches sqrt(2) along x, and is met corner first
+  REQUIRE(history.raycastAtTick(1, ShotAt(1.3f, 0)).hit);
+  REQUIRE_FALSE(history.raycastAtTick(1, ShotAt(1.5f, 0)).hit);
+  RewindHit corner = history.raycastAtTick(1, ShotAt(0, 0));
+  REQUIRE(std::abs(corner.t - (10.0f - std::sqrt(2.0f))) < 1e-4f);
+  REQUIRE(std::abs(std::abs(corner.normal.x) - std::sqrt(0.5f)) < 1e-4f);
+}
+
+TEST_CASE("The registry's first entity is rewound like any other", "[lagcomp]") {
+  phys::StaticWorld world(nullptr);
+  std::vector<float> wall = {-5, 0, 5, 5, 0, 5, 5, 3, 5, -5, 3, 5};
+  std::vector<uint32_t> idx = {0, 1, 2, 0, 2, 3};
+  world.addTriangles(wall, idx);
+
+  Registry r;
+  LagCompensationSystem history;
+  Entity first = SpawnCharacter(r, 0, 1, 0);
+  REQUIRE(first == 0);
+  history.record(3, r);
+  REQUIRE(history.posesAt(3).size() == 1);
+
+  // Hit in front of the wall, and told apart from the wall behind it
+  RewindHit hit = history.raycastAtTick(3, ShotAt(0, 1), LagCompensationSystem::kIgnoreNone, &world);
+  REQUIRE(hit.character);
+  REQUIRE(hit.entity == first);
+  RewindHit past = history.raycastAtTick(3, ShotAt(3, 1), LagCompensationSystem::kIgnoreNone, &world);
+  REQUIRE(past.hit);
+  REQUIRE_FALSE(past.character);
+
+  // Ignoring it as the shooter lets the shot through to the wall
+  RewindHit own = history.raycastAtTick(3, ShotAt(0, 1), first, &world);
+  REQUIRE(own.hit);
+  REQUIRE_FALSE(own.character);
+}
@@ -0,0 +1,336 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::phys;
+
+namespace {
+
+// Reference: test every triangle, nearest hit wins (lowest index on ties)
+RayHit BruteForce(const std::vector<float>& pos, const std::vector<uint32_t>& idx, Vec3 o, Vec3 d, float maxDist) {
+  float len = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+  float od[3] = {o.x, o.y, o.z};
+  float dd[3] = {d.x / len, d.y / len, d.z / len};
+  Ray4 ray(od, dd, maxDist);
+  std::vector<Triangle> tris;
+  for (size_t i = 0; i < idx.size(); i += 3) {
+    tris.push_back(Triangle::fromVertices(&pos[idx[i] * 3], &pos[idx[i + 1] * 3], &pos[idx[i + 2] * 3], uint32_t(i / 3)));
+  }
+  // One single-triangle BLAS per triangle keeps the reference free of any shared traversal
+  TriangleHit best{maxDist, 0, 0, 0, UINT32_MAX};
+  for (auto& tri : tris) {
+    Blas single = Blas::build({tri});
+    intersect(single.view(), ray, best);
+  }
+  RayHit hit;
+  if (best.id != UINT32_MAX) {
+    hit.hit = true;
+    hit.t = best.t;
+  }
+  return hit;
+}
+
+void RandomSoup(std::mt19937& rng, int count, std::vector<float>& pos, std::vector<uint32_t>& idx) {
+  std::uniform_real_distribution<float> center(-50.0f, 50.0f), offset(-2.0f, 2.0f);
+  for (int t = 0; t < count; ++t) {
+    float cx = center(rng), cy = center(rng), cz = center(rng);
+    for (int v = 0; v < 3; ++v) {
+      idx.push_back(uint32_t(pos.size() / 3));
+      pos.push_back(cx + offset(rng));
+      pos.push_back(cy + offset(rng));
+      pos.push_back(cz + offset(rng));
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Node4 layout is two cache lines", "[phys][bvh]") {
+  REQUIRE(sizeof(Node4) == 128);
+  REQUIRE(alignof(Node4) == 64);
+}
+
+TEST_CASE("Traversal visits every leaf of a tree deeper than its inline stack", "[phys][bvh]") {
+  // A chain of 200 nodes, each with the next node and a leaf in identical
+  // boxes: every level leaves one entry on the stack
+  constexpr uint32_t kDepth = 200;
+  std::vector<Node4> nodes(kDepth);
+  for (uint32_t i = 0; i < kDepth; ++i) {
+    Node4& node = nodes[i];
+    node = {};
+    node.count = i + 1 < kDepth ? 2 : 1;
+    for (int lane = 0; lane < 4; ++lane) {
+      node.minX[lane] = node.minY[lane] = node.minZ[lane] = -1.0f;
+      node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = 1.0f;
+    }
+    node.child[0] = i + 1 < kDepth ? i + 1 : makeLeaf(i, 1);
+    node.child[1] = makeLeaf(i, 1);
+  }
+  float origin[3] = {0, 0, -5}, dir[3] = {0, 0, 1};
+  Ray4 ray(origin, dir, 10.0f);
+  size_t leaves = 0;
+  traverseBvh4(nodes.data(), ray, 10.0f, [&](uint32_t, uint32_t) {
+    ++leaves;
+    return 10.0f;
+  });
+  REQUIRE(leaves == kDepth);
+}
+
+TEST_CASE("Raycast hits a floor quad with the expected point and normal", "[phys][bvh]") {
+  StaticWorld world(nullptr);
+  std::vector<float> pos = {-10, 0, -10,  10, 0, -10,  10, 0, 10,  -10, 0, 10};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(pos, idx);
+
+  RayHit hit = world.raycast({1, 5, 2}, {0, -2, 0}, 100.0f);
+  REQUIRE(hit.hit);
+  REQUIRE(std::abs(hit.t - 5.0f) < 1e-4f);
+  REQUIRE(std::abs(hit.pos.y) < 1e-4f);
+  REQUIRE(hit.normal.y == 1.0f);
+  REQUIRE(hit.entity == 0);
+
+  // From below the normal faces down; beyond maxDist nothing is hit
+  REQUIRE(world.raycast({1, -3, 2}, {0, 1, 0}, 100.0f).normal.y == -1.0f);
+  REQUIRE_FALSE(world.raycast({1, 5, 2}, {0, -1, 0}, 4.9f).hit);
+  REQUIRE_FALSE(world.raycast({1, 5, 2}, {0, 1, 0}, 100.0f).hit);
+}
+
+TEST_CASE("Registered meshes are resolved and transformed into world space", "[phys][bvh]") {
+  std::vector<float> quad = {-1, 0, -1,  1, 0, -1,  1, 0, 1,  -1, 0, 1};
+  std::vector<uint32_t> quadIdx = {0, 1, 2,  0, 2, 3};
+  StaticWorld world([&](MeshHandle mh, MeshGeometry& out) {
+    if (mh.id != 7) return false;
+    out.positions = quad;
+    out.indices = quadIdx;
+    return true;
+  });
+
+  // Column-major translation to y = 3
+  Mat4 m{{1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 3, 0, 1}};
+  world.registerStaticMesh({7}, m);
+  world.registerStaticMesh({8}, m); // unknown: ignored
+  REQUIRE(world.meshCount() == 1);
+
+  RayHit hit = world.raycast({0, 10, 0}, {0, -1, 0}, 100.0f);
+  REQUIRE(hit.hit);
+  REQUIRE(std::abs(hit.pos.y - 3.0f) < 1e-4f);
+}
+
+TEST_CASE("BVH raycasts match brute force on a random triangle soup", "[phys][bvh]") {
+  std::mt19937 rng(1234);
+  std::vector<float> pos;
+  std::vector<uint32_t> idx;
+  RandomSoup(rng, 3000, pos, idx);
+
+  // Split across several meshes so the top level is exercised too
+  StaticWorld world(nullptr);
+  size_t perMesh = 3 * 500;
+  for (size_t first = 0; first < idx.size(); first += perMesh) {
+    std::vector<uint32_t> part(idx.begin() + first, idx.begin() + std::min(idx.size(), first + perMesh));
+    world.addTriangles(pos, part);
+  }
+  REQUIRE(world.meshCount() == 6);
+  REQUIRE(world.triangleCount() == 3000);
+
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  int hits = 0;
+  for (int r = 0; r < 2000; ++r) {
+    Vec3 o{unit(rng) * 60, unit(rng) * 60, unit(rng) * 60};
+    Vec3 d{unit(rng), unit(rng), unit(rng)};
+    if (r % 10 == 0) d = {0, 0, 1}; // axis-parallel rays hit the zero-direction path
+    RayHit expected = BruteForce(pos, idx, o, d, 200.0f);
+    RayHit actual = world.raycast(o, d, 200.0f);
+    REQUIRE(actual.hit == expected.hit);
+    if (expected.hit) {
+      ++hits;
+      REQUIRE(actual.t == expected.t);
+    }
+  }
+  REQUIRE(hits > 100);
+}
+
+TEST_CASE("Empty worlds and degenerate rays miss", "[phys][bvh]") {
+  StaticWorld world(nullptr);
+  REQUIRE_FALSE(world.raycast({0, 0, 0}, {1, 0, 0}, 10.0f).hit);
+
+  std::vector<float> pos = {0, 0, 0,  1, 0, 0,  0, 1, 0};
+  std::vector<uint32_t> idx = {0, 1, 2};
+  world.addTriangles(pos, idx);
+  REQUIRE_FALSE(world.raycast({0.2f, 0.2f, -1}, {0, 0, 0}, 10.0f).hit);
+  REQUIRE(world.raycast({0.2f, 0.2f, -1}, {0, 0, 1}, 10.0f).hit);
+}
+
+TEST_CASE("raycastBatch matches raycast exactly, serial and pooled", "[phys][bvh]") {
+  std::mt19937 rng(99);
+  std::vector<float> pos;
+  std::vector<uint32_t> idx;
+  RandomSoup(rng, 2000, pos, idx);
+  StaticWorld world(nullptr);
+  std::vector<uint32_t> firstHalf(idx.begin(), idx.begin() + idx.size() / 2);
+  std::vector<uint32_t> secondHalf(idx.begin() + idx.size() / 2, idx.end());
+  world.addTriangles(pos, firstHalf);
+  world.addTriangles(pos, secondHalf);
+
+  // Scattered rays, pellet-style bundles, probes and a few degenerate ones
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::vector<Ray> rays;
+  for (int i = 0; i < 3000; ++i) {
+    rays.push_back({{unit(rng) * 60, unit(rng) * 60, unit(rng) * 60}, {unit(rng), unit(rng), unit(rng)}, 150.0f});
+  }
+  for (int b = 0; b < 200; ++b) {
+    Vec3 o{unit(rng) * 60, unit(rng) * 60, unit(rng) * 60};
+    Vec3 d{unit(rng), unit(rng), unit(rng)};
+    for (int k = 0; k < 12; ++k) {
+      rays.push_back({o, {d.x + unit(rng) * 0.02f, d.y + unit(rng) * 0.02f, d.z + unit(rng) * 0.02f}, 150.0f});
+    }
+  }
+  // Axis-aligned probes from one cell, so packets hold zero direction components
+  for (int b = 0; b < 50; ++b) {
+    Vec3 o{unit(rng) * 60, unit(rng) * 60, unit(rng) * 60};
+    Vec3 d = b % 2 ? Vec3{0, -1, 0} : Vec3{1, 0, 0};
+    for (int k = 0; k < 8; ++k) rays.push_back({{o.x + k * 0.05f, o.y, o.z + k * 0.05f}, d, 150.0f});
+  }
+  rays.push_back({{0, 0, 0}, {0, 0, 0}, 10.0f});
+  rays.push_back({{0, 0, 0}, {1, 0, 0}, 0.0f});
+
+  auto check = [&](const std::vector<RayHit>& batch) {
+    for (size_t i = 0; i < rays.size(); ++i) {
+      RayHit single = world.raycast(rays[i].origin, rays[i].dir, rays[i].maxDist);
+      REQUIRE(batch[i].hit == single.hit);
+      REQUIRE(batch[i].t == single.t);
+      REQUIRE(batch[i].pos.x == single.pos.x);
+      REQUIRE(batch[i].pos.y == single.pos.y);
+      REQUIRE(batch[i].pos.z == single.pos.z);
+      REQUIRE(batch[i].normal.x == single.normal.x);
+      REQUIRE(batch[i].normal.y == single.normal.y);
+      REQUIRE(batch[i].normal.z == single.normal.z);
+    }
+  };
+
+  std::vector<RayHit> serial(rays.size());
+  world.raycastBatch(rays, serial);
+  check(serial);
+
+  TaskPool pool(3);
+  world.setTaskPool(&pool);
+  std::vector<RayHit> pooled(rays.size());
+  world.raycastBatch(rays, pooled);
+  check(pooled);
+}
+
+TEST_CASE("Meshes inserted and removed one at a time match a fresh build", "[phys][bvh]") {
+  std::mt19937 rng(77);
+  std::vector<std::vector<float>> meshPos(300);
+  std::vector<std::vector<uint32_t>> meshIdx(300);
+  for (size_t m = 0; m < meshPos.size(); ++m) RandomSoup(rng, 12, meshPos[m], meshIdx[m]);
+
+  StaticWorld world(nullptr);
+  std::vector<uint32_t> ids;
+  for (size_t m = 0; m < 200; ++m) ids.push_back(world.addTriangles(meshPos[m], meshIdx[m]));
+  REQUIRE(ids[17] == 17);
+
+  // Drop every third mesh, then add the rest
+  std::vector<bool> live(meshPos.size(), false);
+  for (size_t m = 0; m < 200; ++m) live[m] = m % 3 != 0;
+  for (size_t m = 0; m < 200; m += 3) REQUIRE(world.removeMesh(ids[m]));
+  REQUIRE_FALSE(world.removeMesh(ids[0]));
+  REQUIRE_FALSE(world.removeMesh(5000));
+  for (size_t m = 200; m < meshPos.size(); ++m) {
+    world.addTriangles(meshPos[m], meshIdx[m]);
+    live[m] = true;
+  }
+
+  StaticWorld reference(nullptr);
+  reference.beginBatch();
+  size_t liveCount = 0;
+  for (size_t m = 0; m < meshPos.size(); ++m) {
+    if (!live[m]) continue;
+    reference.addTriangles(meshPos[m], meshIdx[m]);
+    ++liveCount;
+  }
+  reference.endBatch();
+  REQUIRE(world.meshCount() == liveCount);
+  REQUIRE(world.triangleCount() == reference.triangleCount());
+
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  auto compare = [&] {
+    for (int r = 0; r < 1500; ++r) {
+      Vec3 o{unit(rng) * 60, unit(rng) * 60, unit(rng) * 60};
+      Vec3 d{unit(rng), unit(rng), unit(rng)};
+      RayHit expected = reference.raycast(o, d, 200.0f);
+      RayHit actual = world.raycast(o, d, 200.0f);
+      REQUIRE(actual.hit == expected.hit);
+      if (expected.hit) REQUIRE(actual.t == expected.t);
+    }
+  };
+  compare();
+
+  // A rebuild was started along the way; once applied the answers don't change
+  world.finishRebuild();
+  REQUIRE_FALSE(world.rebuildPending());
+  REQUIRE(world.topLevelCost() <= reference.topLevelCost() * StaticWorld::kRebuildCostRatio);
+  compare();
+
+  // Removals racing a rebuild are replayed onto it
+  for (size_t m = 0; m < meshPos.size(); ++m) {
+    if (live[m]) REQUIRE(world.removeMesh(static_cast<uint32_t>(m)));
+  }
+  world.finishRebuild();
+  REQUIRE(world.meshCount() == 0);
+  for (int r = 0; r < 200; ++r) {
+    REQUIRE_FALSE(world.raycast({unit(rng) * 60, unit(rng) * 60, unit(rng) * 60}, {unit(rng), unit(rng), 1}, 200.0f).hit);
+  }
+}
+
+TEST_CASE("Edits made while a rebuild is pending don't degrade the top level without bound", "[phys][bvh]") {
+  // Small crates scattered over a floor, like a level loaded without a batch
+  std::mt19937 rng(91);
+  std::uniform_real_distribution<float> spot(-50.0f, 50.0f), size(0.5f, 3.0f);
+  StaticWorld world(nullptr), reference(nullptr);
+  reference.beginBatch();
+  std::vector<float> floor = {-60, 0, -60,  -60, 0, 60,  60, 0, 60,  60, 0, -60};
+  std::vector<uint32_t> quad = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(floor, quad);
+  reference.addTriangles(floor, quad);
+  float worst = 0.0f;
+  for (int m = 0; m < 200; ++m) {
+    float x = spot(rng), z = spot(rng), s = size(rng);
+    std::vector<float> pos = {x, 0, z,  x + s, 0, z,  x + s, s, z + s,  x, s, z + s};
+    world.addTriangles(pos, quad);
+    reference.addTriangles(pos, quad);
+    worst = std::max(worst, world.topLevelCost());
+  }
+  reference.endBatch();
+
+  // Nobody applied anything between adds, yet each add advanced the pending
+  // rebuild a slice, so every one landed before the tree wandered far
+  REQUIRE(worst <= reference.topLevelCost() * 2.0f);
+  world.finishRebuild();
+  REQUIRE_FALSE(world.rebuildPending());
+  REQUIRE(world.topLevelCost() <= reference.topLevelCost() * StaticWorld::kRebuildCostRatio);
+}
+
+TEST_CASE("Removing every mesh empties the world", "[phys][bvh]") {
+  StaticWorld world(nullptr);
+  std::vector<float> pos = {-10, 0, -10,  10, 0, -10,  10, 0, 10,  -10, 0, 10};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  uint32_t a = world.addTriangles(pos, idx);
+  uint32_t b = world.addTriangles(pos, idx);
+  REQUIRE(world.addTriangles(pos, std::vector<uint32_t>{0, 1, 9}) == StaticWorld::kNoMesh);
+
+  REQUIRE(world.removeMesh(a));
+  REQUIRE(world.raycast({0, 5, 0}, {0, -1, 0}, 10.0f).hit);
+  REQUIRE(world.removeMesh(b));
+  REQUIRE(world.meshCount() == 0);
+  REQUIRE(world.triangleCount() == 0);
+  REQUIRE_FALSE(world.raycast({0, 5, 0}, {0, -1, 0}, 10.0f).hit);
+
+  // And fills up again
+  world.addTriangles(pos, idx);
+  REQUIRE(world.raycast({0, 5, 0}, {0, -1, 0}, 10.0f).hit);
+}
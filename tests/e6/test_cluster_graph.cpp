@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/cluster_graph.hpp"
+#include "arena/nav/grid_nav.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/hierarchical_search.hpp"
+#include "arena/nav/jump_points.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+TEST_CASE("Hierarchical paths are walkable and near the shortest", "[nav][hpa]") {
+  std::mt19937 rng(44);
+  GridSearch astar;
+  HierarchicalSearch hpa;
+  TaskPool pool(2);
+  int compared = 0;
+  double ratios = 0.0;
+  for (int round = 0; round < 6; ++round) {
+    int width = 60 + round * 12, depth = 48 + (round % 3) * 16;
+    NavGrid grid = RandomGrid(rng, width, depth, round % 2 == 0 ? 0.0f : 0.06f, 0.0f);
+    grid.labelRegions();
+    ClusterGraph graph(grid, 8 + (round % 2) * 8, round % 2 == 0 ? &pool : nullptr);
+    REQUIRE(graph.matches(grid));
+    REQUIRE(graph.nodeCount() > 0);
+
+    std::uniform_int_distribution<int> px(0, width - 1), pz(0, depth - 1);
+    for (int q = 0; q < 150; ++q) {
+      Cell a{px(rng), pz(rng), 0}, b{px(rng), pz(rng), q % 4 == 0 ? 1 : 0};
+      Path shortest = astar.findPath(grid, a, b);
+      Path path = hpa.findPath(graph, grid, a, b);
+      REQUIRE(path.ok == shortest.ok);
+      if (!path.ok) continue;
+      ++compared;
+      REQUIRE(Walkable(grid, path, b));
+      REQUIRE(hpa.corridor().front().x == a.x);
+      REQUIRE(hpa.corridor().back().x == b.x);
+      // Never shorter than the shortest path, and not far off it
+      REQUIRE(hpa.cost() >= astar.cost() - 1e-3f);
+      REQUIRE(hpa.cost() <= astar.cost() * 1.25f + 2.0f);
+      ratios += astar.cost() > 0.0f ? hpa.cost() / astar.cost() : 1.0;
+    }
+  }
+  REQUIRE(compared > 250);
+  REQUIRE(ratios / compared < 1.08);
+}
+
+TEST_CASE("Cluster graph updates match a fresh build", "[nav][hpa]") {
+  std::mt19937 rng(7);
+  NavGrid grid = RandomGrid(rng, 96, 64, 0.02f, 0.0f);
+  grid.labelRegions();
+  ClusterGraph graph(grid, 16);
+  // A node well away from the edits, to check it's left alone
+  uint32_t far = graph.clusterNodes(0).front();
+  Cell farCell = graph.cell(far);
+  size_t farEdges = graph.edges(far).size();
+
+  // Wall off a border, open up a patch across another, and raise a strip
+  // of floor by a step along the north edge
+  for (int z = 30; z < 48; ++z) grid.setBlocked(47, z, 0);
+  for (int z = 14; z < 20; ++z) {
+    for (int x = 60; x < 68; ++x) grid.setWalkable(x, z, 0, 0.0f);
+  }
+  for (int x = 40; x < 46; ++x) grid.setWalkable(x, 62, 0, 0.3f);
+  graph.update(grid, 47, 30, 47, 47);
+  graph.update(grid, 60, 14, 67, 19);
+  graph.update(grid, 40, 62, 45, 62);
+  grid.labelRegions();
+
+  ClusterGraph fresh(grid, 16);
+  REQUIRE(graph.nodeCount() == fresh.nodeCount());
+  REQUIRE(graph.edgeCount() == fresh.edgeCount());
+  REQUIRE(graph.live(far));
+  REQUIRE(graph.cell(far).x == farCell.x);
+  REQUIRE(graph.cell(far).y == farCell.y);
+  REQUIRE(graph.edges(far).size() == farEdges);
+
+  HierarchicalSearch updated, rebuilt;
+  std::uniform_int_distribution<int> px(0, 95), pz(0, 63);
+  int found = 0;
+  for (int q = 0; q < 200; ++q) {
+    Cell a{px(rng), pz(rng), 0}, b{px(rng), pz(rng), q % 3 == 0 ? 1 : 0};
+    if (!grid.walkable(a.x, a.y, a.level) || !grid.walkable(b.x, b.y, b.level)) continue;
+    bool ok = updated.plan(graph, grid, a, b);
+    REQUIRE(ok == rebuilt.plan(fresh, grid, a, b));
+    if (!ok) continue;
+    ++found;
+    REQUIRE(std::abs(updated.cost() - rebuilt.cost()) < 1e-3f);
+  }
+  REQUIRE(found > 60);
+}
+
+TEST_CASE("Corridors refine a leg at a time", "[nav][hpa]") {
+  StaticWorld world(nullptr);
+  std::vector<float> pos = {-32, 0, -32,  32, 0, -32,  32, 0, 32,  -32, 0, 32};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(pos, idx);
+  // Long walls across the middle, with gaps at alternate ends
+  std::vector<float> box;
+  for (int w = 0; w < 3; ++w) {
+    float z = -12.0f + w * 12.0f, x0 = w % 2 == 0 ? -32.0f : -24.0f, x1 = w % 2 == 0 ? 24.0f : 32.0f;
+    std::vector<float> wall = {x0, 0, z,  x1, 0, z,  x1, 0, z + 1,  x0, 0, z + 1,
+                               x0, 3, z,  x1, 3, z,  x1, 3, z + 1,  x0, 3, z + 1};
+    std::vector<uint32_t> faces = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                                   3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+    world.addTriangles(wall, faces);
+  }
+
+  NavGridSettings settings = GridSettings(128, 128);
+  settings.origin[0] = -32.0f;
+  settings.origin[2] = -32.0f;
+  GridNav nav(settings);
+  REQUIRE(nav.bakeFromWorld(world));
+  REQUIRE_FALSE(nav.clusterGraph().matches(nav.grid())); // JPS+ alone unless asked
+  nav.setPathSearch(PathSearch::Hierarchical);
+  REQUIRE(nav.clusterGraph().matches(nav.grid()));
+  REQUIRE(nav.jumpPoints().matches(nav.grid()));
+
+  Cell a, b;
+  REQUIRE(nav.grid().locate({-28.0f, 0.0f, -28.0f}, a));
+  REQUIRE(nav.grid().locate({-28.0f, 0.0f, 28.0f}, b));
+  HierarchicalSearch hpa;
+  REQUIRE(hpa.plan(nav.clusterGraph(), nav.grid(), a, b));
+  REQUIRE(hpa.legCount() > 4);
+
+  // The first legs alone end at their corridor cell
+  Path ahead = hpa.refine(nav.grid(), 0, 2, &nav.jumpPoints());
+  REQUIRE(Walkable(nav.grid(), ahead, hpa.corridor()[2]));
+  Path rest = hpa.refine(nav.grid(), 2, hpa.legCount(), &nav.jumpPoints());
+  REQUIRE(rest.points[0].x == hpa.corridor()[2].x);
+  REQUIRE(rest.points[0].y == hpa.corridor()[2].y);
+  REQUIRE(Walkable(nav.grid(), rest, b));
+  REQUIRE_FALSE(hpa.refine(nav.grid(), hpa.legCount(), 1).ok);
+
+  // GridNav goes hierarchical this far apart, and ends where A* does
+  Path path = nav.findPath({-28.0f, 0.0f, -28.0f}, {-28.0f, 0.0f, 28.0f});
+  REQUIRE(Walkable(nav.grid(), path, b));
+  GridSearch astar;
+  REQUIRE(astar.findPath(nav.grid(), a, b).ok);
+  REQUIRE(hpa.expanded() * 10 < astar.expanded());
+  REQUIRE(hpa.cost() <= astar.cost() * 1.1f);
+}
@@ -0,0 +1,241 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/flow_field.hpp"
+#include "arena/nav/grid_nav.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "../support/allocation_counter.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <cmath>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+Cell RandomWalkable(std::mt19937& rng, const NavGrid& grid) {
+  std::uniform_int_distribution<int> px(0, grid.width() - 1), pz(0, grid.depth() - 1), pl(0, grid.levels() - 1);
+  for (;;) {
+    Cell c{px(rng), pz(rng), pl(rng)};
+    if (grid.walkable(c.x, c.y, c.level)) return c;
+  }
+}
+
+bool Same(const Cell& a, const Cell& b) { return a.x == b.x && a.y == b.y && a.level == b.level; }
+
+} // namespace
+
+TEST_CASE("Flow field costs match grid search and lead to the goal", "[nav][flow]") {
+  std::mt19937 rng(45);
+  TaskPool pool(3);
+  GridSearch astar;
+  int compared = 0;
+  for (int round = 0; round < 6; ++round) {
+    int tileSize = round % 3 == 0 ? 8 : round % 3 == 1 ? 13 : 64;
+    NavGrid grid = RandomGrid(rng, 50 + round * 10, 40 + (round % 2) * 17, 0.05f, 0.02f, tileSize);
+    Cell goal = RandomWalkable(rng, grid);
+    FlowField field(grid, goal, &pool);
+    FlowField serial(grid, goal);
+    REQUIRE(field.matches(grid));
+    REQUIRE(Same(field.goal(), goal));
+    REQUIRE(field.direction(goal) == FlowField::kGoal);
+
+    for (int level = 0; level < grid.levels(); ++level) {
+      for (int z = 0; z < grid.depth(); ++z) {
+        for (int x = 0; x < grid.width(); ++x) {
+          float a = field.cost({x, z, level}), b = serial.cost({x, z, level});
+          REQUIRE((a >= FlowField::kUnreached) == (b >= FlowField::kUnreached));
+          if (a < FlowField::kUnreached) REQUIRE(std::abs(a - b) < 1e-3f);
+        }
+      }
+    }
+
+    for (int q = 0; q < 60; ++q) {
+      Cell start = RandomWalkable(rng, grid);
+      bool reached = field.cost(start) < FlowField::kUnreached;
+      REQUIRE(astar.findPath(grid, start, goal).ok == reached);
+      if (!reached) continue;
+      ++compared;
+      REQUIRE(std::abs(astar.cost() - field.cost(start) * grid.settings().cellSize) < 1e-3f);
+
+      // Following the moves costs what the field says and ends at the goal
+      Cell cell = start, to;
+      float walked = 0.0f;
+      for (int steps = 0; field.next(grid, cell, to); ++steps) {
+        REQUIRE(steps < static_cast<int>(grid.cellCount()));
+        walked += to.x != cell.x && to.y != cell.y ? 1.41421356f : 1.0f;
+        cell = to;
+      }
+      REQUIRE(Same(cell, goal));
+      REQUIRE(std::abs(walked - field.cost(start)) < 1e-3f);
+    }
+  }
+  REQUIRE(compared > 150);
+}
+
+TEST_CASE("Flow moves updated round an edit match a fresh build", "[nav][flow]") {
+  std::mt19937 rng(46);
+  NavGrid grid = RandomGrid(rng, 70, 50, 0.05f, 0.02f, 16);
+  FlowMoves moves(grid);
+  REQUIRE(moves.matches(grid));
+
+  // A wall, a raised patch and a hole, then only the box round them updated
+  for (int z = 10; z < 30; ++z) grid.setBlocked(40, z, 0);
+  for (int z = 20; z < 24; ++z) {
+    for (int x = 30; x < 34; ++x) grid.setWalkable(x, z, 0, 0.3f);
+  }
+  grid.setBlocked(36, 12, 0);
+  moves.update(grid, 30, 10, 40, 29);
+
+  FlowMoves fresh(grid);
+  for (size_t i = 0; i < grid.cellCount(); ++i) {
+    REQUIRE(moves.into(i) == fresh.into(i));
+    REQUIRE(moves.out(i) == fresh.out(i));
+  }
+
+  // Fields built on shared moves are the fields built on their own
+  Cell goal = RandomWalkable(rng, grid);
+  FlowField shared(grid, goal, nullptr, &moves), own(grid, goal);
+  for (int level = 0; level < grid.levels(); ++level) {
+    for (int z = 0; z < grid.depth(); ++z) {
+      for (int x = 0; x < grid.width(); ++x) {
+        REQUIRE(shared.cost({x, z, level}) == own.cost({x, z, level}));
+        REQUIRE(shared.direction({x, z, level}) == own.direction({x, z, level}));
+      }
+    }
+  }
+}
+
+TEST_CASE("Flow field cache builds a goal missed by several threads once", "[nav][flow]") {
+  std::mt19937 rng(47);
+  NavGrid grid = RandomGrid(rng, 120, 120, 0.05f, 0.02f, 32);
+  FlowMoves moves(grid);
+  Cell goal = RandomWalkable(rng, grid);
+  FlowFieldCache cache;
+  std::shared_ptr<const FlowField> fields[4];
+  std::vector<std::thread> threads;
+  for (auto& field : fields) {
+    threads.emplace_back([&] { field = cache.get(grid, goal, nullptr, FlowFieldCache::kCurrent, &moves); });
+  }
+  for (auto& thread : threads) thread.join();
+  REQUIRE(cache.misses() == 1);
+  REQUIRE(cache.hits() == 3);
+  for (auto& field : fields) REQUIRE(field == fields[0]);
+  REQUIRE(cache.get(grid, goal) == fields[0]);
+}
+
+TEST_CASE("Flow field cache retries a build that threw", "[nav][flow]") {
+  std::mt19937 rng(48);
+  NavGrid grid = RandomGrid(rng, 60, 60, 0.05f, 0.02f, 16);
+  FlowMoves moves(grid);
+  Cell goal = RandomWalkable(rng, grid);
+  FlowFieldCache cache;
+  {
+    // The field's cost array can't be allocated
+    arena::test::FailAllocationsFrom fail(grid.cellCount() * sizeof(float));
+    REQUIRE_THROWS_AS(cache.get(grid, goal, nullptr, FlowFieldCache::kCurrent, &moves), std::bad_alloc);
+  }
+  REQUIRE(cache.size() == 0);
+  auto field = cache.get(grid, goal, nullptr, FlowFieldCache::kCurrent, &moves);
+  REQUIRE(field != nullptr);
+  REQUIRE(field->cost(goal) == 0.0f);
+  REQUIRE(cache.misses() == 2);
+  REQUIRE(cache.get(grid, goal) == field);
+}
+
+TEST_CASE("Flow field cache drops the least recently used and edited fields", "[nav][flow]") {
+  // Two rooms with no way between them
+  NavGrid grid(GridSettings(40, 20, 8));
+  for (int z = 0; z < 20; ++z) {
+    for (int x = 0; x < 40; ++x) {
+      if (x != 20) grid.setWalkable(x, z, 0, 0.0f);
+    }
+  }
+  Cell west{5, 5, 0}, east{30, 10, 0}, corner{0, 0, 0};
+
+  FlowFieldCache cache(2);
+  auto a = cache.get(grid, west);
+  auto b = cache.get(grid, east);
+  REQUIRE(cache.get(grid, west) == a);
+  REQUIRE(cache.misses() == 2);
+  REQUIRE(cache.hits() == 1);
+  auto c = cache.get(grid, corner); // drops east, used longest ago
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.get(grid, west) == a);
+  REQUIRE(cache.get(grid, corner) == c);
+  REQUIRE(b->cost(east) == 0.0f); // still held, still valid
+  REQUIRE(b->cost(west) >= FlowField::kUnreached);
+
+  // An edit in the east room leaves fields into the west one alone
+  auto eastAgain = cache.get(grid, east);
+  REQUIRE(eastAgain != b);
+  REQUIRE(cache.size() == 2);
+  cache.invalidate(32, 2, 36, 6);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.get(grid, corner) == c);
+
+  // A build from a grid read before an invalidate() is handed out, not kept
+  uint64_t before = cache.generation();
+  cache.invalidate(32, 2, 36, 6);
+  REQUIRE(cache.generation() > before);
+  auto stale = cache.get(grid, east, nullptr, before);
+  REQUIRE(stale->cost(east) == 0.0f);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.get(grid, east) != stale);
+  REQUIRE(cache.size() == 2);
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("GridNav flow fields steer agents round a wall", "[nav][flow]") {
+  StaticWorld world(nullptr);
+  std::vector<float> floor = {-16, 0, -16,  16, 0, -16,  16, 0, 16,  -16, 0, 16};
+  std::vector<uint32_t> quad = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(floor, quad);
+  std::vector<float> wall = {-10, 0, -1,  16, 0, -1,  16, 0, 1,  -10, 0, 1,
+                             -10, 3, -1,  16, 3, -1,  16, 3, 1,  -10, 3, 1};
+  std::vector<uint32_t> box = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                               3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+  world.addTriangles(wall, box);
+
+  NavGridSettings settings = GridSettings(64, 64, 16);
+  settings.origin[0] = -16.0f;
+  settings.origin[2] = -16.0f;
+  TaskPool pool(2);
+  GridNav nav(settings);
+  nav.setTaskPool(&pool);
+  REQUIRE(nav.bakeFromWorld(world));
+
+  Vec3 goal{10.0f, 0.0f, 10.0f};
+  auto field = nav.flowField(goal);
+  REQUIRE(field != nullptr);
+  REQUIRE(nav.flowField(goal) == field);
+  REQUIRE(nav.flowFields().hits() == 1);
+  REQUIRE(nav.flowField({100.0f, 0.0f, 0.0f}) == nullptr);
+
+  // Agents south of the wall walk the field round its west end to the goal
+  for (Vec3 p : {Vec3{10.0f, 0.0f, -10.0f}, Vec3{-4.0f, 0.0f, -14.0f}, Vec3{14.0f, 0.0f, -3.0f}}) {
+    int steps = 0;
+    while (std::hypot(p.x - goal.x, p.z - goal.z) > 0.3f && steps < 1000) {
+      Vec3 dir = field->steer(nav.grid(), p);
+      REQUIRE(std::abs(std::hypot(dir.x, dir.z) - 1.0f) < 1e-3f);
+      p.x += dir.x * 0.1f;
+      p.z += dir.z * 0.1f;
+      Cell cell;
+      REQUIRE(nav.grid().locate(p, cell));
+      REQUIRE(cell.level == 0); // never onto the wall
+      ++steps;
+    }
+    REQUIRE(steps < 1000);
+  }
+
+  REQUIRE(nav.bakeFromWorld(world));
+  REQUIRE(nav.flowFields().size() == 0);
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/grid_nav.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/jump_points.hpp"
+#include "arena/phys/static_world.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+bool EndsAt(const Path& path, const Cell& goal) {
+  const Cell& last = path.points[path.count - 1];
+  return last.x == goal.x && last.y == goal.y && last.level == goal.level;
+}
+
+} // namespace
+
+TEST_CASE("Jump distances on an open floor with a wall", "[nav][jps]") {
+  NavGrid grid(GridSettings(20, 10));
+  for (int z = 0; z < 10; ++z) {
+    for (int x = 0; x < 20; ++x) grid.setWalkable(x, z, 0, 0.0f);
+  }
+  for (int x = 5; x < 10; ++x) grid.setBlocked(x, 6, 0); // wall along x at row 6
+
+  JumpPointTable jumps(grid);
+  REQUIRE(jumps.matches(grid));
+  REQUIRE(jumps.uniformCount() == 20 * 10 - 5);
+  auto at = [&](int x, int z) { return grid.cellIndex(x, z, 0); };
+
+  // Along the open row 2 nothing is forced: free steps to the edge
+  REQUIRE(jumps.distance(at(3, 2), 0) == -16);
+  REQUIRE(jumps.distance(at(3, 2), 2) == -3);
+  // Row 5 runs under the wall; its end at x = 10 opens a turn
+  REQUIRE(jumps.distance(at(2, 5), 0) == 8);
+  REQUIRE(jumps.distance(at(12, 5), 2) == 8); // the other end, at x = 4
+  // Up from row 0 in column 7 the wall is 6 cells away
+  REQUIRE(jumps.distance(at(7, 0), 1) == -5);
+  // Diagonals stop where a straight jump would: column 4 passes the wall's
+  // west end at row 7, and row 7 passes its east end at x = 10
+  REQUIRE(jumps.distance(at(0, 0), 4) == 4);
+  REQUIRE(jumps.distance(at(0, 9), 7) == 2);
+  REQUIRE(jumps.distance(at(15, 0), 4) == -4);
+}
+
+TEST_CASE("JPS+ costs match A* on random grids", "[nav][jps]") {
+  std::mt19937 rng(21);
+  GridSearch astar, jps;
+  int compared = 0, upstairs = 0;
+  for (int round = 0; round < 12; ++round) {
+    int width = 24 + round * 6, depth = 20 + (round % 4) * 9;
+    NavGrid grid = RandomGrid(rng, width, depth, round % 3 == 0 ? 0.0f : 0.08f * (round % 3), 0.02f);
+    if (round % 2 == 0) grid.labelRegions();
+    JumpPointTable jumps(grid);
+    REQUIRE(jumps.uniformCount() > 0);
+
+    std::uniform_int_distribution<int> px(0, width - 1), pz(0, depth - 1);
+    for (int q = 0; q < 150; ++q) {
+      Cell a{px(rng), pz(rng), 0}, b{px(rng), pz(rng), q % 4 == 0 ? 1 : 0};
+      Path slow = astar.findPath(grid, a, b);
+      Path fast = jps.findPath(grid, a, b, &jumps);
+      REQUIRE(slow.ok == fast.ok);
+      if (!slow.ok) continue;
+      ++compared;
+      upstairs += b.level;
+      REQUIRE(std::abs(astar.cost() - jps.cost()) < 1e-3f);
+      REQUIRE(EndsAt(fast, b));
+      for (int i = 1; i < fast.count; ++i) REQUIRE(gridLineOfSight(grid, fast.points[i - 1], fast.points[i]));
+    }
+  }
+  REQUIRE(compared > 300);
+  REQUIRE(upstairs > 20);
+}
+
+TEST_CASE("Updating the table after edits matches a fresh build", "[nav][jps]") {
+  std::mt19937 rng(34);
+  for (int round = 0; round < 6; ++round) {
+    int width = 30 + round * 7, depth = 24 + round * 5;
+    NavGrid grid = RandomGrid(rng, width, depth, 0.04f * (round % 3), 0.02f);
+    JumpPointTable jumps(grid);
+    std::uniform_int_distribution<int> px(0, width - 1), pz(0, depth - 1), size(0, 5), pick(0, 3);
+    for (int edit = 0; edit < 20; ++edit) {
+      int x0 = px(rng), z0 = pz(rng);
+      int x1 = std::min(width - 1, x0 + size(rng)), z1 = std::min(depth - 1, z0 + size(rng));
+      int kind = pick(rng);
+      for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+          if (kind == 0) grid.setBlocked(x, z, 0);
+          else if (kind == 1) grid.setWalkable(x, z, 0, 0.0f);
+          else if (kind == 2 && (x + z) % 3 == 0) grid.setBlocked(x, z, 0);
+          else if (kind == 3) grid.setWalkable(x, z, 0, x == x0 ? 0.6f : 0.0f); // a ledge
+        }
+      }
+      jumps.update(grid, x0, z0, x1, z1);
+      JumpPointTable fresh(grid);
+      REQUIRE(jumps.uniformCount() == fresh.uniformCount());
+      for (size_t cell = 0; cell < grid.cellCount(); ++cell) {
+        REQUIRE(jumps.uniform(cell) == fresh.uniform(cell));
+        for (int dir = 0; dir < 8; ++dir) REQUIRE(jumps.distance(cell, dir) == fresh.distance(cell, dir));
+      }
+    }
+  }
+}
+
+TEST_CASE("GridNav selects the search and keeps the table in step", "[nav][jps]") {
+  StaticWorld world(nullptr);
+  std::vector<float> pos = {-16, 0, -16,  16, 0, -16,  16, 0, 16,  -16, 0, 16};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(pos, idx);
+
+  NavGridSettings settings = GridSettings(64, 64);
+  settings.origin[0] = -16.0f;
+  settings.origin[2] = -16.0f;
+  GridNav nav(settings);
+  REQUIRE(nav.pathSearch() == PathSearch::JumpPoints);
+  REQUIRE(nav.bakeFromWorld(world));
+  REQUIRE(nav.jumpPoints().matches(nav.grid()));
+
+  Cell a, b;
+  REQUIRE(nav.grid().locate({-14.0f, 0.0f, -13.0f}, a));
+  REQUIRE(nav.grid().locate({12.0f, 0.0f, 9.0f}, b));
+  GridSearch astar, jps;
+  REQUIRE(astar.findPath(nav.grid(), a, b).ok);
+  REQUIRE(jps.findPath(nav.grid(), a, b, &nav.jumpPoints()).ok);
+  REQUIRE(std::abs(astar.cost() - jps.cost()) < 1e-3f);
+  REQUIRE(jps.expanded() * 4 < astar.expanded());
+
+  Path viaJumps = nav.findPath({-14.0f, 0.0f, -13.0f}, {12.0f, 0.0f, 9.0f});
+  nav.setPathSearch(PathSearch::AStar);
+  REQUIRE_FALSE(nav.jumpPoints().matches(nav.grid()));
+  Path viaAStar = nav.findPath({-14.0f, 0.0f, -13.0f}, {12.0f, 0.0f, 9.0f});
+  REQUIRE(viaJumps.ok);
+  REQUIRE(viaAStar.ok);
+  REQUIRE(EndsAt(viaJumps, b));
+  REQUIRE(EndsAt(viaAStar, b));
+  nav.setPathSearch(PathSearch::JumpPoints);
+  REQUIRE(nav.jumpPoints().matches(nav.grid()));
+}
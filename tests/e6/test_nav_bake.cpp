@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/grid_nav.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+Cell CellAt(const NavGridSettings& s, float x, float z, int level) {
+  return {static_cast<int>(std::floor((x - s.origin[0]) / s.cellSize)),
+          static_cast<int>(std::floor((z - s.origin[2]) / s.cellSize)), level};
+}
+
+bool WalkableAt(const NavGrid& grid, float x, float z, int level) {
+  Cell c = CellAt(grid.settings(), x, z, level);
+  return grid.walkable(c.x, c.y, c.level);
+}
+
+float HeightAt(const NavGrid& grid, float x, float z, int level) {
+  Cell c = CellAt(grid.settings(), x, z, level);
+  return grid.height(c.x, c.y, c.level);
+}
+
+} // namespace
+
+TEST_CASE("Open floor is walkable except around obstacles", "[nav][bake]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddBox(world, 2, 2, 4, 4, 5); // top lands in level 1
+
+  NavGrid grid = bakeNavGrid(world, SmallArena());
+  REQUIRE(WalkableAt(grid, -8.25f, -8.25f, 0));
+  REQUIRE(std::abs(HeightAt(grid, -8.25f, -8.25f, 0)) < 0.01f);
+  REQUIRE_FALSE(WalkableAt(grid, -8.25f, -8.25f, 1));
+
+  // The agent radius keeps cell centres 0.4 m off the walls
+  REQUIRE_FALSE(WalkableAt(grid, 1.75f, 3.25f, 0));
+  REQUIRE(WalkableAt(grid, 1.25f, 3.25f, 0));
+  REQUIRE_FALSE(WalkableAt(grid, 3.25f, 4.25f, 0));
+  REQUIRE(WalkableAt(grid, 3.25f, 4.75f, 0));
+  REQUIRE_FALSE(WalkableAt(grid, 3.25f, 4.75f, 1));
+
+  // The box top sits in level 1's band and is a floor of its own
+  REQUIRE(WalkableAt(grid, 3.25f, 3.25f, 1));
+  REQUIRE(std::abs(HeightAt(grid, 3.25f, 3.25f, 1) - 5.0f) < 0.01f);
+}
+
+TEST_CASE("Stacked floors bake to separate levels and low ceilings block", "[nav][bake]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddSlab(world, -16, -16, 0, 16, 4.5f);  // upper storey over the west half
+  AddSlab(world, 8, -16, 16, 16, 1.2f);   // crawlspace roof over the east edge
+
+  NavGrid grid = bakeNavGrid(world, SmallArena());
+  REQUIRE(WalkableAt(grid, -8.25f, 0.25f, 0));
+  REQUIRE(WalkableAt(grid, -8.25f, 0.25f, 1));
+  REQUIRE(std::abs(HeightAt(grid, -8.25f, 0.25f, 1) - 4.5f) < 0.01f);
+  REQUIRE_FALSE(WalkableAt(grid, 4.25f, 0.25f, 1));
+
+  // Under 1.2 m there's no headroom, so level 0 there is the roof itself
+  REQUIRE(WalkableAt(grid, 12.25f, 0.25f, 0));
+  REQUIRE(std::abs(HeightAt(grid, 12.25f, 0.25f, 0) - 1.2f) < 0.01f);
+
+  Cell c;
+  REQUIRE(grid.locate({-8.2f, 4.6f, 0.3f}, c));
+  REQUIRE(c.level == 1);
+  REQUIRE(grid.locate({-8.2f, 0.9f, 0.3f}, c));
+  REQUIRE(c.level == 0);
+  Vec3 p = grid.center(c);
+  REQUIRE(std::abs(p.x + 8.25f) < 1e-4f);
+  REQUIRE(std::abs(p.z - 0.25f) < 1e-4f);
+  REQUIRE_FALSE(grid.locate({40.0f, 0.0f, 0.0f}, c));
+}
+
+TEST_CASE("Slopes are walkable up to the limit", "[nav][bake]") {
+  StaticWorld world(nullptr);
+  AddRamp(world, -12, -10, -6, 8, 3);  // ~21 degrees
+  AddRamp(world, -12, 4, 8, 2, 4);     // ~63 degrees
+
+  NavGrid grid = bakeNavGrid(world, SmallArena());
+  REQUIRE(WalkableAt(grid, -8.25f, -7.75f, 0));
+  REQUIRE(std::abs(HeightAt(grid, -8.25f, -7.75f, 0) - 3.0f * 3.75f / 8.0f) < 0.01f);
+  REQUIRE_FALSE(WalkableAt(grid, -11.25f, 6.25f, 0));
+}
+
+TEST_CASE("Tiles baked on a pool match a serial bake", "[nav][bake]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddSlab(world, -10, -10, 2, 2, 4.5f);
+  for (int i = 0; i < 6; ++i) AddBox(world, -14.0f + i * 5.0f, 6, -13.0f + i * 5.0f, 7.5f, 1.0f + i * 0.8f);
+  AddRamp(world, 4, -12, -8, 10, 3.5f);
+
+  NavGridSettings settings = SmallArena();
+  settings.tileSize = 13; // tiles straddle bit words
+  NavGrid serial = bakeNavGrid(world, settings);
+  TaskPool pool(3);
+  NavGrid parallel = bakeNavGrid(world, settings, &pool);
+
+  REQUIRE(serial.walkableCount() > 2000);
+  REQUIRE(serial.walkableCount() == parallel.walkableCount());
+  for (int level = 0; level < settings.levels; ++level) {
+    auto a = serial.levelBits(level), b = parallel.levelBits(level);
+    REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    for (int z = 0; z < settings.depth; ++z) {
+      for (int x = 0; x < settings.width; ++x) {
+        if (serial.walkable(x, z, level)) REQUIRE(serial.height(x, z, level) == parallel.height(x, z, level));
+      }
+    }
+  }
+
+  GridNav nav(settings);
+  nav.setTaskPool(&pool);
+  REQUIRE(nav.bakeFromWorld(world));
+  REQUIRE(nav.grid().walkableCount() == serial.walkableCount());
+  REQUIRE_FALSE(GridNav(settings).bakeFromWorld(StaticWorld(nullptr)));
+}
+
+TEST_CASE("Re-baking skips tiles outside the grid", "[nav][bake]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  NavGridSettings settings = SmallArena(); // 4 x 4 tiles
+  NavGrid baked = bakeNavGrid(world, settings);
+  NavGrid grid(settings);
+  std::vector<uint32_t> tiles = {16, 5, UINT32_MAX, 1000};
+  rebakeNavTiles(world, grid, tiles);
+  for (int z = 0; z < settings.depth; ++z) {
+    for (int x = 0; x < settings.width; ++x) {
+      bool inTile5 = x / 16 == 1 && z / 16 == 1;
+      REQUIRE(grid.walkable(x, z, 0) == (inTile5 && baked.walkable(x, z, 0)));
+    }
+  }
+  REQUIRE(grid.walkableCount() > 0);
+}
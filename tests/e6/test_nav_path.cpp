@@ -0,0 +1,189 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/grid_nav.hpp"
+#include "arena/nav/grid_search.hpp"
+#include "arena/phys/static_world.hpp"
+#include "../support/allocation_counter.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+// Plain Dijkstra over the same moves, for reference costs in cells
+float ReferenceCost(const NavGrid& grid, const Cell& start, const Cell& goal) {
+  std::vector<float> dist(grid.cellCount(), INFINITY);
+  using Item = std::pair<float, Cell>;
+  auto later = [](const Item& a, const Item& b) { return a.first > b.first; };
+  std::priority_queue<Item, std::vector<Item>, decltype(later)> open(later);
+  dist[grid.cellIndex(start.x, start.y, start.level)] = 0.0f;
+  open.push({0.0f, start});
+  while (!open.empty()) {
+    auto [d, c] = open.top();
+    open.pop();
+    if (d > dist[grid.cellIndex(c.x, c.y, c.level)]) continue;
+    if (c.x == goal.x && c.y == goal.y && c.level == goal.level) return d;
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        Cell n, side;
+        if ((dx == 0 && dz == 0) || !grid.step(c, dx, dz, n)) continue;
+        if (dx != 0 && dz != 0 && (!grid.step(c, dx, 0, side) || !grid.step(c, 0, dz, side))) continue;
+        float nd = d + (dx != 0 && dz != 0 ? 1.41421356f : 1.0f);
+        float& best = dist[grid.cellIndex(n.x, n.y, n.level)];
+        if (nd < best) {
+          best = nd;
+          open.push({nd, n});
+        }
+      }
+    }
+  }
+  return INFINITY;
+}
+
+} // namespace
+
+TEST_CASE("Paths go around walls and are straightened", "[nav][path]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddBox(world, -0.5f, -10, 0.5f, 10, 3);
+
+  GridNav nav(SmallArena());
+  REQUIRE(nav.bakeFromWorld(world));
+  const NavGrid& grid = nav.grid();
+
+  // In plain sight: just the two ends
+  Path path = nav.findPath({-8.2f, 0.0f, 12.2f}, {8.2f, 0.0f, 13.2f});
+  REQUIRE(path.ok);
+  REQUIRE(path.count == 2);
+
+  Cell start, goal;
+  REQUIRE(grid.locate({-8.2f, 0.0f, 0.2f}, start));
+  REQUIRE(grid.locate({8.2f, 0.0f, 0.2f}, goal));
+  path = nav.findPath({-8.2f, 0.0f, 0.2f}, {8.2f, 0.0f, 0.2f});
+  REQUIRE(Walkable(grid, path, goal));
+  REQUIRE(path.points[0].x == start.x);
+  REQUIRE(path.points[0].y == start.y);
+  // Round one end of the wall: a corner on each side of it
+  REQUIRE(path.count >= 3);
+  REQUIRE(path.count <= 5);
+  for (int i = 1; i + 1 < path.count; ++i) REQUIRE(std::abs(path.points[i].y - 32) >= 20);
+
+  GridSearch search;
+  REQUIRE(search.findPath(grid, start, goal).ok);
+  REQUIRE(std::abs(search.cost() - ReferenceCost(grid, start, goal) * 0.5f) < 1e-3f);
+}
+
+TEST_CASE("Paths climb ramps between levels", "[nav][path]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddSlab(world, 4, -16, 16, 16, 4.5f);  // deck over the east side
+  AddRamp(world, -6, -2, 2, 10, 4.5f);    // up to it from the west
+
+  GridNav nav(SmallArena());
+  REQUIRE(nav.bakeFromWorld(world));
+  Cell start, goal;
+  REQUIRE(nav.grid().locate({-12.2f, 0.0f, 0.2f}, start));
+  REQUIRE(nav.grid().locate({10.2f, 4.5f, 12.2f}, goal));
+  REQUIRE(start.level == 0);
+  REQUIRE(goal.level == 1);
+
+  Path path = nav.findPath({-12.2f, 0.0f, 0.2f}, {10.2f, 4.5f, 12.2f});
+  REQUIRE(Walkable(nav.grid(), path, goal));
+  REQUIRE(path.count >= 3);
+
+  // The same column under the deck is a different, ground-level goal
+  Cell under;
+  REQUIRE(nav.grid().locate({10.2f, 0.0f, 12.2f}, under));
+  REQUIRE(under.level == 0);
+  REQUIRE(Walkable(nav.grid(), nav.findPath({-12.2f, 0.0f, 0.2f}, {10.2f, 0.0f, 12.2f}), under));
+}
+
+TEST_CASE("Unreachable or unlocatable goals fail", "[nav][path]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  AddSlab(world, 6, 6, 10, 10, 4.5f); // floating platform, no way up
+
+  GridNav nav(SmallArena());
+  REQUIRE(nav.bakeFromWorld(world));
+  REQUIRE_FALSE(nav.findPath({-8.2f, 0.0f, 0.2f}, {8.2f, 4.5f, 8.2f}).ok);
+  REQUIRE_FALSE(nav.findPath({-8.2f, 0.0f, 0.2f}, {40.0f, 0.0f, 0.0f}).ok);
+  REQUIRE(nav.findPath({-8.2f, 0.0f, 0.2f}, {-2.2f, 0.0f, -3.2f}).ok);
+
+  // Regions from the bake turn it down without a search
+  GridSearch search;
+  Cell start, goal;
+  REQUIRE(nav.grid().locate({-8.2f, 0.0f, 0.2f}, start));
+  REQUIRE(nav.grid().locate({8.2f, 4.5f, 8.2f}, goal));
+  REQUIRE_FALSE(search.findPath(nav.grid(), start, goal).ok);
+  REQUIRE(search.expanded() == 0);
+
+  Path same = nav.findPath({-8.2f, 0.0f, 0.2f}, {-8.1f, 0.0f, 0.1f});
+  REQUIRE(same.ok);
+  REQUIRE(same.count == 1);
+}
+
+TEST_CASE("Search costs match Dijkstra on random grids", "[nav][path]") {
+  NavGridSettings settings = SmallArena();
+  settings.width = 40;
+  settings.depth = 30;
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> x(0, settings.width - 1), z(0, settings.depth - 1);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  GridSearch search; // reused across grids and queries
+  int upstairs = 0;
+  for (int round = 0; round < 8; ++round) {
+    NavGrid grid(settings);
+    for (int cz = 0; cz < settings.depth; ++cz) {
+      for (int cx = 0; cx < settings.width; ++cx) {
+        if (unit(rng) < 0.25f) continue;
+        // Gentle undulation with the odd ledge too tall to step up, then a
+        // slope up to a deck on level 1 over the east end
+        float y = cx <= 20 ? 0.1f * std::sin(cx * 0.7f) : cx < 30 ? 0.3f * (cx - 20) : 0.0f;
+        grid.setWalkable(cx, cz, 0, y + (unit(rng) < 0.05f ? 0.5f : 0.0f));
+        if (cx >= 30) grid.setWalkable(cx, cz, 1, 3.0f + 0.02f * cz);
+      }
+    }
+    for (int q = 0; q < 40; ++q) {
+      Cell a{x(rng), z(rng), 0}, b{x(rng), z(rng), q % 3 == 0 ? 1 : 0};
+      float expected = ReferenceCost(grid, a, b);
+      Path path = search.findPath(grid, a, b);
+      if (!grid.walkable(a.x, a.y, a.level) || !grid.walkable(b.x, b.y, b.level) || std::isinf(expected)) {
+        REQUIRE_FALSE(path.ok);
+        continue;
+      }
+      REQUIRE(Walkable(grid, path, b));
+      REQUIRE(std::abs(search.cost() - expected * settings.cellSize) < 1e-3f);
+      upstairs += b.level;
+    }
+  }
+  REQUIRE(upstairs >= 5);
+}
+
+TEST_CASE("Repeated queries make no allocations", "[nav][path]") {
+  StaticWorld world(nullptr);
+  AddSlab(world, -16, -16, 16, 16, 0);
+  for (int i = 0; i < 5; ++i) AddBox(world, -12.0f + i * 5.0f, -12.0f + i * 4.0f, -10.0f + i * 5.0f, -2.0f + i * 4.0f, 3);
+
+  GridNav nav(SmallArena());
+  REQUIRE(nav.bakeFromWorld(world));
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> coord(-15.0f, 15.0f);
+  std::vector<Vec3> ends(400);
+  for (Vec3& p : ends) p = {coord(rng), 0.0f, coord(rng)};
+
+  // Warm up this thread's context on the longest path there is
+  REQUIRE(nav.findPath({-15.7f, 0.0f, -15.7f}, {15.7f, 0.0f, 15.7f}).ok);
+  size_t found = 0;
+  size_t before = arena::test::allocationCount();
+  for (size_t i = 0; i + 1 < ends.size(); i += 2) found += nav.findPath(ends[i], ends[i + 1]).ok ? 1 : 0;
+  REQUIRE(arena::test::allocationCount() == before);
+  REQUIRE(found > 100);
+}
@@ -0,0 +1,170 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/nav/grid_nav.hpp"
+#include "arena/phys/static_world.hpp"
+#include "arena/task_pool.hpp"
+#include "../support/nav_fixtures.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace arena;
+using namespace arena::nav;
+using namespace arena::test;
+using arena::phys::StaticWorld;
+
+namespace {
+
+NavGridSettings ClusteredArena() {
+  NavGridSettings s = SmallArena();
+  s.clusterSize = 8;
+  return s;
+}
+
+// The editor's side: walls go into the world and their boxes to the nav,
+// and markDirty() sends the nav off to re-bake them
+struct WallEditor : IEditMode {
+  StaticWorld& world;
+  GridNav& nav;
+  std::vector<uint32_t> walls;
+
+  WallEditor(StaticWorld& w, GridNav& n) : world(w), nav(n) {}
+
+  void placeWall(const Vec3& p0, const Vec3& p1, float height, int) override {
+    nav.finishRebake(); // the world can't change under a running re-bake
+    Vec3 lo{std::min(p0.x, p1.x) - 0.25f, p0.y, std::min(p0.z, p1.z) - 0.25f};
+    Vec3 hi{std::max(p0.x, p1.x) + 0.25f, p0.y + height, std::max(p0.z, p1.z) + 0.25f};
+    walls.push_back(AddBox(world, lo.x, lo.z, hi.x, hi.z, hi.y - lo.y, lo.y));
+    nav.markDirty(lo, hi);
+  }
+  void removeWall(const Vec3& lo, const Vec3& hi) {
+    nav.finishRebake();
+    world.removeMesh(walls.back());
+    walls.pop_back();
+    nav.markDirty(lo, hi);
+  }
+  void markDirty() override {
+    world.applyRebuild(); // between edits and the re-bake is the world's sync point
+    nav.startRebake(world);
+  }
+};
+
+void RequireSameGrid(const NavGrid& a, const NavGrid& b) {
+  for (int level = 0; level < a.levels(); ++level) {
+    for (int z = 0; z < a.depth(); ++z) {
+      for (int x = 0; x < a.width(); ++x) {
+        REQUIRE(a.walkable(x, z, level) == b.walkable(x, z, level));
+        if (!a.walkable(x, z, level)) continue;
+        REQUIRE(a.height(x, z, level) == b.height(x, z, level));
+        REQUIRE(a.region({x, z, level}) == b.region({x, z, level}));
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Re-baking edited tiles matches a full bake", "[nav][rebake]") {
+  StaticWorld world(nullptr);
+  AddBox(world, -16, -16, 16, 16, 0.2f, -0.2f);
+  TaskPool pool(2);
+  GridNav nav(ClusteredArena());
+  nav.setTaskPool(&pool);
+  nav.setPathSearch(PathSearch::Hierarchical);
+  REQUIRE(nav.bakeFromWorld(world));
+  auto before = nav.snapshot();
+  uint64_t version = nav.version();
+
+  Vec3 south{0.2f, 0.0f, -6.2f}, north{0.2f, 0.0f, 8.2f};
+  REQUIRE(nav.findPath(south, north).count == 2);
+  auto field = nav.flowField(north);
+  REQUIRE(field != nullptr);
+
+  WallEditor editor(world, nav);
+  editor.placeWall({-10.0f, 0.0f, 2.0f}, {10.0f, 0.0f, 2.0f}, 3.0f, 0);
+  REQUIRE_FALSE(nav.rebakePending());
+  editor.markDirty();
+  REQUIRE(nav.rebakePending());
+  REQUIRE_FALSE(nav.startRebake(world)); // one at a time
+  nav.finishRebake();
+  REQUIRE_FALSE(nav.rebakePending());
+  REQUIRE(nav.version() == version + 1);
+
+  // The same grid, jumps and cluster graph as baking it all again
+  NavGrid fresh = bakeNavGrid(world, ClusteredArena());
+  RequireSameGrid(nav.grid(), fresh);
+  JumpPointTable jumps(fresh);
+  REQUIRE(nav.jumpPoints().uniformCount() == jumps.uniformCount());
+  for (size_t cell = 0; cell < fresh.cellCount(); ++cell) {
+    for (int dir = 0; dir < 8; ++dir) REQUIRE(nav.jumpPoints().distance(cell, dir) == jumps.distance(cell, dir));
+  }
+  ClusterGraph clusters(fresh, 8);
+  REQUIRE(nav.clusterGraph().nodeCount() == clusters.nodeCount());
+  REQUIRE(nav.clusterGraph().edgeCount() == clusters.edgeCount());
+
+  // Paths go round the wall, the stale flow field is gone, and the snapshot
+  // held from before is as it was
+  Path path = nav.findPath(south, north);
+  REQUIRE(path.ok);
+  REQUIRE(path.count >= 3);
+  REQUIRE(nav.flowFields().size() == 0);
+  REQUIRE(nav.flowField(north) != field);
+  Cell onWall;
+  REQUIRE(before->grid.locate({0.2f, 0.0f, 2.2f}, onWall));
+  REQUIRE(before->version == version);
+  REQUIRE_FALSE(nav.grid().walkable(onWall.x, onWall.y, 0));
+
+  // Taking it away again restores the original bake
+  editor.removeWall({-10.25f, 0.0f, 1.75f}, {10.25f, 3.0f, 2.25f});
+  editor.markDirty();
+  nav.finishRebake();
+  RequireSameGrid(nav.grid(), before->grid);
+  REQUIRE(nav.clusterGraph().edgeCount() == before->clusters.edgeCount());
+  REQUIRE(nav.findPath(south, north).count == 2);
+}
+
+TEST_CASE("Queries run on while re-bakes are published", "[nav][rebake]") {
+  StaticWorld world(nullptr);
+  AddBox(world, -16, -16, 16, 16, 0.2f, -0.2f);
+  TaskPool pool(1);
+  GridNav nav(ClusteredArena());
+  nav.setTaskPool(&pool);
+  REQUIRE(nav.bakeFromWorld(world));
+  uint64_t version = nav.version();
+
+  // Walls come and go on the east side; the west stays open throughout
+  std::atomic<bool> done{false};
+  std::atomic<int> queries{0}, failed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&, t] {
+      while (!done) {
+        Path path = nav.findPath({-14.0f, 0.0f, -14.0f + t}, {-4.0f, 0.0f, 14.0f - t});
+        if (!path.ok) ++failed;
+        ++queries;
+      }
+    });
+  }
+
+  WallEditor editor(world, nav);
+  for (int i = 0; i < 6; ++i) {
+    float x = 2.0f + i * 2.0f;
+    if (i % 2 == 0) {
+      editor.placeWall({x, 0.0f, -12.0f}, {x, 0.0f, 12.0f}, 3.0f, 0);
+    } else {
+      editor.removeWall({x - 2.25f, 0.0f, -12.25f}, {x - 1.75f, 3.0f, 12.25f});
+    }
+    editor.markDirty();
+    // The tick goes on; the new data turns up at a later sync point
+    while (!nav.applyRebake()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  done = true;
+  for (auto& thread : threads) thread.join();
+
+  REQUIRE(nav.version() == version + 6);
+  REQUIRE(queries > 0);
+  REQUIRE(failed == 0);
+  RequireSameGrid(nav.grid(), bakeNavGrid(world, ClusteredArena()));
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/ecs/path_service.hpp"
+#include "arena/nav/grid_nav.hpp"
+#include "arena/phys/static_world.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace arena;
+using namespace arena::ecs;
+using arena::nav::GridNav;
+using arena::nav::NavGridSettings;
+using arena::phys::StaticWorld;
+
+namespace {
+
+// Cells are whole metres; a path is just the goal cell. Counts searches and
+// optionally takes its time over them.
+struct CountingNav : INav {
+  mutable std::atomic<int> searches{0};
+  std::chrono::microseconds delay{0};
+
+  bool bakeFromWorld(const IWorld&) override { return true; }
+  Path findPath(const Vec3&, const Vec3& goal) const override {
+    ++searches;
+    if (delay.count() > 0) std::this_thread::sleep_for(delay);
+    Path path;
+    path.ok = true;
+    path.count = 1;
+    locate(goal, path.points[0]);
+    return path;
+  }
+  bool locate(const Vec3& p, Cell& out) const override {
+    out = {static_cast<int>(std::floor(p.x)), static_cast<int>(std::floor(p.z)), 0};
+    return true;
+  }
+};
+
+bool SamePath(const Path& a, const Path& b) {
+  if (a.ok != b.ok || a.count != b.count) return false;
+  for (int i = 0; i < a.count; ++i) {
+    if (a.points[i].x != b.points[i].x || a.points[i].y != b.points[i].y || a.points[i].level != b.points[i].level) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Path service orders, shares, replaces and expires requests", "[nav][service]") {
+  CountingNav nav;
+  PathService::Settings settings;
+  settings.workers = 0;
+  settings.inlineSearches = 1;
+  PathService service(nav, settings);
+  Registry registry;
+  Entity a = registry.create(), b = registry.create(), c = registry.create(), d = registry.create(),
+         e = registry.create();
+
+  uint32_t ra = service.submit(a, {0.5f, 0, 0.5f}, {10.5f, 0, 0.5f});
+  uint32_t rb = service.submit(b, {0.5f, 0, 0.5f}, {20.5f, 0, 0.5f}, 5);
+  service.submit(c, {0.2f, 0, 0.7f}, {10.9f, 0, 0.1f}); // a's cells
+  service.submit(d, {0.5f, 0, 0.5f}, {30.5f, 0, 0.5f}, 0, 1);
+  service.submit(e, {0.5f, 0, 0.5f}, {40.5f, 0, 0.5f});
+  REQUIRE(service.queueDepth() == 4);
+  REQUIRE(service.stats().shared == 1);
+
+  // Tick 1 searches b, the highest priority; nothing is delivered until the
+  // sync after a search
+  service.sync(registry);
+  REQUIRE(nav.searches == 1);
+  REQUIRE(!registry.has<NavPath>(b));
+
+  // Tick 2 delivers b, expires d (one tick to get started, and b took it)
+  // and searches a for a and c
+  service.sync(registry);
+  REQUIRE(registry.get<NavPath>(b)->request == rb);
+  REQUIRE(registry.get<NavPath>(b)->path.points[0].x == 20);
+  REQUIRE(registry.get<NavPath>(d)->expired);
+  REQUIRE(!registry.get<NavPath>(d)->path.ok);
+  REQUIRE(nav.searches == 2);
+
+  // e changes its mind before its search runs, and c goes away
+  uint32_t re = service.submit(e, {0.5f, 0, 0.5f}, {50.5f, 0, 0.5f});
+  registry.destroy(c);
+  service.sync(registry);
+  REQUIRE(registry.get<NavPath>(a)->request == ra);
+  REQUIRE(registry.get<NavPath>(a)->path.points[0].x == 10);
+  REQUIRE(!registry.has<NavPath>(c));
+  service.sync(registry);
+  REQUIRE(registry.get<NavPath>(e)->request == re);
+  REQUIRE(registry.get<NavPath>(e)->path.points[0].x == 50);
+  REQUIRE(!registry.get<NavPath>(e)->expired);
+
+  PathService::Stats stats = service.stats();
+  REQUIRE(nav.searches == 3); // b, a + c, e's second
+  REQUIRE(stats.submitted == 6);
+  REQUIRE(stats.replaced == 1);
+  REQUIRE(stats.searched == 3);
+  REQUIRE(stats.expired == 1);
+  REQUIRE(stats.delivered == 4); // a, b, d, e
+  REQUIRE(stats.queued == 0);
+  REQUIRE(stats.waiting == 0);
+  REQUIRE(service.latency().count == 4);
+
+  // A cancelled request is never delivered
+  service.submit(a, {0.5f, 0, 0.5f}, {60.5f, 0, 0.5f});
+  service.cancel(a);
+  service.sync(registry);
+  service.sync(registry);
+  REQUIRE(registry.get<NavPath>(a)->request == ra);
+  REQUIRE(nav.searches == 3);
+}
+
+TEST_CASE("Path service workers keep to the tick budget", "[nav][service]") {
+  CountingNav nav;
+  nav.delay = std::chrono::microseconds(1000);
+  PathService::Settings settings;
+  settings.workers = 2;
+  settings.budgetMs = 2.5f;
+  PathService service(nav, settings);
+  Registry registry;
+
+  std::vector<Entity> agents;
+  for (int i = 0; i < 40; ++i) {
+    agents.push_back(registry.create());
+    // Pairs of agents share their cells
+    service.submit(agents.back(), {0.5f, 0, 0.5f}, {static_cast<float>(i / 2) + 0.5f, 0, 3.5f});
+  }
+
+  // Each search spends at least a millisecond, so three use up a tick's
+  // budget and at most one more can be under way when that happens
+  int ticks = 0, delivered = 0;
+  uint64_t searched = 0;
+  while (delivered < 40 && ticks < 100) {
+    service.wait();
+    uint64_t now = service.stats().searched;
+    REQUIRE(now - searched <= 4);
+    searched = now;
+    service.sync(registry);
+    ++ticks;
+    delivered = static_cast<int>(service.stats().delivered);
+  }
+  REQUIRE(delivered == 40);
+  REQUIRE(ticks >= 5);
+  REQUIRE(nav.searches == 20);
+  for (int i = 0; i < 40; ++i) {
+    const NavPath* path = registry.get<NavPath>(agents[i]);
+    REQUIRE(path != nullptr);
+    REQUIRE(path->path.ok);
+    REQUIRE(path->path.points[0].x == i / 2);
+  }
+  TimingHistory::Summary latency = service.latency();
+  REQUIRE(latency.count == 40);
+  REQUIRE(latency.max >= latency.min);
+  REQUIRE(service.queueDepth() == 0);
+}
+
+TEST_CASE("Path service delivers what GridNav finds", "[nav][service]") {
+  StaticWorld world(nullptr);
+  std::vector<float> floor = {-16, 0, -16,  16, 0, -16,  16, 0, 16,  -16, 0, 16};
+  std::vector<uint32_t> quad = {0, 1, 2,  0, 2, 3};
+  world.addTriangles(floor, quad);
+  std::vector<float> wall = {-0.5f, 0, -10,  0.5f, 0, -10,  0.5f, 0, 10,  -0.5f, 0, 10,
+                             -0.5f, 3, -10,  0.5f, 3, -10,  0.5f, 3, 10,  -0.5f, 3, 10};
+  std::vector<uint32_t> box = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                               3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+  world.addTriangles(wall, box);
+
+  NavGridSettings grid;
+  grid.origin[0] = -16.0f; grid.origin[1] = -1.0f; grid.origin[2] = -16.0f;
+  grid.width = 64;
+  grid.depth = 64;
+  grid.levels = 2;
+  GridNav nav(grid);
+  REQUIRE(nav.bakeFromWorld(world));
+
+  PathService::Settings settings;
+  settings.workers = 2;
+  PathService service(nav, settings);
+  Registry registry;
+  std::vector<Entity> agents;
+  std::vector<Path> expected;
+  std::vector<Vec3> starts, goals;
+  for (int i = 0; i < 48; ++i) {
+    starts.push_back({-12.0f + (i % 6) * 0.1f, 0.0f, -8.0f + (i % 4) * 4.0f});
+    goals.push_back({12.0f, 0.0f, -12.0f + (i % 3) * 12.0f});
+    expected.push_back(nav.findPath(starts.back(), goals.back()));
+    agents.push_back(registry.create());
+  }
+  // Searches stay joinable until delivered, so however the workers race the
+  // submits, each distinct pair of cells is searched once
+  std::vector<std::pair<Cell, Cell>> distinct;
+  for (int i = 0; i < 48; ++i) {
+    Cell from, to;
+    REQUIRE(nav.locate(starts[i], from));
+    REQUIRE(nav.locate(goals[i], to));
+    auto same = [](const Cell& a, const Cell& b) { return a.x == b.x && a.y == b.y && a.level == b.level; };
+    bool seen = std::any_of(distinct.begin(), distinct.end(),
+                            [&](const auto& d) { return same(d.first, from) && same(d.second, to); });
+    if (!seen) distinct.push_back({from, to});
+  }
+  REQUIRE(distinct.size() < 48);
+  for (int i = 0; i < 48; ++i) service.submit(agents[i], starts[i], goals[i], i % 3);
+  for (int tick = 0; tick < 200 && service.stats().waiting > 0; ++tick) {
+    service.wait();
+    service.sync(registry);
+  }
+  REQUIRE(service.stats().waiting == 0);
+  REQUIRE(service.stats().searched == distinct.size());
+  REQUIRE(service.stats().shared == 48 - distinct.size());
+  for (size_t i = 0; i < agents.size(); ++i) {
+    const NavPath* path = registry.get<NavPath>(agents[i]);
+    REQUIRE(path != nullptr);
+    REQUIRE(path->path.ok);
+    REQUIRE(SamePath(path->path, expected[i]));
+  }
+}
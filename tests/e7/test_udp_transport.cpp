@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/net/udp_transport.hpp"
+#include "../support/loopback.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace arena;
+using namespace arena::net;
+using namespace arena::test;
+
+TEST_CASE("Datagrams cross loopback in batches", "[net][udp]") {
+  UdpTransport server(Loopback()), client(Loopback());
+  if (!server.open() || !client.open()) {
+    WARN("no UDP sockets here; skipping");
+    return;
+  }
+  REQUIRE(server.localEndpoint().port != 0);
+  REQUIRE(server.localEndpoint() == Endpoint::loopback(server.localEndpoint().port));
+
+  // Nowhere to send until there's a peer
+  uint8_t byte = 1;
+  REQUIRE_FALSE(server.send(&byte, 1));
+
+  client.setPeer(server.localEndpoint());
+  for (uint32_t i = 0; i < 100; ++i) {
+    auto bytes = Payload(i, 40 + i * 9);
+    REQUIRE(client.send(bytes.data(), bytes.size()));
+  }
+  REQUIRE(client.flush() == 100);
+  REQUIRE(client.stats().sent == 100);
+  REQUIRE(client.stats().sendCalls == 2); // 64 + 36
+
+  auto got = ReceiveAll(server, 100);
+  REQUIRE(got.size() == 100);
+  for (uint32_t i = 0; i < 100; ++i) {
+    REQUIRE(got[i].from == client.localEndpoint());
+    REQUIRE(got[i].bytes == Payload(i, 40 + i * 9));
+  }
+  REQUIRE(server.stats().receiveCalls <= 4);
+
+  // The server answers whoever it last heard from
+  REQUIRE(server.peer() == client.localEndpoint());
+  auto reply = Payload(7, 1200);
+  REQUIRE(server.send(reply.data(), reply.size()));
+  REQUIRE(server.flush() == 1);
+  got = ReceiveAll(client, 1);
+  REQUIRE(got.size() == 1);
+  REQUIRE(got[0].bytes == reply);
+  // A peer that was set stays
+  REQUIRE(client.peer() == server.localEndpoint());
+
+  // receive() cuts what doesn't fit
+  REQUIRE(server.send(reply.data(), reply.size()));
+  server.flush();
+  uint8_t small[16];
+  int n = 0;
+  for (int tries = 0; tries < 1000 && n == 0; ++tries) {
+    client.poll();
+    n = client.receive(small, sizeof(small));
+  }
+  REQUIRE(n == 16);
+  REQUIRE(std::memcmp(small, reply.data(), 16) == 0);
+}
+
+TEST_CASE("Queues refuse what they can't hold", "[net][udp]") {
+  UdpTransport::Settings s = Loopback();
+  s.maxPacket = 64;
+  s.sendSlots = 4;
+  s.receiveSlots = 8;
+  UdpTransport a(s), b(s);
+  if (!a.open() || !b.open()) {
+    WARN("no UDP sockets here; skipping");
+    return;
+  }
+  a.setPeer(b.localEndpoint());
+
+  uint8_t bytes[65] = {};
+  REQUIRE_FALSE(a.send(bytes, 65));
+  for (int i = 0; i < 4; ++i) REQUIRE(a.send(bytes, 64));
+  REQUIRE_FALSE(a.send(bytes, 1));
+  REQUIRE(a.stats().sendDropped == 2);
+  REQUIRE(a.flush() == 4);
+
+  // Twenty arrive; the queue takes eight and the rest wait in the socket
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      bytes[0] = static_cast<uint8_t>(4 + round * 4 + i);
+      REQUIRE(a.send(bytes, 10));
+    }
+    REQUIRE(a.flush() == 4);
+  }
+  auto first = ReceiveAll(b, 8);
+  REQUIRE(first.size() == 8);
+  REQUIRE(b.poll() == 8);
+  auto rest = ReceiveAll(b, 12);
+  REQUIRE(rest.size() == 12);
+  for (size_t i = 0; i < rest.size(); ++i) REQUIRE(rest[i].bytes[0] == 8 + i);
+  REQUIRE(b.stats().receiveDropped == 0);
+}
+
+TEST_CASE("The I/O thread sends and receives without poll", "[net][udp]") {
+  UdpTransport server(Loopback(true)), client(Loopback(true));
+  if (!server.open() || !client.open()) {
+    WARN("no UDP sockets here; skipping");
+    return;
+  }
+  client.setPeer(server.localEndpoint());
+
+  uint32_t received = 0;
+  uint8_t buffer[256];
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (uint32_t tick = 0; tick < 20; ++tick) {
+    for (uint32_t i = 0; i < 10; ++i) {
+      auto bytes = Payload(tick * 10 + i, 100);
+      REQUIRE(client.send(bytes.data(), bytes.size()));
+    }
+    REQUIRE(client.flush() == 0); // handed to the thread
+    REQUIRE(server.poll() == 0);
+    while (received < (tick + 1) * 10 && std::chrono::steady_clock::now() < deadline) {
+      int n = server.receive(buffer, sizeof(buffer));
+      if (n == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        continue;
+      }
+      REQUIRE(std::vector<uint8_t>(buffer, buffer + n) == Payload(received, 100));
+      ++received;
+    }
+  }
+  REQUIRE(received == 200);
+  client.close();
+  server.close();
+  REQUIRE(client.stats().sent == 200);
+  REQUIRE(server.stats().received == 200);
+}
+
+TEST_CASE("The loss sim drops and delays arrivals", "[net][udp]") {
+  UdpTransport a(Loopback()), b(Loopback());
+  if (!a.open() || !b.open()) {
+    WARN("no UDP sockets here; skipping");
+    return;
+  }
+  a.setPeer(b.localEndpoint());
+  b.setLossSim(50.0f, 0);
+
+  uint8_t buffer[64] = {};
+  size_t kept = 0;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (uint64_t round = 1; round <= 10; ++round) {
+    for (int i = 0; i < 100; ++i) REQUIRE(a.send(buffer, 32));
+    REQUIRE(a.flush() == 100);
+    while (b.stats().received < round * 100 && std::chrono::steady_clock::now() < deadline) {
+      b.poll();
+      while (b.receive(buffer, sizeof(buffer)) > 0) ++kept;
+    }
+  }
+  REQUIRE(b.stats().received == 1000);
+  REQUIRE(kept + b.stats().lossSimDropped == 1000);
+  REQUIRE(kept > 350);
+  REQUIRE(kept < 650);
+
+  // Jitter only: everything arrives, in order, some tens of ms late
+  b.setLossSim(0.0f, 30);
+  for (uint32_t i = 0; i < 20; ++i) {
+    auto bytes = Payload(i, 32);
+    REQUIRE(a.send(bytes.data(), bytes.size()));
+  }
+  auto start = std::chrono::steady_clock::now();
+  REQUIRE(a.flush() == 20);
+  auto late = ReceiveAll(b, 20);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  REQUIRE(late.size() == 20);
+  for (uint32_t i = 0; i < 20; ++i) REQUIRE(late[i].bytes == Payload(i, 32));
+  REQUIRE(ms >= 10.0);
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+#include "arena/net/udp_transport.hpp"
+#include "arena/net/uring_transport.hpp"
+#include "../support/loopback.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace arena;
+using namespace arena::net;
+using namespace arena::test;
+
+TEST_CASE("io_uring datagrams cross loopback with one enter per flush", "[net][uring]") {
+  UringTransport server(Loopback()), client(Loopback());
+  if (!server.open() || !client.open()) {
+    WARN("no io_uring here; skipping");
+    return;
+  }
+  REQUIRE(std::string(server.backend()) == "io_uring");
+  REQUIRE(server.localEndpoint() == Endpoint::loopback(server.localEndpoint().port));
+
+  client.setPeer(server.localEndpoint());
+  for (uint32_t i = 0; i < 100; ++i) {
+    auto bytes = Payload(i, 40 + i * 9);
+    REQUIRE(client.send(bytes.data(), bytes.size()));
+  }
+  REQUIRE(client.flush() == 100);
+  REQUIRE(client.stats().sendCalls == 1);
+
+  auto got = ReceiveAll(server, 100);
+  REQUIRE(got.size() == 100);
+  for (uint32_t i = 0; i < 100; ++i) {
+    REQUIRE(got[i].from == client.localEndpoint());
+    REQUIRE(got[i].bytes == Payload(i, 40 + i * 9));
+  }
+  // Only open() entered the kernel to receive; arrivals came in as completions
+  REQUIRE(server.stats().receiveCalls == 1);
+  for (int tries = 0; tries < 1000 && client.stats().sent < 100; ++tries) client.poll();
+  REQUIRE(client.stats().sent == 100);
+
+  auto reply = Payload(7, 1200);
+  REQUIRE(server.send(reply.data(), reply.size()));
+  REQUIRE(server.flush() == 1);
+  got = ReceiveAll(client, 1);
+  REQUIRE(got.size() == 1);
+  REQUIRE(got[0].bytes == reply);
+
+  // receive() cuts what doesn't fit, and a datagram over maxPacket is dropped
+  REQUIRE(server.send(reply.data(), reply.size()));
+  server.flush();
+  uint8_t small[16];
+  int n = 0;
+  for (int tries = 0; tries < 1000 && n == 0; ++tries) {
+    client.poll();
+    n = client.receive(small, sizeof(small));
+  }
+  REQUIRE(n == 16);
+  REQUIRE(std::memcmp(small, reply.data(), 16) == 0);
+
+  DatagramTransport::Settings s = Loopback();
+  s.maxPacket = 64;
+  UringTransport narrow(s);
+  REQUIRE(narrow.open());
+  client.setPeer(narrow.localEndpoint());
+  uint8_t bytes[128] = {};
+  REQUIRE(client.send(bytes, 100)); // client's maxPacket is the default
+  REQUIRE(client.send(bytes, 50));
+  client.flush();
+  got = ReceiveAll(narrow, 1);
+  REQUIRE(got.size() == 1);
+  REQUIRE(got[0].bytes.size() == 50);
+  REQUIRE(narrow.stats().receiveDropped == 1);
+}
+
+TEST_CASE("io_uring receive stops while every buffer is held and picks up after", "[net][uring]") {
+  DatagramTransport::Settings s = Loopback();
+  s.receiveSlots = 8;
+  UringTransport a(Loopback()), b(s);
+  if (!a.open() || !b.open()) {
+    WARN("no io_uring here; skipping");
+    return;
+  }
+  a.setPeer(b.localEndpoint());
+
+  uint8_t bytes[10] = {};
+  for (int i = 0; i < 20; ++i) {
+    bytes[0] = static_cast<uint8_t>(i);
+    REQUIRE(a.send(bytes, sizeof(bytes)));
+  }
+  REQUIRE(a.flush() == 20);
+
+  // Eight land in the buffers; the rest wait in the socket
+  size_t collected = 0;
+  for (int tries = 0; tries < 1000 && collected < 8; ++tries) {
+    collected += b.poll();
+    if (collected < 8) std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  REQUIRE(collected == 8);
+  REQUIRE(b.poll() == 0);
+  auto got = ReceiveAll(b, 20);
+  REQUIRE(got.size() == 20);
+  for (size_t i = 0; i < got.size(); ++i) REQUIRE(got[i].bytes[0] == i);
+  REQUIRE(b.stats().receiveDropped == 0);
+  REQUIRE(b.stats().receiveCalls >= 2); // re-armed at least once
+}
+
+TEST_CASE("Both backends carry a tick of many clients", "[net][uring]") {
+  std::unique_ptr<DatagramTransport> picked = openDatagramTransport(Loopback());
+  if (!picked) {
+    WARN("no UDP sockets here; skipping");
+    return;
+  }
+  std::string name = picked->backend();
+  REQUIRE((name == "io_uring" || name == "sendmmsg"));
+  picked.reset();
+
+  constexpr int kClients = 48, kTicks = 20;
+  for (bool uring : {false, true}) {
+    DatagramTransport::Settings s = Loopback();
+    std::unique_ptr<DatagramTransport> server;
+    if (uring) {
+      server = std::make_unique<UringTransport>(s);
+    } else {
+      server = std::make_unique<UdpTransport>(s);
+    }
+    if (!server->open()) {
+      WARN(std::string(server->backend()) + " unavailable; skipping it");
+      continue;
+    }
+    std::vector<std::unique_ptr<UdpTransport>> clients;
+    for (int i = 0; i < kClients; ++i) {
+      clients.push_back(std::make_unique<UdpTransport>(s));
+      REQUIRE(clients.back()->open());
+      clients.back()->setPeer(server->localEndpoint());
+    }
+
+    size_t inputs = 0, snapshots = 0;
+    uint8_t buffer[1500], snapshot[1000] = {};
+    for (int tick = 0; tick < kTicks; ++tick) {
+      for (auto& client : clients) {
+        buffer[0] = static_cast<uint8_t>(tick);
+        REQUIRE(client->send(buffer, 64));
+        client->flush();
+      }
+      std::vector<Endpoint> heard;
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (heard.size() < kClients && std::chrono::steady_clock::now() < deadline) {
+        server->poll();
+        Endpoint from;
+        while (server->receiveFrom(from, buffer, sizeof(buffer)) > 0) {
+          REQUIRE(buffer[0] == tick);
+          heard.push_back(from);
+        }
+      }
+      REQUIRE(heard.size() == kClients);
+      inputs += heard.size();
+      snapshot[0] = static_cast<uint8_t>(tick);
+      for (const Endpoint& to : heard) REQUIRE(server->sendTo(to, snapshot, sizeof(snapshot)));
+      REQUIRE(server->flush() == kClients);
+      for (auto& client : clients) snapshots += ReceiveAll(*client, 1).size();
+    }
+    REQUIRE(inputs == kClients * kTicks);
+    REQUIRE(snapshots == kClients * kTicks);
+    // io_uring sends complete after flush() returns
+    for (int tries = 0; tries < 1000 && server->stats().sent < kClients * kTicks; ++tries) server->poll();
+    DatagramTransport::Stats stats = server->stats();
+    REQUIRE(stats.sent == kClients * kTicks);
+    REQUIRE(stats.received == kClients * kTicks);
+    // Both make a handful of syscalls per tick, not one per client
+    REQUIRE(stats.sendCalls <= 2 * kTicks);
+    if (uring) REQUIRE(stats.receiveCalls <= kTicks);
+  }
+}
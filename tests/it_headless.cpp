@@ -1,4 +1,7 @@
 #include <catch2/catch_all.hpp>
+#include <cmath>
+#include "../src/app/Clock.hpp"
+#include "../src/app/Headless.hpp"
 
 extern "C" int RunHeadlessForMs(int ms, int tickHz);
 
@@ -7,3 +10,35 @@ TEST_CASE("Headless 1s ~ 60 ticks") {
     REQUIRE(ticks >= 59);
     REQUIRE(ticks <= 61);
 }
+
+TEST_CASE("Unthrottled simulation runs exact ticks faster than real time") {
+    uint64_t calls = 0;
+    // 10 simulated minutes at 60 Hz
+    SimulationReport report = RunHeadlessTicks(36000, 60, true,
+        [](const Clock&, void* user) { ++*static_cast<uint64_t*>(user); }, &calls);
+    
+    REQUIRE(report.ticks == 36000);
+    REQUIRE(calls == 36000);
+    REQUIRE(std::abs(report.simSeconds - 600.0) < 1e-6);
+    REQUIRE(report.wallSeconds < 60.0);
+    REQUIRE(report.ticksPerSecond > 600.0);
+}
+
+TEST_CASE("Simulation advances by exact dt steps") {
+    struct Trace { uint64_t lastTick = 0; bool monotonic = true; };
+    Trace trace;
+    RunHeadlessTicks(1000, 120, true, [](const Clock& clock, void* user) {
+        auto* t = static_cast<Trace*>(user);
+        if (clock.ticks != t->lastTick + 1 || clock.accumulator != 0.0) t->monotonic = false;
+        t->lastTick = clock.ticks;
+    }, &trace);
+    
+    REQUIRE(trace.monotonic);
+    REQUIRE(trace.lastTick == 1000);
+}
+
+TEST_CASE("Throttled simulation is paced to real time") {
+    SimulationReport report = RunHeadlessTicks(30, 60, false);
+    REQUIRE(report.ticks == 30);
+    REQUIRE(report.wallSeconds >= 0.45);
+}
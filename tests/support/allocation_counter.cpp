@@ -0,0 +1,31 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_failFrom{SIZE_MAX};
+
+void* Allocate(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (size >= g_failFrom.load(std::memory_order_relaxed)) throw std::bad_alloc();
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+size_t arena::test::allocationCount() { return g_allocations.load(std::memory_order_relaxed); }
+
+arena::test::FailAllocationsFrom::FailAllocationsFrom(size_t bytes) { g_failFrom = bytes; }
+arena::test::FailAllocationsFrom::~FailAllocationsFrom() { g_failFrom = SIZE_MAX; }
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+
+// Linking allocation_counter.cpp into a test executable replaces the global
+// operator new/delete (scalar and array forms) with malloc/free wrappers that
+// count every allocation, so hot paths can be checked for zero, and can
+// make large ones fail to exercise out-of-memory paths.
+namespace arena::test {
+
+// Allocations made through operator new or new[] so far, on any thread
+size_t allocationCount();
+
+// Allocations of at least bytes throw std::bad_alloc until the guard goes
+class FailAllocationsFrom {
+public:
+  explicit FailAllocationsFrom(size_t bytes);
+  ~FailAllocationsFrom();
+  FailAllocationsFrom(const FailAllocationsFrom&) = delete;
+  FailAllocationsFrom& operator=(const FailAllocationsFrom&) = delete;
+};
+
+} // namespace arena::test
@@ -0,0 +1,51 @@
+#pragma once
+#include "arena/net/datagram_transport.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Loopback fixtures shared by the transport tests: settings for a socket on
+// 127.0.0.1, recognisable payloads, and a bounded wait for datagrams.
+namespace arena::test {
+
+inline net::DatagramTransport::Settings Loopback(bool ioThread = false) {
+  net::DatagramTransport::Settings s;
+  s.loopbackOnly = true;
+  s.ioThread = ioThread;
+  return s;
+}
+
+// size bytes that start with seq and differ from every other seq's
+inline std::vector<uint8_t> Payload(uint32_t seq, size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) bytes[i] = static_cast<uint8_t>(seq * 31 + i);
+  std::memcpy(bytes.data(), &seq, sizeof(seq));
+  return bytes;
+}
+
+struct Datagram {
+  net::Endpoint from;
+  std::vector<uint8_t> bytes;
+};
+
+// Polls and drains until count datagrams have come in or a second has passed
+inline std::vector<Datagram> ReceiveAll(net::DatagramTransport& t, size_t count) {
+  std::vector<Datagram> got;
+  uint8_t buffer[2048];
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (got.size() < count && std::chrono::steady_clock::now() < deadline) {
+    t.poll();
+    net::Endpoint from;
+    while (got.size() < count) {
+      int n = t.receiveFrom(from, buffer, sizeof(buffer));
+      if (n <= 0) break;
+      got.push_back({from, std::vector<uint8_t>(buffer, buffer + n)});
+    }
+    if (got.size() < count) std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return got;
+}
+
+} // namespace arena::test
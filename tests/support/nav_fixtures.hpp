@@ -0,0 +1,99 @@
+#pragma once
+#include "arena/nav/grid_search.hpp"
+#include "arena/nav/nav_grid.hpp"
+#include "arena/phys/static_world.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Nav fixtures shared by the e6 tests: geometry to bake, grid settings,
+// random grids to compare searches and tables against their references on,
+// and a check that a path can be walked.
+namespace arena::test {
+
+// Horizontal quad at height y
+inline uint32_t AddSlab(phys::StaticWorld& world, float x0, float z0, float x1, float z1, float y) {
+  std::vector<float> pos = {x0, y, z0,  x1, y, z0,  x1, y, z1,  x0, y, z1};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  return world.addTriangles(pos, idx);
+}
+
+// Closed box from base up to base + height
+inline uint32_t AddBox(phys::StaticWorld& world, float x0, float z0, float x1, float z1, float height,
+                       float base = 0.0f) {
+  float y0 = base, y1 = base + height;
+  std::vector<float> pos = {x0, y0, z0,  x1, y0, z0,  x1, y0, z1,  x0, y0, z1,
+                            x0, y1, z0,  x1, y1, z0,  x1, y1, z1,  x0, y1, z1};
+  std::vector<uint32_t> idx = {0, 1, 5, 0, 5, 4,  1, 2, 6, 1, 6, 5,  2, 3, 7, 2, 7, 6,
+                               3, 0, 4, 3, 4, 7,  4, 5, 6, 4, 6, 7};
+  return world.addTriangles(pos, idx);
+}
+
+// Ramp along +x from (x, 0) rising to `rise` over `length`, spanning z0..z1
+inline uint32_t AddRamp(phys::StaticWorld& world, float x, float z0, float z1, float length, float rise) {
+  std::vector<float> pos = {x, 0, z0,  x, 0, z1,  x + length, rise, z1,  x + length, rise, z0};
+  std::vector<uint32_t> idx = {0, 1, 2,  0, 2, 3};
+  return world.addTriangles(pos, idx);
+}
+
+// 32 m square centred on the origin, 0.5 m cells, levels [-1, 3) and
+// [3, 7), 16-cell tiles
+inline nav::NavGridSettings SmallArena() {
+  nav::NavGridSettings s;
+  s.origin[0] = -16.0f; s.origin[1] = -1.0f; s.origin[2] = -16.0f;
+  s.width = 64;
+  s.depth = 64;
+  s.levels = 2;
+  s.tileSize = 16;
+  return s;
+}
+
+// width x depth cells of 0.5 m from the origin, levels [-1, 3) and [3, 7)
+inline nav::NavGridSettings GridSettings(int width, int depth, int tileSize = nav::NavGridSettings{}.tileSize) {
+  nav::NavGridSettings s;
+  s.origin[0] = 0.0f; s.origin[1] = -1.0f; s.origin[2] = 0.0f;
+  s.width = width;
+  s.depth = depth;
+  s.levels = 2;
+  s.tileSize = tileSize;
+  return s;
+}
+
+// Open floor with rectangular blocks, a `holes` share of cells missing and
+// a `ledges` share half a metre too tall to step up, and on the east side a
+// slope up to a deck on level 1. Regions aren't labelled.
+inline nav::NavGrid RandomGrid(std::mt19937& rng, int width, int depth, float holes, float ledges,
+                               int tileSize = nav::NavGridSettings{}.tileSize) {
+  nav::NavGrid grid(GridSettings(width, depth, tileSize));
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  int deck = width * 3 / 4;
+  for (int z = 0; z < depth; ++z) {
+    for (int x = 0; x < width; ++x) {
+      if (unit(rng) < holes) continue;
+      float y = x < deck - 9 ? 0.0f : x < deck ? 0.3f * (x - deck + 10) : 0.0f;
+      grid.setWalkable(x, z, 0, y + (ledges > 0.0f && unit(rng) < ledges ? 0.5f : 0.0f));
+      if (x >= deck) grid.setWalkable(x, z, 1, 3.0f);
+    }
+  }
+  std::uniform_int_distribution<int> px(0, width - 1), pz(0, depth - 1), size(1, 8);
+  for (int b = 0; b < width * depth / 80; ++b) {
+    int x0 = px(rng), z0 = pz(rng), w = size(rng), d = size(rng);
+    for (int z = z0; z < std::min(depth, z0 + d); ++z) {
+      for (int x = x0; x < std::min(width, x0 + w); ++x) grid.setBlocked(x, z, 0);
+    }
+  }
+  return grid;
+}
+
+// Every consecutive pair of waypoints in sight of each other, ending at goal
+inline bool Walkable(const nav::NavGrid& grid, const Path& path, const Cell& goal) {
+  if (!path.ok || path.count < 1) return false;
+  for (int i = 1; i < path.count; ++i) {
+    if (!nav::gridLineOfSight(grid, path.points[i - 1], path.points[i])) return false;
+  }
+  const Cell& last = path.points[path.count - 1];
+  return last.x == goal.x && last.y == goal.y && last.level == goal.level;
+}
+
+} // namespace arena::test
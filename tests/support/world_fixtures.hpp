@@ -0,0 +1,17 @@
+#pragma once
+#include "arena/contracts.hpp"
+#include "arena/phys/static_world.hpp"
+#include <cstdint>
+#include <vector>
+
+// StaticWorld geometry shared by the e5 tests
+namespace arena::test {
+
+// Quad a-b-c-d as two triangles; returns its mesh id
+inline uint32_t AddQuad(phys::StaticWorld& world, Vec3 a, Vec3 b, Vec3 c, Vec3 d) {
+  std::vector<float> pos = {a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z, d.x, d.y, d.z};
+  std::vector<uint32_t> idx = {0, 1, 2, 0, 2, 3};
+  return world.addTriangles(pos, idx);
+}
+
+} // namespace arena::test
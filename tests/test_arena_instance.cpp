@@ -0,0 +1,157 @@
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../src/app/ArenaInstance.hpp"
+#include "../src/app/ArenaScheduler.hpp"
+
+TEST_CASE("Arena instances own independent registries and clocks") {
+    auto assets = std::make_shared<SharedAssets>();
+    assets->meshes.push_back({{0,0,0, 1,0,0, 0,0,1}, {0,1,2}});
+    
+    ArenaInstance a(1, 60, assets);
+    ArenaInstance b(2, 30, assets);
+    
+    int aTicks = 0;
+    a.addSystem("count", [&](ArenaInstance&) { ++aTicks; });
+    
+    auto e = a.registry().create();
+    a.registry().add<arena::ecs::Transform>(e, {});
+    
+    a.tick(); a.tick();
+    b.step(0.1); // 3 ticks at 30 Hz
+    
+    REQUIRE(aTicks == 2);
+    REQUIRE(a.clock().ticks == 2);
+    REQUIRE(b.clock().ticks == 3);
+    REQUIRE(a.registry().has<arena::ecs::PreviousTransform>(e));
+    REQUIRE_FALSE(b.registry().alive(e));
+    
+    // Both arenas see the same read-only assets
+    REQUIRE(&a.assets() == &b.assets());
+    REQUIRE(a.assets().meshes.size() == 1);
+}
+
+TEST_CASE("Scheduler picks the arena that best evens out two workers") {
+    // Busiest worker at 0.9, idlest at 0.1: moving ~0.4 balances them
+    std::vector<double> loads = {0.1, 0.45, 0.35};
+    REQUIRE(ArenaScheduler::pickArenaToMove(loads, 0.9, 0.1) == 1);
+    
+    // Anything as big as the gap would just swap which worker is busiest
+    REQUIRE(ArenaScheduler::pickArenaToMove({0.5}, 0.5, 0.1) == -1);
+    REQUIRE(ArenaScheduler::pickArenaToMove({}, 0.5, 0.1) == -1);
+}
+
+TEST_CASE("Scheduler runs every arena to completion across workers") {
+    ArenaSchedulerOptions options;
+    options.workers = 3;
+    options.pinThreads = false;
+    options.unthrottled = true;
+    options.maxTicks = 200;
+    
+    ArenaScheduler scheduler(options);
+    std::atomic<int> totalTicks{0};
+    std::vector<ArenaInstance*> arenas;
+    for (uint32_t i = 0; i < 12; ++i) {
+        auto arena = std::make_unique<ArenaInstance>(i, 60, nullptr);
+        arena->addSystem("count", [&](ArenaInstance&) { ++totalTicks; });
+        arenas.push_back(&scheduler.add(std::move(arena)));
+    }
+    
+    auto counts = scheduler.arenasPerWorker();
+    REQUIRE(counts.size() == 3);
+    for (size_t c : counts) REQUIRE(c == 4);
+    
+    scheduler.start();
+    scheduler.wait();
+    
+    REQUIRE(totalTicks == 12 * 200);
+    for (auto* arena : arenas) REQUIRE(arena->clock().ticks == 200);
+}
+
+TEST_CASE("Scheduler migrates arenas off an overloaded worker") {
+    ArenaSchedulerOptions options;
+    options.workers = 2;
+    options.pinThreads = false;
+    options.unthrottled = true;
+    options.rebalanceIntervalSec = 3600.0; // only rebalance when asked
+    
+    ArenaScheduler scheduler(options);
+    // Arenas alternate between workers as they're added: worker 0 gets the slow ones
+    for (uint32_t i = 0; i < 4; ++i) {
+        auto arena = std::make_unique<ArenaInstance>(i, 60, nullptr);
+        if (i % 2 == 0) {
+            arena->addSystem("busy", [](ArenaInstance&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            });
+        }
+        scheduler.add(std::move(arena));
+    }
+    
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    scheduler.stop();
+    
+    auto loads = scheduler.workerLoads();
+    REQUIRE(loads[0] > loads[1]);
+    
+    REQUIRE(scheduler.rebalance());
+    REQUIRE(scheduler.migrations() == 1);
+    auto counts = scheduler.arenasPerWorker();
+    REQUIRE(counts[0] == 1);
+    REQUIRE(counts[1] == 3);
+}
+
+TEST_CASE("Scheduler queries don't wait for a tick in progress") {
+    ArenaSchedulerOptions options;
+    options.workers = 2;
+    options.pinThreads = false;
+    options.unthrottled = true;
+    options.rebalanceIntervalSec = 3600.0;
+    
+    ArenaScheduler scheduler(options);
+    std::atomic<bool> inTick{false};
+    auto slow = std::make_unique<ArenaInstance>(0, 60, nullptr);
+    slow->addSystem("slow", [&](ArenaInstance&) {
+        inTick = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    });
+    scheduler.add(std::move(slow));
+    scheduler.add(std::make_unique<ArenaInstance>(1, 60, nullptr));
+    
+    scheduler.start();
+    while (!inTick) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto start = std::chrono::steady_clock::now();
+    scheduler.workerLoads();
+    scheduler.arenasPerWorker();
+    scheduler.rebalance();
+    double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    scheduler.stop();
+    
+    REQUIRE(waited < 0.1);
+    // The arena mid-tick stayed on its worker
+    REQUIRE(scheduler.migrations() == 0);
+}
+
+TEST_CASE("Counter report has the tick, interpolation capture and each system") {
+    ArenaInstance arena(1, 60, nullptr);
+    arena.addSystem("movement", [](ArenaInstance&) {});
+    arena.addSystem("camera", [](ArenaInstance&) {});
+    
+    arena::perf::setEnabled(true);
+    arena.tick();
+    arena.tick();
+    arena::perf::setEnabled(false);
+    
+    auto report = arena.counterReport();
+    REQUIRE(report.size() == 4);
+    REQUIRE(report[0].name == "tick");
+    REQUIRE(report[1].name == "interpolation capture");
+    REQUIRE(report[2].name == "movement");
+    REQUIRE(report[3].name == "camera");
+    // Samples are only taken where the kernel grants counters
+    uint64_t expected = arena::perf::available() ? 2 : 0;
+    for (auto& entry : report) {
+        REQUIRE(entry.totals.samples == expected);
+    }
+}
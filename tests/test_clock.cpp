@@ -63,6 +63,23 @@ bool test_clock_accumulator_precision() {
   return true;
 }
 
+bool test_clock_alpha() {
+  std::cout << "\n=== Testing Clock interpolation alpha ===" << std::endl;
+  
+  Clock c;
+  c.dt = 1.0/60.0;
+  
+  uint32_t steps = c.step(c.dt * 2.5);
+  TEST_ASSERT(steps == 2, "step() should report 2 ticks for 2.5 dt");
+  TEST_ASSERT(c.alpha() > 0.49 && c.alpha() < 0.51, "Alpha should be ~0.5 with half a tick accumulated");
+  
+  steps = c.step(c.dt * 0.5);
+  TEST_ASSERT(steps == 1, "step() should report 1 tick once the accumulator fills");
+  TEST_ASSERT(c.alpha() >= 0.0 && c.alpha() < 0.01, "Alpha should be ~0 right after a tick");
+  
+  return true;
+}
+
 int main() {
   std::cout << "Arena Engine - Clock Tests (Simplified)" << std::endl;
   std::cout << "========================================" << std::endl;
@@ -74,6 +91,7 @@ int main() {
   ++total; if (test_clock_60_per_second()) ++passed;
   ++total; if (test_clock_90_for_1_5_seconds()) ++passed;
   ++total; if (test_clock_accumulator_precision()) ++passed;
+  ++total; if (test_clock_alpha()) ++passed;
   
   std::cout << "\n========================================" << std::endl;
   std::cout << "Test Results: " << passed << "/" << total << " tests passed" << std::endl;